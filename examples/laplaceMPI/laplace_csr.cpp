@@ -0,0 +1,170 @@
+/**********************************************************************************************
+ � 2020. Triad National Security, LLC. All rights reserved.
+ This program was produced under U.S. Government contract 89233218CNA000001 for Los Alamos
+ National Laboratory (LANL), which is operated by Triad National Security, LLC for the U.S.
+ Department of Energy/National Nuclear Security Administration. All rights in the program are
+ reserved by Triad National Security, LLC, and the U.S. Department of Energy/National Nuclear
+ Security Administration. The Government is granted for itself and others acting on its behalf a
+ nonexclusive, paid-up, irrevocable worldwide license in this material to reproduce, prepare
+ derivative works, distribute copies to the public, perform publicly and display publicly, and
+ to permit others to do so.
+ This program is open source under the BSD-3 License.
+ Redistribution and use in source and binary forms, with or without modification, are permitted
+ provided that the following conditions are met:
+ 1.  Redistributions of source code must retain the above copyright notice, this list of
+ conditions and the following disclaimer.
+ 2.  Redistributions in binary form must reproduce the above copyright notice, this list of
+ conditions and the following disclaimer in the documentation and/or other materials
+ provided with the distribution.
+ 3.  Neither the name of the copyright holder nor the names of its contributors may be used
+ to endorse or promote products derived from this software without specific prior
+ written permission.
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+ IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **********************************************************************************************/
+#include <mpi.h>
+#include <matar.h>
+#include <stdio.h>
+#include <math.h>
+#include <string>
+#include "krylov_solver.hpp"
+
+// Dont change ROOT
+#define ROOT  0
+// ----------------
+
+using namespace mtr; // matar namespace
+
+int    width  = 512;
+int    height = 512;
+int    max_num_iterations = 5000;
+double tolerance = 1e-8;
+
+// owned rows of the 5 point Laplacian on a height x width grid, global columns
+CSRArrayKokkos<double> build_rows(size_t row_begin, size_t num_rows);
+
+void parse_command_line(int argc, char* argv[]);
+
+// Same operator as laplace_mg.cpp, assembled as a sparse matrix whose rows
+// are split over the ranks in contiguous blocks and solved with CG. The
+// right hand side is A 1, so the error against 1 is known.
+int main(int argc, char* argv[])
+{
+    MPI_Init(&argc, &argv);
+    Kokkos::initialize(argc, argv);
+    { // kokkos scope
+        parse_command_line(argc, argv);
+
+        double begin_time_total = MPI_Wtime();
+
+        int world_size, rank;
+        MPI_Comm_size(MPI_COMM_WORLD, &world_size);
+        MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+
+        const size_t num_global = (size_t) height * width;
+        const size_t row_begin  = (num_global * rank) / world_size;
+        const size_t row_end    = (num_global * (rank + 1)) / world_size;
+
+        CSRArrayKokkos<double> rows = build_rows(row_begin, row_end - row_begin);
+        DistributedCSRMatrix<double> A(MPI_COMM_WORLD, rows);
+        const size_t n = A.num_owned_rows();
+
+        DCArrayKokkos<double> x(n, "x");
+        DCArrayKokkos<double> b(n, "b");
+        x.set_values(1.0);
+        A.apply(x, b);
+        x.set_values(0.0);
+
+        KrylovOptions options;
+        options.tolerance      = tolerance;
+        options.max_iterations = max_num_iterations;
+        options.comm           = A.comm();
+
+        // the diagonal is 4
+        auto jacobi = [](DCArrayKokkos<double>& r, DCArrayKokkos<double>& z) {
+            FOR_ALL(i, 0, r.size(), {
+                z(i) = 0.25 * r(i);
+            });
+        };
+
+        double begin_time_main_loop = MPI_Wtime();
+        KrylovResult result = cg_solve(A, x, b, options, jacobi);
+        double end_time = MPI_Wtime();
+
+        double error = 0.0;
+        double loc_error;
+        FOR_REDUCE_MAX(i, 0, n, loc_error, {
+            loc_error = fmax(loc_error, fabs(x(i) - 1.0));
+        }, error);
+        MPI_Allreduce(MPI_IN_PLACE, &error, 1, MPI_DOUBLE, MPI_MAX, MPI_COMM_WORLD);
+
+        if (rank == ROOT) {
+            printf("\n");
+            printf("Number of MPI processes = %d\n", world_size);
+            printf("height = %d; width = %d\n", height, width);
+            printf("Ghost columns on rank 0 = %zu\n", A.num_ghosts());
+            printf("Total code time was %10.6e seconds.\n", end_time - begin_time_total);
+            printf("Main loop time was %10.6e seconds.\n", end_time - begin_time_main_loop);
+            printf("Residual after %zu iterations was %10.6e, error %10.6e\n",
+                   result.iterations, result.residual, error);
+        }
+    } // end kokkos scope
+    Kokkos::finalize();
+    MPI_Finalize();
+    return 0;
+}
+
+CSRArrayKokkos<double> build_rows(size_t row_begin, size_t num_rows)
+{
+    const int h = height;
+    const int w = width;
+    SparseAssembler<double> assembler(num_rows, (size_t) h * w, 5 * num_rows);
+
+    FOR_ALL(r, 0, num_rows, {
+        const size_t row = row_begin + r;
+        const int i = row / w;
+        const int j = row % w;
+        const size_t slot = 5 * r;
+
+        // neighbors past the walls are Dirichlet zeros, added to the diagonal slot
+        assembler.insert(slot,     r, row,                   4.0);
+        assembler.insert(slot + 1, r, (i > 0)     ? row - w : row, (i > 0)     ? -1.0 : 0.0);
+        assembler.insert(slot + 2, r, (i < h - 1) ? row + w : row, (i < h - 1) ? -1.0 : 0.0);
+        assembler.insert(slot + 3, r, (j > 0)     ? row - 1 : row, (j > 0)     ? -1.0 : 0.0);
+        assembler.insert(slot + 4, r, (j < w - 1) ? row + 1 : row, (j < w - 1) ? -1.0 : 0.0);
+    });
+    return assembler.to_csr();
+}
+
+void parse_command_line(int argc, char* argv[])
+{
+    std::string opt;
+    int i = 1;
+    while (i < argc && argv[i][0] == '-')
+    {
+        opt = std::string(argv[i]);
+
+        if (opt == "-height") {
+            height = atoi(argv[++i]);
+        }
+
+        if (opt == "-width") {
+            width = atoi(argv[++i]);
+        }
+
+        if (opt == "-tolerance") {
+            tolerance = atof(argv[++i]);
+        }
+
+        ++i;
+    }
+}
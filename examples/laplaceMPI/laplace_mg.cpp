@@ -0,0 +1,141 @@
+/**********************************************************************************************
+ � 2020. Triad National Security, LLC. All rights reserved.
+ This program was produced under U.S. Government contract 89233218CNA000001 for Los Alamos
+ National Laboratory (LANL), which is operated by Triad National Security, LLC for the U.S.
+ Department of Energy/National Nuclear Security Administration. All rights in the program are
+ reserved by Triad National Security, LLC, and the U.S. Department of Energy/National Nuclear
+ Security Administration. The Government is granted for itself and others acting on its behalf a
+ nonexclusive, paid-up, irrevocable worldwide license in this material to reproduce, prepare
+ derivative works, distribute copies to the public, perform publicly and display publicly, and
+ to permit others to do so.
+ This program is open source under the BSD-3 License.
+ Redistribution and use in source and binary forms, with or without modification, are permitted
+ provided that the following conditions are met:
+ 1.  Redistributions of source code must retain the above copyright notice, this list of
+ conditions and the following disclaimer.
+ 2.  Redistributions in binary form must reproduce the above copyright notice, this list of
+ conditions and the following disclaimer in the documentation and/or other materials
+ provided with the distribution.
+ 3.  Neither the name of the copyright holder nor the names of its contributors may be used
+ to endorse or promote products derived from this software without specific prior
+ written permission.
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+ IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **********************************************************************************************/
+#include <mpi.h>
+#include <matar.h>
+#include <stdio.h>
+#include <math.h>
+#include <string>
+#include "multigrid_solver.hpp"
+
+// Dont change ROOT
+#define ROOT  0
+// ----------------
+
+using namespace mtr; // matar namespace
+
+int    width  = 1023;
+int    height = 1023;
+int    max_num_cycles = 50;
+double tolerance      = 1e-8;
+
+void set_boundary(DCArrayKokkos<double>& temperature, const CartesianDecomposition& decomp);
+void parse_command_line(int argc, char* argv[]);
+
+// Same problem as laplace_cart.cpp, solved with geometric multigrid instead
+// of Jacobi sweeps. The dims want 2^k - 1 points, the coarse levels are
+// gathered on one rank once the blocks get thin.
+int main(int argc, char* argv[])
+{
+    MPI_Init(&argc, &argv);
+    Kokkos::initialize(argc, argv);
+    { // kokkos scope
+        parse_command_line(argc, argv);
+
+        double begin_time_total = MPI_Wtime();
+
+        int world_size;
+        MPI_Comm_size(MPI_COMM_WORLD, &world_size);
+
+        CartesianOptions options;
+        CartesianDecomposition decomp(MPI_COMM_WORLD, options, height, width);
+        const int rank = decomp.rank();
+
+        GeometricMultigrid mg(decomp, 1.0);
+        DCArrayKokkos<double> temperature = mg.solution();
+        set_boundary(temperature, decomp);
+
+        double begin_time_main_loop = MPI_Wtime();
+        MultigridResult result = mg.solve(tolerance, max_num_cycles);
+        double end_time = MPI_Wtime();
+
+        if (rank == ROOT) {
+            printf("\n");
+            printf("Number of MPI processes = %d (%d x %d)\n", world_size, decomp.procs(0), decomp.procs(1));
+            printf("height = %d; width = %d\n", height, width);
+            printf("Levels across the ranks = %zu\n", mg.num_levels());
+            printf("Total code time was %10.6e seconds.\n", end_time - begin_time_total);
+            printf("Main loop time was %10.6e seconds.\n", end_time - begin_time_main_loop);
+            printf("Residual after %zu cycles was %10.6e\n", result.cycles, result.residual);
+        }
+    } // end kokkos scope
+    Kokkos::finalize();
+    MPI_Finalize();
+    return 0;
+}
+
+// the boundary conditions of laplace_mpi.cpp in the ghosts on the global edges
+void set_boundary(DCArrayKokkos<double>& temperature, const CartesianDecomposition& decomp)
+{
+    const int n  = decomp.local_dims(0);
+    const int m  = decomp.local_dims(1);
+    const int i0 = decomp.offset(0);
+    const int j0 = decomp.offset(1);
+    const int h  = height;
+    const int w  = width;
+
+    if (decomp.on_boundary(1, +1)) {
+        FOR_ALL(i, 0, n + 2, {
+            temperature(i, m + 1) = (100.0 / h) * (i0 + i);
+        });
+    }
+    if (decomp.on_boundary(0, +1)) {
+        FOR_ALL(j, 0, m + 2, {
+            temperature(n + 1, j) = (100.0 / w) * (j0 + j);
+        });
+    }
+}
+
+void parse_command_line(int argc, char* argv[])
+{
+    std::string opt;
+    int i = 1;
+    while (i < argc && argv[i][0] == '-')
+    {
+        opt = std::string(argv[i]);
+
+        if (opt == "-height") {
+            height = atoi(argv[++i]);
+        }
+
+        if (opt == "-width") {
+            width = atoi(argv[++i]);
+        }
+
+        if (opt == "-tolerance") {
+            tolerance = atof(argv[++i]);
+        }
+
+        ++i;
+    }
+}
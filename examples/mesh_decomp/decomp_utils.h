@@ -500,31 +500,24 @@ void naive_partition_mesh(
     // Timer for reverse mapping of element-node connectivity
     double t_reverse_map_start = MPI_Wtime();
 
-    // rebuild the local element-node connectivity using the local node ids
+    // rebuild the local element-node connectivity using the local node ids,
+    // the global to local lookup runs on the device through the partition map
+    PartitionMap<size_t> node_map(naive_mesh.local_to_global_node_mapping, MPI_COMM_WORLD, "node_map");
+
+    DCArrayKokkos<int> node_gids(num_elements_on_rank, num_nodes_per_elem, "node_gids");
     for(int i = 0; i < num_elements_on_rank; i++) {
         for(int j = 0; j < num_nodes_per_elem; j++) {
-            int node_gid = nodes_in_elem_on_rank[i * num_nodes_per_elem + j];
-
-            int node_lid = -1;
-
-            // Use binary search to find the local node index for node_gid, local_to_global_node_mapping is sorted
-            int left = 0, right = num_nodes_on_rank - 1;
-            while (left <= right) {
-                int mid = left + (right - left) / 2;
-                size_t mid_gid = naive_mesh.local_to_global_node_mapping.host(mid);
-                if (node_gid == mid_gid) {
-                    node_lid = mid;
-                    break;
-                } else if (node_gid < mid_gid) {
-                    right = mid - 1;
-                } else {
-                    left = mid + 1;
-                }
-            }
-
-            naive_mesh.nodes_in_elem.host(i, j) = node_lid;
+            node_gids.host(i, j) = nodes_in_elem_on_rank[i * num_nodes_per_elem + j];
         }
     }
+    node_gids.update_device();
+
+    FOR_ALL(i, 0, num_elements_on_rank,
+            j, 0, num_nodes_per_elem, {
+        naive_mesh.nodes_in_elem(i, j) = node_map.getLocalIndex(node_gids(i, j));
+    });
+    MATAR_FENCE();
+    naive_mesh.nodes_in_elem.update_host();
 
     MPI_Barrier(MPI_COMM_WORLD);
 
@@ -534,8 +527,6 @@ void naive_partition_mesh(
         std::cout<<" Reverse mapping time: " << (t_reverse_map_end - t_reverse_map_start) << " seconds." << std::endl;
     }
 
-    naive_mesh.nodes_in_elem.update_device();
-
     // ****************************************************************************************** 
     //     Build the connectivity for the local naive_mesh
     // ****************************************************************************************** 
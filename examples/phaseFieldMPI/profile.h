@@ -1,87 +0,0 @@
-/**********************************************************************************************
-  2020. Triad National Security, LLC. All rights reserved.
- This program was produced under U.S. Government contract 89233218CNA000001 for Los Alamos
- National Laboratory (LANL), which is operated by Triad National Security, LLC for the U.S.
- Department of Energy/National Nuclear Security Administration. All rights in the program are
- reserved by Triad National Security, LLC, and the U.S. Department of Energy/National Nuclear
- Security Administration. The Government is granted for itself and others acting on its behalf a
- nonexclusive, paid-up, irrevocable worldwide license in this material to reproduce, prepare
- derivative works, distribute copies to the public, perform publicly and display publicly, and
- to permit others to do so.
- This program is open source under the BSD-3 License.
- Redistribution and use in source and binary forms, with or without modification, are permitted
- provided that the following conditions are met:
- 1.  Redistributions of source code must retain the above copyright notice, this list of
- conditions and the following disclaimer.
- 2.  Redistributions in binary form must reproduce the above copyright notice, this list of
- conditions and the following disclaimer in the documentation and/or other materials
- provided with the distribution.
- 3.  Neither the name of the copyright holder nor the names of its contributors may be used
- to endorse or promote products derived from this software without specific prior
- written permission.
- THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
- IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
- IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
- PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
- CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
- EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
- PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
- OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
- WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
- OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
- ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
- **********************************************************************************************/
-#pragma once
-
-#include <chrono>
-#include <stdio.h>
-#include <string>
-#include <vector>
-
-// Defination of Event class
-class Event
-{
-// using chrono_t   = std::chrono;
-using clock_t    = std::chrono::high_resolution_clock;
-using duration_t = clock_t::duration;
-
-private:
-    clock_t::time_point start_time_;
-    duration_t total_time_;     // total time
-    int count_;          // current call count
-    std::string name_;           // name of event
-
-public:
-    Event(const std::string& name);
-    void start();
-    void stop();
-    double get_time_in_seconds();
-    int    get_count();
-    std::string& get_name();
-};
-
-// Defination of Profile class
-class Profile
-{
-// -----------------------------------------------
-// To use the profile class for another projects,
-// change the events. Remember to define the Events
-// in profile.cpp file since they are static members.
-public:
-    static Event total;
-    static Event fft_forward;
-    static Event fft_backward;
-// -----------------------------------------------
-
-private:
-    static std::vector<Event*> events_;
-
-public:
-    Profile();
-    static void start(Event& event);
-    static void stop(Event& event);
-    static void start_barrier(Event& event);
-    static void stop_barrier(Event& event);
-    static void print_one(Event& event);
-    static void print();
-};
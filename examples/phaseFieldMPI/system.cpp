@@ -165,14 +165,16 @@ double System::calculate_total_free_energy()
 void System::time_march()
 {
     // get foward fft of comp
-    Profile::start_barrier(Profile::fft_forward);
-    fft.forward(ga.comp.device_pointer(), ca.comp_img.device_pointer());
-    Profile::stop_barrier(Profile::fft_forward);
+    {
+        ProfileScope scope("fft_forward", ProfileCategory::compute);
+        fft.forward(ga.comp.device_pointer(), ca.comp_img.device_pointer());
+    }
 
     // get foward fft of dfdc
-    Profile::start_barrier(Profile::fft_forward);
-    fft.forward(ga.dfdc.device_pointer(), ca.dfdc_img.device_pointer());
-    Profile::stop_barrier(Profile::fft_forward);
+    {
+        ProfileScope scope("fft_forward", ProfileCategory::compute);
+        fft.forward(ga.dfdc.device_pointer(), ca.dfdc_img.device_pointer());
+    }
     Kokkos::fence();
 
     // solve Cahn Hilliard equation in fourier space
@@ -189,9 +191,10 @@ void System::time_march()
 
     // get backward fft of comp_img (note fft.backward was set to scale the result already.
     // you can chnage if needed in FFT3D_R2C class)
-    Profile::start_barrier(Profile::fft_backward);
-    fft.backward(ca.comp_img.device_pointer(), ga.comp.device_pointer());
-    Profile::stop_barrier(Profile::fft_backward);
+    {
+        ProfileScope scope("fft_backward", ProfileCategory::compute);
+        fft.backward(ca.comp_img.device_pointer(), ga.comp.device_pointer());
+    }
     Kokkos::fence();
 }
 
@@ -262,31 +265,34 @@ void System::output_total_free_energy(int iter)
 
 void System::solve()
 {
-    Profile::start_barrier(Profile::total);
+    {
+        ProfileScope total("total");
 
-    initialize_comp();
+        initialize_comp();
 
-    // time stepping loop
-    for (int iter = 1; iter <= sp.num_steps; iter++) {
-        // calculate df/dc
-        calculate_dfdc();
+        // time stepping loop
+        for (int iter = 1; iter <= sp.num_steps; iter++) {
+            // calculate df/dc
+            calculate_dfdc();
 
-        // Cahn Hilliard equation time step
-        time_march();
+            // Cahn Hilliard equation time step
+            time_march();
 
-        // report simulation progress and output vtk files
-        if (iter % sp.print_rate == 0) {
-            track_progress(iter);
+            // report simulation progress and output vtk files
+            if (iter % sp.print_rate == 0) {
+                track_progress(iter);
 
-            output_total_free_energy(iter);
+                output_total_free_energy(iter);
 
-            ga.comp.update_host();
-            vtk_writer.write(iter, ga.comp.host_pointer());
+                ga.comp.update_host();
+                vtk_writer.write(iter, ga.comp.host_pointer());
+            }
         }
     }
 
-    Profile::stop_barrier(Profile::total);
+    // the reduction is collective, the result is only valid on the root rank
+    std::vector<ProfileStats> stats = Profiler::instance().reduce_stats(comm);
     if (root == my_rank) {
-        Profile::print();
+        Profiler::print(stats);
     }
 }
@@ -44,7 +44,6 @@
 #include "global_arrays.h"
 #include "numeric"
 #include "complex_arrays.h"
-#include "profile.h"
 #include "vtk_writer_mpi_io.h"
 #include "heffte_backends.h"
 
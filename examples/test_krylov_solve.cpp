@@ -0,0 +1,227 @@
+/**********************************************************************************************
+ © 2020. Triad National Security, LLC. All rights reserved.
+ This program was produced under U.S. Government contract 89233218CNA000001 for Los Alamos
+ National Laboratory (LANL), which is operated by Triad National Security, LLC for the U.S.
+ Department of Energy/National Nuclear Security Administration. All rights in the program are
+ reserved by Triad National Security, LLC, and the U.S. Department of Energy/National Nuclear
+ Security Administration. The Government is granted for itself and others acting on its behalf a
+ nonexclusive, paid-up, irrevocable worldwide license in this material to reproduce, prepare
+ derivative works, distribute copies to the public, perform publicly and display publicly, and
+ to permit others to do so.
+ This program is open source under the BSD-3 License.
+ Redistribution and use in source and binary forms, with or without modification, are permitted
+ provided that the following conditions are met:
+ 
+ 1.  Redistributions of source code must retain the above copyright notice, this list of
+ conditions and the following disclaimer.
+ 
+ 2.  Redistributions in binary form must reproduce the above copyright notice, this list of
+ conditions and the following disclaimer in the documentation and/or other materials
+ provided with the distribution.
+ 
+ 3.  Neither the name of the copyright holder nor the names of its contributors may be used
+ to endorse or promote products derived from this software without specific prior
+ written permission.
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+ IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **********************************************************************************************/
+ 
+#include <stdio.h>
+#include <math.h>
+#include "krylov_solver.hpp"
+#include "preconditioners.hpp"
+
+// 2D Poisson, or convection diffusion when wind != 0, on a num x num grid
+// with Dirichlet walls, 5 slots per row in CSR format
+CSRArrayKokkos <double> build_matrix(size_t num, double wind);
+
+// b = A 1, so the exact solution is 1
+void build_rhs(const CSRArrayKokkos <double> &A, DCArrayKokkos <double> &b);
+
+double max_error(const DCArrayKokkos <double> &x);
+
+void report(const char *name, const KrylovResult &result, const DCArrayKokkos <double> &x);
+
+
+int main(int argc, char *argv[]){
+
+    Kokkos::initialize(argc, argv);
+    {
+
+        std::cout << "\ntesting MATAR Krylov solvers \n\n";
+
+        const size_t num  = 32;
+        const size_t size = num*num;
+
+        KrylovOptions options;
+        options.tolerance = 1e-10;
+        options.max_iterations = 2000;
+
+        DCArrayKokkos <double> x(size, "x");
+        DCArrayKokkos <double> b(size, "b");
+
+        // --- symmetric positive definite ---
+        CSRArrayKokkos <double> A = build_matrix(num, 0.0);
+        build_rhs(A, b);
+
+        x.set_values(0.0);
+        report("CG", cg_solve(A, x, b, options), x);
+
+        x.set_values(0.0);
+        report("pipelined CG", pipelined_cg_solve(A, x, b, options), x);
+
+        // Jacobi preconditioner, the diagonal is 4
+        auto jacobi = [](DCArrayKokkos <double> &r, DCArrayKokkos <double> &z){
+            FOR_ALL(i, 0, r.size(), {
+                z(i) = 0.25*r(i);
+            });
+        };
+
+        x.set_values(0.0);
+        report("CG + Jacobi", cg_solve(A, x, b, options, jacobi), x);
+
+        x.set_values(0.0);
+        report("pipelined CG + Jacobi", pipelined_cg_solve(A, x, b, options, jacobi), x);
+
+        // matrix free, the same operator as the CSR matrix
+        const int n = num;
+        auto laplace = [=](DCArrayKokkos <double> &u, DCArrayKokkos <double> &Au){
+            FOR_ALL(row, 0, n*n, {
+                const int i = row / n;
+                const int j = row % n;
+                double sum = 4.0*u(row);
+                if(i > 0)   sum -= u(row - n);
+                if(i < n-1) sum -= u(row + n);
+                if(j > 0)   sum -= u(row - 1);
+                if(j < n-1) sum -= u(row + 1);
+                Au(row) = sum;
+            });
+        };
+
+        x.set_values(0.0);
+        report("CG matrix free", cg_solve(laplace, x, b, options), x);
+
+        // incomplete Cholesky and block Jacobi
+        ICPreconditioner ic(A);
+        x.set_values(0.0);
+        report("CG + IC(0)", cg_solve(A, x, b, options, ic), x);
+
+        PreconditionerOptions sweeps;
+        sweeps.triangular = TriangularSolve::jacobi;
+        ICPreconditioner ic_sweeps(A, sweeps);
+        x.set_values(0.0);
+        report("CG + IC(0) sweeps", cg_solve(A, x, b, options, ic_sweeps), x);
+
+        PreconditionerOptions blocks;
+        blocks.block_size = num;
+        BlockJacobiPreconditioner block_jacobi(A, blocks);
+        x.set_values(0.0);
+        report("CG + block Jacobi", cg_solve(A, x, b, options, block_jacobi), x);
+
+        // --- nonsymmetric ---
+        CSRArrayKokkos <double> C = build_matrix(num, 0.5);
+        build_rhs(C, b);
+
+        x.set_values(0.0);
+        report("BiCGStab", bicgstab_solve(C, x, b, options), x);
+
+        x.set_values(0.0);
+        report("BiCGStab + Jacobi", bicgstab_solve(C, x, b, options, jacobi), x);
+
+        x.set_values(0.0);
+        report("GMRES(30)", gmres_solve(C, x, b, options), x);
+
+        x.set_values(0.0);
+        report("GMRES(30) + Jacobi", gmres_solve(C, x, b, options, jacobi), x);
+
+        ILUPreconditioner ilu(C);
+        x.set_values(0.0);
+        report("BiCGStab + ILU(0)", bicgstab_solve(C, x, b, options, ilu), x);
+
+        x.set_values(0.0);
+        report("GMRES(30) + ILU(0)", gmres_solve(C, x, b, options, ilu), x);
+
+    } // end of kokkos scope
+
+    Kokkos::finalize();
+
+    return 0;
+
+} // end function
+
+
+CSRArrayKokkos <double> build_matrix(size_t num, double wind){
+
+    const size_t size = num*num;
+    const int n = num;
+
+    CArrayKokkos <double> values(5*size, "values");
+    CArrayKokkos <size_t> columns(5*size, "columns");
+    CArrayKokkos <size_t> starts(size + 1, "starts");
+
+    // missing neighbors on the walls get a zero in the diagonal column
+    FOR_ALL(row, 0, n*n, {
+        const int i = row / n;
+        const int j = row % n;
+        const size_t k = 5*row;
+
+        values(k)  = 4.0;
+        columns(k) = row;
+
+        values(k+1)  = (i > 0) ? -1.0 - wind : 0.0;
+        columns(k+1) = (i > 0) ? row - n : row;
+        values(k+2)  = (i < n-1) ? -1.0 + wind : 0.0;
+        columns(k+2) = (i < n-1) ? row + n : row;
+        values(k+3)  = (j > 0) ? -1.0 - wind : 0.0;
+        columns(k+3) = (j > 0) ? row - 1 : row;
+        values(k+4)  = (j < n-1) ? -1.0 + wind : 0.0;
+        columns(k+4) = (j < n-1) ? row + 1 : row;
+    });
+
+    FOR_ALL(row, 0, n*n + 1, {
+        starts(row) = 5*row;
+    });
+
+    return CSRArrayKokkos <double> (values, starts, columns, size, size, "A");
+
+} // end function
+
+
+void build_rhs(const CSRArrayKokkos <double> &A, DCArrayKokkos <double> &b){
+
+    DCArrayKokkos <double> ones(b.size(), "ones");
+    ones.set_values(1.0);
+    krylov_apply(A, ones, b);
+
+} // end function
+
+
+double max_error(const DCArrayKokkos <double> &x){
+
+    double error = 0.0;
+    double loc_error;
+    FOR_REDUCE_MAX(i, 0, x.size(), loc_error, {
+        const double diff = fabs(x(i) - 1.0);
+        loc_error = diff > loc_error ? diff : loc_error;
+    }, error);
+
+    return error;
+
+} // end function
+
+
+void report(const char *name, const KrylovResult &result, const DCArrayKokkos <double> &x){
+
+    printf("%-24s converged = %d, iterations = %4zu, residual = %e, error = %e \n",
+           name, result.converged, result.iterations, result.residual, max_error(x));
+
+} // end function
@@ -0,0 +1,213 @@
+/**********************************************************************************************
+ © 2020. Triad National Security, LLC. All rights reserved.
+ This program was produced under U.S. Government contract 89233218CNA000001 for Los Alamos
+ National Laboratory (LANL), which is operated by Triad National Security, LLC for the U.S.
+ Department of Energy/National Nuclear Security Administration. All rights in the program are
+ reserved by Triad National Security, LLC, and the U.S. Department of Energy/National Nuclear
+ Security Administration. The Government is granted for itself and others acting on its behalf a
+ nonexclusive, paid-up, irrevocable worldwide license in this material to reproduce, prepare
+ derivative works, distribute copies to the public, perform publicly and display publicly, and
+ to permit others to do so.
+ This program is open source under the BSD-3 License.
+ Redistribution and use in source and binary forms, with or without modification, are permitted
+ provided that the following conditions are met:
+ 
+ 1.  Redistributions of source code must retain the above copyright notice, this list of
+ conditions and the following disclaimer.
+ 
+ 2.  Redistributions in binary form must reproduce the above copyright notice, this list of
+ conditions and the following disclaimer in the documentation and/or other materials
+ provided with the distribution.
+ 
+ 3.  Neither the name of the copyright holder nor the names of its contributors may be used
+ to endorse or promote products derived from this software without specific prior
+ written permission.
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+ IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **********************************************************************************************/
+ 
+#include <stdio.h>
+#include <math.h>
+#include "krylov_solver.hpp"
+#include "multigrid_solver.hpp"
+
+// -lap(u) = f on the unit square with u = sin(pi x) sin(pi y), so the error is
+// the discretization error once the solve has converged
+double poisson_2D(GeometricMultigrid &mg, size_t num);
+
+// u + dt (-lap(u)) = f on the unit cube with u = sin(pi x) sin(pi y) sin(pi z)
+double heat_step_3D(GeometricMultigrid &mg, size_t num, double dt);
+
+void report(const char *name, size_t num, const MultigridResult &result, double error);
+
+
+int main(int argc, char *argv[]){
+
+    Kokkos::initialize(argc, argv);
+    {
+
+        std::cout << "\ntesting MATAR geometric multigrid \n\n";
+
+        // the number of cycles should not grow with the grid
+        MultigridOptions options;
+        for(size_t num = 31; num <= 255; num = 2*num + 1){
+            GeometricMultigrid mg(1.0/(num + 1), num, num, options);
+            double error = poisson_2D(mg, num);
+            report("2D V-cycle, RBGS", num, mg.solve(1e-10, 50), error);
+        }
+
+        options.cycle    = MultigridCycle::W;
+        options.smoother = MultigridSmoother::weighted_jacobi;
+        for(size_t num = 31; num <= 255; num = 2*num + 1){
+            GeometricMultigrid mg(1.0/(num + 1), num, num, options);
+            double error = poisson_2D(mg, num);
+            report("2D W-cycle, Jacobi", num, mg.solve(1e-10, 50), error);
+        }
+
+        // implicit heat step, the shift makes it easier than Poisson
+        MultigridOptions heat;
+        heat.shift = 1.0;
+        for(size_t num = 15; num <= 63; num = 2*num + 1){
+            const double dt = 1e-2;
+            heat.diffusion = dt;
+            GeometricMultigrid mg(1.0/(num + 1), num, num, num, heat);
+            double error = heat_step_3D(mg, num, dt);
+            report("3D heat step, V-cycle", num, mg.solve(1e-10, 50), error);
+        }
+
+        // one V-cycle as a CG preconditioner, the matrix free operator of the
+        // 2D Poisson problem on the interior points with h = 1
+        const int n = 127;
+        MultigridOptions precondition;
+        precondition.pre_sweeps  = 1;
+        precondition.post_sweeps = 1;
+        GeometricMultigrid mg(1.0, n, n, precondition);
+
+        auto laplace = [=](DCArrayKokkos <double> &u, DCArrayKokkos <double> &Au){
+            FOR_ALL(row, 0, n*n, {
+                const int i = row / n;
+                const int j = row % n;
+                double sum = 4.0*u(row);
+                if(i > 0)   sum -= u(row - n);
+                if(i < n-1) sum -= u(row + n);
+                if(j > 0)   sum -= u(row - 1);
+                if(j < n-1) sum -= u(row + 1);
+                Au(row) = sum;
+            });
+        };
+
+        DCArrayKokkos <double> x(n*n, "x");
+        DCArrayKokkos <double> b(n*n, "b");
+        b.set_values(1.0);
+
+        KrylovOptions krylov_options;
+        krylov_options.tolerance = 1e-10;
+        krylov_options.max_iterations = 2000;
+
+        x.set_values(0.0);
+        KrylovResult result = cg_solve(laplace, x, b, krylov_options);
+        printf("%-24s n = %4d, iterations = %4zu, residual = %e \n",
+               "CG", n, result.iterations, result.residual);
+
+        x.set_values(0.0);
+        result = cg_solve(laplace, x, b, krylov_options, mg);
+        printf("%-24s n = %4d, iterations = %4zu, residual = %e \n",
+               "CG + multigrid", n, result.iterations, result.residual);
+
+    } // end of kokkos scope
+
+    Kokkos::finalize();
+
+    return 0;
+
+} // end function
+
+
+double poisson_2D(GeometricMultigrid &mg, size_t num){
+
+    const double h  = 1.0/(num + 1);
+    const double pi = M_PI;
+    const int n = num;
+
+    DCArrayKokkos <double> u = mg.solution();
+    DCArrayKokkos <double> f = mg.rhs();
+
+    // zero on the walls
+    FOR_ALL(i, 0, n + 2,
+            j, 0, n + 2, {
+        u(i, j) = 0.0;
+        f(i, j) = 2.0*pi*pi*sin(pi*i*h)*sin(pi*j*h);
+    });
+    mg.solve(1e-10, 50);
+
+    double error = 0.0;
+    double loc_error;
+    FOR_REDUCE_MAX(i, 1, n + 1,
+                   j, 1, n + 1, loc_error, {
+        const double diff = fabs(u(i, j) - sin(pi*i*h)*sin(pi*j*h));
+        loc_error = diff > loc_error ? diff : loc_error;
+    }, error);
+
+    // start over so the caller can count the cycles
+    FOR_ALL(i, 1, n + 1,
+            j, 1, n + 1, {
+        u(i, j) = 0.0;
+    });
+
+    return error;
+
+} // end function
+
+
+double heat_step_3D(GeometricMultigrid &mg, size_t num, double dt){
+
+    const double h  = 1.0/(num + 1);
+    const double pi = M_PI;
+    const int n = num;
+
+    DCArrayKokkos <double> u = mg.solution();
+    DCArrayKokkos <double> f = mg.rhs();
+
+    FOR_ALL(i, 0, n + 2,
+            j, 0, n + 2,
+            k, 0, n + 2, {
+        u(i, j, k) = 0.0;
+        f(i, j, k) = (1.0 + 3.0*pi*pi*dt)*sin(pi*i*h)*sin(pi*j*h)*sin(pi*k*h);
+    });
+    mg.solve(1e-10, 50);
+
+    double error = 0.0;
+    double loc_error;
+    FOR_REDUCE_MAX(i, 1, n + 1,
+                   j, 1, n + 1,
+                   k, 1, n + 1, loc_error, {
+        const double diff = fabs(u(i, j, k) - sin(pi*i*h)*sin(pi*j*h)*sin(pi*k*h));
+        loc_error = diff > loc_error ? diff : loc_error;
+    }, error);
+
+    FOR_ALL(i, 1, n + 1,
+            j, 1, n + 1,
+            k, 1, n + 1, {
+        u(i, j, k) = 0.0;
+    });
+
+    return error;
+
+} // end function
+
+
+void report(const char *name, size_t num, const MultigridResult &result, double error){
+
+    printf("%-24s n = %4zu, converged = %d, cycles = %2zu, residual = %e, error = %e \n",
+           name, num, result.converged, result.cycles, result.residual, error);
+
+} // end function
@@ -0,0 +1,141 @@
+/**********************************************************************************************
+ � 2020. Triad National Security, LLC. All rights reserved.
+ This program was produced under U.S. Government contract 89233218CNA000001 for Los Alamos
+ National Laboratory (LANL), which is operated by Triad National Security, LLC for the U.S.
+ Department of Energy/National Nuclear Security Administration. All rights in the program are
+ reserved by Triad National Security, LLC, and the U.S. Department of Energy/National Nuclear
+ Security Administration. The Government is granted for itself and others acting on its behalf a
+ nonexclusive, paid-up, irrevocable worldwide license in this material to reproduce, prepare
+ derivative works, distribute copies to the public, perform publicly and display publicly, and
+ to permit others to do so.
+ This program is open source under the BSD-3 License.
+ Redistribution and use in source and binary forms, with or without modification, are permitted
+ provided that the following conditions are met:
+ 1.  Redistributions of source code must retain the above copyright notice, this list of
+ conditions and the following disclaimer.
+ 2.  Redistributions in binary form must reproduce the above copyright notice, this list of
+ conditions and the following disclaimer in the documentation and/or other materials
+ provided with the distribution.
+ 3.  Neither the name of the copyright holder nor the names of its contributors may be used
+ to endorse or promote products derived from this software without specific prior
+ written permission.
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+ IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **********************************************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <matar.h>
+#include <chrono>
+
+using namespace mtr; // matar namespace
+
+// reproducible random numbers, one stream per (node, neighbor) pair
+KOKKOS_INLINE_FUNCTION
+uint64_t hash64(uint64_t x)
+{
+    x += 0x9e3779b97f4a7c15ULL;
+    x  = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    x  = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+    return x ^ (x >> 31);
+}
+
+// k := connect to k nearest neighbors, k/2 on each side
+// n := size of graph
+// p := rewire prob. should be 0 <= p <= 1
+// The same watts storgatz graph as kokkos_floyd.cpp, undirected and stored
+// as a CSR adjacency instead of a dense n x n matrix, so millions of nodes fit
+CSRArrayKokkos<double> wattsStorgatzGraph(int k, int n, double p)
+{
+    const int half = k / 2;
+    SparseAssembler<double> assembler(n, n, 2 * n * half);
+    FOR_ALL(i, 0, n,
+            j, 1, half + 1, {
+        const uint64_t seed = hash64(uint64_t(i) * k + j);
+        const double   coin = (seed % 10000) / 10000.0;
+        int target = (i + j) % n;
+        if (coin < p) {
+            target = (i + k + hash64(seed) % (n - 2 * k)) % n;
+        }
+        const size_t slot = 2 * (size_t(i) * half + j - 1);
+        assembler.insert(slot, i, target, 1.0);
+        assembler.insert(slot + 1, target, i, 1.0);
+    });
+    return assembler.to_csr();
+}
+
+// average shortest distance from num_sources evenly spaced sources, exact
+// when every node is a source
+double averageDistance(const CSRArrayKokkos<double>& G, int n, int num_sources)
+{
+    CArrayKokkos<int> distance(n);
+    double total = 0;
+    for (int s = 0; s < num_sources; s++) {
+        graph_bfs(G, (size_t(s) * n) / num_sources, distance);
+
+        double sum = 0;
+        double loc_sum;
+        FOR_REDUCE_SUM(i, 0, n,
+                       loc_sum, {
+            loc_sum += distance(i) > 0 ? distance(i) : 0;
+        }, sum);
+        total += sum / (n - 1);
+    }
+    return total / num_sources;
+}
+
+int main(int argc, char** argv)
+{
+    int    node_size   = 1000000;
+    double rewire_p    = 0.01;
+    int    k_nearest   = 6;
+    int    num_sources = 16;
+    if ((argc > 5) || (argc < 4)) {
+        printf("Usage is ./test_kokkos_bfs <number of nodes> <rewire prob.> <k nearest> [number of sources]\n");
+        printf("Using default values: [number of nodes: %d] [rewire_prob : %.2f] [k_nearest : %d] [sources : %d]\n",
+               node_size, rewire_p, k_nearest, num_sources);
+    }
+    else {
+        node_size = atoi(argv[1]);
+        rewire_p  = atof(argv[2]);
+        k_nearest = atoi(argv[3]);
+        if (argc == 5) {
+            num_sources = atoi(argv[4]);
+        }
+    }
+    printf("%d, %.5f, %d", node_size, rewire_p, k_nearest);
+    Kokkos::initialize(); {
+        auto start = std::chrono::high_resolution_clock::now(); // start clock
+        CSRArrayKokkos<double> G = wattsStorgatzGraph(k_nearest, node_size, rewire_p);
+
+        auto lap = std::chrono::high_resolution_clock::now();
+        auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(lap - start);
+        printf(", %.2f,", elapsed.count() * 1e-9);
+        double average_steps = averageDistance(G, node_size, num_sources);
+
+        auto lap2 = std::chrono::high_resolution_clock::now();
+        elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(lap2 - lap);
+        printf(" %.2f,", elapsed.count() * 1e-9);
+
+        CArrayKokkos<size_t> component(node_size);
+        size_t num_components = graph_components(G, component);
+        GraphColoring coloring = graph_color(G);
+
+        auto lap3 = std::chrono::high_resolution_clock::now();
+        elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(lap3 - lap2);
+        auto elapsed2 = std::chrono::duration_cast<std::chrono::nanoseconds>(lap3 - start);
+
+        printf(" %.2f, %.2f, ", elapsed.count() * 1e-9, elapsed2.count() * 1e-9);
+        printf("%f, %zu, %zu\n", average_steps, num_components, coloring.num_colors);
+    }
+    Kokkos::finalize();
+}
@@ -0,0 +1,756 @@
+#ifndef KRYLOVSOLVER_H
+#define KRYLOVSOLVER_H
+/**********************************************************************************************
+ © 2020. Triad National Security, LLC. All rights reserved.
+ This program was produced under U.S. Government contract 89233218CNA000001 for Los Alamos
+ National Laboratory (LANL), which is operated by Triad National Security, LLC for the U.S.
+ Department of Energy/National Nuclear Security Administration. All rights in the program are
+ reserved by Triad National Security, LLC, and the U.S. Department of Energy/National Nuclear
+ Security Administration. The Government is granted for itself and others acting on its behalf a
+ nonexclusive, paid-up, irrevocable worldwide license in this material to reproduce, prepare
+ derivative works, distribute copies to the public, perform publicly and display publicly, and
+ to permit others to do so.
+ This program is open source under the BSD-3 License.
+ Redistribution and use in source and binary forms, with or without modification, are permitted
+ provided that the following conditions are met:
+ 
+ 1.  Redistributions of source code must retain the above copyright notice, this list of
+ conditions and the following disclaimer.
+ 
+ 2.  Redistributions in binary form must reproduce the above copyright notice, this list of
+ conditions and the following disclaimer in the documentation and/or other materials
+ provided with the distribution.
+ 
+ 3.  Neither the name of the copyright holder nor the names of its contributors may be used
+ to endorse or promote products derived from this software without specific prior
+ written permission.
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+ IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **********************************************************************************************/
+#include <stdio.h>
+#include <cmath>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+
+#include "matar.h"
+using namespace mtr;
+
+
+// ---------------------------
+// Krylov solvers for A x = b
+// ---------------------------
+//
+//   KrylovOptions options;
+//   options.tolerance = 1e-10;                           // on ||r|| / ||b||
+//
+//   KrylovResult result = cg_solve(A, x, b, options);    // A is a CSRArrayKokkos <double>
+//
+//   auto laplace = [&](DCArrayKokkos <double> &u, DCArrayKokkos <double> &Au){
+//       FOR_ALL(i, 1, n-1, { Au(i) = 2.0*u(i) - u(i-1) - u(i+1); });
+//   };
+//   result = gmres_solve(laplace, x, b, options);        // matrix free
+//
+// The operator is a CSRArrayKokkos or anything callable as A(x, y) that
+// sets y = A x. A preconditioner is callable as M(r, z) and sets z = M^-1 r;
+// without one no preconditioned copies of the vectors are made.
+//
+// The vectors can be DCArrayKokkos, CArrayKokkos or, with MPI, a 1D
+// MPICArrayKokkos that has a comm plan: the owned entries come first, the
+// ghosts follow and are refreshed before every product with a CSR matrix.
+// Sums are then taken over the ranks of the plan, or over options.comm.
+//
+// Vector updates are fused with the dot products that follow them, so an
+// iteration passes over memory and reduces across ranks as few times as the
+// method allows. pipelined_cg_solve does one reduction per iteration and
+// overlaps it with the preconditioner and the matrix product.
+
+struct KrylovOptions {
+    double tolerance      = 1e-8;   // on ||r|| / ||b||
+    size_t max_iterations = 1000;
+    size_t restart        = 30;     // GMRES basis size
+#ifdef HAVE_MPI
+    MPI_Comm comm = MPI_COMM_NULL;  // ranks of a distributed DCArrayKokkos, not needed for MPICArrayKokkos
+#endif
+};
+
+struct KrylovResult {
+    bool   converged  = false;
+    size_t iterations = 0;
+    double residual   = 0.0;        // ||r|| / ||b||
+};
+
+// up to three sums from a single pass
+struct KrylovSums {
+    double v[3];
+
+    KOKKOS_INLINE_FUNCTION
+    KrylovSums() {
+        v[0] = 0.0;
+        v[1] = 0.0;
+        v[2] = 0.0;
+    }
+
+    KOKKOS_INLINE_FUNCTION
+    KrylovSums& operator+=(const KrylovSums& other) {
+        v[0] += other.v[0];
+        v[1] += other.v[1];
+        v[2] += other.v[2];
+        return *this;
+    }
+};
+
+namespace Kokkos {
+template <>
+struct reduction_identity<KrylovSums> {
+    KOKKOS_FORCEINLINE_FUNCTION static KrylovSums sum() {
+        return KrylovSums();
+    }
+};
+}
+
+
+// ---------------------------
+// Operators and preconditioners
+// ---------------------------
+
+// z = r
+struct KrylovIdentity {
+    template <typename Vector>
+    void operator()(Vector &r, Vector &z) const {
+        const size_t n = r.size();
+        FOR_ALL(i, 0, n, {
+            z(i) = r(i);
+        });
+    }
+};
+
+
+// ---------------------------
+// Vector helpers, overloaded for the distributed vectors
+// ---------------------------
+
+// number of entries owned by this rank
+template <typename Vector>
+size_t krylov_size(const Vector &v){
+    return v.size();
+}
+
+// work vector laid out like v
+template <typename Vector>
+Vector krylov_like(const Vector &v, const std::string &tag){
+    return Vector(v.size(), tag);
+}
+
+// refresh the ghost entries before a product
+template <typename Vector>
+void krylov_update_ghosts(Vector &){
+}
+
+#ifdef HAVE_MPI
+template <typename Vector>
+MPI_Comm krylov_comm(const Vector &){
+    return MPI_COMM_NULL;
+}
+
+inline bool krylov_has_plan(const MPICArrayKokkos <double> &v){
+    return v.comm_plan() != NULL && v.comm_plan()->comm_type != communication_plan_type::no_communication;
+}
+
+inline size_t krylov_size(const MPICArrayKokkos <double> &v){
+    return krylov_has_plan(v) ? v.dims(0) - v.comm_plan()->total_recv_count : v.dims(0);
+}
+
+inline MPICArrayKokkos <double> krylov_like(const MPICArrayKokkos <double> &v, const std::string &tag){
+    MPICArrayKokkos <double> like(v.dims(0), tag);
+    if(v.comm_plan() != NULL){
+        like.initialize_comm_plan(*v.comm_plan());
+    }
+    return like;
+}
+
+inline void krylov_update_ghosts(MPICArrayKokkos <double> &v){
+    if(krylov_has_plan(v)){
+        v.communicate();
+    }
+}
+
+inline MPI_Comm krylov_comm(const MPICArrayKokkos <double> &v){
+    return v.comm_plan() != NULL && v.comm_plan()->has_comm_world ? v.comm_plan()->mpi_comm_world : MPI_COMM_NULL;
+}
+#endif
+
+// sum local values over the ranks, if any
+template <typename Vector>
+void krylov_sum(KrylovSums &sums, const Vector &like, const KrylovOptions &options){
+#ifdef HAVE_MPI
+    MPI_Comm comm = (options.comm != MPI_COMM_NULL) ? options.comm : krylov_comm(like);
+    if(comm != MPI_COMM_NULL){
+        MATAR_PROFILE_SCOPE("krylov_sum", ProfileCategory::communication);
+        MPI_Allreduce(MPI_IN_PLACE, sums.v, 3, MPI_DOUBLE, MPI_SUM, comm);
+    }
+#endif
+}
+
+// y = A x
+template <typename Operator, typename Vector>
+void krylov_apply(const Operator &A, Vector &x, Vector &y){
+    A(x, y);
+}
+
+template <typename Vector>
+void krylov_apply(const CSRArrayKokkos <double> &A_csr, Vector &x, Vector &y){
+    krylov_update_ghosts(x);
+
+    CSRArrayKokkos <double> A = A_csr;
+    const size_t rows = A.dim1();
+    FOR_ALL(i, 0, rows, {
+        double sum = 0.0;
+        for(size_t k = A.begin_index(i); k < A.end_index(i); k++){
+            sum += A.get_val_flat(k) * x(A.get_col_flat(k));
+        }
+        y(i) = sum;
+    });
+}
+
+// (a, b) over the owned entries
+template <typename Vector>
+double krylov_dot(const Vector &a, const Vector &b, const KrylovOptions &options){
+    const size_t n = krylov_size(a);
+    KrylovSums sums;
+    KrylovSums loc_sums;
+    FOR_REDUCE_SUM(i, 0, n, loc_sums, {
+        loc_sums.v[0] += a(i) * b(i);
+    }, Kokkos::Sum<KrylovSums>(sums));
+    krylov_sum(sums, a, options);
+    return sums.v[0];
+}
+
+// r = b - A x, returns (b, b) and (r, r)
+template <typename Operator, typename Vector>
+KrylovSums krylov_residual(const Operator &A, Vector &x, const Vector &b, Vector &r, const KrylovOptions &options){
+    krylov_apply(A, x, r);
+
+    const size_t n = krylov_size(b);
+    KrylovSums sums;
+    KrylovSums loc_sums;
+    FOR_REDUCE_SUM(i, 0, n, loc_sums, {
+        const double ri = b(i) - r(i);
+        r(i) = ri;
+        loc_sums.v[0] += b(i) * b(i);
+        loc_sums.v[1] += ri * ri;
+    }, Kokkos::Sum<KrylovSums>(sums));
+    krylov_sum(sums, b, options);
+    return sums;
+}
+
+
+// ---------------------------
+// Conjugate gradient, A symmetric positive definite
+// ---------------------------
+template <typename Operator, typename Vector, typename Preconditioner = KrylovIdentity>
+KrylovResult cg_solve(const Operator &A,
+                      Vector &x,
+                      const Vector &b,
+                      const KrylovOptions &options = KrylovOptions(),
+                      const Preconditioner &M = Preconditioner()){
+
+    MATAR_PROFILE_SCOPE("cg_solve", ProfileCategory::compute);
+    constexpr bool precondition = !std::is_same<Preconditioner, KrylovIdentity>::value;
+    const size_t n = krylov_size(b);
+
+    Vector r  = krylov_like(b, "cg_r");
+    Vector p  = krylov_like(b, "cg_p");
+    Vector Ap = krylov_like(b, "cg_Ap");
+    Vector z  = r;
+    if(precondition){
+        z = krylov_like(b, "cg_z");
+    }
+
+    KrylovResult result;
+    KrylovSums sums = krylov_residual(A, x, b, r, options);
+    const double b_norm = (sums.v[0] > 0.0) ? sqrt(sums.v[0]) : 1.0;
+    result.residual  = sqrt(sums.v[1]) / b_norm;
+    result.converged = result.residual <= options.tolerance;
+    if(result.converged){
+        return result;
+    }
+
+    // p = z, rz = (r, z)
+    if(precondition){
+        M(r, z);
+    }
+    double rz;
+    double loc_rz;
+    FOR_REDUCE_SUM(i, 0, n, loc_rz, {
+        p(i) = z(i);
+        loc_rz += r(i) * z(i);
+    }, rz);
+    sums = KrylovSums();
+    sums.v[0] = rz;
+    krylov_sum(sums, b, options);
+    rz = sums.v[0];
+
+    for(size_t iter = 1; iter <= options.max_iterations; iter++){
+
+        krylov_apply(A, p, Ap);
+        const double alpha = rz / krylov_dot(p, Ap, options);
+
+        // x += alpha p, r -= alpha Ap, and (r, r) in the same pass
+        KrylovSums loc_sums;
+        sums = KrylovSums();
+        FOR_REDUCE_SUM(i, 0, n, loc_sums, {
+            x(i) += alpha * p(i);
+            const double ri = r(i) - alpha * Ap(i);
+            r(i) = ri;
+            loc_sums.v[0] += ri * ri;
+        }, Kokkos::Sum<KrylovSums>(sums));
+        krylov_sum(sums, b, options);
+
+        result.iterations = iter;
+        result.residual   = sqrt(sums.v[0]) / b_norm;
+        if(result.residual <= options.tolerance){
+            result.converged = true;
+            break;
+        }
+
+        double rz_new = sums.v[0];
+        if(precondition){
+            M(r, z);
+            rz_new = krylov_dot(r, z, options);
+        }
+        const double beta = rz_new / rz;
+        rz = rz_new;
+
+        FOR_ALL(i, 0, n, {
+            p(i) = z(i) + beta * p(i);
+        });
+    } // end for iter
+
+    return result;
+
+} // end of cg_solve
+
+
+// ---------------------------
+// Pipelined conjugate gradient (Ghysels and Vanroose), one reduction per
+// iteration overlapped with the preconditioner and the matrix product.
+// It needs a few more vectors than cg_solve and the recurrences drift a
+// little more, so it pays off when the reductions are what limits scaling.
+// ---------------------------
+template <typename Operator, typename Vector, typename Preconditioner = KrylovIdentity>
+KrylovResult pipelined_cg_solve(const Operator &A,
+                                Vector &x,
+                                const Vector &b,
+                                const KrylovOptions &options = KrylovOptions(),
+                                const Preconditioner &M = Preconditioner()){
+
+    MATAR_PROFILE_SCOPE("pipelined_cg_solve", ProfileCategory::compute);
+    constexpr bool precondition = !std::is_same<Preconditioner, KrylovIdentity>::value;
+    const size_t n = krylov_size(b);
+
+    // without a preconditioner u = r, m = w and q = s
+    Vector r  = krylov_like(b, "pcg_r");
+    Vector w  = krylov_like(b, "pcg_w");
+    Vector nv = krylov_like(b, "pcg_n");
+    Vector z  = krylov_like(b, "pcg_z");
+    Vector s  = krylov_like(b, "pcg_s");
+    Vector p  = krylov_like(b, "pcg_p");
+    Vector u  = r;
+    Vector m  = w;
+    Vector q  = s;
+    if(precondition){
+        u = krylov_like(b, "pcg_u");
+        m = krylov_like(b, "pcg_m");
+        q = krylov_like(b, "pcg_q");
+        q.set_values(0.0);
+    }
+    z.set_values(0.0);
+    s.set_values(0.0);
+    p.set_values(0.0);
+
+    KrylovResult result;
+    KrylovSums sums = krylov_residual(A, x, b, r, options);
+    const double b_norm = (sums.v[0] > 0.0) ? sqrt(sums.v[0]) : 1.0;
+    result.residual  = sqrt(sums.v[1]) / b_norm;
+    result.converged = result.residual <= options.tolerance;
+    if(result.converged){
+        return result;
+    }
+
+    if(precondition){
+        M(r, u);
+    }
+    krylov_apply(A, u, w);
+
+    // gamma = (r, u), delta = (w, u), (r, r)
+    KrylovSums loc_sums;
+    sums = KrylovSums();
+    FOR_REDUCE_SUM(i, 0, n, loc_sums, {
+        loc_sums.v[0] += r(i) * u(i);
+        loc_sums.v[1] += w(i) * u(i);
+        loc_sums.v[2] += r(i) * r(i);
+    }, Kokkos::Sum<KrylovSums>(sums));
+
+    double gamma_old = 1.0;
+    double alpha_old = 1.0;
+    for(size_t iter = 1; iter <= options.max_iterations + 1; iter++){
+
+        // start the reduction, m = M w and n = A m while it runs
+        KrylovSums global = sums;
+#ifdef HAVE_MPI
+        MPI_Comm comm = (options.comm != MPI_COMM_NULL) ? options.comm : krylov_comm(b);
+        MPI_Request request = MPI_REQUEST_NULL;
+        if(comm != MPI_COMM_NULL){
+            MPI_Iallreduce(sums.v, global.v, 3, MPI_DOUBLE, MPI_SUM, comm, &request);
+        }
+#endif
+        if(precondition){
+            M(w, m);
+        }
+        krylov_apply(A, m, nv);
+#ifdef HAVE_MPI
+        if(request != MPI_REQUEST_NULL){
+            MATAR_PROFILE_SCOPE("pipelined_cg_solve::wait", ProfileCategory::communication);
+            MPI_Wait(&request, MPI_STATUS_IGNORE);
+        }
+#endif
+
+        const double gamma = global.v[0];
+        const double delta = global.v[1];
+        result.iterations = iter - 1;
+        result.residual   = sqrt(global.v[2]) / b_norm;
+        if(result.residual <= options.tolerance){
+            result.converged = true;
+            break;
+        }
+        if(iter > options.max_iterations){
+            break;
+        }
+
+        double alpha = gamma / delta;
+        double beta  = 0.0;
+        if(iter > 1){
+            beta  = gamma / gamma_old;
+            alpha = gamma / (delta - beta * gamma / alpha_old);
+        }
+        gamma_old = gamma;
+        alpha_old = alpha;
+
+        // all the recurrences and the next three dots in one pass
+        sums = KrylovSums();
+        FOR_REDUCE_SUM(i, 0, n, loc_sums, {
+            const double zi = nv(i) + beta * z(i);
+            const double si = w(i) + beta * s(i);
+            const double pi = u(i) + beta * p(i);
+            z(i) = zi;
+            s(i) = si;
+            p(i) = pi;
+            x(i) += alpha * pi;
+            const double ri = r(i) - alpha * si;
+            const double wi = w(i) - alpha * zi;
+            r(i) = ri;
+            w(i) = wi;
+            double ui = ri;
+            if(precondition){
+                const double qi = m(i) + beta * q(i);
+                q(i) = qi;
+                ui = u(i) - alpha * qi;
+                u(i) = ui;
+            }
+            loc_sums.v[0] += ri * ui;
+            loc_sums.v[1] += wi * ui;
+            loc_sums.v[2] += ri * ri;
+        }, Kokkos::Sum<KrylovSums>(sums));
+    } // end for iter
+
+    return result;
+
+} // end of pipelined_cg_solve
+
+
+// ---------------------------
+// BiCGStab, right preconditioned, for nonsymmetric A
+// ---------------------------
+template <typename Operator, typename Vector, typename Preconditioner = KrylovIdentity>
+KrylovResult bicgstab_solve(const Operator &A,
+                            Vector &x,
+                            const Vector &b,
+                            const KrylovOptions &options = KrylovOptions(),
+                            const Preconditioner &M = Preconditioner()){
+
+    MATAR_PROFILE_SCOPE("bicgstab_solve", ProfileCategory::compute);
+    constexpr bool precondition = !std::is_same<Preconditioner, KrylovIdentity>::value;
+    const size_t n = krylov_size(b);
+
+    Vector r     = krylov_like(b, "bicgstab_r");
+    Vector r_hat = krylov_like(b, "bicgstab_r_hat");
+    Vector p     = krylov_like(b, "bicgstab_p");
+    Vector v     = krylov_like(b, "bicgstab_v");
+    Vector t     = krylov_like(b, "bicgstab_t");
+    Vector p_hat = p;
+    Vector s_hat = r;   // s is kept in r
+    if(precondition){
+        p_hat = krylov_like(b, "bicgstab_p_hat");
+        s_hat = krylov_like(b, "bicgstab_s_hat");
+    }
+    p.set_values(0.0);
+    v.set_values(0.0);
+
+    KrylovResult result;
+    KrylovSums sums = krylov_residual(A, x, b, r, options);
+    const double b_norm = (sums.v[0] > 0.0) ? sqrt(sums.v[0]) : 1.0;
+    result.residual  = sqrt(sums.v[1]) / b_norm;
+    result.converged = result.residual <= options.tolerance;
+    if(result.converged){
+        return result;
+    }
+
+    FOR_ALL(i, 0, n, {
+        r_hat(i) = r(i);
+    });
+
+    double rho_old = 1.0;
+    double alpha   = 1.0;
+    double omega   = 1.0;
+    double rho     = sums.v[1];   // (r_hat, r)
+
+    for(size_t iter = 1; iter <= options.max_iterations; iter++){
+
+        const double beta = (rho / rho_old) * (alpha / omega);
+        rho_old = rho;
+
+        FOR_ALL(i, 0, n, {
+            p(i) = r(i) + beta * (p(i) - omega * v(i));
+        });
+        if(precondition){
+            M(p, p_hat);
+        }
+        krylov_apply(A, p_hat, v);
+        alpha = rho / krylov_dot(r_hat, v, options);
+
+        // s = r - alpha v, kept in r, and (s, s)
+        KrylovSums loc_sums;
+        sums = KrylovSums();
+        FOR_REDUCE_SUM(i, 0, n, loc_sums, {
+            const double si = r(i) - alpha * v(i);
+            r(i) = si;
+            loc_sums.v[0] += si * si;
+        }, Kokkos::Sum<KrylovSums>(sums));
+        krylov_sum(sums, b, options);
+
+        result.iterations = iter;
+        if(sqrt(sums.v[0]) / b_norm <= options.tolerance){
+            FOR_ALL(i, 0, n, {
+                x(i) += alpha * p_hat(i);
+            });
+            result.residual  = sqrt(sums.v[0]) / b_norm;
+            result.converged = true;
+            break;
+        }
+
+        if(precondition){
+            M(r, s_hat);
+        }
+        krylov_apply(A, s_hat, t);
+
+        // (t, s) and (t, t)
+        sums = KrylovSums();
+        FOR_REDUCE_SUM(i, 0, n, loc_sums, {
+            loc_sums.v[0] += t(i) * r(i);
+            loc_sums.v[1] += t(i) * t(i);
+        }, Kokkos::Sum<KrylovSums>(sums));
+        krylov_sum(sums, b, options);
+        omega = sums.v[0] / sums.v[1];
+
+        // x += alpha p_hat + omega s_hat, r = s - omega t, (r, r) and (r_hat, r)
+        sums = KrylovSums();
+        FOR_REDUCE_SUM(i, 0, n, loc_sums, {
+            x(i) += alpha * p_hat(i) + omega * s_hat(i);
+            const double ri = r(i) - omega * t(i);
+            r(i) = ri;
+            loc_sums.v[0] += ri * ri;
+            loc_sums.v[1] += r_hat(i) * ri;
+        }, Kokkos::Sum<KrylovSums>(sums));
+        krylov_sum(sums, b, options);
+
+        result.residual = sqrt(sums.v[0]) / b_norm;
+        rho = sums.v[1];
+        if(result.residual <= options.tolerance){
+            result.converged = true;
+            break;
+        }
+    } // end for iter
+
+    return result;
+
+} // end of bicgstab_solve
+
+
+// ---------------------------
+// Restarted GMRES(m), right preconditioned. The basis is orthogonalized
+// with modified Gram-Schmidt where each update w -= h_i v_i is fused with
+// the next dot product (w, v_i+1).
+// ---------------------------
+template <typename Operator, typename Vector, typename Preconditioner = KrylovIdentity>
+KrylovResult gmres_solve(const Operator &A,
+                         Vector &x,
+                         const Vector &b,
+                         const KrylovOptions &options = KrylovOptions(),
+                         const Preconditioner &M = Preconditioner()){
+
+    MATAR_PROFILE_SCOPE("gmres_solve", ProfileCategory::compute);
+    constexpr bool precondition = !std::is_same<Preconditioner, KrylovIdentity>::value;
+    const size_t n = krylov_size(b);
+    const size_t m = (options.restart > 0) ? options.restart : 1;
+
+    std::vector<Vector> V(m + 1);
+    for(size_t j = 0; j <= m; j++){
+        V[j] = krylov_like(b, "gmres_v");
+    }
+    Vector t = krylov_like(b, "gmres_t");
+    Vector u = t;
+    if(precondition){
+        u = krylov_like(b, "gmres_u");
+    }
+
+    // Hessenberg matrix, Givens rotations and the rotated right hand side, on the host
+    std::vector<double> H((m + 1) * m, 0.0);
+    std::vector<double> cs(m, 0.0);
+    std::vector<double> sn(m, 0.0);
+    std::vector<double> g(m + 1, 0.0);
+    std::vector<double> y(m, 0.0);
+
+    KrylovResult result;
+    double b_norm = 1.0;
+    bool first = true;
+
+    while(true){
+
+        Vector v0 = V[0];
+        KrylovSums sums = krylov_residual(A, x, b, v0, options);
+        if(first){
+            b_norm = (sums.v[0] > 0.0) ? sqrt(sums.v[0]) : 1.0;
+            first  = false;
+        }
+        const double beta = sqrt(sums.v[1]);
+        result.residual = beta / b_norm;
+        if(result.residual <= options.tolerance){
+            result.converged = true;
+            break;
+        }
+        if(result.iterations >= options.max_iterations){
+            break;
+        }
+
+        FOR_ALL(i, 0, n, {
+            v0(i) /= beta;
+        });
+        std::fill(g.begin(), g.end(), 0.0);
+        g[0] = beta;
+
+        size_t k = 0;
+        while(k < m && result.iterations < options.max_iterations){
+
+            Vector vk = V[k];
+            Vector w  = V[k + 1];
+            if(precondition){
+                M(vk, u);
+                krylov_apply(A, u, w);
+            }
+            else {
+                krylov_apply(A, vk, w);
+            }
+
+            // h_0 = (w, v_0); then w -= h_i v_i together with h_i+1, or ||w|| after the last
+            double h = krylov_dot(w, V[0], options);
+            for(size_t i = 0; i <= k; i++){
+                H[i * m + k] = h;
+                Vector vi = V[i];
+                Vector vn = V[(i < k) ? i + 1 : i];
+                const bool last = (i == k);
+                KrylovSums loc_sums;
+                KrylovSums sums_i;
+                FOR_REDUCE_SUM(l, 0, n, loc_sums, {
+                    const double wl = w(l) - h * vi(l);
+                    w(l) = wl;
+                    loc_sums.v[0] += wl * (last ? wl : vn(l));
+                }, Kokkos::Sum<KrylovSums>(sums_i));
+                krylov_sum(sums_i, b, options);
+                h = sums_i.v[0];
+            }
+            const double w_norm = sqrt(h);
+            H[(k + 1) * m + k] = w_norm;
+
+            if(w_norm > 0.0){
+                FOR_ALL(l, 0, n, {
+                    w(l) /= w_norm;
+                });
+            }
+
+            // rotate the new column and eliminate the subdiagonal
+            for(size_t i = 0; i < k; i++){
+                const double a = H[i * m + k];
+                const double c = H[(i + 1) * m + k];
+                H[i * m + k]       =  cs[i] * a + sn[i] * c;
+                H[(i + 1) * m + k] = -sn[i] * a + cs[i] * c;
+            }
+            const double a = H[k * m + k];
+            const double c = H[(k + 1) * m + k];
+            const double r = sqrt(a * a + c * c);
+            cs[k] = (r > 0.0) ? a / r : 1.0;
+            sn[k] = (r > 0.0) ? c / r : 0.0;
+            H[k * m + k]       = r;
+            H[(k + 1) * m + k] = 0.0;
+            g[k + 1] = -sn[k] * g[k];
+            g[k]     =  cs[k] * g[k];
+
+            k++;
+            result.iterations++;
+            result.residual = fabs(g[k]) / b_norm;
+            if(result.residual <= options.tolerance || w_norm == 0.0){
+                break;
+            }
+        } // end while k
+
+        // H y = g, then x += M^-1 V y
+        for(int i = static_cast<int>(k) - 1; i >= 0; i--){
+            double sum = g[i];
+            for(size_t j = i + 1; j < k; j++){
+                sum -= H[i * m + j] * y[j];
+            }
+            y[i] = sum / H[i * m + i];
+        }
+
+        Vector target = precondition ? t : x;
+        for(size_t j = 0; j < k; j++){
+            Vector vj = V[j];
+            const double yj = y[j];
+            const bool first_term = precondition && (j == 0);
+            FOR_ALL(l, 0, n, {
+                target(l) = (first_term ? 0.0 : target(l)) + yj * vj(l);
+            });
+        }
+        if(precondition){
+            M(t, u);
+            FOR_ALL(l, 0, n, {
+                x(l) += u(l);
+            });
+        }
+    } // end while restart
+
+    return result;
+
+} // end of gmres_solve
+
+#endif // KRYLOVSOLVER_H
@@ -52,12 +52,14 @@ const double TINY = 1e-15;
 // ---------------------------
 
 
-// the function is run on the GPU
+// the function is run on the GPU, the arrays can be a DCArrayKokkos or
+// views of one block of a batch, e.g. ViewCArrayKokkos in a FOR_ALL
+template <typename Matrix, typename Permutation, typename Scale>
 KOKKOS_FUNCTION
 int LU_decompose(
-    const DCArrayKokkos <double> &A, // matrix A passed in and is sent out in LU decomp format
-    const DCArrayKokkos <size_t> &perm,  // permutations
-    const CArrayKokkos <double> &vv,
+    const Matrix &A,               // matrix A passed in and is sent out in LU decomp format
+    const Permutation &perm,       // permutations
+    const Scale &vv,
     int &parity) {                 // parity (+1 or -1)
                           
     const int n = A.dims(0);  // size of matrix 
@@ -163,12 +165,13 @@ int LU_decompose(
 // LU back substitution functions 
 // -------------------------------
 
-// this function is run on the GPU
+// this function is run on the GPU, with the same arrays as LU_decompose
+template <typename Matrix, typename Permutation, typename Vector>
 KOKKOS_FUNCTION
 void LU_backsub(
-    const DCArrayKokkos <double> &A,     // input matrix A in LU decomp format
-    const DCArrayKokkos <size_t> &perm,  // permutations
-    const DCArrayKokkos <double> &b){          // RHS and is answer x to Ax=B
+    const Matrix &A,               // input matrix A in LU decomp format
+    const Permutation &perm,       // permutations
+    const Vector &b){              // RHS and is answer x to Ax=B
 
         const int n = A.dims(0);    // size of matrix
 
@@ -191,7 +194,7 @@ void LU_backsub(
                     sum -= A(i,j)*b(j);
                 }
             }
-            else if(sum>0){
+            else if(sum != 0.0){
                 ii=i;  // a nonzero element encounted
             }
           
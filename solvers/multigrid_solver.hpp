@@ -0,0 +1,921 @@
+#ifndef MULTIGRIDSOLVER_H
+#define MULTIGRIDSOLVER_H
+/**********************************************************************************************
+ © 2020. Triad National Security, LLC. All rights reserved.
+ This program was produced under U.S. Government contract 89233218CNA000001 for Los Alamos
+ National Laboratory (LANL), which is operated by Triad National Security, LLC for the U.S.
+ Department of Energy/National Nuclear Security Administration. All rights in the program are
+ reserved by Triad National Security, LLC, and the U.S. Department of Energy/National Nuclear
+ Security Administration. The Government is granted for itself and others acting on its behalf a
+ nonexclusive, paid-up, irrevocable worldwide license in this material to reproduce, prepare
+ derivative works, distribute copies to the public, perform publicly and display publicly, and
+ to permit others to do so.
+ This program is open source under the BSD-3 License.
+ Redistribution and use in source and binary forms, with or without modification, are permitted
+ provided that the following conditions are met:
+ 
+ 1.  Redistributions of source code must retain the above copyright notice, this list of
+ conditions and the following disclaimer.
+ 
+ 2.  Redistributions in binary form must reproduce the above copyright notice, this list of
+ conditions and the following disclaimer in the documentation and/or other materials
+ provided with the distribution.
+ 
+ 3.  Neither the name of the copyright holder nor the names of its contributors may be used
+ to endorse or promote products derived from this software without specific prior
+ written permission.
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+ IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **********************************************************************************************/
+#include <stdio.h>
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+
+#include "matar.h"
+#include "lu_solver.hpp"
+using namespace mtr;
+
+
+// ---------------------------
+// Geometric multigrid for a u - b lap(u) = f on a structured 2D or 3D grid
+// ---------------------------
+//
+//   MultigridOptions options;                       // V-cycles, red-black Gauss-Seidel
+//   GeometricMultigrid mg(h, 127, 127, options);    // 127 x 127 interior points, spacing h
+//
+//   DCArrayKokkos <double> u = mg.solution();       // padded by one ghost layer, the ghosts
+//   DCArrayKokkos <double> f = mg.rhs();            // hold the Dirichlet values, interior is [1, n]
+//   ... fill f and the ghosts of u ...
+//
+//   MultigridResult result = mg.solve(1e-10, 50);   // cycles until ||f - A u|| / ||f|| <= 1e-10
+//
+//   cg_solve(A, x, b, krylov_options, mg);          // or one cycle as a preconditioner
+//
+// The operator is the 5 or 7 point Laplacian over h^2 times options.diffusion,
+// plus options.shift on the diagonal: shift = 0 is Poisson, shift = 1 with
+// diffusion = dt k is an implicit heat step.
+//
+// Grids are vertex centered and coarsen 2:1, fine point 2I is coarse point I,
+// so each dimension wants c 2^k - 1 points. Coarsening stops at an even
+// dimension or once every dimension is at most options.coarse_size, and the
+// coarsest grid is solved with the LU solver, factored when the hierarchy is
+// built.
+//
+// As a preconditioner r and z hold the interior of the local block, entry
+// (i n1 + j) n2 + k counting from 0, the boundary is homogeneous and the
+// ghosts of solution() are cleared.
+//
+// With MPI, build it from a CartesianDecomposition with a halo of one and no
+// periodic edges. The levels are coarsened over the same ranks while every
+// block keeps options.gather_points per dimension, then the coarse problem
+// is gathered on rank 0, solved there with a serial hierarchy and scattered
+// back, so the small grids are not spread thinner than they are worth.
+
+enum class MultigridCycle {
+    V,      // each coarse grid visited once
+    W       // visited twice, for weak smoothers and strong anisotropy
+};
+
+enum class MultigridSmoother {
+    weighted_jacobi,
+    red_black_gauss_seidel
+};
+
+struct MultigridOptions {
+    MultigridCycle    cycle    = MultigridCycle::V;
+    MultigridSmoother smoother = MultigridSmoother::red_black_gauss_seidel;
+    size_t pre_sweeps    = 2;
+    size_t post_sweeps   = 2;
+    double jacobi_weight = 0.0;     // 0 picks 4/5 in 2D and 6/7 in 3D
+    double shift         = 0.0;     // a in a u - b lap(u) = f
+    double diffusion     = 1.0;     // b
+    size_t coarse_size   = 3;       // grids with at most this many points per dimension are solved directly
+    size_t max_direct    = 4096;    // unknowns the dense coarse solve accepts
+#ifdef HAVE_MPI
+    size_t gather_points = 4;       // points per dimension every block keeps before the coarse problem is gathered
+#endif
+};
+
+struct MultigridResult {
+    bool   converged = false;
+    size_t cycles    = 0;
+    double residual  = 0.0;         // ||f - A u|| / ||f||
+};
+
+// one grid of the hierarchy, the local block of it with MPI
+struct MultigridLevel {
+    size_t order      = 2;
+    size_t dims[3]    = {1, 1, 1};  // interior points
+    size_t offsets[3] = {0, 0, 0};  // first interior point in the global grid
+    double h          = 1.0;
+
+    // padded by one ghost layer, the views are 3D with a single plane in 2D
+    DCArrayKokkos <double> u;
+    DCArrayKokkos <double> f;
+    DCArrayKokkos <double> r;
+    ViewCArrayKokkos <double> u_view;
+    ViewCArrayKokkos <double> f_view;
+    ViewCArrayKokkos <double> r_view;
+
+#ifdef HAVE_MPI
+    CartesianDecomposition* decomp = nullptr;              // null when the level needs no halo
+    std::unique_ptr<CartesianDecomposition> owned_decomp;  // of the coarse levels
+    CartesianHaloExchange<double> u_halo;
+    CartesianHaloExchange<double> r_halo;
+#endif
+
+    size_t padded(size_t d) const { return d < order ? dims[d] + 2 : 1; }
+
+    // interior range of dimension d in the views
+    int lo(size_t d) const { return d < order ? 1 : 0; }
+    int hi(size_t d) const { return d < order ? static_cast<int>(dims[d]) + 1 : 1; }
+};
+
+
+/////////////////////////
+// GeometricMultigrid:  V- and W-cycles on a hierarchy of structured grids
+/////////////////////////
+class GeometricMultigrid {
+
+private:
+    size_t order_ = 2;
+    MultigridOptions options_;
+
+    // the cycles work in the levels, also when preconditioning through a const reference
+    mutable std::vector<MultigridLevel> levels_;
+
+    // LU factors of the coarsest grid
+    DCArrayKokkos <double> coarse_lu_;
+    DCArrayKokkos <size_t> coarse_perm_;
+    mutable DCArrayKokkos <double> coarse_rhs_;
+
+#ifdef HAVE_MPI
+    // the last level is gathered on rank 0 of gather_comm_ and solved by gathered_ there
+    MPI_Comm gather_comm_ = MPI_COMM_NULL;
+    int gather_rank_ = 0;
+    std::vector<int> blocks_;           // dims and offsets of every block, on rank 0
+    std::vector<int> gather_counts_;
+    std::vector<int> gather_displs_;
+    std::vector<int> scatter_counts_;
+    std::vector<int> scatter_displs_;
+    std::unique_ptr<GeometricMultigrid> gathered_;
+
+    void build_gather(double h, const size_t global[3]);
+
+    void gather_solve() const;
+#endif
+
+    void setup(const MultigridOptions& options, size_t order, const size_t global[3]);
+
+    void add_level(const size_t dims[3], const size_t offsets[3], double h);
+
+    void build_direct();
+
+    // true when the grid halves again in every dimension
+    static bool can_coarsen(size_t order, const size_t dims[3], size_t coarse_size);
+
+    void exchange(MultigridLevel& level, bool residual) const;
+
+    void zero(const ViewCArrayKokkos <double>& field, const MultigridLevel& level) const;
+
+    void smooth(size_t l, size_t sweeps) const;
+
+    // r = f - A u on level l
+    void compute_residual(size_t l) const;
+
+    // f of level l+1 from r of level l, full weighting
+    void restrict_residual(size_t l) const;
+
+    // u of level l += u of level l+1, bi- or trilinear
+    void prolongate(size_t l) const;
+
+    void coarse_solve() const;
+
+    void cycle_level(size_t l) const;
+
+public:
+    GeometricMultigrid(double h, size_t dim0, size_t dim1, const MultigridOptions& options = MultigridOptions());
+
+    GeometricMultigrid(double h, size_t dim0, size_t dim1, size_t dim2, const MultigridOptions& options = MultigridOptions());
+
+#ifdef HAVE_MPI
+    // every rank of decomp.comm() constructs it, decomp has to outlive it
+    GeometricMultigrid(CartesianDecomposition& decomp, double h, const MultigridOptions& options = MultigridOptions());
+#endif
+
+    // the levels hold communicators and LU factors, so it is not copied
+    GeometricMultigrid(const GeometricMultigrid&) = delete;
+    GeometricMultigrid& operator=(const GeometricMultigrid&) = delete;
+
+    // finest grid, padded by one ghost layer
+    DCArrayKokkos <double>& solution() { return levels_[0].u; }
+
+    DCArrayKokkos <double>& rhs() { return levels_[0].f; }
+
+    // levels on this rank, the gathered coarse grids are not counted
+    size_t num_levels() const { return levels_.size(); }
+
+    // interior points of the local block of a level
+    size_t level_dims(size_t level, size_t d) const { return levels_[level].dims[d]; }
+
+    // one V- or W-cycle on solution()
+    void cycle();
+
+    // ||f - A u|| / ||f|| over all ranks
+    double residual();
+
+    MultigridResult solve(double tolerance, size_t max_cycles);
+
+    // z = M^-1 r with one cycle from zero
+    template <typename Vector>
+    void operator()(Vector& r, Vector& z) const;
+
+}; // End of GeometricMultigrid
+
+inline GeometricMultigrid::GeometricMultigrid(double h, size_t dim0, size_t dim1, const MultigridOptions& options)
+{
+    const size_t dims[3]    = {dim0, dim1, 1};
+    const size_t offsets[3] = {0, 0, 0};
+    setup(options, 2, dims);
+    add_level(dims, offsets, h);
+    while (can_coarsen(order_, levels_.back().dims, options_.coarse_size)) {
+        const size_t* fine = levels_.back().dims;
+        const size_t coarse[3] = {(fine[0] - 1) / 2, (fine[1] - 1) / 2, 1};
+        add_level(coarse, offsets, 2.0 * levels_.back().h);
+    }
+    build_direct();
+}
+
+inline GeometricMultigrid::GeometricMultigrid(double h, size_t dim0, size_t dim1, size_t dim2, const MultigridOptions& options)
+{
+    const size_t dims[3]    = {dim0, dim1, dim2};
+    const size_t offsets[3] = {0, 0, 0};
+    setup(options, 3, dims);
+    add_level(dims, offsets, h);
+    while (can_coarsen(order_, levels_.back().dims, options_.coarse_size)) {
+        const size_t* fine = levels_.back().dims;
+        const size_t coarse[3] = {(fine[0] - 1) / 2, (fine[1] - 1) / 2, (fine[2] - 1) / 2};
+        add_level(coarse, offsets, 2.0 * levels_.back().h);
+    }
+    build_direct();
+}
+
+#ifdef HAVE_MPI
+inline GeometricMultigrid::GeometricMultigrid(CartesianDecomposition& decomp, double h, const MultigridOptions& options)
+{
+    if (decomp.halo() != 1) {
+        throw std::runtime_error("GeometricMultigrid: the decomposition needs a halo of one");
+    }
+
+    size_t global[3]  = {1, 1, 1};
+    size_t dims[3]    = {1, 1, 1};
+    size_t offsets[3] = {0, 0, 0};
+    for (size_t d = 0; d < decomp.order(); d++) {
+        global[d]  = decomp.global_dims(d);
+        dims[d]    = decomp.local_dims(d);
+        offsets[d] = decomp.offset(d);
+    }
+    setup(options, decomp.order(), global);
+
+    add_level(dims, offsets, h);
+    levels_.back().decomp = &decomp;
+
+    const int gather_points = static_cast<int>(options_.gather_points > 1 ? options_.gather_points : 1);
+    while (true) {
+        MultigridLevel& fine = levels_.back();
+        const double h_fine = fine.h;
+        if (!can_coarsen(order_, global, options_.coarse_size)) {
+            build_gather(h_fine, global);  // the global grid is already coarse
+            break;
+        }
+
+        // the coarse points that land on the fine points of this block
+        int thinnest = gather_points;
+        for (size_t d = 0; d < order_; d++) {
+            global[d]  = (global[d] - 1) / 2;
+            dims[d]    = (fine.offsets[d] + fine.dims[d]) / 2 - fine.offsets[d] / 2;
+            offsets[d] = fine.offsets[d] / 2;
+            thinnest   = std::min(thinnest, static_cast<int>(dims[d]));
+        }
+        MPI_Allreduce(MPI_IN_PLACE, &thinnest, 1, MPI_INT, MPI_MIN, fine.decomp->comm());
+
+        if (thinnest >= gather_points) {
+            std::unique_ptr<CartesianDecomposition> coarse = fine.decomp->coarsen();
+            add_level(dims, offsets, 2.0 * h_fine);
+            levels_.back().owned_decomp = std::move(coarse);
+            levels_.back().decomp = levels_.back().owned_decomp.get();
+        }
+        else {
+            // blocks of the gathered grid, some may be empty, no halo
+            add_level(dims, offsets, 2.0 * h_fine);
+            build_gather(2.0 * h_fine, global);
+            break;
+        }
+    }
+
+    for (MultigridLevel& level : levels_) {
+        if (level.decomp != nullptr) {
+            level.u_halo = CartesianHaloExchange<double>(*level.decomp, level.u);
+            level.r_halo = CartesianHaloExchange<double>(*level.decomp, level.r);
+        }
+    }
+}
+#endif
+
+inline void GeometricMultigrid::setup(const MultigridOptions& options, size_t order, const size_t global[3])
+{
+    order_   = order;
+    options_ = options;
+    if (options_.jacobi_weight <= 0.0) {
+        options_.jacobi_weight = (order_ == 2) ? 0.8 : 6.0 / 7.0;
+    }
+
+    // the coarsest grid is known from the global dims, every rank checks it
+    size_t dims[3] = {global[0], global[1], global[2]};
+    while (can_coarsen(order_, dims, options_.coarse_size)) {
+        for (size_t d = 0; d < order_; d++) {
+            dims[d] = (dims[d] - 1) / 2;
+        }
+    }
+    if (dims[0] * dims[1] * dims[2] > options_.max_direct) {
+        throw std::runtime_error("GeometricMultigrid: the coarsest grid is too large for the direct solve, "
+                                 "use c 2^k - 1 points per dimension");
+    }
+}
+
+inline bool GeometricMultigrid::can_coarsen(size_t order, const size_t dims[3], size_t coarse_size)
+{
+    bool larger = false;
+    for (size_t d = 0; d < order; d++) {
+        if (dims[d] < 3 || dims[d] % 2 == 0) {
+            return false;
+        }
+        larger = larger || dims[d] > coarse_size;
+    }
+    return larger;
+}
+
+inline void GeometricMultigrid::add_level(const size_t dims[3], const size_t offsets[3], double h)
+{
+    MultigridLevel level;
+    level.order = order_;
+    level.h     = h;
+    for (size_t d = 0; d < 3; d++) {
+        level.dims[d]    = d < order_ ? dims[d] : 1;
+        level.offsets[d] = d < order_ ? offsets[d] : 0;
+    }
+
+    const size_t p0 = level.padded(0);
+    const size_t p1 = level.padded(1);
+    const size_t p2 = level.padded(2);
+    if (order_ == 2) {
+        level.u = DCArrayKokkos <double> (p0, p1, "mg_u");
+        level.f = DCArrayKokkos <double> (p0, p1, "mg_f");
+        level.r = DCArrayKokkos <double> (p0, p1, "mg_r");
+    }
+    else {
+        level.u = DCArrayKokkos <double> (p0, p1, p2, "mg_u");
+        level.f = DCArrayKokkos <double> (p0, p1, p2, "mg_f");
+        level.r = DCArrayKokkos <double> (p0, p1, p2, "mg_r");
+    }
+    level.u.set_values(0.0);
+    level.f.set_values(0.0);
+    level.r.set_values(0.0);
+    level.u_view = ViewCArrayKokkos <double> (level.u.device_pointer(), p0, p1, p2);
+    level.f_view = ViewCArrayKokkos <double> (level.f.device_pointer(), p0, p1, p2);
+    level.r_view = ViewCArrayKokkos <double> (level.r.device_pointer(), p0, p1, p2);
+
+    levels_.push_back(std::move(level));
+}
+
+inline void GeometricMultigrid::build_direct()
+{
+    const MultigridLevel& level = levels_.back();
+    const size_t n0  = level.dims[0];
+    const size_t n1  = level.dims[1];
+    const size_t n2  = level.dims[2];
+    const size_t num = n0 * n1 * n2;
+
+    const double c    = options_.diffusion / (level.h * level.h);
+    const double diag = options_.shift + 2.0 * order_ * c;
+
+    coarse_lu_   = DCArrayKokkos <double> (num, num, "mg_coarse_lu");
+    coarse_perm_ = DCArrayKokkos <size_t> (num, "mg_coarse_perm");
+    coarse_rhs_  = DCArrayKokkos <double> (num, "mg_coarse_rhs");
+    CArrayKokkos <double> vv(num, "mg_coarse_vv");
+
+    for (size_t p = 0; p < num; p++) {
+        for (size_t q = 0; q < num; q++) {
+            coarse_lu_.host(p, q) = 0.0;
+        }
+    }
+    for (size_t i = 0; i < n0; i++) {
+        for (size_t j = 0; j < n1; j++) {
+            for (size_t k = 0; k < n2; k++) {
+                const size_t p = (i * n1 + j) * n2 + k;
+                coarse_lu_.host(p, p) = diag;
+                if (i > 0)      { coarse_lu_.host(p, p - n1 * n2) = -c; }
+                if (i + 1 < n0) { coarse_lu_.host(p, p + n1 * n2) = -c; }
+                if (j > 0)      { coarse_lu_.host(p, p - n2) = -c; }
+                if (j + 1 < n1) { coarse_lu_.host(p, p + n2) = -c; }
+                if (order_ == 3) {
+                    if (k > 0)      { coarse_lu_.host(p, p - 1) = -c; }
+                    if (k + 1 < n2) { coarse_lu_.host(p, p + 1) = -c; }
+                }
+            }
+        }
+    }
+    coarse_lu_.update_device();
+
+    int parity = 0;
+    if (LU_decompose_host(coarse_lu_, coarse_perm_, vv, parity) == 0) {
+        throw std::runtime_error("GeometricMultigrid: the coarse grid operator is singular");
+    }
+}
+
+inline void GeometricMultigrid::exchange(MultigridLevel& level, bool residual) const
+{
+#ifdef HAVE_MPI
+    if (level.decomp != nullptr) {
+        if (residual) {
+            level.r_halo.exchange();
+        }
+        else {
+            level.u_halo.exchange();
+        }
+    }
+#else
+    (void) level;
+    (void) residual;
+#endif
+}
+
+inline void GeometricMultigrid::zero(const ViewCArrayKokkos <double>& field, const MultigridLevel& level) const
+{
+    const int p0 = level.padded(0);
+    const int p1 = level.padded(1);
+    const int p2 = level.padded(2);
+    ViewCArrayKokkos <double> v = field;
+    FOR_ALL(i, 0, p0,
+            j, 0, p1,
+            k, 0, p2, {
+        v(i, j, k) = 0.0;
+    });
+}
+
+inline void GeometricMultigrid::smooth(size_t l, size_t sweeps) const
+{
+    MATAR_PROFILE_SCOPE("multigrid_smooth", ProfileCategory::compute);
+    MultigridLevel& level = levels_[l];
+    ViewCArrayKokkos <double> u = level.u_view;
+    ViewCArrayKokkos <double> f = level.f_view;
+    ViewCArrayKokkos <double> r = level.r_view;
+
+    const bool   three_d = (order_ == 3);
+    const double c       = options_.diffusion / (level.h * level.h);
+    const double diag    = options_.shift + 2.0 * order_ * c;
+    const double weight  = options_.jacobi_weight;
+    const int n0  = level.dims[0];
+    const int n1  = level.dims[1];
+    const int n2  = level.dims[2];
+    const int lo2 = level.lo(2);
+    const int hi2 = level.hi(2);
+
+    // red points have an even sum of global indices
+    const int parity = (level.offsets[0] + level.offsets[1] + level.offsets[2]) % 2;
+
+    for (size_t sweep = 0; sweep < sweeps; sweep++) {
+        if (options_.smoother == MultigridSmoother::weighted_jacobi) {
+            exchange(level, false);
+            FOR_ALL(i, 1, n0 + 1,
+                    j, 1, n1 + 1,
+                    k, lo2, hi2, {
+                double sum = u(i - 1, j, k) + u(i + 1, j, k) + u(i, j - 1, k) + u(i, j + 1, k);
+                if (three_d) {
+                    sum += u(i, j, k - 1) + u(i, j, k + 1);
+                }
+                r(i, j, k) = u(i, j, k) + weight * (f(i, j, k) + c * sum - diag * u(i, j, k)) / diag;
+            });
+            FOR_ALL(i, 1, n0 + 1,
+                    j, 1, n1 + 1,
+                    k, lo2, hi2, {
+                u(i, j, k) = r(i, j, k);
+            });
+            continue;
+        }
+
+        // red-black Gauss-Seidel, the loop over the last dimension visits one color
+        for (int color = 0; color < 2; color++) {
+            exchange(level, false);
+            const int local_color = (color + parity) % 2;
+            if (three_d) {
+                FOR_ALL(i, 1, n0 + 1,
+                        j, 1, n1 + 1,
+                        kk, 0, (n2 + 1) / 2, {
+                    const int k = 1 + (i + j + 1 + local_color) % 2 + 2 * kk;
+                    if (k <= n2) {
+                        const double sum = u(i - 1, j, k) + u(i + 1, j, k) + u(i, j - 1, k) +
+                                           u(i, j + 1, k) + u(i, j, k - 1) + u(i, j, k + 1);
+                        u(i, j, k) = (f(i, j, k) + c * sum) / diag;
+                    }
+                });
+            }
+            else {
+                FOR_ALL(i, 1, n0 + 1,
+                        jj, 0, (n1 + 1) / 2, {
+                    const int j = 1 + (i + 1 + local_color) % 2 + 2 * jj;
+                    if (j <= n1) {
+                        const double sum = u(i - 1, j, 0) + u(i + 1, j, 0) + u(i, j - 1, 0) + u(i, j + 1, 0);
+                        u(i, j, 0) = (f(i, j, 0) + c * sum) / diag;
+                    }
+                });
+            }
+        }
+    } // end for sweep
+}
+
+inline void GeometricMultigrid::compute_residual(size_t l) const
+{
+    MATAR_PROFILE_SCOPE("multigrid_residual", ProfileCategory::compute);
+    MultigridLevel& level = levels_[l];
+    exchange(level, false);
+
+    ViewCArrayKokkos <double> u = level.u_view;
+    ViewCArrayKokkos <double> f = level.f_view;
+    ViewCArrayKokkos <double> r = level.r_view;
+
+    const bool   three_d = (order_ == 3);
+    const double c       = options_.diffusion / (level.h * level.h);
+    const double diag    = options_.shift + 2.0 * order_ * c;
+    FOR_ALL(i, 1, level.hi(0),
+            j, 1, level.hi(1),
+            k, level.lo(2), level.hi(2), {
+        double sum = u(i - 1, j, k) + u(i + 1, j, k) + u(i, j - 1, k) + u(i, j + 1, k);
+        if (three_d) {
+            sum += u(i, j, k - 1) + u(i, j, k + 1);
+        }
+        r(i, j, k) = f(i, j, k) - diag * u(i, j, k) + c * sum;
+    });
+}
+
+inline void GeometricMultigrid::restrict_residual(size_t l) const
+{
+    MATAR_PROFILE_SCOPE("multigrid_restrict", ProfileCategory::compute);
+    MultigridLevel& fine   = levels_[l];
+    MultigridLevel& coarse = levels_[l + 1];
+    exchange(fine, true);
+
+    ViewCArrayKokkos <double> r  = fine.r_view;
+    ViewCArrayKokkos <double> fc = coarse.f_view;
+
+    const bool three_d = (order_ == 3);
+    const int  reach   = three_d ? 1 : 0;
+    const double scale = three_d ? 1.0 / 64.0 : 1.0 / 32.0;
+    const int o0  = fine.offsets[0];
+    const int o1  = fine.offsets[1];
+    const int o2  = fine.offsets[2];
+    const int oc0 = coarse.offsets[0];
+    const int oc1 = coarse.offsets[1];
+    const int oc2 = coarse.offsets[2];
+
+    // weights 1 2 1 in each dimension, the 2D stencil is counted twice in k
+    FOR_ALL(I, 1, coarse.hi(0),
+            J, 1, coarse.hi(1),
+            K, coarse.lo(2), coarse.hi(2), {
+        const int i = 2 * (oc0 + I) - o0;
+        const int j = 2 * (oc1 + J) - o1;
+        const int k = three_d ? 2 * (oc2 + K) - o2 : 0;
+        double sum = 0.0;
+        for (int di = -1; di <= 1; di++) {
+            for (int dj = -1; dj <= 1; dj++) {
+                for (int dk = -reach; dk <= reach; dk++) {
+                    const double weight = (di == 0 ? 2.0 : 1.0) * (dj == 0 ? 2.0 : 1.0) * (dk == 0 ? 2.0 : 1.0);
+                    sum += weight * r(i + di, j + dj, k + dk);
+                }
+            }
+        }
+        fc(I, J, K) = scale * sum;
+    });
+}
+
+inline void GeometricMultigrid::prolongate(size_t l) const
+{
+    MATAR_PROFILE_SCOPE("multigrid_prolongate", ProfileCategory::compute);
+    MultigridLevel& fine   = levels_[l];
+    MultigridLevel& coarse = levels_[l + 1];
+    exchange(coarse, false);
+
+    ViewCArrayKokkos <double> u  = fine.u_view;
+    ViewCArrayKokkos <double> uc = coarse.u_view;
+
+    const bool three_d = (order_ == 3);
+    const int o0  = fine.offsets[0];
+    const int o1  = fine.offsets[1];
+    const int o2  = fine.offsets[2];
+    const int oc0 = coarse.offsets[0];
+    const int oc1 = coarse.offsets[1];
+    const int oc2 = coarse.offsets[2];
+
+    // a fine point between two coarse points averages them, one on top of a
+    // coarse point has both ends the same, and the 2D sum repeats k = 0
+    FOR_ALL(i, 1, fine.hi(0),
+            j, 1, fine.hi(1),
+            k, fine.lo(2), fine.hi(2), {
+        const int a0 = (o0 + i) / 2 - oc0;
+        const int b0 = (o0 + i + 1) / 2 - oc0;
+        const int a1 = (o1 + j) / 2 - oc1;
+        const int b1 = (o1 + j + 1) / 2 - oc1;
+        const int a2 = three_d ? (o2 + k) / 2 - oc2 : 0;
+        const int b2 = three_d ? (o2 + k + 1) / 2 - oc2 : 0;
+        u(i, j, k) += 0.125 * (uc(a0, a1, a2) + uc(a0, a1, b2) + uc(a0, b1, a2) + uc(a0, b1, b2) +
+                               uc(b0, a1, a2) + uc(b0, a1, b2) + uc(b0, b1, a2) + uc(b0, b1, b2));
+    });
+}
+
+inline void GeometricMultigrid::coarse_solve() const
+{
+    MATAR_PROFILE_SCOPE("multigrid_coarse_solve", ProfileCategory::compute);
+#ifdef HAVE_MPI
+    if (gather_comm_ != MPI_COMM_NULL) {
+        gather_solve();
+        return;
+    }
+#endif
+
+    MultigridLevel& level = levels_.back();
+    ViewCArrayKokkos <double> u = level.u_view;
+    ViewCArrayKokkos <double> f = level.f_view;
+    DCArrayKokkos <double> b = coarse_rhs_;
+    const int n1  = level.dims[1];
+    const int n2  = level.dims[2];
+    const int lo2 = level.lo(2);
+
+    FOR_ALL(i, 1, level.hi(0),
+            j, 1, level.hi(1),
+            k, lo2, level.hi(2), {
+        b(((i - 1) * n1 + (j - 1)) * n2 + k - lo2) = f(i, j, k);
+    });
+    LU_backsub_host(coarse_lu_, coarse_perm_, coarse_rhs_);
+    FOR_ALL(i, 1, level.hi(0),
+            j, 1, level.hi(1),
+            k, lo2, level.hi(2), {
+        u(i, j, k) = b(((i - 1) * n1 + (j - 1)) * n2 + k - lo2);
+    });
+}
+
+#ifdef HAVE_MPI
+inline void GeometricMultigrid::build_gather(double h, const size_t global[3])
+{
+    gather_comm_ = levels_[0].decomp->comm();
+    int num_ranks;
+    MPI_Comm_rank(gather_comm_, &gather_rank_);
+    MPI_Comm_size(gather_comm_, &num_ranks);
+
+    const MultigridLevel& level = levels_.back();
+    int block[6];
+    for (size_t d = 0; d < 3; d++) {
+        block[d]     = static_cast<int>(level.dims[d]);
+        block[3 + d] = static_cast<int>(level.offsets[d]);
+    }
+    if (gather_rank_ == 0) {
+        blocks_.resize(6 * num_ranks);
+    }
+    MPI_Gather(block, 6, MPI_INT, blocks_.data(), 6, MPI_INT, 0, gather_comm_);
+
+    if (gather_rank_ != 0) {
+        return;
+    }
+
+    // the interior of each block comes in, the block with its ghosts goes out
+    gather_counts_.resize(num_ranks);
+    gather_displs_.resize(num_ranks);
+    scatter_counts_.resize(num_ranks);
+    scatter_displs_.resize(num_ranks);
+    int gather_total  = 0;
+    int scatter_total = 0;
+    for (int q = 0; q < num_ranks; q++) {
+        int interior = 1;
+        int padded   = 1;
+        for (size_t d = 0; d < order_; d++) {
+            interior *= blocks_[6 * q + d];
+            padded   *= blocks_[6 * q + d] + 2;
+        }
+        gather_counts_[q]  = interior;
+        gather_displs_[q]  = gather_total;
+        scatter_counts_[q] = padded;
+        scatter_displs_[q] = scatter_total;
+        gather_total  += interior;
+        scatter_total += padded;
+    }
+
+    if (order_ == 2) {
+        gathered_.reset(new GeometricMultigrid(h, global[0], global[1], options_));
+    }
+    else {
+        gathered_.reset(new GeometricMultigrid(h, global[0], global[1], global[2], options_));
+    }
+}
+
+inline void GeometricMultigrid::gather_solve() const
+{
+    MATAR_PROFILE_SCOPE("multigrid_gather_solve", ProfileCategory::communication);
+    MultigridLevel& level = levels_.back();
+    const size_t p1 = level.padded(1);
+    const size_t p2 = level.padded(2);
+
+    level.f.update_host();
+    const double* f_local = level.f.host_pointer();
+    std::vector<double> interior;
+    interior.reserve(level.dims[0] * level.dims[1] * level.dims[2]);
+    for (int i = 1; i < level.hi(0); i++) {
+        for (int j = 1; j < level.hi(1); j++) {
+            for (int k = level.lo(2); k < level.hi(2); k++) {
+                interior.push_back(f_local[(i * p1 + j) * p2 + k]);
+            }
+        }
+    }
+
+    std::vector<double> gathered;
+    std::vector<double> blocks;
+    if (gather_rank_ == 0) {
+        gathered.resize(gather_displs_.back() + gather_counts_.back());
+        blocks.resize(scatter_displs_.back() + scatter_counts_.back());
+    }
+    MPI_Gatherv(interior.data(), static_cast<int>(interior.size()), MPI_DOUBLE,
+                gathered.data(), gather_counts_.data(), gather_displs_.data(), MPI_DOUBLE,
+                0, gather_comm_);
+
+    if (gather_rank_ == 0) {
+        MultigridLevel& global = gathered_->levels_[0];
+        const size_t g1 = global.padded(1);
+        const size_t g2 = global.padded(2);
+        const size_t num_ranks = gather_counts_.size();
+
+        double* f_global = global.f.host_pointer();
+        for (size_t q = 0; q < num_ranks; q++) {
+            const int* dims    = &blocks_[6 * q];
+            const int* offsets = &blocks_[6 * q + 3];
+            const int  lo2     = (order_ == 3) ? 1 : 0;
+            const int  hi2     = (order_ == 3) ? dims[2] + 1 : 1;
+            size_t count = gather_displs_[q];
+            for (int i = 1; i <= dims[0]; i++) {
+                for (int j = 1; j <= dims[1]; j++) {
+                    for (int k = lo2; k < hi2; k++) {
+                        f_global[((offsets[0] + i) * g1 + offsets[1] + j) * g2 + offsets[2] + k] = gathered[count++];
+                    }
+                }
+            }
+        }
+        global.f.update_device();
+
+        // the correction starts from zero, a W-cycle visits the coarse grids twice
+        zero(global.u_view, global);
+        const int visits = (options_.cycle == MultigridCycle::W) ? 2 : 1;
+        for (int visit = 0; visit < visits; visit++) {
+            gathered_->cycle_level(0);
+        }
+
+        global.u.update_host();
+        const double* u_global = global.u.host_pointer();
+        for (size_t q = 0; q < num_ranks; q++) {
+            const int* dims    = &blocks_[6 * q];
+            const int* offsets = &blocks_[6 * q + 3];
+            const int  hi2     = (order_ == 3) ? dims[2] + 2 : 1;
+            size_t count = scatter_displs_[q];
+            for (int i = 0; i < dims[0] + 2; i++) {
+                for (int j = 0; j < dims[1] + 2; j++) {
+                    for (int k = 0; k < hi2; k++) {
+                        blocks[count++] = u_global[((offsets[0] + i) * g1 + offsets[1] + j) * g2 + offsets[2] + k];
+                    }
+                }
+            }
+        }
+    }
+
+    // the padded block, in the layout of the local field
+    MPI_Scatterv(blocks.data(), scatter_counts_.data(), scatter_displs_.data(), MPI_DOUBLE,
+                 level.u.host_pointer(), static_cast<int>(level.u.size()), MPI_DOUBLE,
+                 0, gather_comm_);
+    level.u.update_device();
+}
+#endif
+
+inline void GeometricMultigrid::cycle_level(size_t l) const
+{
+    if (l + 1 == levels_.size()) {
+        coarse_solve();
+        return;
+    }
+
+    smooth(l, options_.pre_sweeps);
+    compute_residual(l);
+    restrict_residual(l);
+
+    // the coarsest grid is solved in one visit
+    MultigridLevel& coarse = levels_[l + 1];
+    zero(coarse.u_view, coarse);
+    const bool twice = (options_.cycle == MultigridCycle::W) && (l + 2 < levels_.size());
+    cycle_level(l + 1);
+    if (twice) {
+        cycle_level(l + 1);
+    }
+
+    prolongate(l);
+    smooth(l, options_.post_sweeps);
+}
+
+inline void GeometricMultigrid::cycle()
+{
+    MATAR_PROFILE_SCOPE("multigrid_cycle", ProfileCategory::compute);
+    cycle_level(0);
+}
+
+inline double GeometricMultigrid::residual()
+{
+    compute_residual(0);
+
+    MultigridLevel& level = levels_[0];
+    ViewCArrayKokkos <double> r = level.r_view;
+    ViewCArrayKokkos <double> f = level.f_view;
+
+    double sums[2];
+    double loc_sum;
+    FOR_REDUCE_SUM(i, 1, level.hi(0),
+                   j, 1, level.hi(1),
+                   k, level.lo(2), level.hi(2), loc_sum, {
+        loc_sum += r(i, j, k) * r(i, j, k);
+    }, sums[0]);
+    FOR_REDUCE_SUM(i, 1, level.hi(0),
+                   j, 1, level.hi(1),
+                   k, level.lo(2), level.hi(2), loc_sum, {
+        loc_sum += f(i, j, k) * f(i, j, k);
+    }, sums[1]);
+
+#ifdef HAVE_MPI
+    if (level.decomp != nullptr) {
+        MPI_Allreduce(MPI_IN_PLACE, sums, 2, MPI_DOUBLE, MPI_SUM, level.decomp->comm());
+    }
+#endif
+
+    const double f_norm = (sums[1] > 0.0) ? sqrt(sums[1]) : 1.0;
+    return sqrt(sums[0]) / f_norm;
+}
+
+inline MultigridResult GeometricMultigrid::solve(double tolerance, size_t max_cycles)
+{
+    MATAR_PROFILE_SCOPE("multigrid_solve", ProfileCategory::compute);
+    MultigridResult result;
+    result.residual  = residual();
+    result.converged = result.residual <= tolerance;
+    while (!result.converged && result.cycles < max_cycles) {
+        cycle_level(0);
+        result.cycles++;
+        result.residual  = residual();
+        result.converged = result.residual <= tolerance;
+    }
+    return result;
+}
+
+template <typename Vector>
+void GeometricMultigrid::operator()(Vector& r, Vector& z) const
+{
+    MATAR_PROFILE_SCOPE("multigrid_precondition", ProfileCategory::compute);
+    MultigridLevel& level = levels_[0];
+    ViewCArrayKokkos <double> u = level.u_view;
+    ViewCArrayKokkos <double> f = level.f_view;
+    const int n1  = level.dims[1];
+    const int n2  = level.dims[2];
+    const int lo2 = level.lo(2);
+
+    zero(u, level);
+    FOR_ALL(i, 1, level.hi(0),
+            j, 1, level.hi(1),
+            k, lo2, level.hi(2), {
+        f(i, j, k) = r(((i - 1) * n1 + (j - 1)) * n2 + k - lo2);
+    });
+
+    cycle_level(0);
+
+    FOR_ALL(i, 1, level.hi(0),
+            j, 1, level.hi(1),
+            k, lo2, level.hi(2), {
+        z(((i - 1) * n1 + (j - 1)) * n2 + k - lo2) = u(i, j, k);
+    });
+}
+
+// End of GeometricMultigrid
+
+#endif // MULTIGRIDSOLVER_H
@@ -0,0 +1,634 @@
+#ifndef PRECONDITIONERS_H
+#define PRECONDITIONERS_H
+/**********************************************************************************************
+ © 2020. Triad National Security, LLC. All rights reserved.
+ This program was produced under U.S. Government contract 89233218CNA000001 for Los Alamos
+ National Laboratory (LANL), which is operated by Triad National Security, LLC for the U.S.
+ Department of Energy/National Nuclear Security Administration. All rights in the program are
+ reserved by Triad National Security, LLC, and the U.S. Department of Energy/National Nuclear
+ Security Administration. The Government is granted for itself and others acting on its behalf a
+ nonexclusive, paid-up, irrevocable worldwide license in this material to reproduce, prepare
+ derivative works, distribute copies to the public, perform publicly and display publicly, and
+ to permit others to do so.
+ This program is open source under the BSD-3 License.
+ Redistribution and use in source and binary forms, with or without modification, are permitted
+ provided that the following conditions are met:
+ 
+ 1.  Redistributions of source code must retain the above copyright notice, this list of
+ conditions and the following disclaimer.
+ 
+ 2.  Redistributions in binary form must reproduce the above copyright notice, this list of
+ conditions and the following disclaimer in the documentation and/or other materials
+ provided with the distribution.
+ 
+ 3.  Neither the name of the copyright holder nor the names of its contributors may be used
+ to endorse or promote products derived from this software without specific prior
+ written permission.
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+ IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **********************************************************************************************/
+#include <stdio.h>
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+
+#include "matar.h"
+#include "lu_solver.hpp"
+using namespace mtr;
+
+
+// ---------------------------
+// Preconditioners for a CSRArrayKokkos <double>
+// ---------------------------
+//
+//   ILUPreconditioner ilu(A);                           // ILU(0), A nonsymmetric
+//   KrylovResult result = gmres_solve(A, x, b, options, ilu);
+//
+//   ICPreconditioner ic(A);                             // IC(0), A symmetric positive definite
+//   result = cg_solve(A, x, b, options, ic);
+//
+//   PreconditionerOptions block;
+//   block.block_size = 8;
+//   BlockJacobiPreconditioner jacobi(A, block);        // LU of the diagonal blocks
+//
+// Each is callable as M(r, z) and sets z = M^-1 r, as the Krylov solvers
+// expect. They are built once for a matrix and can be applied any number of
+// times; rebuild them when the values of A change.
+//
+// The incomplete factors keep the sparsity of A. They are computed on the
+// device, and the triangular solves run the same way, a level at a time:
+// rows of one level only depend on rows of earlier levels, so they are
+// done in parallel. A 2D grid in natural order has about 2n levels. With
+// TriangularSolve::jacobi the solves are replaced by a few Jacobi sweeps
+// on the triangles, every row in parallel and no level ordering, which
+// suits many-core CPUs and GPUs when the levels are too small to fill them.
+//
+// Columns at or past the number of rows are left out, so the rows of one
+// rank of a distributed matrix give the local, block Jacobi across ranks,
+// factors.
+
+enum class TriangularSolve {
+    level_scheduled,    // exact, the rows of one level in parallel
+    jacobi              // options.jacobi_sweeps sweeps, every row in parallel
+};
+
+struct PreconditionerOptions {
+    TriangularSolve triangular = TriangularSolve::level_scheduled;
+    size_t jacobi_sweeps = 3;
+    size_t block_size    = 4;       // rows in a block of BlockJacobiPreconditioner
+};
+
+
+// ---------------------------
+// Sparse triangular factors
+// ---------------------------
+
+// helpers of the preconditioners below, not part of the solver interface
+namespace mtr {
+namespace detail {
+
+// one triangle of a CSR matrix with sorted, duplicate free rows, the
+// rows grouped in levels that only depend on rows of earlier levels
+struct TriangularFactor {
+    size_t rows  = 0;
+    bool   lower = true;
+    bool   unit  = false;                // ones on the diagonal, which is not used
+
+    DCArrayKokkos <size_t> starts;
+    DCArrayKokkos <size_t> columns;
+    DCArrayKokkos <double> values;
+    DCArrayKokkos <size_t> diagonal;     // flat index of the diagonal of each row
+
+    DCArrayKokkos <size_t> level_rows;   // rows in level order
+    std::vector<size_t> level_starts;    // level l is level_rows [level_starts[l], level_starts[l+1])
+
+    size_t num_levels() const { return level_starts.empty() ? 0 : level_starts.size() - 1; }
+};
+
+template <typename T>
+DCArrayKokkos <T> dual_copy(const std::vector<T> &host, const std::string &tag){
+    DCArrayKokkos <T> array(host.size() > 0 ? host.size() : 1, tag);
+    for(size_t i = 0; i < host.size(); i++){
+        array.host(i) = host[i];
+    }
+    array.update_device();
+    return array;
+}
+
+// host copy of A with the columns of every row sorted, duplicates summed and
+// a diagonal entry in every row, keeping the lower triangle only when asked
+inline void sorted_pattern(const CSRArrayKokkos <double> &A_csr,
+                           bool lower_only,
+                           std::vector<size_t> &starts,
+                           std::vector<size_t> &columns,
+                           std::vector<double> &values){
+
+    CSRArrayKokkos <double> A = A_csr;
+    const size_t rows = A.dim1();
+    const size_t nnz  = A.nnz();
+
+    DCArrayKokkos <size_t> A_starts(rows + 1, "csr_starts");
+    DCArrayKokkos <size_t> A_columns(nnz > 0 ? nnz : 1, "csr_columns");
+    DCArrayKokkos <double> A_values(nnz > 0 ? nnz : 1, "csr_values");
+    FOR_ALL(i, 0, rows, {
+        A_starts(i + 1) = A.end_index(i);
+        for(size_t k = A.begin_index(i); k < A.end_index(i); k++){
+            A_columns(k) = A.get_col_flat(k);
+            A_values(k)  = A.get_val_flat(k);
+        }
+    });
+    A_starts.update_host();
+    A_columns.update_host();
+    A_values.update_host();
+
+    starts.assign(1, 0);
+    columns.clear();
+    values.clear();
+    std::vector<std::pair<size_t, double>> row;
+    for(size_t i = 0; i < rows; i++){
+        const size_t begin = (i == 0) ? 0 : A_starts.host(i);
+        row.clear();
+        row.push_back(std::make_pair(i, 0.0));
+        for(size_t k = begin; k < A_starts.host(i + 1); k++){
+            const size_t col = A_columns.host(k);
+            if(col < rows && (!lower_only || col <= i)){
+                row.push_back(std::make_pair(col, A_values.host(k)));
+            }
+        }
+        std::sort(row.begin(), row.end(),
+                  [](const std::pair<size_t, double> &a, const std::pair<size_t, double> &b){
+                      return a.first < b.first;
+                  });
+        for(size_t k = 0; k < row.size(); k++){
+            if(!columns.empty() && columns.size() > starts.back() && columns.back() == row[k].first){
+                values.back() += row[k].second;
+            }
+            else{
+                columns.push_back(row[k].first);
+                values.push_back(row[k].second);
+            }
+        }
+        starts.push_back(columns.size());
+    } // end for i
+
+} // end function
+
+// diagonal positions and level sets of a factor whose pattern is on the host
+inline void build_levels(TriangularFactor &T,
+                         const std::vector<size_t> &starts,
+                         const std::vector<size_t> &columns){
+
+    const size_t rows = T.rows;
+    std::vector<size_t> diagonal(rows);
+    std::vector<size_t> level(rows, 0);
+    size_t num_levels = 0;
+
+    for(size_t count = 0; count < rows; count++){
+        const size_t i = T.lower ? count : rows - 1 - count;
+        size_t depth = 0;
+        for(size_t k = starts[i]; k < starts[i + 1]; k++){
+            const size_t col = columns[k];
+            if(col == i){
+                diagonal[i] = k;
+            }
+            else if(T.lower ? col < i : col > i){
+                depth = std::max(depth, level[col] + 1);
+            }
+        }
+        level[i] = depth;
+        num_levels = std::max(num_levels, depth + 1);
+    }
+
+    // counting sort of the rows by level
+    T.level_starts.assign(num_levels + 1, 0);
+    for(size_t i = 0; i < rows; i++){
+        T.level_starts[level[i] + 1]++;
+    }
+    for(size_t l = 0; l < num_levels; l++){
+        T.level_starts[l + 1] += T.level_starts[l];
+    }
+    std::vector<size_t> next(T.level_starts.begin(), T.level_starts.end() - 1);
+    std::vector<size_t> level_rows(rows);
+    for(size_t i = 0; i < rows; i++){
+        level_rows[next[level[i]]++] = i;
+    }
+
+    T.diagonal   = dual_copy(diagonal, "factor_diagonal");
+    T.level_rows = dual_copy(level_rows, "factor_level_rows");
+
+} // end function
+
+// x = T^-1 b, work is only used by the Jacobi sweeps
+template <typename VectorB, typename VectorX>
+void triangular_solve(const TriangularFactor &T,
+                      const VectorB &b,
+                      VectorX &x,
+                      const DCArrayKokkos <double> &work,
+                      const PreconditionerOptions &options){
+
+    MATAR_PROFILE_SCOPE("triangular_solve", ProfileCategory::compute);
+    DCArrayKokkos <size_t> starts   = T.starts;
+    DCArrayKokkos <size_t> columns  = T.columns;
+    DCArrayKokkos <double> values   = T.values;
+    DCArrayKokkos <size_t> diagonal = T.diagonal;
+    DCArrayKokkos <double> y        = work;
+    const bool lower = T.lower;
+    const bool unit  = T.unit;
+
+    if(options.triangular == TriangularSolve::level_scheduled){
+        DCArrayKokkos <size_t> level_rows = T.level_rows;
+        for(size_t l = 0; l < T.num_levels(); l++){
+            FOR_ALL(q, T.level_starts[l], T.level_starts[l + 1], {
+                const size_t i = level_rows(q);
+                double sum = b(i);
+                for(size_t k = starts(i); k < starts(i + 1); k++){
+                    const size_t col = columns(k);
+                    if(lower ? col < i : col > i){
+                        sum -= values(k) * x(col);
+                    }
+                }
+                x(i) = unit ? sum : sum / values(diagonal(i));
+            });
+        }
+        return;
+    }
+
+    // x_{s+1} = D^-1 (b - (T - D) x_s) from x_0 = D^-1 b
+    const size_t rows = T.rows;
+    FOR_ALL(i, 0, rows, {
+        x(i) = unit ? b(i) : b(i) / values(diagonal(i));
+    });
+    for(size_t sweep = 0; sweep < options.jacobi_sweeps; sweep++){
+        FOR_ALL(i, 0, rows, {
+            double sum = b(i);
+            for(size_t k = starts(i); k < starts(i + 1); k++){
+                const size_t col = columns(k);
+                if(lower ? col < size_t(i) : col > size_t(i)){
+                    sum -= values(k) * x(col);
+                }
+            }
+            y(i) = unit ? sum : sum / values(diagonal(i));
+        });
+        FOR_ALL(i, 0, rows, {
+            x(i) = y(i);
+        });
+    }
+
+} // end function
+
+} // end namespace detail
+} // end namespace mtr
+
+
+/////////////////////////
+// ILUPreconditioner:  incomplete LU with the sparsity of A, z = U^-1 L^-1 r
+/////////////////////////
+class ILUPreconditioner {
+
+private:
+    PreconditionerOptions options_;
+    detail::TriangularFactor lower_;    // L, unit diagonal
+    detail::TriangularFactor upper_;    // U, in the same arrays as L
+    DCArrayKokkos <double> y_;
+    DCArrayKokkos <double> work_;
+
+public:
+    ILUPreconditioner() {}
+
+    ILUPreconditioner(const CSRArrayKokkos <double> &A, const PreconditionerOptions &options = PreconditionerOptions());
+
+    // levels of the L and U solves
+    size_t num_levels(bool lower = true) const { return lower ? lower_.num_levels() : upper_.num_levels(); }
+
+    template <typename Vector>
+    void operator()(Vector &r, Vector &z) const;
+
+}; // End of ILUPreconditioner
+
+inline ILUPreconditioner::ILUPreconditioner(const CSRArrayKokkos <double> &A, const PreconditionerOptions &options)
+{
+    MATAR_PROFILE_SCOPE("ilu_factor", ProfileCategory::compute);
+    options_ = options;
+
+    std::vector<size_t> starts;
+    std::vector<size_t> columns;
+    std::vector<double> values;
+    detail::sorted_pattern(A, false, starts, columns, values);
+
+    const size_t rows = starts.size() - 1;
+    lower_.rows    = rows;
+    lower_.lower   = true;
+    lower_.unit    = true;
+    lower_.starts  = detail::dual_copy(starts, "ilu_starts");
+    lower_.columns = detail::dual_copy(columns, "ilu_columns");
+    lower_.values  = detail::dual_copy(values, "ilu_values");
+    detail::build_levels(lower_, starts, columns);
+
+    upper_ = lower_;
+    upper_.lower = false;
+    upper_.unit  = false;
+    detail::build_levels(upper_, starts, columns);
+
+    y_    = DCArrayKokkos <double> (rows > 0 ? rows : 1, "ilu_y");
+    work_ = DCArrayKokkos <double> (rows > 0 ? rows : 1, "ilu_work");
+
+    // IKJ elimination restricted to the pattern, row i needs the finished
+    // rows k < i it refers to, which are in earlier levels of L
+    DCArrayKokkos <size_t> row_start  = lower_.starts;
+    DCArrayKokkos <size_t> col        = lower_.columns;
+    DCArrayKokkos <double> val        = lower_.values;
+    DCArrayKokkos <size_t> diag       = lower_.diagonal;
+    DCArrayKokkos <size_t> level_rows = lower_.level_rows;
+    for(size_t l = 0; l < lower_.num_levels(); l++){
+        FOR_ALL(q, lower_.level_starts[l], lower_.level_starts[l + 1], {
+            const size_t i = level_rows(q);
+            for(size_t p = row_start(i); p < diag(i); p++){
+                const size_t k = col(p);
+                const double lik = val(p) / val(diag(k));
+                val(p) = lik;
+
+                // a_ij -= l_ik u_kj where both are in the pattern
+                size_t s = diag(k) + 1;
+                for(size_t m = p + 1; m < row_start(i + 1); m++){
+                    while(s < row_start(k + 1) && col(s) < col(m)){
+                        s++;
+                    }
+                    if(s < row_start(k + 1) && col(s) == col(m)){
+                        val(m) -= lik * val(s);
+                    }
+                }
+            }
+        });
+    }
+}
+
+template <typename Vector>
+void ILUPreconditioner::operator()(Vector &r, Vector &z) const
+{
+    MATAR_PROFILE_SCOPE("ilu_apply", ProfileCategory::compute);
+    DCArrayKokkos <double> y = y_;
+    detail::triangular_solve(lower_, r, y, work_, options_);
+    detail::triangular_solve(upper_, y, z, work_, options_);
+}
+
+// End of ILUPreconditioner
+
+
+/////////////////////////
+// ICPreconditioner:  incomplete Cholesky with the sparsity of A, z = L^-T L^-1 r
+/////////////////////////
+class ICPreconditioner {
+
+private:
+    PreconditionerOptions options_;
+    detail::TriangularFactor lower_;    // L
+    detail::TriangularFactor upper_;    // L^T, stored by rows
+    DCArrayKokkos <size_t> transpose_source_;   // entry of L behind each entry of L^T
+    DCArrayKokkos <double> y_;
+    DCArrayKokkos <double> work_;
+
+public:
+    ICPreconditioner() {}
+
+    // only the lower triangle of A is read
+    ICPreconditioner(const CSRArrayKokkos <double> &A, const PreconditionerOptions &options = PreconditionerOptions());
+
+    size_t num_levels() const { return lower_.num_levels(); }
+
+    template <typename Vector>
+    void operator()(Vector &r, Vector &z) const;
+
+}; // End of ICPreconditioner
+
+inline ICPreconditioner::ICPreconditioner(const CSRArrayKokkos <double> &A, const PreconditionerOptions &options)
+{
+    MATAR_PROFILE_SCOPE("ic_factor", ProfileCategory::compute);
+    options_ = options;
+
+    std::vector<size_t> starts;
+    std::vector<size_t> columns;
+    std::vector<double> values;
+    detail::sorted_pattern(A, true, starts, columns, values);
+
+    const size_t rows = starts.size() - 1;
+    lower_.rows    = rows;
+    lower_.lower   = true;
+    lower_.unit    = false;
+    lower_.starts  = detail::dual_copy(starts, "ic_starts");
+    lower_.columns = detail::dual_copy(columns, "ic_columns");
+    lower_.values  = detail::dual_copy(values, "ic_values");
+    detail::build_levels(lower_, starts, columns);
+
+    // pattern of L^T, the rows come out sorted as the rows of L are visited in order
+    std::vector<size_t> t_starts(rows + 1, 0);
+    std::vector<size_t> t_columns(columns.size());
+    std::vector<size_t> source(columns.size());
+    for(size_t k = 0; k < columns.size(); k++){
+        t_starts[columns[k] + 1]++;
+    }
+    for(size_t i = 0; i < rows; i++){
+        t_starts[i + 1] += t_starts[i];
+    }
+    std::vector<size_t> next(t_starts.begin(), t_starts.end() - 1);
+    for(size_t i = 0; i < rows; i++){
+        for(size_t k = starts[i]; k < starts[i + 1]; k++){
+            const size_t slot = next[columns[k]]++;
+            t_columns[slot] = i;
+            source[slot]    = k;
+        }
+    }
+
+    upper_.rows    = rows;
+    upper_.lower   = false;
+    upper_.unit    = false;
+    upper_.starts  = detail::dual_copy(t_starts, "ic_t_starts");
+    upper_.columns = detail::dual_copy(t_columns, "ic_t_columns");
+    upper_.values  = DCArrayKokkos <double> (t_columns.size() > 0 ? t_columns.size() : 1, "ic_t_values");
+    transpose_source_ = detail::dual_copy(source, "ic_t_source");
+    detail::build_levels(upper_, t_starts, t_columns);
+
+    y_    = DCArrayKokkos <double> (rows > 0 ? rows : 1, "ic_y");
+    work_ = DCArrayKokkos <double> (rows > 0 ? rows : 1, "ic_work");
+
+    // row-wise Cholesky restricted to the pattern, by the levels of L
+    DCArrayKokkos <size_t> row_start  = lower_.starts;
+    DCArrayKokkos <size_t> col        = lower_.columns;
+    DCArrayKokkos <double> val        = lower_.values;
+    DCArrayKokkos <size_t> diag       = lower_.diagonal;
+    DCArrayKokkos <size_t> level_rows = lower_.level_rows;
+    for(size_t l = 0; l < lower_.num_levels(); l++){
+        FOR_ALL(q, lower_.level_starts[l], lower_.level_starts[l + 1], {
+            const size_t i = level_rows(q);
+            for(size_t p = row_start(i); p < diag(i); p++){
+                const size_t k = col(p);
+
+                // l_ik = (a_ik - sum_{j<k} l_ij l_kj) / l_kk
+                double sum = val(p);
+                size_t s = row_start(k);
+                for(size_t m = row_start(i); m < p; m++){
+                    while(s < diag(k) && col(s) < col(m)){
+                        s++;
+                    }
+                    if(s < diag(k) && col(s) == col(m)){
+                        sum -= val(m) * val(s);
+                    }
+                }
+                val(p) = sum / val(diag(k));
+            }
+
+            // on a breakdown the diagonal of A is kept
+            double d = val(diag(i));
+            for(size_t p = row_start(i); p < diag(i); p++){
+                d -= val(p) * val(p);
+            }
+            val(diag(i)) = sqrt(d > 0.0 ? d : fabs(val(diag(i))));
+        });
+    }
+
+    DCArrayKokkos <double> t_val  = upper_.values;
+    DCArrayKokkos <size_t> t_from = transpose_source_;
+    FOR_ALL(k, 0, t_columns.size(), {
+        t_val(k) = val(t_from(k));
+    });
+}
+
+template <typename Vector>
+void ICPreconditioner::operator()(Vector &r, Vector &z) const
+{
+    MATAR_PROFILE_SCOPE("ic_apply", ProfileCategory::compute);
+    DCArrayKokkos <double> y = y_;
+    detail::triangular_solve(lower_, r, y, work_, options_);
+    detail::triangular_solve(upper_, y, z, work_, options_);
+}
+
+// End of ICPreconditioner
+
+
+/////////////////////////
+// BlockJacobiPreconditioner:  batched LU of the diagonal blocks of A
+/////////////////////////
+class BlockJacobiPreconditioner {
+
+private:
+    size_t rows_       = 0;
+    size_t block_size_ = 1;
+    size_t num_blocks_ = 0;
+    CArrayKokkos <double> blocks_;   // (block, row, column), LU factors
+    CArrayKokkos <size_t> perm_;     // (block, row)
+    CArrayKokkos <double> work_;     // (block, row)
+
+public:
+    BlockJacobiPreconditioner() {}
+
+    // blocks of options.block_size consecutive rows, the last one padded with
+    // the identity, entries outside the blocks are dropped
+    BlockJacobiPreconditioner(const CSRArrayKokkos <double> &A, const PreconditionerOptions &options = PreconditionerOptions());
+
+    size_t num_blocks() const { return num_blocks_; }
+
+    template <typename Vector>
+    void operator()(Vector &r, Vector &z) const;
+
+}; // End of BlockJacobiPreconditioner
+
+inline BlockJacobiPreconditioner::BlockJacobiPreconditioner(const CSRArrayKokkos <double> &A_csr,
+                                                            const PreconditionerOptions &options)
+{
+    MATAR_PROFILE_SCOPE("block_jacobi_factor", ProfileCategory::compute);
+    CSRArrayKokkos <double> A = A_csr;
+    rows_       = A.dim1();
+    block_size_ = options.block_size > 0 ? options.block_size : 1;
+    num_blocks_ = (rows_ + block_size_ - 1) / block_size_;
+
+    const size_t rows = rows_;
+    const size_t bs   = block_size_;
+    const size_t nb   = num_blocks_ > 0 ? num_blocks_ : 1;
+    blocks_ = CArrayKokkos <double> (nb, bs, bs, "block_jacobi_blocks");
+    perm_   = CArrayKokkos <size_t> (nb, bs, "block_jacobi_perm");
+    work_   = CArrayKokkos <double> (nb, bs, "block_jacobi_work");
+    blocks_.set_values(0.0);
+
+    CArrayKokkos <double> blocks = blocks_;
+    CArrayKokkos <size_t> perm   = perm_;
+    CArrayKokkos <double> work   = work_;
+
+    // every thread fills one row of one block
+    FOR_ALL(i, 0, num_blocks_ * bs, {
+        const size_t a_row = i;
+        const size_t block = a_row / bs;
+        const size_t row   = a_row % bs;
+        if(a_row >= rows){
+            blocks(block, row, row) = 1.0;
+        }
+        else{
+            for(size_t k = A.begin_index(a_row); k < A.end_index(a_row); k++){
+                const size_t col = A.get_col_flat(k);
+                if(col < rows && col / bs == block){
+                    blocks(block, row, col % bs) += A.get_val_flat(k);
+                }
+            }
+        }
+    });
+
+    // the dense LU of lu_solver.hpp on every block
+    int singular = 0;
+    int loc_singular;
+    FOR_REDUCE_SUM(block, 0, num_blocks_, loc_singular, {
+        ViewCArrayKokkos <double> A_block(&blocks(block, 0, 0), bs, bs);
+        ViewCArrayKokkos <size_t> perm_block(&perm(block, 0), bs);
+        ViewCArrayKokkos <double> scale(&work(block, 0), bs);
+        int parity;
+        loc_singular += (LU_decompose(A_block, perm_block, scale, parity) == 0) ? 1 : 0;
+    }, singular);
+
+    if(singular > 0){
+        throw std::runtime_error("BlockJacobiPreconditioner: a diagonal block is singular");
+    }
+}
+
+template <typename Vector>
+void BlockJacobiPreconditioner::operator()(Vector &r, Vector &z) const
+{
+    MATAR_PROFILE_SCOPE("block_jacobi_apply", ProfileCategory::compute);
+    CArrayKokkos <double> blocks = blocks_;
+    CArrayKokkos <size_t> perm   = perm_;
+    CArrayKokkos <double> work   = work_;
+    const size_t rows = rows_;
+    const size_t bs   = block_size_;
+
+    FOR_ALL(block, 0, num_blocks_, {
+        for(size_t row = 0; row < bs; row++){
+            const size_t i = block * bs + row;
+            work(block, row) = (i < rows) ? r(i) : 0.0;
+        }
+
+        ViewCArrayKokkos <double> A_block(&blocks(block, 0, 0), bs, bs);
+        ViewCArrayKokkos <size_t> perm_block(&perm(block, 0), bs);
+        ViewCArrayKokkos <double> x(&work(block, 0), bs);
+        LU_backsub(A_block, perm_block, x);
+
+        for(size_t row = 0; row < bs; row++){
+            const size_t i = block * bs + row;
+            if(i < rows){
+                z(i) = work(block, row);
+            }
+        }
+    });
+}
+
+// End of BlockJacobiPreconditioner
+
+#endif // PRECONDITIONERS_H
@@ -97,10 +97,26 @@ void QR_backsub_host(const DCArrayKokkos <double> &R,
 
 } // end function
 
+// scratch arena shared by the QR calls that are not given one, its blocks
+// are kept between calls and freed when Kokkos is finalized
+DeviceArena& QR_scratch_arena() {
+    static DeviceArena* arena = nullptr;
+    if (arena == nullptr) {
+        arena = new DeviceArena(16*1024*1024, "QR_scratch");
+        Kokkos::push_finalize_hook([]() {
+            delete arena;
+            arena = nullptr;
+        });
+    }
+    return *arena;
+}
+
 // QR Decomposition using Modified Gram-Schmidt
+// v comes from scratch, or from QR_scratch_arena() when none is passed
 void QR_decompose_host(const DCArrayKokkos <double> &A, 
                        DFArrayKokkos <double> &Q, 
-                       DCArrayKokkos <double> &R) {
+                       DCArrayKokkos <double> &R,
+                       DeviceArena* scratch = nullptr) {
 
 
     const size_t m = A.dims(0);
@@ -109,7 +125,10 @@ void QR_decompose_host(const DCArrayKokkos <double> &A,
     Q.set_values(0.0);
     R.set_values(0.0);
 
-    DCArrayKokkos <double> v(n,m,"v");
+    DeviceArena& arena = (scratch != nullptr) ? *scratch : QR_scratch_arena();
+    ArenaScope <DeviceArena> scope(arena);
+
+    ViewCArrayKokkos <double> v = arena.carray<double>(n,m);
 
     // Copy columns of A to v, and taking transpose
     FOR_ALL(i, 0, m,
@@ -181,7 +181,7 @@ namespace mtr
 #ifdef HAVE_KOKKOS
 #define MATAR_FENCE() Kokkos::fence()
 #define MATAR_INITIALIZE(...)  Kokkos::initialize(__VA_ARGS__)
-#define MATAR_FINALIZE() Kokkos::finalize();
+#define MATAR_FINALIZE() do { mtr::TransferLog::instance().finalize(); Kokkos::finalize(); } while (0)
 #else
 #define MATAR_FENCE()
 #define MATAR_INITIALIZE(...)
@@ -0,0 +1,541 @@
+#ifndef CARTESIAN_DECOMPOSITION_H
+#define CARTESIAN_DECOMPOSITION_H
+/**********************************************************************************************
+ © 2020. Triad National Security, LLC. All rights reserved.
+ This program was produced under U.S. Government contract 89233218CNA000001 for Los Alamos
+ National Laboratory (LANL), which is operated by Triad National Security, LLC for the U.S.
+ Department of Energy/National Nuclear Security Administration. All rights in the program are
+ reserved by Triad National Security, LLC, and the U.S. Department of Energy/National Nuclear
+ Security Administration. The Government is granted for itself and others acting on its behalf a
+ nonexclusive, paid-up, irrevocable worldwide license in this material to reproduce, prepare
+ derivative works, distribute copies to the public, perform publicly and display publicly, and
+ to permit others to do so.
+ This program is open source under the BSD-3 License.
+ Redistribution and use in source and binary forms, with or without modification, are permitted
+ provided that the following conditions are met:
+ 
+ 1.  Redistributions of source code must retain the above copyright notice, this list of
+ conditions and the following disclaimer.
+ 
+ 2.  Redistributions in binary form must reproduce the above copyright notice, this list of
+ conditions and the following disclaimer in the documentation and/or other materials
+ provided with the distribution.
+ 
+ 3.  Neither the name of the copyright holder nor the names of its contributors may be used
+ to endorse or promote products derived from this software without specific prior
+ written permission.
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+ IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **********************************************************************************************/
+
+#ifdef HAVE_MPI
+#include <mpi.h>
+#include "matar.h"
+#include "communication_plan.h"
+#include "mpi_types.h"
+
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+
+// -----------------------------------------
+// Block decomposition of a structured grid over a Cartesian process grid
+//
+//   CartesianOptions options;                       // one ghost layer, not periodic
+//   CartesianDecomposition decomp(MPI_COMM_WORLD, options, height, width);
+//
+//   auto u = decomp.make_field<double>("u");        // local block padded by the halo,
+//                                                   // interior is [halo, local_dims(d) + halo)
+//   CartesianHaloExchange<double> halo(decomp, u);
+//
+//   halo.begin();                                   // pack on the device, post the exchange
+//   ... work on the deep interior ...
+//   halo.end();                                     // wait, unpack on the device
+//   ... work next to the halo ...
+//
+// The ranks are arranged with MPI_Cart_create and every rank exchanges with
+// all of its face, edge and corner neighbors, so a 3D block has up to 26.
+// The halo is described by a CommunicationPlan, so the exchange is a single
+// MPI_Ineighbor_alltoallv on its graph communicator. Blocks have less
+// surface than strips once there are more than a few ranks.
+//
+// Ghost cells on a non-periodic edge of the global grid are not touched,
+// they hold the boundary values the user sets, see on_boundary().
+// -----------------------------------------
+
+namespace mtr
+{
+
+struct CartesianOptions {
+    size_t halo = 1;                           // ghost layers around each local block
+    bool   periodic[3] = {false, false, false};
+    int    procs[3] = {0, 0, 0};               // ranks per dimension, 0 lets MPI choose
+    bool   gpu_aware = false;                  // hand device buffers straight to MPI
+};
+
+
+/////////////////////////
+// CartesianDecomposition:  local block of a 2D or 3D grid and the plan for its halo
+/////////////////////////
+class CartesianDecomposition {
+
+private:
+    MPI_Comm cart_comm_ = MPI_COMM_NULL;
+    size_t order_ = 0;
+    size_t halo_  = 0;
+    int    rank_  = -1;
+    bool   gpu_aware_ = false;
+
+    int    procs_[3]       = {1, 1, 1};
+    int    coords_[3]      = {0, 0, 0};
+    bool   periodic_[3]    = {false, false, false};
+    size_t global_dims_[3] = {1, 1, 1};
+    size_t local_dims_[3]  = {1, 1, 1};
+    size_t offsets_[3]     = {0, 0, 0};
+
+    CommunicationPlan plan_;
+
+    // flat index, in the padded local block, of every value in the send and receive buffers
+    DCArrayKokkos<int> send_cells_;
+    DCArrayKokkos<int> recv_cells_;
+
+    CartesianDecomposition() {}
+
+    void setup(MPI_Comm comm, const CartesianOptions& options);
+
+    // neighbor lists and communication plan of the local block
+    void build_plan();
+
+    // padded indices of the cells on the side of the block toward offset,
+    // inside the halo when ghosts is true and just inside the interior otherwise
+    void collect_cells(const int offset[3], bool ghosts, std::vector<int>& cells) const;
+
+public:
+    CartesianDecomposition(MPI_Comm comm, const CartesianOptions& options, size_t global0, size_t global1);
+
+    CartesianDecomposition(MPI_Comm comm, const CartesianOptions& options, size_t global0, size_t global1, size_t global2);
+
+    // owns MPI communicators, so it is not copied
+    CartesianDecomposition(const CartesianDecomposition&) = delete;
+    CartesianDecomposition& operator=(const CartesianDecomposition&) = delete;
+
+    ~CartesianDecomposition();
+
+    MPI_Comm comm() const { return cart_comm_; }
+
+    size_t order() const { return order_; }
+
+    size_t halo() const { return halo_; }
+
+    int rank() const { return rank_; }
+
+    int procs(size_t d) const { return procs_[d]; }
+
+    int coords(size_t d) const { return coords_[d]; }
+
+    size_t global_dims(size_t d) const { return global_dims_[d]; }
+
+    // interior points of the local block and where it starts in the global grid
+    size_t local_dims(size_t d) const { return local_dims_[d]; }
+
+    size_t offset(size_t d) const { return offsets_[d]; }
+
+    size_t padded_dims(size_t d) const { return d < order_ ? local_dims_[d] + 2*halo_ : 1; }
+
+    // true when side (-1 low, +1 high) of dimension d is an edge of the global grid
+    bool on_boundary(size_t d, int side) const;
+
+    bool gpu_aware() const { return gpu_aware_; }
+
+    CommunicationPlan& plan() { return plan_; }
+
+    const DCArrayKokkos<int>& send_cells() const { return send_cells_; }
+
+    const DCArrayKokkos<int>& recv_cells() const { return recv_cells_; }
+
+    // same ranks on the grid with every other point, for multigrid. Global
+    // point 2I of this grid, counting from 1, is point I of the coarse one.
+    // The global dims must be odd and the coarse blocks at least halo thick,
+    // and every rank of comm() calls it.
+    std::unique_ptr<CartesianDecomposition> coarsen() const;
+
+    // padded local block
+    template <typename T>
+    DCArrayKokkos<T> make_field(const std::string& tag_string = DEFAULTSTRINGARRAY) const;
+
+}; // End of CartesianDecomposition
+
+inline CartesianDecomposition::CartesianDecomposition(MPI_Comm comm, const CartesianOptions& options,
+                                                      size_t global0, size_t global1)
+{
+    order_ = 2;
+    global_dims_[0] = global0;
+    global_dims_[1] = global1;
+    setup(comm, options);
+}
+
+inline CartesianDecomposition::CartesianDecomposition(MPI_Comm comm, const CartesianOptions& options,
+                                                      size_t global0, size_t global1, size_t global2)
+{
+    order_ = 3;
+    global_dims_[0] = global0;
+    global_dims_[1] = global1;
+    global_dims_[2] = global2;
+    setup(comm, options);
+}
+
+inline CartesianDecomposition::~CartesianDecomposition()
+{
+    if (cart_comm_ != MPI_COMM_NULL) {
+        MPI_Comm_free(&cart_comm_);
+    }
+}
+
+inline void CartesianDecomposition::setup(MPI_Comm comm, const CartesianOptions& options)
+{
+    halo_      = options.halo;
+    gpu_aware_ = options.gpu_aware;
+
+    int world_size;
+    MPI_Comm_size(comm, &world_size);
+
+    // process grid, ranks are kept in the order of comm
+    int dims[3]    = {0, 0, 0};
+    int periods[3] = {0, 0, 0};
+    for (size_t d = 0; d < order_; d++) {
+        dims[d]    = options.procs[d];
+        periods[d] = options.periodic[d] ? 1 : 0;
+    }
+    MPI_Dims_create(world_size, static_cast<int>(order_), dims);
+    MPI_Cart_create(comm, static_cast<int>(order_), dims, periods, 0, &cart_comm_);
+    MPI_Comm_rank(cart_comm_, &rank_);
+    MPI_Cart_coords(cart_comm_, rank_, static_cast<int>(order_), coords_);
+
+    // balanced blocks, the first global % procs ranks get one more point
+    for (size_t d = 0; d < order_; d++) {
+        procs_[d]    = dims[d];
+        periodic_[d] = options.periodic[d];
+
+        const size_t base  = global_dims_[d] / procs_[d];
+        const size_t extra = global_dims_[d] % procs_[d];
+        const size_t c     = static_cast<size_t>(coords_[d]);
+        local_dims_[d] = base + (c < extra ? 1 : 0);
+        offsets_[d]    = c * base + (c < extra ? c : extra);
+
+        if (local_dims_[d] < halo_) {
+            throw std::runtime_error("CartesianDecomposition: local block is thinner than the halo");
+        }
+    }
+
+    build_plan();
+}
+
+inline std::unique_ptr<CartesianDecomposition> CartesianDecomposition::coarsen() const
+{
+    std::unique_ptr<CartesianDecomposition> coarse(new CartesianDecomposition());
+    coarse->order_     = order_;
+    coarse->halo_      = halo_;
+    coarse->rank_      = rank_;
+    coarse->gpu_aware_ = gpu_aware_;
+    MPI_Comm_dup(cart_comm_, &coarse->cart_comm_);
+
+    // global point 2I (counting from 1) is coarse point I, so a block keeps
+    // the coarse points that land on its own fine points
+    for (size_t d = 0; d < order_; d++) {
+        if (periodic_[d] || global_dims_[d] % 2 == 0) {
+            throw std::runtime_error("CartesianDecomposition: coarsen needs an odd number of points and no periodic edges");
+        }
+        coarse->procs_[d]       = procs_[d];
+        coarse->coords_[d]      = coords_[d];
+        coarse->global_dims_[d] = (global_dims_[d] - 1) / 2;
+        coarse->offsets_[d]     = offsets_[d] / 2;
+        coarse->local_dims_[d]  = (offsets_[d] + local_dims_[d]) / 2 - offsets_[d] / 2;
+
+        if (coarse->local_dims_[d] < halo_) {
+            throw std::runtime_error("CartesianDecomposition: coarse block is thinner than the halo");
+        }
+    }
+
+    coarse->build_plan();
+    return coarse;
+}
+
+inline void CartesianDecomposition::build_plan()
+{
+    // Neighbors are visited in lexicographic order of their offset for the
+    // sends and in the reverse order for the receives. When two ranks are
+    // neighbors more than once (periodic with 1 or 2 ranks in a dimension)
+    // MPI pairs the messages in list order, and negating the offset reverses
+    // that order, so each send meets the receive of the opposite side.
+    const int num_offsets = (order_ == 2) ? 9 : 27;
+    std::vector<int> send_ranks;
+    std::vector<int> recv_ranks;
+    std::vector<std::vector<int>> send_lists;
+    std::vector<std::vector<int>> recv_lists;
+
+    for (int pass = 0; pass < 2; pass++) {
+        const bool sends = (pass == 0);
+        for (int count = 0; count < num_offsets; count++) {
+            const int n = sends ? count : num_offsets - 1 - count;
+            int offset[3] = {n / 9 - 1, (n / 3) % 3 - 1, n % 3 - 1};
+            if (order_ == 2) {
+                offset[0] = n / 3 - 1;
+                offset[1] = n % 3 - 1;
+                offset[2] = 0;
+            }
+            if (offset[0] == 0 && offset[1] == 0 && offset[2] == 0) {
+                continue;
+            }
+
+            int neighbor_coords[3] = {0, 0, 0};
+            bool exists = true;
+            for (size_t d = 0; d < order_; d++) {
+                int c = coords_[d] + offset[d];
+                if (c < 0 || c >= procs_[d]) {
+                    if (!periodic_[d]) {
+                        exists = false;
+                    }
+                    c = (c + procs_[d]) % procs_[d];
+                }
+                neighbor_coords[d] = c;
+            }
+            if (!exists) {
+                continue;
+            }
+
+            int neighbor;
+            MPI_Cart_rank(cart_comm_, neighbor_coords, &neighbor);
+
+            std::vector<int> cells;
+            collect_cells(offset, !sends, cells);
+            if (sends) {
+                send_ranks.push_back(neighbor);
+                send_lists.push_back(cells);
+            }
+            else {
+                recv_ranks.push_back(neighbor);
+                recv_lists.push_back(cells);
+            }
+        }
+    }
+
+    plan_.initialize(cart_comm_);
+    if (send_ranks.empty()) {
+        return;  // a single rank and nothing periodic
+    }
+    plan_.initialize_graph_communicator(static_cast<int>(send_ranks.size()), send_ranks.data(),
+                                        static_cast<int>(recv_ranks.size()), recv_ranks.data());
+
+    // per neighbor lists for the plan, and the same cells flattened in buffer order
+    auto build = [](const std::vector<std::vector<int>>& lists, DRaggedRightArrayKokkos<int>& ragged,
+                    DCArrayKokkos<int>& flat, const std::string& tag) {
+        std::vector<size_t> strides(lists.size());
+        size_t total = 0;
+        for (size_t r = 0; r < lists.size(); r++) {
+            strides[r] = lists[r].size();
+            total += strides[r];
+        }
+        ragged = DRaggedRightArrayKokkos<int>(strides.data(), strides.size(), tag + "_indices");
+        flat   = DCArrayKokkos<int>(total, tag + "_cells");
+        size_t count = 0;
+        for (size_t r = 0; r < lists.size(); r++) {
+            for (size_t j = 0; j < lists[r].size(); j++) {
+                ragged.host(r, j) = lists[r][j];
+                flat.host(count++) = lists[r][j];
+            }
+        }
+        ragged.update_device();
+        flat.update_device();
+    };
+
+    DRaggedRightArrayKokkos<int> send_indices;
+    DRaggedRightArrayKokkos<int> recv_indices;
+    build(send_lists, send_indices, send_cells_, "halo_send");
+    build(recv_lists, recv_indices, recv_cells_, "halo_recv");
+    plan_.setup_send_recv(send_indices, recv_indices);
+}
+
+inline void CartesianDecomposition::collect_cells(const int offset[3], bool ghosts, std::vector<int>& cells) const
+{
+    const int h = static_cast<int>(halo_);
+    int lo[3] = {0, 0, 0};
+    int hi[3] = {1, 1, 1};
+    for (size_t d = 0; d < order_; d++) {
+        const int n = static_cast<int>(local_dims_[d]);
+        if (offset[d] == 0) {
+            lo[d] = h;
+            hi[d] = n + h;
+        }
+        else if (offset[d] < 0) {
+            lo[d] = ghosts ? 0 : h;
+            hi[d] = lo[d] + h;
+        }
+        else {
+            lo[d] = ghosts ? n + h : n;
+            hi[d] = lo[d] + h;
+        }
+    }
+
+    const int p1 = static_cast<int>(padded_dims(1));
+    const int p2 = static_cast<int>(padded_dims(2));
+    for (int i = lo[0]; i < hi[0]; i++) {
+        for (int j = lo[1]; j < hi[1]; j++) {
+            for (int k = lo[2]; k < hi[2]; k++) {
+                cells.push_back((i*p1 + j)*p2 + k);
+            }
+        }
+    }
+}
+
+inline bool CartesianDecomposition::on_boundary(size_t d, int side) const
+{
+    assert(d < order_ && "d is out of bounds in CartesianDecomposition on_boundary!");
+    if (periodic_[d]) {
+        return false;
+    }
+    return side < 0 ? coords_[d] == 0 : coords_[d] == procs_[d] - 1;
+}
+
+template <typename T>
+DCArrayKokkos<T> CartesianDecomposition::make_field(const std::string& tag_string) const
+{
+    if (order_ == 2) {
+        return DCArrayKokkos<T>(padded_dims(0), padded_dims(1), tag_string);
+    }
+    return DCArrayKokkos<T>(padded_dims(0), padded_dims(1), padded_dims(2), tag_string);
+}
+
+// End of CartesianDecomposition
+
+
+/////////////////////////
+// CartesianHaloExchange:  packs, exchanges and unpacks the halo of one field
+/////////////////////////
+template <typename T>
+class CartesianHaloExchange {
+
+private:
+    CartesianDecomposition* decomp_ = nullptr;
+    DCArrayKokkos<T> field_;
+    DCArrayKokkos<T> send_buffer_;
+    DCArrayKokkos<T> recv_buffer_;
+    MPI_Request request_ = MPI_REQUEST_NULL;
+
+    bool active() const;
+
+public:
+    CartesianHaloExchange() {}
+
+    CartesianHaloExchange(CartesianDecomposition& decomp, const DCArrayKokkos<T>& field);
+
+    // pack the halo on the device and start the exchange
+    void begin();
+
+    // wait for the exchange and unpack the ghosts on the device
+    void end();
+
+    void exchange();
+
+}; // End of CartesianHaloExchange
+
+template <typename T>
+CartesianHaloExchange<T>::CartesianHaloExchange(CartesianDecomposition& decomp, const DCArrayKokkos<T>& field)
+{
+    decomp_ = &decomp;
+    field_  = field;
+
+    if (!active()) {
+        return;
+    }
+    assert(field.size() == decomp.padded_dims(0) * decomp.padded_dims(1) * decomp.padded_dims(2) &&
+           "field is not a padded block of this decomposition in CartesianHaloExchange!");
+
+    send_buffer_ = DCArrayKokkos<T>(decomp.plan().total_send_count, "halo_send_buffer");
+    recv_buffer_ = DCArrayKokkos<T>(decomp.plan().total_recv_count, "halo_recv_buffer");
+}
+
+template <typename T>
+bool CartesianHaloExchange<T>::active() const
+{
+    return decomp_ != nullptr && decomp_->plan().comm_type != communication_plan_type::no_communication;
+}
+
+template <typename T>
+void CartesianHaloExchange<T>::begin()
+{
+    MATAR_PROFILE_SCOPE("CartesianHaloExchange::begin", ProfileCategory::communication);
+    if (!active()) {
+        return;
+    }
+
+    CommunicationPlan& plan = decomp_->plan();
+    DCArrayKokkos<int> cells = decomp_->send_cells();
+    DCArrayKokkos<T> buffer  = send_buffer_;
+    T* data = field_.device_pointer();
+
+    FOR_ALL(s, 0, plan.total_send_count, {
+        buffer(s) = data[cells(s)];
+    });
+
+    T* send_ptr = buffer.device_pointer();
+    T* recv_ptr = recv_buffer_.device_pointer();
+    if (!decomp_->gpu_aware()) {
+        buffer.update_host();
+        send_ptr = buffer.host_pointer();
+        recv_ptr = recv_buffer_.host_pointer();
+    }
+    MATAR_FENCE();
+
+    MPI_Ineighbor_alltoallv(send_ptr, plan.send_counts_.host_pointer(), plan.send_displs_.host_pointer(),
+                            mpi_type_map<T>::value(),
+                            recv_ptr, plan.recv_counts_.host_pointer(), plan.recv_displs_.host_pointer(),
+                            mpi_type_map<T>::value(),
+                            plan.mpi_comm_graph, &request_);
+}
+
+template <typename T>
+void CartesianHaloExchange<T>::end()
+{
+    MATAR_PROFILE_SCOPE("CartesianHaloExchange::end", ProfileCategory::communication);
+    if (!active()) {
+        return;
+    }
+
+    MPI_Wait(&request_, MPI_STATUS_IGNORE);
+    if (!decomp_->gpu_aware()) {
+        recv_buffer_.update_device();
+    }
+
+    DCArrayKokkos<int> cells = decomp_->recv_cells();
+    DCArrayKokkos<T> buffer  = recv_buffer_;
+    T* data = field_.device_pointer();
+
+    FOR_ALL(s, 0, decomp_->plan().total_recv_count, {
+        data[cells(s)] = buffer(s);
+    });
+    MATAR_FENCE();
+}
+
+template <typename T>
+void CartesianHaloExchange<T>::exchange()
+{
+    begin();
+    end();
+}
+
+// End of CartesianHaloExchange
+
+} // end namespace
+
+#endif // end if HAVE_MPI
+#endif // end if CARTESIAN_DECOMPOSITION_H
@@ -0,0 +1,1704 @@
+#ifndef CHECKPOINT_H
+#define CHECKPOINT_H
+/**********************************************************************************************
+ © 2020. Triad National Security, LLC. All rights reserved.
+ This program was produced under U.S. Government contract 89233218CNA000001 for Los Alamos
+ National Laboratory (LANL), which is operated by Triad National Security, LLC for the U.S.
+ Department of Energy/National Nuclear Security Administration. All rights in the program are
+ reserved by Triad National Security, LLC, and the U.S. Department of Energy/National Nuclear
+ Security Administration. The Government is granted for itself and others acting on its behalf a
+ nonexclusive, paid-up, irrevocable worldwide license in this material to reproduce, prepare
+ derivative works, distribute copies to the public, perform publicly and display publicly, and
+ to permit others to do so.
+ This program is open source under the BSD-3 License.
+ Redistribution and use in source and binary forms, with or without modification, are permitted
+ provided that the following conditions are met:
+ 
+ 1.  Redistributions of source code must retain the above copyright notice, this list of
+ conditions and the following disclaimer.
+ 
+ 2.  Redistributions in binary form must reproduce the above copyright notice, this list of
+ conditions and the following disclaimer in the documentation and/or other materials
+ provided with the distribution.
+ 
+ 3.  Neither the name of the copyright holder nor the names of its contributors may be used
+ to endorse or promote products derived from this software without specific prior
+ written permission.
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+ IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **********************************************************************************************/
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#ifdef HAVE_MPI
+#include <mpi.h>
+#endif
+
+#include "host_types.h"  // mmap and MATAR_HAVE_MMAP
+#include "kokkos_types.h"
+#include "interop_types.h"
+#include "profile.h"
+
+
+// -----------------------------------------
+// Binary checkpoint and restart of MATAR containers
+//
+//   CheckpointOptions options;
+//   options.compress = true;
+//
+//   CheckpointWriter out(checkpoint_file_name("restart", rank), options);
+//   out.write("density", density);          // CArray, FArray, ragged, CSR,
+//   out.write("node_coords", coords);       // CSC, Kokkos and dual types
+//   out.close();
+//
+//   CheckpointReader in(checkpoint_file_name("restart", rank));
+//   in.read("density", density);            // allocated if empty, else the
+//   in.read("node_coords", coords);         // dims must match
+//
+// With MPI, CheckpointWriter(file_name, comm) writes every rank into one
+// shared file with collective MPI-IO, read it back with
+// CheckpointReader(file_name, rank). Until close() each rank stages its
+// part in a file next to the checkpoint, so memory use stays bounded.
+//
+// File layout, native byte order:
+//   file header, part table (one part per rank)
+//   per part, a list of records: record header, name, sections
+//   per section (data, start index, column index), a list of chunks
+//   per chunk, the raw and stored sizes, then the bytes, LZ4 compressed
+//   when that made the chunk smaller
+//
+// Reads map the file with mmap and decompress the chunks in parallel with
+// OpenMP. Device data is staged through a host copy.
+// -----------------------------------------
+
+namespace mtr
+{
+
+// -----------------------------------------
+// LZ4 block format compression, used on each chunk
+// -----------------------------------------
+inline uint32_t lz4_read32(const unsigned char* p)
+{
+    uint32_t value;
+    std::memcpy(&value, p, 4);
+    return value;
+}
+
+// extra length bytes of a literal or match length of 15 or more
+inline void lz4_put_length(unsigned char* dest, size_t& op, size_t length)
+{
+    while (length >= 255) {
+        dest[op++] = 255;
+        length -= 255;
+    }
+    dest[op++] = static_cast<unsigned char>(length);
+}
+
+// compress length bytes into dest, returns the compressed size or 0 when
+// it would not fit in capacity bytes
+inline size_t lz4_compress_block(const char* source, size_t length, char* dest, size_t capacity)
+{
+    const int    hash_log      = 12;
+    const size_t min_match     = 4;
+    const size_t last_literals = 5;   // the last 5 bytes are always literals
+    const size_t match_limit   = 12;  // the last match starts 12 bytes before the end
+
+    const unsigned char* src = reinterpret_cast<const unsigned char*>(source);
+    unsigned char*       dst = reinterpret_cast<unsigned char*>(dest);
+    size_t op     = 0;
+    size_t anchor = 0;
+
+    if (length > match_limit) {
+        std::vector<uint32_t> table(size_t(1) << hash_log, 0);  // position + 1 of the last sequence
+        const size_t ip_limit  = length - match_limit;
+        const size_t end_limit = length - last_literals;
+
+        size_t ip = 0;
+        while (ip < ip_limit) {
+            const uint32_t sequence = lz4_read32(src + ip);
+            const uint32_t hash     = (sequence * 2654435761u) >> (32 - hash_log);
+            const size_t   ref      = table[hash];
+            table[hash] = static_cast<uint32_t>(ip + 1);
+
+            if (ref == 0 || ip - (ref - 1) > 65535 || lz4_read32(src + ref - 1) != sequence) {
+                ip++;
+                continue;
+            }
+
+            const size_t match_start = ref - 1;
+            size_t match = min_match;
+            while (ip + match < end_limit && src[match_start + match] == src[ip + match]) {
+                match++;
+            }
+
+            const size_t literals = ip - anchor;
+            if (op + 1 + literals + literals / 255 + 1 + 2 + match / 255 + 1 > capacity) {
+                return 0;
+            }
+
+            const size_t match_code = match - min_match;
+            dst[op++] = static_cast<unsigned char>(((literals < 15 ? literals : 15) << 4) |
+                                                   (match_code < 15 ? match_code : 15));
+            if (literals >= 15) {
+                lz4_put_length(dst, op, literals - 15);
+            }
+            std::memcpy(dst + op, src + anchor, literals);
+            op += literals;
+
+            const size_t offset = ip - match_start;
+            dst[op++] = static_cast<unsigned char>(offset & 255);
+            dst[op++] = static_cast<unsigned char>(offset >> 8);
+            if (match_code >= 15) {
+                lz4_put_length(dst, op, match_code - 15);
+            }
+
+            ip    += match;
+            anchor = ip;
+        }
+    }
+
+    // the rest are literals
+    const size_t literals = length - anchor;
+    if (op + 1 + literals + literals / 255 + 1 > capacity) {
+        return 0;
+    }
+    dst[op++] = static_cast<unsigned char>((literals < 15 ? literals : 15) << 4);
+    if (literals >= 15) {
+        lz4_put_length(dst, op, literals - 15);
+    }
+    std::memcpy(dst + op, src + anchor, literals);
+    op += literals;
+
+    return op;
+}
+
+// decompress a block into exactly length bytes, false if it is corrupt
+inline bool lz4_decompress_block(const char* source, size_t stored, char* dest, size_t length)
+{
+    const unsigned char* src = reinterpret_cast<const unsigned char*>(source);
+    unsigned char*       dst = reinterpret_cast<unsigned char*>(dest);
+    size_t ip = 0;
+    size_t op = 0;
+
+    while (ip < stored) {
+        const unsigned char token = src[ip++];
+
+        size_t literals = token >> 4;
+        if (literals == 15) {
+            unsigned char byte;
+            do {
+                if (ip >= stored) {
+                    return false;
+                }
+                byte = src[ip++];
+                literals += byte;
+            } while (byte == 255);
+        }
+        if (ip + literals > stored || op + literals > length) {
+            return false;
+        }
+        std::memcpy(dst + op, src + ip, literals);
+        ip += literals;
+        op += literals;
+
+        if (ip == stored) {
+            break;  // the last sequence has no match
+        }
+
+        if (ip + 2 > stored) {
+            return false;
+        }
+        const size_t offset = src[ip] | (size_t(src[ip + 1]) << 8);
+        ip += 2;
+        if (offset == 0 || offset > op) {
+            return false;
+        }
+
+        size_t match = token & 15;
+        if (match == 15) {
+            unsigned char byte;
+            do {
+                if (ip >= stored) {
+                    return false;
+                }
+                byte = src[ip++];
+                match += byte;
+            } while (byte == 255);
+        }
+        match += 4;
+        if (op + match > length) {
+            return false;
+        }
+
+        // byte by byte, the match may overlap the output
+        for (size_t n = 0; n < match; n++) {
+            dst[op + n] = dst[op - offset + n];
+        }
+        op += match;
+    }
+
+    return op == length;
+}
+
+
+// -----------------------------------------
+// File format
+// -----------------------------------------
+enum class CheckpointKind : uint32_t {
+    dense_c      = 0,  // CArray and the C Kokkos and dual types
+    dense_f      = 1,  // FArray and the F Kokkos and dual types
+    ragged_right = 2,
+    ragged_down  = 3,
+    csr          = 4,
+    csc          = 5
+};
+
+struct CheckpointOptions {
+    size_t chunk_bytes = size_t(4) << 20;  // uncompressed bytes per chunk
+    bool   compress    = false;            // LZ4 compress each chunk
+};
+
+struct CheckpointFileHeader {
+    char     magic[8];   // "MATARCKP"
+    uint32_t version;
+    uint32_t num_parts;
+};
+
+struct CheckpointPart {
+    uint64_t offset;     // from the start of the file
+    uint64_t bytes;
+};
+
+struct CheckpointRecordHeader {
+    char     magic[4];   // "MREC"
+    uint32_t name_length;
+    uint32_t kind;       // CheckpointKind
+    uint8_t  dtype_code; // DataKind of the values
+    uint8_t  reserved;
+    uint16_t num_sections;
+    uint32_t order;
+    uint32_t pad;
+    uint64_t dims[7];
+    uint64_t record_bytes;  // header, name and sections
+};
+
+struct CheckpointSectionHeader {
+    uint64_t count;      // number of entries
+    uint32_t elem_bytes;
+    uint32_t num_chunks;
+};
+
+struct CheckpointChunkHeader {
+    uint32_t raw_bytes;
+    uint32_t stored_bytes;  // equal to raw_bytes when the chunk is not compressed
+};
+
+// name of the checkpoint file of one rank, when every rank writes its own
+inline std::string checkpoint_file_name(const std::string& base, int rank)
+{
+    char suffix[32];
+    std::snprintf(suffix, sizeof(suffix), ".%06d.mckp", rank);
+    return base + suffix;
+}
+
+// allocate a dense container from the dims of a record
+template <typename Array, typename... Extra>
+Array checkpoint_make_dense(const uint64_t* dims, size_t order, const Extra&... extra)
+{
+    switch (order) {
+        case 1:  return Array(dims[0], extra...);
+        case 2:  return Array(dims[0], dims[1], extra...);
+        case 3:  return Array(dims[0], dims[1], dims[2], extra...);
+        case 4:  return Array(dims[0], dims[1], dims[2], dims[3], extra...);
+        case 5:  return Array(dims[0], dims[1], dims[2], dims[3], dims[4], extra...);
+        case 6:  return Array(dims[0], dims[1], dims[2], dims[3], dims[4], dims[5], extra...);
+        default: return Array(dims[0], dims[1], dims[2], dims[3], dims[4], dims[5], dims[6], extra...);
+    }
+}
+
+#ifdef HAVE_KOKKOS
+// copy count values from memory of ExecSpace to the host and back
+template <typename ExecSpace, typename T>
+void checkpoint_to_host(const T* device, T* host, size_t count)
+{
+    if (count == 0) {
+        return;
+    }
+    Kokkos::View<const T*, ExecSpace, Kokkos::MemoryUnmanaged> src(device, count);
+    Kokkos::View<T*, Kokkos::HostSpace, Kokkos::MemoryUnmanaged> dest(host, count);
+    Kokkos::deep_copy(dest, src);
+}
+
+template <typename ExecSpace, typename T>
+void checkpoint_to_device(const T* host, T* device, size_t count)
+{
+    if (count == 0) {
+        return;
+    }
+    Kokkos::View<const T*, Kokkos::HostSpace, Kokkos::MemoryUnmanaged> src(host, count);
+    Kokkos::View<T*, ExecSpace, Kokkos::MemoryUnmanaged> dest(device, count);
+    Kokkos::deep_copy(dest, src);
+}
+#endif
+
+
+// -----------------------------------------
+// CheckpointWriter
+// -----------------------------------------
+class CheckpointWriter {
+
+private:
+    CheckpointOptions options_;
+    std::FILE* file_ = nullptr;
+    bool closed_ = false;
+    uint64_t part_bytes_ = 0;   // bytes written to the part of this rank
+    uint64_t part_base_  = 0;   // offset of the part in file_
+
+    // collective MPI-IO writes stage the part of the rank in a file next
+    // to the checkpoint, close() copies it over in pieces
+    bool collective_ = false;
+#ifdef HAVE_MPI
+    MPI_Comm comm_ = MPI_COMM_NULL;
+    std::string file_name_;
+    std::string stage_name_;
+#endif
+    std::vector<char> scratch_;
+
+    static constexpr uint64_t part_start_ = sizeof(CheckpointFileHeader) + sizeof(CheckpointPart);
+
+    // close the open file and throw
+    [[noreturn]] void fail_(const std::string& message);
+
+    void put_(const void* data, size_t bytes);
+
+    void patch_(uint64_t part_offset, const void* data, size_t bytes);
+
+    void write_section_(const void* data, size_t count, size_t elem_bytes);
+
+    uint64_t begin_record_(const std::string& name, CheckpointKind kind, uint8_t dtype_code,
+                           size_t order, const uint64_t* dims, size_t num_sections);
+
+    void end_record_(uint64_t record_start);
+
+    template <typename T>
+    void write_dense_(const std::string& name, CheckpointKind kind, size_t order,
+                      const uint64_t* dims, const T* data, size_t count);
+
+public:
+    // one file, e.g. one file per rank with checkpoint_file_name
+    CheckpointWriter(const std::string& file_name, const CheckpointOptions& options = CheckpointOptions());
+
+#ifdef HAVE_MPI
+    // one shared file for all ranks in comm, close() is collective
+    CheckpointWriter(const std::string& file_name, MPI_Comm comm, const CheckpointOptions& options = CheckpointOptions());
+#endif
+
+    CheckpointWriter(const CheckpointWriter&) = delete;
+    CheckpointWriter& operator=(const CheckpointWriter&) = delete;
+
+    template <typename T>
+    void write(const std::string& name, const CArray<T>& a);
+
+    template <typename T>
+    void write(const std::string& name, const FArray<T>& a);
+
+    template <typename T>
+    void write(const std::string& name, const RaggedRightArray<T>& a);
+
+    template <typename T>
+    void write(const std::string& name, const RaggedDownArray<T>& a);
+
+    template <typename T>
+    void write(const std::string& name, const CSRArray<T>& a);
+
+    template <typename T>
+    void write(const std::string& name, const CSCArray<T>& a);
+
+#ifdef HAVE_KOKKOS
+    template <typename T, typename Layout, typename ExecSpace, typename MemoryTraits>
+    void write(const std::string& name, const CArrayKokkos<T, Layout, ExecSpace, MemoryTraits>& a);
+
+    template <typename T, typename Layout, typename ExecSpace, typename MemoryTraits>
+    void write(const std::string& name, const FArrayKokkos<T, Layout, ExecSpace, MemoryTraits>& a);
+
+    // the dual types copy the device data to the host first
+    template <typename T, typename Layout, typename ExecSpace, typename MemoryTraits>
+    void write(const std::string& name, DCArrayKokkos<T, Layout, ExecSpace, MemoryTraits>& a);
+
+    template <typename T, typename Layout, typename ExecSpace, typename MemoryTraits>
+    void write(const std::string& name, DFArrayKokkos<T, Layout, ExecSpace, MemoryTraits>& a);
+
+    // the ragged and sparse Kokkos types use the same records as the host
+    // types, so either can read them back
+    template <typename T, typename Layout, typename ExecSpace, typename MemoryTraits, typename ILayout>
+    void write(const std::string& name, RaggedRightArrayKokkos<T, Layout, ExecSpace, MemoryTraits, ILayout>& a);
+
+    template <typename T, typename Layout, typename ExecSpace, typename MemoryTraits, typename ILayout>
+    void write(const std::string& name, RaggedDownArrayKokkos<T, Layout, ExecSpace, MemoryTraits, ILayout>& a);
+
+    // vector and tensor entries are stored with the dims of the entry
+    template <typename T, typename Layout, typename ExecSpace, typename MemoryTraits, typename ILayout>
+    void write(const std::string& name, DRaggedRightArrayKokkos<T, Layout, ExecSpace, MemoryTraits, ILayout>& a);
+
+    template <typename T, typename Layout, typename ExecSpace, typename MemoryTraits>
+    void write(const std::string& name, const CSRArrayKokkos<T, Layout, ExecSpace, MemoryTraits>& a);
+
+    template <typename T, typename Layout, typename ExecSpace, typename MemoryTraits>
+    void write(const std::string& name, const CSCArrayKokkos<T, Layout, ExecSpace, MemoryTraits>& a);
+#endif
+
+    // finish the file, called by the destructor if needed. Write errors
+    // throw std::runtime_error, call close() to see them.
+    void close();
+
+    ~CheckpointWriter();
+}; // End of CheckpointWriter
+
+inline CheckpointWriter::CheckpointWriter(const std::string& file_name, const CheckpointOptions& options)
+    : options_(options)
+{
+    assert(options_.chunk_bytes > 0 && options_.chunk_bytes <= (size_t(1) << 30) &&
+           "CheckpointOptions chunk_bytes must be between 1 byte and 1 GB!");
+
+    file_ = std::fopen(file_name.c_str(), "wb");
+    if (file_ == nullptr) {
+        throw std::runtime_error("CheckpointWriter could not open " + file_name);
+    }
+    part_base_ = part_start_;
+
+    CheckpointFileHeader header = {{'M', 'A', 'T', 'A', 'R', 'C', 'K', 'P'}, 1, 1};
+    CheckpointPart part = {part_start_, 0};  // bytes are set in close()
+    if (std::fwrite(&header, sizeof(header), 1, file_) != 1 ||
+        std::fwrite(&part, sizeof(part), 1, file_) != 1) {
+        fail_("CheckpointWriter failed to write " + file_name);
+    }
+}
+
+#ifdef HAVE_MPI
+inline CheckpointWriter::CheckpointWriter(const std::string& file_name, MPI_Comm comm, const CheckpointOptions& options)
+    : options_(options), collective_(true), comm_(comm), file_name_(file_name)
+{
+    assert(options_.chunk_bytes > 0 && options_.chunk_bytes <= (size_t(1) << 30) &&
+           "CheckpointOptions chunk_bytes must be between 1 byte and 1 GB!");
+
+    int rank;
+    MPI_Comm_rank(comm_, &rank);
+    stage_name_ = checkpoint_file_name(file_name + ".stage", rank);
+    file_ = std::fopen(stage_name_.c_str(), "w+b");
+    if (file_ == nullptr) {
+        throw std::runtime_error("CheckpointWriter could not open " + stage_name_);
+    }
+}
+#endif
+
+inline void CheckpointWriter::fail_(const std::string& message)
+{
+    if (file_ != nullptr) {
+        std::fclose(file_);
+        file_ = nullptr;
+    }
+#ifdef HAVE_MPI
+    // a collective writer stays open so close() still joins the other ranks
+    if (collective_) {
+        std::remove(stage_name_.c_str());
+        throw std::runtime_error(message);
+    }
+#endif
+    closed_ = true;
+    throw std::runtime_error(message);
+}
+
+inline void CheckpointWriter::put_(const void* data, size_t bytes)
+{
+    if (file_ == nullptr) {
+        throw std::runtime_error("CheckpointWriter failed to write");
+    }
+    if (bytes > 0 && std::fwrite(data, 1, bytes, file_) != bytes) {
+        fail_("CheckpointWriter failed to write");
+    }
+    part_bytes_ += bytes;
+}
+
+inline void CheckpointWriter::patch_(uint64_t part_offset, const void* data, size_t bytes)
+{
+    if (file_ == nullptr) {
+        throw std::runtime_error("CheckpointWriter failed to write");
+    }
+    if (std::fseek(file_, static_cast<long>(part_base_ + part_offset), SEEK_SET) != 0 ||
+        std::fwrite(data, 1, bytes, file_) != bytes ||
+        std::fseek(file_, 0, SEEK_END) != 0) {
+        fail_("CheckpointWriter failed to write");
+    }
+}
+
+inline void CheckpointWriter::write_section_(const void* data, size_t count, size_t elem_bytes)
+{
+    // chunks hold whole entries
+    const size_t chunk_entries = options_.chunk_bytes / elem_bytes > 0 ? options_.chunk_bytes / elem_bytes : 1;
+    const size_t num_chunks    = (count + chunk_entries - 1) / chunk_entries;
+
+    CheckpointSectionHeader section = {count, static_cast<uint32_t>(elem_bytes), static_cast<uint32_t>(num_chunks)};
+    put_(&section, sizeof(section));
+
+    const char* bytes = static_cast<const char*>(data);
+    for (size_t c = 0; c < num_chunks; c++) {
+        const size_t first = c * chunk_entries;
+        const size_t raw   = ((first + chunk_entries < count ? first + chunk_entries : count) - first) * elem_bytes;
+
+        size_t stored = 0;
+        if (options_.compress) {
+            scratch_.resize(raw);
+            stored = lz4_compress_block(bytes + first * elem_bytes, raw, scratch_.data(), raw > 0 ? raw - 1 : 0);
+        }
+
+        CheckpointChunkHeader chunk = {static_cast<uint32_t>(raw), static_cast<uint32_t>(stored > 0 ? stored : raw)};
+        put_(&chunk, sizeof(chunk));
+        if (stored > 0) {
+            put_(scratch_.data(), stored);
+        }
+        else {
+            put_(bytes + first * elem_bytes, raw);
+        }
+    }
+}
+
+inline uint64_t CheckpointWriter::begin_record_(const std::string& name, CheckpointKind kind, uint8_t dtype_code,
+                                               size_t order, const uint64_t* dims, size_t num_sections)
+{
+    assert(!closed_ && "CheckpointWriter is already closed!");
+    assert(order <= 7 && "checkpoint records have an order (rank) of 7 or less!");
+
+    CheckpointRecordHeader header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, "MREC", 4);
+    header.name_length  = static_cast<uint32_t>(name.size());
+    header.kind         = static_cast<uint32_t>(kind);
+    header.dtype_code   = dtype_code;
+    header.num_sections = static_cast<uint16_t>(num_sections);
+    header.order        = static_cast<uint32_t>(order);
+    for (size_t d = 0; d < order; d++) {
+        header.dims[d] = dims[d];
+    }
+
+    const uint64_t record_start = part_bytes_;
+    put_(&header, sizeof(header));
+    put_(name.data(), name.size());
+    return record_start;
+}
+
+inline void CheckpointWriter::end_record_(uint64_t record_start)
+{
+    const uint64_t record_bytes = part_bytes_ - record_start;
+    patch_(record_start + offsetof(CheckpointRecordHeader, record_bytes), &record_bytes, sizeof(record_bytes));
+}
+
+template <typename T>
+void CheckpointWriter::write_dense_(const std::string& name, CheckpointKind kind, size_t order,
+                                    const uint64_t* dims, const T* data, size_t count)
+{
+    static_assert(std::is_trivially_copyable<T>::value, "checkpoint values must be trivially copyable!");
+    MATAR_PROFILE_SCOPE("CheckpointWriter::write", ProfileCategory::transfer);
+
+    uint64_t start = begin_record_(name, kind, static_cast<uint8_t>(interop_data_kind<T>()), order, dims, 1);
+    write_section_(data, count, sizeof(T));
+    end_record_(start);
+}
+
+template <typename T>
+void CheckpointWriter::write(const std::string& name, const CArray<T>& a)
+{
+    uint64_t dims[7];
+    for (size_t d = 0; d < a.order(); d++) {
+        dims[d] = a.dims(d);
+    }
+    write_dense_(name, CheckpointKind::dense_c, a.order(), dims, a.pointer(), a.size());
+}
+
+template <typename T>
+void CheckpointWriter::write(const std::string& name, const FArray<T>& a)
+{
+    uint64_t dims[7];
+    for (size_t d = 0; d < a.order(); d++) {
+        dims[d] = a.dims(d);
+    }
+    write_dense_(name, CheckpointKind::dense_f, a.order(), dims, a.pointer(), a.size());
+}
+
+template <typename T>
+void CheckpointWriter::write(const std::string& name, const RaggedRightArray<T>& a)
+{
+    static_assert(std::is_trivially_copyable<T>::value, "checkpoint values must be trivially copyable!");
+    MATAR_PROFILE_SCOPE("CheckpointWriter::write", ProfileCategory::transfer);
+
+    const uint64_t dims[1] = {a.dim1()};
+    uint64_t start = begin_record_(name, CheckpointKind::ragged_right, static_cast<uint8_t>(interop_data_kind<T>()), 1, dims, 2);
+    write_section_(a.get_starts(), a.dim1() + 1, sizeof(size_t));
+    write_section_(a.pointer(), a.get_starts()[a.dim1()], sizeof(T));
+    end_record_(start);
+}
+
+template <typename T>
+void CheckpointWriter::write(const std::string& name, const RaggedDownArray<T>& a)
+{
+    static_assert(std::is_trivially_copyable<T>::value, "checkpoint values must be trivially copyable!");
+    MATAR_PROFILE_SCOPE("CheckpointWriter::write", ProfileCategory::transfer);
+
+    const uint64_t dims[1] = {a.dim2()};
+    uint64_t start = begin_record_(name, CheckpointKind::ragged_down, static_cast<uint8_t>(interop_data_kind<T>()), 1, dims, 2);
+    write_section_(a.get_starts(), a.dim2() + 1, sizeof(size_t));
+    write_section_(a.pointer(), a.get_starts()[a.dim2()], sizeof(T));
+    end_record_(start);
+}
+
+template <typename T>
+void CheckpointWriter::write(const std::string& name, const CSRArray<T>& a)
+{
+    static_assert(std::is_trivially_copyable<T>::value, "checkpoint values must be trivially copyable!");
+    MATAR_PROFILE_SCOPE("CheckpointWriter::write", ProfileCategory::transfer);
+
+    const size_t nnz = a.get_starts()[a.dim1()];
+    std::vector<size_t> columns(nnz);
+    for (size_t k = 0; k < nnz; k++) {
+        columns[k] = a.get_col_flat(k);
+    }
+
+    const uint64_t dims[2] = {a.dim1(), a.dim2()};
+    uint64_t start = begin_record_(name, CheckpointKind::csr, static_cast<uint8_t>(interop_data_kind<T>()), 2, dims, 3);
+    write_section_(a.get_starts(), a.dim1() + 1, sizeof(size_t));
+    write_section_(columns.data(), nnz, sizeof(size_t));
+    write_section_(a.pointer(), nnz, sizeof(T));
+    end_record_(start);
+}
+
+template <typename T>
+void CheckpointWriter::write(const std::string& name, const CSCArray<T>& a)
+{
+    static_assert(std::is_trivially_copyable<T>::value, "checkpoint values must be trivially copyable!");
+    MATAR_PROFILE_SCOPE("CheckpointWriter::write", ProfileCategory::transfer);
+
+    const size_t nnz = a.get_starts()[a.dim2()];
+    std::vector<size_t> rows(nnz);
+    for (size_t k = 0; k < nnz; k++) {
+        rows[k] = a.get_row_flat(k);
+    }
+
+    const uint64_t dims[2] = {a.dim1(), a.dim2()};
+    uint64_t start = begin_record_(name, CheckpointKind::csc, static_cast<uint8_t>(interop_data_kind<T>()), 2, dims, 3);
+    write_section_(a.get_starts(), a.dim2() + 1, sizeof(size_t));
+    write_section_(rows.data(), nnz, sizeof(size_t));
+    write_section_(a.pointer(), nnz, sizeof(T));
+    end_record_(start);
+}
+
+#ifdef HAVE_KOKKOS
+template <typename T, typename Layout, typename ExecSpace, typename MemoryTraits>
+void CheckpointWriter::write(const std::string& name, const CArrayKokkos<T, Layout, ExecSpace, MemoryTraits>& a)
+{
+    auto host = Kokkos::create_mirror_view(a.get_kokkos_view());
+    Kokkos::deep_copy(host, a.get_kokkos_view());
+
+    uint64_t dims[7];
+    for (size_t d = 0; d < a.order(); d++) {
+        dims[d] = a.dims(d);
+    }
+    write_dense_(name, CheckpointKind::dense_c, a.order(), dims, host.data(), a.size());
+}
+
+template <typename T, typename Layout, typename ExecSpace, typename MemoryTraits>
+void CheckpointWriter::write(const std::string& name, const FArrayKokkos<T, Layout, ExecSpace, MemoryTraits>& a)
+{
+    auto host = Kokkos::create_mirror_view(a.get_kokkos_view());
+    Kokkos::deep_copy(host, a.get_kokkos_view());
+
+    uint64_t dims[7];
+    for (size_t d = 0; d < a.order(); d++) {
+        dims[d] = a.dims(d);
+    }
+    write_dense_(name, CheckpointKind::dense_f, a.order(), dims, host.data(), a.size());
+}
+
+template <typename T, typename Layout, typename ExecSpace, typename MemoryTraits>
+void CheckpointWriter::write(const std::string& name, DCArrayKokkos<T, Layout, ExecSpace, MemoryTraits>& a)
+{
+    a.update_host();
+
+    uint64_t dims[7];
+    for (size_t d = 0; d < a.order(); d++) {
+        dims[d] = a.dims(d);
+    }
+    write_dense_(name, CheckpointKind::dense_c, a.order(), dims, a.host_pointer(), a.size());
+}
+
+template <typename T, typename Layout, typename ExecSpace, typename MemoryTraits>
+void CheckpointWriter::write(const std::string& name, DFArrayKokkos<T, Layout, ExecSpace, MemoryTraits>& a)
+{
+    a.update_host();
+
+    uint64_t dims[7];
+    for (size_t d = 0; d < a.order(); d++) {
+        dims[d] = a.dims(d);
+    }
+    write_dense_(name, CheckpointKind::dense_f, a.order(), dims, a.host_pointer(), a.size());
+}
+
+template <typename T, typename Layout, typename ExecSpace, typename MemoryTraits, typename ILayout>
+void CheckpointWriter::write(const std::string& name, RaggedRightArrayKokkos<T, Layout, ExecSpace, MemoryTraits, ILayout>& a)
+{
+    static_assert(std::is_trivially_copyable<T>::value, "checkpoint values must be trivially copyable!");
+    MATAR_PROFILE_SCOPE("CheckpointWriter::write", ProfileCategory::transfer);
+    assert(a.start_index_.extent(0) > 0 && "RaggedRightArrayKokkos is not allocated in CheckpointWriter!");
+
+    auto starts = Kokkos::create_mirror_view(a.start_index_);
+    auto values = Kokkos::create_mirror_view(a.get_kokkos_view());
+    Kokkos::deep_copy(starts, a.start_index_);
+    Kokkos::deep_copy(values, a.get_kokkos_view());
+
+    const size_t dim1 = starts.extent(0) - 1;
+    const uint64_t dims[1] = {dim1};
+    uint64_t start = begin_record_(name, CheckpointKind::ragged_right, static_cast<uint8_t>(interop_data_kind<T>()), 1, dims, 2);
+    write_section_(starts.data(), dim1 + 1, sizeof(size_t));
+    write_section_(values.data(), starts(dim1), sizeof(T));
+    end_record_(start);
+}
+
+template <typename T, typename Layout, typename ExecSpace, typename MemoryTraits, typename ILayout>
+void CheckpointWriter::write(const std::string& name, RaggedDownArrayKokkos<T, Layout, ExecSpace, MemoryTraits, ILayout>& a)
+{
+    static_assert(std::is_trivially_copyable<T>::value, "checkpoint values must be trivially copyable!");
+    MATAR_PROFILE_SCOPE("CheckpointWriter::write", ProfileCategory::transfer);
+    assert(a.start_index_.extent(0) > 0 && "RaggedDownArrayKokkos is not allocated in CheckpointWriter!");
+
+    auto starts = Kokkos::create_mirror_view(a.start_index_);
+    auto values = Kokkos::create_mirror_view(a.get_kokkos_view());
+    Kokkos::deep_copy(starts, a.start_index_);
+    Kokkos::deep_copy(values, a.get_kokkos_view());
+
+    const size_t dim2 = starts.extent(0) - 1;
+    const uint64_t dims[1] = {dim2};
+    uint64_t start = begin_record_(name, CheckpointKind::ragged_down, static_cast<uint8_t>(interop_data_kind<T>()), 1, dims, 2);
+    write_section_(starts.data(), dim2 + 1, sizeof(size_t));
+    write_section_(values.data(), starts(dim2), sizeof(T));
+    end_record_(start);
+}
+
+template <typename T, typename Layout, typename ExecSpace, typename MemoryTraits, typename ILayout>
+void CheckpointWriter::write(const std::string& name, DRaggedRightArrayKokkos<T, Layout, ExecSpace, MemoryTraits, ILayout>& a)
+{
+    static_assert(std::is_trivially_copyable<T>::value, "checkpoint values must be trivially copyable!");
+    MATAR_PROFILE_SCOPE("CheckpointWriter::write", ProfileCategory::transfer);
+    a.update_host();
+
+    // the start indices may have been built on the device
+    auto starts = Kokkos::create_mirror_view(a.start_index_.view_device());
+    Kokkos::deep_copy(starts, a.start_index_.view_device());
+
+    // dims are the number of rows then the dims of a vector or tensor entry
+    const size_t dim1 = a.dims(0);
+    const uint64_t dims[3] = {dim1, a.dims(1), a.dims(2)};
+    const size_t order = dims[1] == 0 ? 1 : (dims[2] == 0 ? 2 : 3);
+    uint64_t start = begin_record_(name, CheckpointKind::ragged_right, static_cast<uint8_t>(interop_data_kind<T>()), order, dims, 2);
+    write_section_(starts.data(), dim1 + 1, sizeof(size_t));
+    write_section_(a.host_pointer(), starts(dim1), sizeof(T));
+    end_record_(start);
+}
+
+template <typename T, typename Layout, typename ExecSpace, typename MemoryTraits>
+void CheckpointWriter::write(const std::string& name, const CSRArrayKokkos<T, Layout, ExecSpace, MemoryTraits>& a)
+{
+    static_assert(std::is_trivially_copyable<T>::value, "checkpoint values must be trivially copyable!");
+    MATAR_PROFILE_SCOPE("CheckpointWriter::write", ProfileCategory::transfer);
+
+    const size_t dim1 = a.dim1();
+    std::vector<size_t> starts(dim1 + 1);
+    checkpoint_to_host<ExecSpace>(a.get_starts(), starts.data(), dim1 + 1);
+    const size_t nnz = starts[dim1];
+
+    // the column indices are only reachable on the device
+    Kokkos::View<size_t*, Layout, ExecSpace> columns("CheckpointColumns", nnz);
+    CSRArrayKokkos<T, Layout, ExecSpace, MemoryTraits> matrix = a;
+    Kokkos::parallel_for("CheckpointColumns", Kokkos::RangePolicy<ExecSpace>(0, nnz), KOKKOS_LAMBDA(const int k) {
+        columns(k) = matrix.get_col_flat(k);
+    });
+    auto columns_host = Kokkos::create_mirror_view(columns);
+    Kokkos::deep_copy(columns_host, columns);
+
+    std::vector<T> values(nnz);
+    checkpoint_to_host<ExecSpace>(a.pointer(), values.data(), nnz);
+
+    const uint64_t dims[2] = {dim1, a.dim2()};
+    uint64_t start = begin_record_(name, CheckpointKind::csr, static_cast<uint8_t>(interop_data_kind<T>()), 2, dims, 3);
+    write_section_(starts.data(), dim1 + 1, sizeof(size_t));
+    write_section_(columns_host.data(), nnz, sizeof(size_t));
+    write_section_(values.data(), nnz, sizeof(T));
+    end_record_(start);
+}
+
+template <typename T, typename Layout, typename ExecSpace, typename MemoryTraits>
+void CheckpointWriter::write(const std::string& name, const CSCArrayKokkos<T, Layout, ExecSpace, MemoryTraits>& a)
+{
+    static_assert(std::is_trivially_copyable<T>::value, "checkpoint values must be trivially copyable!");
+    MATAR_PROFILE_SCOPE("CheckpointWriter::write", ProfileCategory::transfer);
+
+    const size_t dim2 = a.dim2();
+    std::vector<size_t> starts(dim2 + 1);
+    checkpoint_to_host<ExecSpace>(a.get_starts(), starts.data(), dim2 + 1);
+    const size_t nnz = starts[dim2];
+
+    // the row indices are only reachable on the device
+    Kokkos::View<size_t*, Layout, ExecSpace> rows("CheckpointRows", nnz);
+    CSCArrayKokkos<T, Layout, ExecSpace, MemoryTraits> matrix = a;
+    Kokkos::parallel_for("CheckpointRows", Kokkos::RangePolicy<ExecSpace>(0, nnz), KOKKOS_LAMBDA(const int k) {
+        rows(k) = matrix.get_row_flat(k);
+    });
+    auto rows_host = Kokkos::create_mirror_view(rows);
+    Kokkos::deep_copy(rows_host, rows);
+
+    std::vector<T> values(nnz);
+    checkpoint_to_host<ExecSpace>(a.pointer(), values.data(), nnz);
+
+    const uint64_t dims[2] = {a.dim1(), dim2};
+    uint64_t start = begin_record_(name, CheckpointKind::csc, static_cast<uint8_t>(interop_data_kind<T>()), 2, dims, 3);
+    write_section_(starts.data(), dim2 + 1, sizeof(size_t));
+    write_section_(rows_host.data(), nnz, sizeof(size_t));
+    write_section_(values.data(), nnz, sizeof(T));
+    end_record_(start);
+}
+#endif
+
+inline void CheckpointWriter::close()
+{
+    if (closed_) {
+        return;
+    }
+
+    if (!collective_) {
+        const uint64_t bytes = part_bytes_;
+        if (std::fseek(file_, offsetof(CheckpointPart, bytes) + sizeof(CheckpointFileHeader), SEEK_SET) != 0 ||
+            std::fwrite(&bytes, sizeof(bytes), 1, file_) != 1) {
+            fail_("CheckpointWriter failed to write");
+        }
+        closed_ = true;
+        const int status = std::fclose(file_);
+        file_ = nullptr;
+        if (status != 0) {
+            throw std::runtime_error("CheckpointWriter failed to close");
+        }
+        return;
+    }
+
+#ifdef HAVE_MPI
+    MATAR_PROFILE_SCOPE("CheckpointWriter::close", ProfileCategory::communication);
+    closed_ = true;
+
+    int rank, num_ranks;
+    MPI_Comm_rank(comm_, &rank);
+    MPI_Comm_size(comm_, &num_ranks);
+
+    // a rank that failed to stage its part writes nothing
+    int failed = file_ == nullptr;
+
+    // place the parts of the ranks one after another behind the part table
+    uint64_t my_bytes = failed ? 0 : part_bytes_;
+    std::vector<uint64_t> part_bytes(num_ranks);
+    MPI_Allgather(&my_bytes, 1, MPI_UINT64_T, part_bytes.data(), 1, MPI_UINT64_T, comm_);
+
+    std::vector<CheckpointPart> parts(num_ranks);
+    uint64_t offset = sizeof(CheckpointFileHeader) + num_ranks * sizeof(CheckpointPart);
+    for (int r = 0; r < num_ranks; r++) {
+        parts[r].offset = offset;
+        parts[r].bytes  = part_bytes[r];
+        offset += part_bytes[r];
+    }
+
+    MPI_File fh;
+    if (MPI_File_open(comm_, file_name_.c_str(), MPI_MODE_CREATE | MPI_MODE_WRONLY, MPI_INFO_NULL, &fh) != MPI_SUCCESS) {
+        if (file_ != nullptr) {
+            std::fclose(file_);
+            file_ = nullptr;
+        }
+        std::remove(stage_name_.c_str());
+        throw std::runtime_error("CheckpointWriter could not open " + file_name_);
+    }
+    MPI_File_set_size(fh, static_cast<MPI_Offset>(offset));
+
+    // errors are collected so every rank takes part in every collective call
+    if (rank == 0) {
+        CheckpointFileHeader header = {{'M', 'A', 'T', 'A', 'R', 'C', 'K', 'P'}, 1, static_cast<uint32_t>(num_ranks)};
+        failed |= MPI_File_write_at(fh, 0, &header, sizeof(header), MPI_BYTE, MPI_STATUS_IGNORE) != MPI_SUCCESS;
+        failed |= MPI_File_write_at(fh, sizeof(header), parts.data(), static_cast<int>(num_ranks * sizeof(CheckpointPart)),
+                                    MPI_BYTE, MPI_STATUS_IGNORE) != MPI_SUCCESS;
+    }
+
+    // copy the staged part over with collective writes, one piece at a time
+    const uint64_t piece = uint64_t(64) << 20;
+    uint64_t my_rounds = (my_bytes + piece - 1) / piece;
+    uint64_t rounds    = 0;
+    MPI_Allreduce(&my_rounds, &rounds, 1, MPI_UINT64_T, MPI_MAX, comm_);
+
+    std::vector<char> buffer(my_bytes < piece ? my_bytes : piece);
+    if (!failed) {
+        failed = std::fflush(file_) != 0 || std::fseek(file_, 0, SEEK_SET) != 0;
+    }
+    for (uint64_t round = 0; round < rounds; round++) {
+        const uint64_t begin = round * piece;
+        uint64_t count = begin < my_bytes ? (my_bytes - begin < piece ? my_bytes - begin : piece) : 0;
+        if (count > 0 && (failed || std::fread(buffer.data(), 1, count, file_) != count)) {
+            failed = 1;
+            count  = 0;
+        }
+        failed |= MPI_File_write_at_all(fh, static_cast<MPI_Offset>(parts[rank].offset + begin),
+                                        buffer.data(), static_cast<int>(count),
+                                        MPI_BYTE, MPI_STATUS_IGNORE) != MPI_SUCCESS;
+    }
+    failed |= MPI_File_close(&fh) != MPI_SUCCESS;
+
+    if (file_ != nullptr) {
+        failed |= std::fclose(file_) != 0;
+        file_ = nullptr;
+    }
+    std::remove(stage_name_.c_str());
+
+    int any_failed = 0;
+    MPI_Allreduce(&failed, &any_failed, 1, MPI_INT, MPI_MAX, comm_);
+    if (any_failed) {
+        throw std::runtime_error("CheckpointWriter failed to write " + file_name_);
+    }
+#endif
+}
+
+inline CheckpointWriter::~CheckpointWriter()
+{
+    // a destructor can not throw, call close() to see write errors
+    try {
+        close();
+    }
+    catch (const std::runtime_error&) {
+    }
+}
+
+
+// -----------------------------------------
+// CheckpointReader
+// -----------------------------------------
+class CheckpointReader {
+
+private:
+    struct Record {
+        CheckpointRecordHeader header;
+        std::vector<const char*> sections;  // section headers in the mapped file
+    };
+
+    const char* data_ = nullptr;
+    size_t bytes_ = 0;
+    bool mapped_ = false;
+    std::vector<char> storage_;  // the file when mmap is not available
+    std::map<std::string, Record> records_;
+
+    const Record& find_(const std::string& name, CheckpointKind kind, uint8_t dtype_code, size_t elem_bytes) const;
+
+    // throw unless section s of a record holds count entries of elem_bytes
+    void check_section_(const Record& record, size_t s, size_t count, size_t elem_bytes) const;
+
+    // decompress section s of a record into dest
+    void read_section_(const Record& record, size_t s, void* dest, size_t count, size_t elem_bytes) const;
+
+    // read the start index section, the first value is 0 and they never decrease
+    void read_starts_(const Record& record, size_t* starts, size_t count) const;
+
+    // read the dim + 1 starts and the row or column indices, below bound,
+    // of a CSR or CSC record
+    void read_sparse_index_(const Record& record, std::vector<size_t>& starts, std::vector<size_t>& index,
+                            size_t dim, size_t bound, size_t value_bytes) const;
+
+    template <typename T>
+    const Record& read_dense_dims_(const std::string& name, CheckpointKind kind, size_t order, const size_t* dims, size_t size) const;
+
+public:
+    // open the part written by rank part, 0 for files written per rank
+    CheckpointReader(const std::string& file_name, size_t part = 0);
+
+    CheckpointReader(const CheckpointReader&) = delete;
+    CheckpointReader& operator=(const CheckpointReader&) = delete;
+
+    bool has(const std::string& name) const;
+
+    std::vector<std::string> names() const;
+
+    // empty containers are allocated, otherwise the dims must match
+    template <typename T>
+    void read(const std::string& name, CArray<T>& a) const;
+
+    template <typename T>
+    void read(const std::string& name, FArray<T>& a) const;
+
+    // the ragged and sparse types are rebuilt from the file
+    template <typename T>
+    void read(const std::string& name, RaggedRightArray<T>& a) const;
+
+    template <typename T>
+    void read(const std::string& name, RaggedDownArray<T>& a) const;
+
+    template <typename T>
+    void read(const std::string& name, CSRArray<T>& a) const;
+
+    template <typename T>
+    void read(const std::string& name, CSCArray<T>& a) const;
+
+#ifdef HAVE_KOKKOS
+    template <typename T, typename Layout, typename ExecSpace, typename MemoryTraits>
+    void read(const std::string& name, CArrayKokkos<T, Layout, ExecSpace, MemoryTraits>& a) const;
+
+    template <typename T, typename Layout, typename ExecSpace, typename MemoryTraits>
+    void read(const std::string& name, FArrayKokkos<T, Layout, ExecSpace, MemoryTraits>& a) const;
+
+    // the dual types are read on the host and copied to the device
+    template <typename T, typename Layout, typename ExecSpace, typename MemoryTraits>
+    void read(const std::string& name, DCArrayKokkos<T, Layout, ExecSpace, MemoryTraits>& a) const;
+
+    template <typename T, typename Layout, typename ExecSpace, typename MemoryTraits>
+    void read(const std::string& name, DFArrayKokkos<T, Layout, ExecSpace, MemoryTraits>& a) const;
+
+    template <typename T, typename Layout, typename ExecSpace, typename MemoryTraits, typename ILayout>
+    void read(const std::string& name, RaggedRightArrayKokkos<T, Layout, ExecSpace, MemoryTraits, ILayout>& a) const;
+
+    template <typename T, typename Layout, typename ExecSpace, typename MemoryTraits, typename ILayout>
+    void read(const std::string& name, RaggedDownArrayKokkos<T, Layout, ExecSpace, MemoryTraits, ILayout>& a) const;
+
+    template <typename T, typename Layout, typename ExecSpace, typename MemoryTraits, typename ILayout>
+    void read(const std::string& name, DRaggedRightArrayKokkos<T, Layout, ExecSpace, MemoryTraits, ILayout>& a) const;
+
+    template <typename T, typename Layout, typename ExecSpace, typename MemoryTraits>
+    void read(const std::string& name, CSRArrayKokkos<T, Layout, ExecSpace, MemoryTraits>& a) const;
+
+    template <typename T, typename Layout, typename ExecSpace, typename MemoryTraits>
+    void read(const std::string& name, CSCArrayKokkos<T, Layout, ExecSpace, MemoryTraits>& a) const;
+#endif
+
+    ~CheckpointReader();
+}; // End of CheckpointReader
+
+inline CheckpointReader::CheckpointReader(const std::string& file_name, size_t part)
+{
+    MATAR_PROFILE_SCOPE("CheckpointReader::open", ProfileCategory::transfer);
+
+#ifdef MATAR_HAVE_MMAP
+    int fd = ::open(file_name.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw std::runtime_error("CheckpointReader could not open " + file_name);
+    }
+    struct stat info;
+    fstat(fd, &info);
+    bytes_ = static_cast<size_t>(info.st_size);
+    if (bytes_ > 0) {
+        void* map = mmap(nullptr, bytes_, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (map == MAP_FAILED) {
+            ::close(fd);
+            throw std::runtime_error("CheckpointReader could not map " + file_name);
+        }
+        madvise(map, bytes_, MADV_WILLNEED);  // start reading the whole file ahead
+        data_   = static_cast<const char*>(map);
+        mapped_ = true;
+    }
+    ::close(fd);
+#else
+    std::FILE* file = std::fopen(file_name.c_str(), "rb");
+    if (file == nullptr) {
+        throw std::runtime_error("CheckpointReader could not open " + file_name);
+    }
+    std::fseek(file, 0, SEEK_END);
+    bytes_ = static_cast<size_t>(std::ftell(file));
+    std::fseek(file, 0, SEEK_SET);
+    storage_.resize(bytes_);
+    bytes_ = std::fread(storage_.data(), 1, bytes_, file);
+    std::fclose(file);
+    data_ = storage_.data();
+#endif
+
+    CheckpointFileHeader header;
+    if (bytes_ < sizeof(header)) {
+        throw std::runtime_error(file_name + " is not a MATAR checkpoint");
+    }
+    std::memcpy(&header, data_, sizeof(header));
+    if (std::memcmp(header.magic, "MATARCKP", 8) != 0 || header.version != 1) {
+        throw std::runtime_error(file_name + " is not a MATAR checkpoint");
+    }
+    if (part >= header.num_parts || sizeof(header) + header.num_parts * sizeof(CheckpointPart) > bytes_) {
+        throw std::runtime_error(file_name + " has no part " + std::to_string(part));
+    }
+
+    CheckpointPart location;
+    std::memcpy(&location, data_ + sizeof(header) + part * sizeof(CheckpointPart), sizeof(location));
+    if (location.offset > bytes_ || location.bytes > bytes_ - location.offset) {
+        throw std::runtime_error(file_name + " is truncated");
+    }
+
+    // index the records and their sections, every size is checked against
+    // the end of its record so a truncated or corrupt file throws here
+    const std::string corrupt = file_name + " has a corrupt record";
+    const uint64_t end = location.offset + location.bytes;
+    uint64_t pos = location.offset;
+    while (pos < end) {
+        Record record;
+        const CheckpointRecordHeader& info = record.header;
+        if (end - pos < sizeof(info)) {
+            throw std::runtime_error(corrupt);
+        }
+        std::memcpy(&record.header, data_ + pos, sizeof(info));
+
+        const uint64_t name_end = sizeof(info) + info.name_length;
+        if (std::memcmp(info.magic, "MREC", 4) != 0 || info.record_bytes < name_end ||
+            info.record_bytes > end - pos || info.order > 7 || info.num_sections == 0 ||
+            info.kind > static_cast<uint32_t>(CheckpointKind::csc)) {
+            throw std::runtime_error(corrupt);
+        }
+        const uint64_t record_end = pos + info.record_bytes;
+        std::string name(data_ + pos + sizeof(info), info.name_length);
+
+        uint64_t section = pos + name_end;
+        for (size_t s = 0; s < info.num_sections; s++) {
+            CheckpointSectionHeader section_info;
+            if (record_end - section < sizeof(section_info)) {
+                throw std::runtime_error(corrupt);
+            }
+            std::memcpy(&section_info, data_ + section, sizeof(section_info));
+            if (section_info.elem_bytes == 0 || section_info.count > UINT64_MAX / section_info.elem_bytes) {
+                throw std::runtime_error(corrupt);
+            }
+            record.sections.push_back(data_ + section);
+            section += sizeof(section_info);
+
+            uint64_t raw_bytes = 0;
+            for (size_t c = 0; c < section_info.num_chunks; c++) {
+                CheckpointChunkHeader chunk;
+                if (record_end - section < sizeof(chunk)) {
+                    throw std::runtime_error(corrupt);
+                }
+                std::memcpy(&chunk, data_ + section, sizeof(chunk));
+                section += sizeof(chunk);
+                if (chunk.stored_bytes > chunk.raw_bytes || chunk.stored_bytes > record_end - section) {
+                    throw std::runtime_error(corrupt);
+                }
+                section   += chunk.stored_bytes;
+                raw_bytes += chunk.raw_bytes;
+            }
+            if (raw_bytes != section_info.count * section_info.elem_bytes) {
+                throw std::runtime_error(corrupt);
+            }
+        }
+
+        records_[name] = record;
+        pos = record_end;
+    }
+}
+
+inline bool CheckpointReader::has(const std::string& name) const
+{
+    return records_.find(name) != records_.end();
+}
+
+inline std::vector<std::string> CheckpointReader::names() const
+{
+    std::vector<std::string> list;
+    for (const auto& record : records_) {
+        list.push_back(record.first);
+    }
+    return list;
+}
+
+inline const CheckpointReader::Record& CheckpointReader::find_(const std::string& name, CheckpointKind kind,
+                                                               uint8_t dtype_code, size_t elem_bytes) const
+{
+    auto found = records_.find(name);
+    if (found == records_.end()) {
+        throw std::runtime_error("checkpoint has no record " + name);
+    }
+    const Record& record = found->second;
+    if (record.header.kind != static_cast<uint32_t>(kind)) {
+        throw std::runtime_error("checkpoint record " + name + " is a different container type");
+    }
+
+    // the values are the last section
+    CheckpointSectionHeader values;
+    std::memcpy(&values, record.sections.back(), sizeof(values));
+    if (record.header.dtype_code != dtype_code || values.elem_bytes != elem_bytes) {
+        throw std::runtime_error("checkpoint record " + name + " has a different value type");
+    }
+    return record;
+}
+
+inline void CheckpointReader::check_section_(const Record& record, size_t s, size_t count, size_t elem_bytes) const
+{
+    if (s >= record.sections.size()) {
+        throw std::runtime_error("checkpoint record has too few sections");
+    }
+    CheckpointSectionHeader section;
+    std::memcpy(&section, record.sections[s], sizeof(section));
+    if (section.count != count || section.elem_bytes != elem_bytes) {
+        throw std::runtime_error("checkpoint section does not match the container");
+    }
+}
+
+inline void CheckpointReader::read_section_(const Record& record, size_t s, void* dest, size_t count, size_t elem_bytes) const
+{
+    check_section_(record, s, count, elem_bytes);
+    CheckpointSectionHeader section;
+    std::memcpy(&section, record.sections[s], sizeof(section));
+
+    // find the chunks, then decompress them in parallel
+    std::vector<const char*> chunks(section.num_chunks);
+    std::vector<uint64_t> offsets(section.num_chunks);
+    const char* pos = record.sections[s] + sizeof(section);
+    uint64_t offset = 0;
+    for (size_t c = 0; c < section.num_chunks; c++) {
+        CheckpointChunkHeader chunk;
+        std::memcpy(&chunk, pos, sizeof(chunk));
+        chunks[c]  = pos;
+        offsets[c] = offset;
+        offset += chunk.raw_bytes;
+        pos    += sizeof(chunk) + chunk.stored_bytes;
+    }
+    if (offset != count * elem_bytes) {
+        throw std::runtime_error("checkpoint section is corrupt");
+    }
+
+    char* out = static_cast<char*>(dest);
+    bool corrupt = false;
+#ifdef _OPENMP
+    #pragma omp parallel for schedule(dynamic) reduction(||:corrupt)
+#endif
+    for (long long c = 0; c < (long long)chunks.size(); c++) {
+        CheckpointChunkHeader chunk;
+        std::memcpy(&chunk, chunks[c], sizeof(chunk));
+        const char* bytes = chunks[c] + sizeof(chunk);
+        if (chunk.stored_bytes == chunk.raw_bytes) {
+            std::memcpy(out + offsets[c], bytes, chunk.raw_bytes);
+        }
+        else if (!lz4_decompress_block(bytes, chunk.stored_bytes, out + offsets[c], chunk.raw_bytes)) {
+            corrupt = true;
+        }
+    }
+    if (corrupt) {
+        throw std::runtime_error("checkpoint chunk is corrupt");
+    }
+}
+
+inline void CheckpointReader::read_sparse_index_(const Record& record, std::vector<size_t>& starts,
+                                                 std::vector<size_t>& index, size_t dim, size_t bound,
+                                                 size_t value_bytes) const
+{
+    check_section_(record, 0, dim + 1, sizeof(size_t));
+    starts.resize(dim + 1);
+    read_starts_(record, starts.data(), dim + 1);
+
+    const size_t nnz = starts[dim];
+    check_section_(record, 1, nnz, sizeof(size_t));
+    check_section_(record, 2, nnz, value_bytes);
+    index.resize(nnz);
+    read_section_(record, 1, index.data(), nnz, sizeof(size_t));
+    for (size_t k = 0; k < nnz; k++) {
+        if (index[k] >= bound) {
+            throw std::runtime_error("checkpoint sparse indices are corrupt");
+        }
+    }
+}
+
+inline void CheckpointReader::read_starts_(const Record& record, size_t* starts, size_t count) const
+{
+    if (count == 0) {
+        throw std::runtime_error("checkpoint start indices are corrupt");
+    }
+    read_section_(record, 0, starts, count, sizeof(size_t));
+    if (starts[0] != 0) {
+        throw std::runtime_error("checkpoint start indices are corrupt");
+    }
+    for (size_t i = 1; i < count; i++) {
+        if (starts[i] < starts[i - 1]) {
+            throw std::runtime_error("checkpoint start indices are corrupt");
+        }
+    }
+}
+
+template <typename T>
+const CheckpointReader::Record& CheckpointReader::read_dense_dims_(const std::string& name, CheckpointKind kind,
+                                                                  size_t order, const size_t* dims, size_t size) const
+{
+    const Record& record = find_(name, kind, static_cast<uint8_t>(interop_data_kind<T>()), sizeof(T));
+
+    // the dims must describe the values before they are used to allocate
+    if (record.header.order == 0) {
+        throw std::runtime_error("checkpoint record " + name + " has corrupt dims");
+    }
+    size_t count = 1;
+    for (size_t d = 0; d < record.header.order; d++) {
+        const uint64_t dim = record.header.dims[d];
+        if (dim != 0 && count > SIZE_MAX / dim) {
+            throw std::runtime_error("checkpoint record " + name + " has corrupt dims");
+        }
+        count *= dim;
+    }
+    check_section_(record, 0, count, sizeof(T));
+
+    if (size > 0) {
+        bool match = record.header.order == order;
+        for (size_t d = 0; match && d < order; d++) {
+            match = record.header.dims[d] == dims[d];
+        }
+        if (!match) {
+            throw std::runtime_error("checkpoint record " + name + " has different dims");
+        }
+    }
+    return record;
+}
+
+template <typename T>
+void CheckpointReader::read(const std::string& name, CArray<T>& a) const
+{
+    MATAR_PROFILE_SCOPE("CheckpointReader::read", ProfileCategory::transfer);
+    size_t dims[7];
+    for (size_t d = 0; d < a.order(); d++) {
+        dims[d] = a.dims(d);
+    }
+    const Record& record = read_dense_dims_<T>(name, CheckpointKind::dense_c, a.order(), dims, a.size());
+    if (a.size() == 0) {
+        a = checkpoint_make_dense<CArray<T>>(record.header.dims, record.header.order);
+    }
+    read_section_(record, 0, a.pointer(), a.size(), sizeof(T));
+}
+
+template <typename T>
+void CheckpointReader::read(const std::string& name, FArray<T>& a) const
+{
+    MATAR_PROFILE_SCOPE("CheckpointReader::read", ProfileCategory::transfer);
+    size_t dims[7];
+    for (size_t d = 0; d < a.order(); d++) {
+        dims[d] = a.dims(d);
+    }
+    const Record& record = read_dense_dims_<T>(name, CheckpointKind::dense_f, a.order(), dims, a.size());
+    if (a.size() == 0) {
+        a = checkpoint_make_dense<FArray<T>>(record.header.dims, record.header.order);
+    }
+    read_section_(record, 0, a.pointer(), a.size(), sizeof(T));
+}
+
+template <typename T>
+void CheckpointReader::read(const std::string& name, RaggedRightArray<T>& a) const
+{
+    MATAR_PROFILE_SCOPE("CheckpointReader::read", ProfileCategory::transfer);
+    const Record& record = find_(name, CheckpointKind::ragged_right, static_cast<uint8_t>(interop_data_kind<T>()), sizeof(T));
+    if (record.header.order != 1) {
+        throw std::runtime_error("checkpoint record " + name + " is a different container type");
+    }
+    const size_t dim1 = record.header.dims[0];
+    check_section_(record, 0, dim1 + 1, sizeof(size_t));
+
+    std::vector<size_t> starts(dim1 + 1);
+    read_starts_(record, starts.data(), dim1 + 1);
+    check_section_(record, 1, starts[dim1], sizeof(T));
+
+    CArray<size_t> strides(dim1 > 0 ? dim1 : 1);
+    for (size_t i = 0; i < dim1; i++) {
+        strides(i) = starts[i + 1] - starts[i];
+    }
+    a = RaggedRightArray<T>(strides.pointer(), dim1);
+    read_section_(record, 1, a.pointer(), starts[dim1], sizeof(T));
+}
+
+template <typename T>
+void CheckpointReader::read(const std::string& name, RaggedDownArray<T>& a) const
+{
+    MATAR_PROFILE_SCOPE("CheckpointReader::read", ProfileCategory::transfer);
+    const Record& record = find_(name, CheckpointKind::ragged_down, static_cast<uint8_t>(interop_data_kind<T>()), sizeof(T));
+    const size_t dim2 = record.header.dims[0];
+    check_section_(record, 0, dim2 + 1, sizeof(size_t));
+
+    std::vector<size_t> starts(dim2 + 1);
+    read_starts_(record, starts.data(), dim2 + 1);
+    check_section_(record, 1, starts[dim2], sizeof(T));
+
+    CArray<size_t> strides(dim2 > 0 ? dim2 : 1);
+    for (size_t j = 0; j < dim2; j++) {
+        strides(j) = starts[j + 1] - starts[j];
+    }
+    a = RaggedDownArray<T>(strides.pointer(), dim2);
+    read_section_(record, 1, a.pointer(), starts[dim2], sizeof(T));
+}
+
+template <typename T>
+void CheckpointReader::read(const std::string& name, CSRArray<T>& a) const
+{
+    MATAR_PROFILE_SCOPE("CheckpointReader::read", ProfileCategory::transfer);
+    const Record& record = find_(name, CheckpointKind::csr, static_cast<uint8_t>(interop_data_kind<T>()), sizeof(T));
+    const size_t dim1 = record.header.dims[0];
+    const size_t dim2 = record.header.dims[1];
+
+    std::vector<size_t> start_list, column_list;
+    read_sparse_index_(record, start_list, column_list, dim1, dim2, sizeof(T));
+    const size_t nnz = column_list.size();
+
+    CArray<size_t> starts(dim1 + 1);
+    CArray<size_t> columns(nnz);
+    CArray<T> values(nnz);
+    std::copy(start_list.begin(), start_list.end(), starts.pointer());
+    std::copy(column_list.begin(), column_list.end(), columns.pointer());
+    read_section_(record, 2, values.pointer(), nnz, sizeof(T));
+    a = CSRArray<T>(values, columns, starts, dim1, dim2);
+}
+
+template <typename T>
+void CheckpointReader::read(const std::string& name, CSCArray<T>& a) const
+{
+    MATAR_PROFILE_SCOPE("CheckpointReader::read", ProfileCategory::transfer);
+    const Record& record = find_(name, CheckpointKind::csc, static_cast<uint8_t>(interop_data_kind<T>()), sizeof(T));
+    const size_t dim1 = record.header.dims[0];
+    const size_t dim2 = record.header.dims[1];
+
+    std::vector<size_t> start_list, row_list;
+    read_sparse_index_(record, start_list, row_list, dim2, dim1, sizeof(T));
+    const size_t nnz = row_list.size();
+
+    CArray<size_t> starts(dim2 + 1);
+    CArray<size_t> rows(nnz);
+    CArray<T> values(nnz);
+    std::copy(start_list.begin(), start_list.end(), starts.pointer());
+    std::copy(row_list.begin(), row_list.end(), rows.pointer());
+    read_section_(record, 2, values.pointer(), nnz, sizeof(T));
+    a = CSCArray<T>(values, rows, starts, dim1, dim2);
+}
+
+#ifdef HAVE_KOKKOS
+template <typename T, typename Layout, typename ExecSpace, typename MemoryTraits>
+void CheckpointReader::read(const std::string& name, CArrayKokkos<T, Layout, ExecSpace, MemoryTraits>& a) const
+{
+    MATAR_PROFILE_SCOPE("CheckpointReader::read", ProfileCategory::transfer);
+    size_t dims[7];
+    for (size_t d = 0; d < a.order(); d++) {
+        dims[d] = a.dims(d);
+    }
+    const Record& record = read_dense_dims_<T>(name, CheckpointKind::dense_c, a.order(), dims, a.size());
+    if (a.size() == 0) {
+        a = checkpoint_make_dense<CArrayKokkos<T, Layout, ExecSpace, MemoryTraits>>(record.header.dims, record.header.order, name);
+    }
+    auto host = Kokkos::create_mirror_view(a.get_kokkos_view());
+    read_section_(record, 0, host.data(), a.size(), sizeof(T));
+    Kokkos::deep_copy(a.get_kokkos_view(), host);
+}
+
+template <typename T, typename Layout, typename ExecSpace, typename MemoryTraits>
+void CheckpointReader::read(const std::string& name, FArrayKokkos<T, Layout, ExecSpace, MemoryTraits>& a) const
+{
+    MATAR_PROFILE_SCOPE("CheckpointReader::read", ProfileCategory::transfer);
+    size_t dims[7];
+    for (size_t d = 0; d < a.order(); d++) {
+        dims[d] = a.dims(d);
+    }
+    const Record& record = read_dense_dims_<T>(name, CheckpointKind::dense_f, a.order(), dims, a.size());
+    if (a.size() == 0) {
+        a = checkpoint_make_dense<FArrayKokkos<T, Layout, ExecSpace, MemoryTraits>>(record.header.dims, record.header.order, name);
+    }
+    auto host = Kokkos::create_mirror_view(a.get_kokkos_view());
+    read_section_(record, 0, host.data(), a.size(), sizeof(T));
+    Kokkos::deep_copy(a.get_kokkos_view(), host);
+}
+
+template <typename T, typename Layout, typename ExecSpace, typename MemoryTraits>
+void CheckpointReader::read(const std::string& name, DCArrayKokkos<T, Layout, ExecSpace, MemoryTraits>& a) const
+{
+    MATAR_PROFILE_SCOPE("CheckpointReader::read", ProfileCategory::transfer);
+    size_t dims[7];
+    for (size_t d = 0; d < a.order(); d++) {
+        dims[d] = a.dims(d);
+    }
+    const Record& record = read_dense_dims_<T>(name, CheckpointKind::dense_c, a.order(), dims, a.size());
+    if (a.size() == 0) {
+        a = checkpoint_make_dense<DCArrayKokkos<T, Layout, ExecSpace, MemoryTraits>>(record.header.dims, record.header.order, name);
+    }
+    read_section_(record, 0, a.host_pointer(), a.size(), sizeof(T));
+    a.update_device();
+}
+
+template <typename T, typename Layout, typename ExecSpace, typename MemoryTraits>
+void CheckpointReader::read(const std::string& name, DFArrayKokkos<T, Layout, ExecSpace, MemoryTraits>& a) const
+{
+    MATAR_PROFILE_SCOPE("CheckpointReader::read", ProfileCategory::transfer);
+    size_t dims[7];
+    for (size_t d = 0; d < a.order(); d++) {
+        dims[d] = a.dims(d);
+    }
+    const Record& record = read_dense_dims_<T>(name, CheckpointKind::dense_f, a.order(), dims, a.size());
+    if (a.size() == 0) {
+        a = checkpoint_make_dense<DFArrayKokkos<T, Layout, ExecSpace, MemoryTraits>>(record.header.dims, record.header.order, name);
+    }
+    read_section_(record, 0, a.host_pointer(), a.size(), sizeof(T));
+    a.update_device();
+}
+
+template <typename T, typename Layout, typename ExecSpace, typename MemoryTraits, typename ILayout>
+void CheckpointReader::read(const std::string& name, RaggedRightArrayKokkos<T, Layout, ExecSpace, MemoryTraits, ILayout>& a) const
+{
+    MATAR_PROFILE_SCOPE("CheckpointReader::read", ProfileCategory::transfer);
+    const Record& record = find_(name, CheckpointKind::ragged_right, static_cast<uint8_t>(interop_data_kind<T>()), sizeof(T));
+    if (record.header.order != 1) {
+        throw std::runtime_error("checkpoint record " + name + " is a different container type");
+    }
+    const size_t dim1 = record.header.dims[0];
+    check_section_(record, 0, dim1 + 1, sizeof(size_t));
+
+    std::vector<size_t> starts(dim1 + 1);
+    read_starts_(record, starts.data(), dim1 + 1);
+    check_section_(record, 1, starts[dim1], sizeof(T));
+
+    CArrayKokkos<size_t, ILayout, ExecSpace, MemoryTraits> strides(dim1, name + "_strides");
+    auto strides_host = Kokkos::create_mirror_view(strides.get_kokkos_view());
+    for (size_t i = 0; i < dim1; i++) {
+        strides_host(i) = starts[i + 1] - starts[i];
+    }
+    Kokkos::deep_copy(strides.get_kokkos_view(), strides_host);
+    a = RaggedRightArrayKokkos<T, Layout, ExecSpace, MemoryTraits, ILayout>(strides, name);
+
+    auto values = Kokkos::create_mirror_view(a.get_kokkos_view());
+    read_section_(record, 1, values.data(), starts[dim1], sizeof(T));
+    Kokkos::deep_copy(a.get_kokkos_view(), values);
+}
+
+template <typename T, typename Layout, typename ExecSpace, typename MemoryTraits, typename ILayout>
+void CheckpointReader::read(const std::string& name, RaggedDownArrayKokkos<T, Layout, ExecSpace, MemoryTraits, ILayout>& a) const
+{
+    MATAR_PROFILE_SCOPE("CheckpointReader::read", ProfileCategory::transfer);
+    const Record& record = find_(name, CheckpointKind::ragged_down, static_cast<uint8_t>(interop_data_kind<T>()), sizeof(T));
+    const size_t dim2 = record.header.dims[0];
+    check_section_(record, 0, dim2 + 1, sizeof(size_t));
+
+    std::vector<size_t> starts(dim2 + 1);
+    read_starts_(record, starts.data(), dim2 + 1);
+    check_section_(record, 1, starts[dim2], sizeof(T));
+
+    CArrayKokkos<size_t, Layout, ExecSpace, MemoryTraits> strides(dim2, name + "_strides");
+    auto strides_host = Kokkos::create_mirror_view(strides.get_kokkos_view());
+    for (size_t j = 0; j < dim2; j++) {
+        strides_host(j) = starts[j + 1] - starts[j];
+    }
+    Kokkos::deep_copy(strides.get_kokkos_view(), strides_host);
+    a = RaggedDownArrayKokkos<T, Layout, ExecSpace, MemoryTraits, ILayout>(strides, name);
+
+    auto values = Kokkos::create_mirror_view(a.get_kokkos_view());
+    read_section_(record, 1, values.data(), starts[dim2], sizeof(T));
+    Kokkos::deep_copy(a.get_kokkos_view(), values);
+}
+
+template <typename T, typename Layout, typename ExecSpace, typename MemoryTraits, typename ILayout>
+void CheckpointReader::read(const std::string& name, DRaggedRightArrayKokkos<T, Layout, ExecSpace, MemoryTraits, ILayout>& a) const
+{
+    MATAR_PROFILE_SCOPE("CheckpointReader::read", ProfileCategory::transfer);
+    const Record& record = find_(name, CheckpointKind::ragged_right, static_cast<uint8_t>(interop_data_kind<T>()), sizeof(T));
+    const size_t order = record.header.order;
+    if (order < 1 || order > 3) {
+        throw std::runtime_error("checkpoint record " + name + " is a different container type");
+    }
+    const size_t dim1 = record.header.dims[0];
+    const size_t dim2 = order > 1 ? record.header.dims[1] : 0;
+    const size_t dim3 = order > 2 ? record.header.dims[2] : 0;
+    const size_t block = (order > 1 ? dim2 : 1) * (order > 2 ? dim3 : 1);
+    if (block == 0) {
+        throw std::runtime_error("checkpoint record " + name + " has corrupt dims");
+    }
+    check_section_(record, 0, dim1 + 1, sizeof(size_t));
+
+    std::vector<size_t> starts(dim1 + 1);
+    read_starts_(record, starts.data(), dim1 + 1);
+    check_section_(record, 1, starts[dim1], sizeof(T));
+
+    // each row holds whole vector or tensor entries
+    std::vector<size_t> strides(dim1 > 0 ? dim1 : 1);
+    for (size_t i = 0; i < dim1; i++) {
+        const size_t entries = starts[i + 1] - starts[i];
+        if (entries % block != 0) {
+            throw std::runtime_error("checkpoint start indices are corrupt");
+        }
+        strides[i] = entries / block;
+    }
+
+    using Array = DRaggedRightArrayKokkos<T, Layout, ExecSpace, MemoryTraits, ILayout>;
+    switch (order) {
+        case 1:  a = Array(strides.data(), dim1, name); break;
+        case 2:  a = Array(strides.data(), dim1, dim2, name); break;
+        default: a = Array(strides.data(), dim1, dim2, dim3, name); break;
+    }
+    read_section_(record, 1, a.host_pointer(), starts[dim1], sizeof(T));
+    a.update_device();
+}
+
+template <typename T, typename Layout, typename ExecSpace, typename MemoryTraits>
+void CheckpointReader::read(const std::string& name, CSRArrayKokkos<T, Layout, ExecSpace, MemoryTraits>& a) const
+{
+    MATAR_PROFILE_SCOPE("CheckpointReader::read", ProfileCategory::transfer);
+    const Record& record = find_(name, CheckpointKind::csr, static_cast<uint8_t>(interop_data_kind<T>()), sizeof(T));
+    const size_t dim1 = record.header.dims[0];
+    const size_t dim2 = record.header.dims[1];
+
+    std::vector<size_t> start_list, column_list;
+    read_sparse_index_(record, start_list, column_list, dim1, dim2, sizeof(T));
+    const size_t nnz = column_list.size();
+
+    CArrayKokkos<size_t, Layout, ExecSpace, MemoryTraits> starts(dim1 + 1, name + "_starts");
+    CArrayKokkos<size_t, Layout, ExecSpace, MemoryTraits> columns(nnz, name + "_columns");
+    CArrayKokkos<T, Layout, ExecSpace, MemoryTraits> values(nnz, name);
+    std::vector<T> value_list(nnz);
+    read_section_(record, 2, value_list.data(), nnz, sizeof(T));
+    checkpoint_to_device<ExecSpace>(start_list.data(), starts.pointer(), dim1 + 1);
+    checkpoint_to_device<ExecSpace>(column_list.data(), columns.pointer(), nnz);
+    checkpoint_to_device<ExecSpace>(value_list.data(), values.pointer(), nnz);
+    a = CSRArrayKokkos<T, Layout, ExecSpace, MemoryTraits>(values, starts, columns, dim1, dim2, name);
+}
+
+template <typename T, typename Layout, typename ExecSpace, typename MemoryTraits>
+void CheckpointReader::read(const std::string& name, CSCArrayKokkos<T, Layout, ExecSpace, MemoryTraits>& a) const
+{
+    MATAR_PROFILE_SCOPE("CheckpointReader::read", ProfileCategory::transfer);
+    const Record& record = find_(name, CheckpointKind::csc, static_cast<uint8_t>(interop_data_kind<T>()), sizeof(T));
+    const size_t dim1 = record.header.dims[0];
+    const size_t dim2 = record.header.dims[1];
+
+    std::vector<size_t> start_list, row_list;
+    read_sparse_index_(record, start_list, row_list, dim2, dim1, sizeof(T));
+    const size_t nnz = row_list.size();
+
+    CArrayKokkos<size_t, Layout, ExecSpace, MemoryTraits> starts(dim2 + 1, name + "_starts");
+    CArrayKokkos<size_t, Layout, ExecSpace, MemoryTraits> rows(nnz, name + "_rows");
+    CArrayKokkos<T, Layout, ExecSpace, MemoryTraits> values(nnz, name);
+    std::vector<T> value_list(nnz);
+    read_section_(record, 2, value_list.data(), nnz, sizeof(T));
+    checkpoint_to_device<ExecSpace>(start_list.data(), starts.pointer(), dim2 + 1);
+    checkpoint_to_device<ExecSpace>(row_list.data(), rows.pointer(), nnz);
+    checkpoint_to_device<ExecSpace>(value_list.data(), values.pointer(), nnz);
+    a = CSCArrayKokkos<T, Layout, ExecSpace, MemoryTraits>(values, starts, rows, dim1, dim2, name);
+}
+#endif
+
+inline CheckpointReader::~CheckpointReader()
+{
+#ifdef MATAR_HAVE_MMAP
+    if (mapped_) {
+        munmap(const_cast<char*>(data_), bytes_);
+    }
+#endif
+}
+
+} // end namespace
+
+#endif // CHECKPOINT_H
@@ -0,0 +1,250 @@
+#ifndef CONVERGENCE_H
+#define CONVERGENCE_H
+/**********************************************************************************************
+ © 2020. Triad National Security, LLC. All rights reserved.
+ This program was produced under U.S. Government contract 89233218CNA000001 for Los Alamos
+ National Laboratory (LANL), which is operated by Triad National Security, LLC for the U.S.
+ Department of Energy/National Nuclear Security Administration. All rights in the program are
+ reserved by Triad National Security, LLC, and the U.S. Department of Energy/National Nuclear
+ Security Administration. The Government is granted for itself and others acting on its behalf a
+ nonexclusive, paid-up, irrevocable worldwide license in this material to reproduce, prepare
+ derivative works, distribute copies to the public, perform publicly and display publicly, and
+ to permit others to do so.
+ This program is open source under the BSD-3 License.
+ Redistribution and use in source and binary forms, with or without modification, are permitted
+ provided that the following conditions are met:
+ 
+ 1.  Redistributions of source code must retain the above copyright notice, this list of
+ conditions and the following disclaimer.
+ 
+ 2.  Redistributions in binary form must reproduce the above copyright notice, this list of
+ conditions and the following disclaimer in the documentation and/or other materials
+ provided with the distribution.
+ 
+ 3.  Neither the name of the copyright holder nor the names of its contributors may be used
+ to endorse or promote products derived from this software without specific prior
+ written permission.
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+ IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **********************************************************************************************/
+
+#include <string>
+
+#include "kokkos_types.h"
+#include "profile.h"
+
+#ifdef HAVE_MPI
+#include <mpi.h>
+#endif
+
+
+// -----------------------------------------
+// Convergence checks that do not stall every iteration
+//
+//   ConvergenceMonitor monitor(tolerance, 10, MPI_COMM_WORLD);   // check every 10th
+//
+//   for (size_t iter = 0; iter < max_iter && !monitor.converged(); iter++) {
+//       monitor.step(iter, policy2D({1, 1}, {n + 1, m + 1}),
+//                    KOKKOS_LAMBDA(const int i, const int j, double& residual) {
+//           u_new(i, j) = 0.25*(u(i + 1, j) + u(i - 1, j) + u(i, j + 1) + u(i, j - 1));
+//           residual = fmax(residual, fabs(u_new(i, j) - u(i, j)));
+//       });
+//       ...
+//   }
+//   monitor.finish();
+//
+// step() runs the update as a max reduction on the check iterations and as a
+// plain parallel_for, with the residual thrown away, on the others, so the
+// residual is computed in the same pass as the update. Kernels that reduce on
+// their own can call due() and submit() instead.
+//
+// With MPI the global max is an MPI_Iallreduce. It is completed only when the
+// next check is submitted or in finish(), points every rank reaches together,
+// so it runs behind the iterations in between and every rank learns about
+// convergence at the same check, one check late. converged() never completes
+// it, since MPI_Test can finish on one rank before another and let the ranks
+// leave the loop at different iterations.
+// -----------------------------------------
+
+namespace mtr
+{
+
+#ifdef HAVE_KOKKOS
+
+/////////////////////////
+// ConvergenceMonitor:  max norm residual checked every interval iterations
+/////////////////////////
+class ConvergenceMonitor {
+
+private:
+    double tolerance_;
+    size_t interval_;
+    double residual_;        // last global residual
+    size_t checks_;          // completed checks
+    bool   converged_;
+
+#ifdef HAVE_MPI
+    MPI_Comm    comm_;
+    MPI_Request request_;
+    double      local_;      // buffers of the reduction in flight
+    double      global_;
+#endif
+
+    void record(double residual);
+
+    // the discarded residual lets one update functor serve both loops
+    template <typename Update>
+    struct DiscardResidual {
+        Update fcn_;
+
+        template <typename... Indices>
+        KOKKOS_INLINE_FUNCTION
+        void operator()(const Indices... idx) const {
+            double residual = 0.0;
+            fcn_(idx..., residual);
+        }
+    };
+
+public:
+    ConvergenceMonitor(double tolerance, size_t interval = 1);
+
+#ifdef HAVE_MPI
+    ConvergenceMonitor(double tolerance, size_t interval, MPI_Comm comm);
+#endif
+
+    // a reduction may be in flight
+    ConvergenceMonitor(const ConvergenceMonitor&) = delete;
+    ConvergenceMonitor& operator=(const ConvergenceMonitor&) = delete;
+
+    ~ConvergenceMonitor();
+
+    // true on the iterations whose residual is checked
+    bool due(size_t iteration) const;
+
+    // hand in the local residual of a check iteration
+    void submit(double local_residual);
+
+    // run fcn(indices..., residual) over policy, reducing the residual only when due
+    template <typename Policy, typename Update>
+    void step(size_t iteration, const Policy& policy, const Update& fcn);
+
+    // true once a completed check is below the tolerance
+    bool converged() const;
+
+    // wait for the check in flight
+    void finish();
+
+    double residual() const;
+
+    size_t num_checks() const;
+
+}; // End of ConvergenceMonitor
+
+inline ConvergenceMonitor::ConvergenceMonitor(double tolerance, size_t interval)
+    : tolerance_(tolerance), interval_(interval > 0 ? interval : 1),
+      residual_(0.0), checks_(0), converged_(false)
+{
+#ifdef HAVE_MPI
+    comm_    = MPI_COMM_NULL;
+    request_ = MPI_REQUEST_NULL;
+    local_   = 0.0;
+    global_  = 0.0;
+#endif
+}
+
+#ifdef HAVE_MPI
+inline ConvergenceMonitor::ConvergenceMonitor(double tolerance, size_t interval, MPI_Comm comm)
+    : ConvergenceMonitor(tolerance, interval)
+{
+    comm_ = comm;
+}
+#endif
+
+inline ConvergenceMonitor::~ConvergenceMonitor()
+{
+    finish();
+}
+
+inline bool ConvergenceMonitor::due(size_t iteration) const
+{
+    return iteration % interval_ == 0;
+}
+
+inline void ConvergenceMonitor::record(double residual)
+{
+    residual_ = residual;
+    checks_++;
+    if (residual <= tolerance_) {
+        converged_ = true;
+    }
+}
+
+inline void ConvergenceMonitor::submit(double local_residual)
+{
+#ifdef HAVE_MPI
+    if (comm_ != MPI_COMM_NULL) {
+        MATAR_PROFILE_SCOPE("ConvergenceMonitor::submit", ProfileCategory::communication);
+        finish();
+        local_ = local_residual;
+        MPI_Iallreduce(&local_, &global_, 1, MPI_DOUBLE, MPI_MAX, comm_, &request_);
+        return;
+    }
+#endif
+    record(local_residual);
+}
+
+template <typename Policy, typename Update>
+void ConvergenceMonitor::step(size_t iteration, const Policy& policy, const Update& fcn)
+{
+    MATAR_PROFILE_SCOPE("ConvergenceMonitor::step", ProfileCategory::compute);
+    if (!due(iteration)) {
+        Kokkos::parallel_for("ConvergenceMonitor::update", policy, DiscardResidual<Update>{fcn});
+        return;
+    }
+
+    double local_residual = 0.0;
+    Kokkos::parallel_reduce("ConvergenceMonitor::update", policy, fcn, Kokkos::Max<double>(local_residual));
+    submit(local_residual);
+}
+
+inline bool ConvergenceMonitor::converged() const
+{
+    return converged_;
+}
+
+inline void ConvergenceMonitor::finish()
+{
+#ifdef HAVE_MPI
+    if (request_ != MPI_REQUEST_NULL) {
+        MPI_Wait(&request_, MPI_STATUS_IGNORE);
+        record(global_);
+    }
+#endif
+}
+
+inline double ConvergenceMonitor::residual() const
+{
+    return residual_;
+}
+
+inline size_t ConvergenceMonitor::num_checks() const
+{
+    return checks_;
+}
+
+// End of ConvergenceMonitor
+
+#endif // HAVE_KOKKOS
+
+} // end namespace
+
+#endif // CONVERGENCE_H
@@ -0,0 +1,502 @@
+#ifndef DISTRIBUTED_CSR_H
+#define DISTRIBUTED_CSR_H
+/**********************************************************************************************
+ © 2020. Triad National Security, LLC. All rights reserved.
+ This program was produced under U.S. Government contract 89233218CNA000001 for Los Alamos
+ National Laboratory (LANL), which is operated by Triad National Security, LLC for the U.S.
+ Department of Energy/National Nuclear Security Administration. All rights in the program are
+ reserved by Triad National Security, LLC, and the U.S. Department of Energy/National Nuclear
+ Security Administration. The Government is granted for itself and others acting on its behalf a
+ nonexclusive, paid-up, irrevocable worldwide license in this material to reproduce, prepare
+ derivative works, distribute copies to the public, perform publicly and display publicly, and
+ to permit others to do so.
+ This program is open source under the BSD-3 License.
+ Redistribution and use in source and binary forms, with or without modification, are permitted
+ provided that the following conditions are met:
+ 
+ 1.  Redistributions of source code must retain the above copyright notice, this list of
+ conditions and the following disclaimer.
+ 
+ 2.  Redistributions in binary form must reproduce the above copyright notice, this list of
+ conditions and the following disclaimer in the documentation and/or other materials
+ provided with the distribution.
+ 
+ 3.  Neither the name of the copyright holder nor the names of its contributors may be used
+ to endorse or promote products derived from this software without specific prior
+ written permission.
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+ IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **********************************************************************************************/
+#ifdef HAVE_MPI
+#include <mpi.h>
+#include "matar.h"
+#include "communication_plan.h"
+#include "mpi_types.h"
+#include "partition_map.h"
+
+#include <algorithm>
+#include <stdexcept>
+#include <vector>
+
+
+// -----------------------------------------
+// Row distributed sparse matrix without Trilinos
+//
+//   // owned rows of the global matrix, columns in global numbering
+//   CSRArrayKokkos<double> rows(values, starts, columns, num_owned, num_global);
+//
+//   DistributedCSRMatrix<double> A(MPI_COMM_WORLD, rows);
+//
+//   DCArrayKokkos<double> x(A.num_owned_rows());   // owned entries only
+//   DCArrayKokkos<double> y(A.num_owned_rows());
+//   A.apply(x, y);                                 // y = A x
+//
+//   KrylovOptions options;
+//   options.comm = A.comm();
+//   cg_solve(A, x, b, options);                    // A is callable as A(x, y)
+//
+// Every rank owns a contiguous block of rows, in rank order, and the
+// entries of x and y with the same global numbers. The rows are split into
+// a local block, columns this rank owns, and a ghost block, columns owned by
+// other ranks. Ghost columns are numbered after the owned ones in order of
+// their global number, which also groups them by owning rank, so the
+// exchange receives straight into the ghost vector.
+//
+// apply() packs and posts the ghost exchange, multiplies the local block
+// while the messages are in flight, then waits and adds the ghost block.
+// The exchange is a single MPI_Ineighbor_alltoallv on the graph
+// communicator of a CommunicationPlan.
+//
+// row_map() and col_map() are PartitionMaps of the owned rows and of the
+// local columns, for translating indices inside kernels.
+// -----------------------------------------
+
+namespace mtr
+{
+
+/////////////////////////
+// DistributedCSRMatrix:  owned rows split into local and ghost column blocks
+/////////////////////////
+template <typename T>
+class DistributedCSRMatrix {
+
+private:
+    MPI_Comm comm_ = MPI_COMM_NULL;
+    int    rank_ = 0;
+    int    num_ranks_ = 1;
+    bool   gpu_aware_ = false;
+
+    size_t global_rows_ = 0;
+    size_t num_owned_ = 0;
+    size_t num_ghost_ = 0;
+    size_t row_begin_ = 0;
+    std::vector<size_t> row_offsets_;   // first global row of every rank, and the total
+
+    PartitionMap<long long> row_map_;  // owned rows, contiguous
+    PartitionMap<long long> col_map_;  // owned columns, then the ghosts ascending
+
+    CSRArrayKokkos<T> local_;          // num_owned x num_owned, local columns
+    CSRArrayKokkos<T> ghost_;          // num_owned x num_ghost, ghost columns
+    CArrayKokkos<size_t> local_source_;  // entry of the input rows behind each local entry
+    CArrayKokkos<size_t> ghost_source_;
+
+    CommunicationPlan plan_;
+    DCArrayKokkos<int> send_rows_;     // owned row of every value in the send buffer
+    DCArrayKokkos<T> send_buffer_;
+    DCArrayKokkos<T> ghost_values_;    // receive buffer, x at the ghost columns
+
+    bool active() const;
+
+    // pack the owned values other ranks need and post the exchange
+    template <typename Vector>
+    void begin_exchange(const Vector& x, MPI_Request& request) const;
+
+    void end_exchange(MPI_Request& request) const;
+
+public:
+    // rows are the owned rows of a square matrix with global column numbers,
+    // every rank of comm calls it
+    DistributedCSRMatrix(MPI_Comm comm, const CSRArrayKokkos<T>& rows, bool gpu_aware = false);
+
+    // owns an MPI graph communicator through its plan, so it is not copied
+    DistributedCSRMatrix(const DistributedCSRMatrix&) = delete;
+    DistributedCSRMatrix& operator=(const DistributedCSRMatrix&) = delete;
+
+    MPI_Comm comm() const { return comm_; }
+
+    size_t global_rows() const { return global_rows_; }
+
+    size_t num_owned_rows() const { return num_owned_; }
+
+    size_t num_ghosts() const { return num_ghost_; }
+
+    // first global row owned by this rank
+    size_t row_begin() const { return row_begin_; }
+
+    // rank that owns a global row or column
+    int owner(size_t global) const;
+
+    // global number of a local column, owned columns first and ghosts after
+    size_t global_col(size_t local) const;
+
+    // local column of a global one, -1 when it is neither owned nor a ghost
+    long long local_col(size_t global) const;
+
+    const PartitionMap<long long>& row_map() const { return row_map_; }
+
+    const PartitionMap<long long>& col_map() const { return col_map_; }
+
+    const CSRArrayKokkos<T>& local_block() const { return local_; }
+
+    const CSRArrayKokkos<T>& ghost_block() const { return ghost_; }
+
+    CommunicationPlan& plan() { return plan_; }
+
+    // copy new values from rows with the pattern given to the constructor
+    void update_values(const CSRArrayKokkos<T>& rows);
+
+    // y = A x, both hold the owned entries
+    template <typename Vector>
+    void apply(const Vector& x, Vector& y) const;
+
+    // same as apply, so the matrix works as a Krylov operator
+    template <typename Vector>
+    void operator()(Vector& x, Vector& y) const { apply(x, y); }
+
+}; // End of DistributedCSRMatrix
+
+template <typename T>
+DistributedCSRMatrix<T>::DistributedCSRMatrix(MPI_Comm comm, const CSRArrayKokkos<T>& rows, bool gpu_aware)
+{
+    MATAR_PROFILE_SCOPE("DistributedCSRMatrix::setup", ProfileCategory::communication);
+    comm_      = comm;
+    gpu_aware_ = gpu_aware;
+    MPI_Comm_rank(comm, &rank_);
+    MPI_Comm_size(comm, &num_ranks_);
+    num_owned_ = rows.dim1();
+
+    // contiguous row blocks in rank order
+    std::vector<long long> counts(num_ranks_);
+    long long owned = static_cast<long long>(num_owned_);
+    MPI_Allgather(&owned, 1, MPI_LONG_LONG, counts.data(), 1, MPI_LONG_LONG, comm);
+    row_offsets_.assign(num_ranks_ + 1, 0);
+    for (int r = 0; r < num_ranks_; r++) {
+        row_offsets_[r + 1] = row_offsets_[r] + static_cast<size_t>(counts[r]);
+    }
+    global_rows_ = row_offsets_[num_ranks_];
+    row_begin_   = row_offsets_[rank_];
+    if (rows.dim2() != global_rows_) {
+        throw std::runtime_error("DistributedCSRMatrix: the rows need one column per global row");
+    }
+
+    // pattern of the owned rows on the host
+    DCArrayKokkos<size_t> starts(num_owned_ + 1, "dist_csr_starts");
+    FOR_ALL(i, 0, num_owned_ + 1, {
+        starts(i) = rows.begin_index(i);
+    });
+    starts.update_host();
+    const size_t nnz = starts.host(num_owned_);
+    DCArrayKokkos<size_t> columns(nnz > 0 ? nnz : 1, "dist_csr_columns");
+    FOR_ALL(k, 0, nnz, {
+        columns(k) = rows.get_col_flat(k);
+    });
+    columns.update_host();
+
+    // ghost columns, ascending, which groups them by owner
+    const size_t row_end = row_begin_ + num_owned_;
+    std::vector<size_t> ghosts;
+    for (size_t k = 0; k < nnz; k++) {
+        const size_t g = columns.host(k);
+        if (g < row_begin_ || g >= row_end) {
+            ghosts.push_back(g);
+        }
+    }
+    std::sort(ghosts.begin(), ghosts.end());
+    ghosts.erase(std::unique(ghosts.begin(), ghosts.end()), ghosts.end());
+    num_ghost_ = ghosts.size();
+
+    row_map_ = PartitionMap<long long>(global_rows_, num_owned_, comm, "dist_csr_row_map");
+    col_map_ = PartitionMap<long long>(num_owned_ + num_ghost_, "dist_csr_col_map");
+    for (size_t c = 0; c < num_owned_; c++) {
+        col_map_.host(c) = row_begin_ + c;
+    }
+    for (size_t c = 0; c < num_ghost_; c++) {
+        col_map_.host(num_owned_ + c) = ghosts[c];
+    }
+    col_map_.update_device();
+
+    // split every row into the two blocks
+    DCArrayKokkos<size_t> local_starts(num_owned_ + 1, "dist_csr_local_starts");
+    DCArrayKokkos<size_t> ghost_starts(num_owned_ + 1, "dist_csr_ghost_starts");
+    std::vector<size_t> local_cols, local_src, ghost_cols, ghost_src;
+    local_starts.host(0) = 0;
+    ghost_starts.host(0) = 0;
+    for (size_t i = 0; i < num_owned_; i++) {
+        for (size_t k = starts.host(i); k < starts.host(i + 1); k++) {
+            const size_t g = columns.host(k);
+            if (g >= row_begin_ && g < row_end) {
+                local_cols.push_back(g - row_begin_);
+                local_src.push_back(k);
+            }
+            else {
+                ghost_cols.push_back(col_map_.getLocalIndexHost(static_cast<long long>(g)) - num_owned_);
+                ghost_src.push_back(k);
+            }
+        }
+        local_starts.host(i + 1) = local_cols.size();
+        ghost_starts.host(i + 1) = ghost_cols.size();
+    }
+    local_starts.update_device();
+    ghost_starts.update_device();
+
+    // device copies of the blocks, values are filled by update_values
+    auto build = [&](const std::vector<size_t>& cols, const std::vector<size_t>& src,
+                     DCArrayKokkos<size_t>& block_starts, size_t num_cols,
+                     CSRArrayKokkos<T>& block, CArrayKokkos<size_t>& source, const std::string& tag) {
+        const size_t count = cols.size();
+        DCArrayKokkos<size_t> host_cols(count > 0 ? count : 1, tag + "_host_cols");
+        DCArrayKokkos<size_t> host_src(count > 0 ? count : 1, tag + "_host_src");
+        for (size_t k = 0; k < count; k++) {
+            host_cols.host(k) = cols[k];
+            host_src.host(k)  = src[k];
+        }
+        host_cols.update_device();
+        host_src.update_device();
+
+        CArrayKokkos<size_t> block_cols(count > 0 ? count : 1, tag + "_cols");
+        CArrayKokkos<size_t> block_rows(num_owned_ + 1, tag + "_starts");
+        CArrayKokkos<T> block_values(count > 0 ? count : 1, tag + "_values");
+        source = CArrayKokkos<size_t>(count > 0 ? count : 1, tag + "_source");
+        CArrayKokkos<size_t> block_source = source;
+        FOR_ALL(k, 0, count, {
+            block_cols(k)   = host_cols(k);
+            block_source(k) = host_src(k);
+        });
+        FOR_ALL(i, 0, num_owned_ + 1, {
+            block_rows(i) = block_starts(i);
+        });
+        block = CSRArrayKokkos<T>(block_values, block_rows, block_cols, num_owned_, num_cols, tag);
+    };
+    build(local_cols, local_src, local_starts, num_owned_, local_, local_source_, "dist_csr_local");
+    build(ghost_cols, ghost_src, ghost_starts, num_ghost_, ghost_, ghost_source_, "dist_csr_ghost");
+    update_values(rows);
+
+    // ask the owners for the ghosts, the answers are the send lists
+    std::vector<int> request_counts(num_ranks_, 0);
+    for (size_t c = 0; c < num_ghost_; c++) {
+        request_counts[owner(ghosts[c])]++;
+    }
+    std::vector<int> serve_counts(num_ranks_, 0);
+    MPI_Alltoall(request_counts.data(), 1, MPI_INT, serve_counts.data(), 1, MPI_INT, comm);
+
+    std::vector<int> request_displs(num_ranks_ + 1, 0);
+    std::vector<int> serve_displs(num_ranks_ + 1, 0);
+    for (int r = 0; r < num_ranks_; r++) {
+        request_displs[r + 1] = request_displs[r] + request_counts[r];
+        serve_displs[r + 1]   = serve_displs[r] + serve_counts[r];
+    }
+    std::vector<long long> requested(num_ghost_ > 0 ? num_ghost_ : 1);
+    std::vector<long long> served(serve_displs[num_ranks_] > 0 ? serve_displs[num_ranks_] : 1);
+    for (size_t c = 0; c < num_ghost_; c++) {
+        requested[c] = static_cast<long long>(ghosts[c]);
+    }
+    MPI_Alltoallv(requested.data(), request_counts.data(), request_displs.data(), MPI_LONG_LONG,
+                  served.data(), serve_counts.data(), serve_displs.data(), MPI_LONG_LONG, comm);
+
+    std::vector<int> send_ranks;
+    std::vector<int> recv_ranks;
+    std::vector<std::vector<int>> send_lists;
+    std::vector<std::vector<int>> recv_lists;
+    for (int r = 0; r < num_ranks_; r++) {
+        if (serve_counts[r] > 0) {
+            std::vector<int> list;
+            for (int s = serve_displs[r]; s < serve_displs[r + 1]; s++) {
+                list.push_back(static_cast<int>(served[s] - static_cast<long long>(row_begin_)));
+            }
+            send_ranks.push_back(r);
+            send_lists.push_back(list);
+        }
+        if (request_counts[r] > 0) {
+            std::vector<int> list;
+            for (int s = request_displs[r]; s < request_displs[r + 1]; s++) {
+                list.push_back(static_cast<int>(num_owned_) + s);
+            }
+            recv_ranks.push_back(r);
+            recv_lists.push_back(list);
+        }
+    }
+
+    // the graph communicator is collective, so it is made when any rank has neighbors
+    int local_neighbors  = static_cast<int>(send_ranks.size() + recv_ranks.size());
+    int global_neighbors = 0;
+    MPI_Allreduce(&local_neighbors, &global_neighbors, 1, MPI_INT, MPI_MAX, comm);
+
+    plan_.initialize(comm);
+    if (global_neighbors == 0) {
+        return;
+    }
+    plan_.initialize_graph_communicator(static_cast<int>(send_ranks.size()), send_ranks.data(),
+                                        static_cast<int>(recv_ranks.size()), recv_ranks.data());
+
+    auto ragged = [](const std::vector<std::vector<int>>& lists, const std::string& tag) {
+        std::vector<size_t> strides(lists.size());
+        for (size_t r = 0; r < lists.size(); r++) {
+            strides[r] = lists[r].size();
+        }
+        DRaggedRightArrayKokkos<int> indices(strides.data(), strides.size(), tag);
+        for (size_t r = 0; r < lists.size(); r++) {
+            for (size_t j = 0; j < lists[r].size(); j++) {
+                indices.host(r, j) = lists[r][j];
+            }
+        }
+        indices.update_device();
+        return indices;
+    };
+    DRaggedRightArrayKokkos<int> send_indices = ragged(send_lists, "dist_csr_send_indices");
+    DRaggedRightArrayKokkos<int> recv_indices = ragged(recv_lists, "dist_csr_recv_indices");
+    plan_.setup_send_recv(send_indices, recv_indices);
+
+    const size_t total_send = plan_.total_send_count;
+    send_rows_ = DCArrayKokkos<int>(total_send > 0 ? total_send : 1, "dist_csr_send_rows");
+    size_t count = 0;
+    for (size_t r = 0; r < send_lists.size(); r++) {
+        for (size_t j = 0; j < send_lists[r].size(); j++) {
+            send_rows_.host(count++) = send_lists[r][j];
+        }
+    }
+    send_rows_.update_device();
+    send_buffer_  = DCArrayKokkos<T>(total_send > 0 ? total_send : 1, "dist_csr_send_buffer");
+    ghost_values_ = DCArrayKokkos<T>(num_ghost_ > 0 ? num_ghost_ : 1, "dist_csr_ghost_values");
+}
+
+template <typename T>
+bool DistributedCSRMatrix<T>::active() const
+{
+    return plan_.comm_type != communication_plan_type::no_communication;
+}
+
+template <typename T>
+int DistributedCSRMatrix<T>::owner(size_t global) const
+{
+    assert(global < global_rows_ && "global is out of bounds in DistributedCSRMatrix owner!");
+    return static_cast<int>(std::upper_bound(row_offsets_.begin(), row_offsets_.end(), global) - row_offsets_.begin()) - 1;
+}
+
+template <typename T>
+size_t DistributedCSRMatrix<T>::global_col(size_t local) const
+{
+    assert(local < num_owned_ + num_ghost_ && "local is out of bounds in DistributedCSRMatrix global_col!");
+    return col_map_.host(local);
+}
+
+template <typename T>
+long long DistributedCSRMatrix<T>::local_col(size_t global) const
+{
+    return col_map_.getLocalIndexHost(static_cast<long long>(global));
+}
+
+template <typename T>
+void DistributedCSRMatrix<T>::update_values(const CSRArrayKokkos<T>& rows)
+{
+    CSRArrayKokkos<T> local = local_;
+    CSRArrayKokkos<T> ghost = ghost_;
+    CArrayKokkos<size_t> local_source = local_source_;
+    CArrayKokkos<size_t> ghost_source = ghost_source_;
+    FOR_ALL(i, 0, num_owned_, {
+        for (size_t k = local.begin_index(i); k < local.end_index(i); k++) {
+            local.get_val_flat(k) = rows.get_val_flat(local_source(k));
+        }
+        for (size_t k = ghost.begin_index(i); k < ghost.end_index(i); k++) {
+            ghost.get_val_flat(k) = rows.get_val_flat(ghost_source(k));
+        }
+    });
+}
+
+template <typename T>
+template <typename Vector>
+void DistributedCSRMatrix<T>::begin_exchange(const Vector& x, MPI_Request& request) const
+{
+    MATAR_PROFILE_SCOPE("DistributedCSRMatrix::begin_exchange", ProfileCategory::communication);
+    DCArrayKokkos<int> send_rows = send_rows_;
+    DCArrayKokkos<T> buffer = send_buffer_;
+    FOR_ALL(s, 0, plan_.total_send_count, {
+        buffer(s) = x(send_rows(s));
+    });
+
+    T* send_ptr = buffer.device_pointer();
+    T* recv_ptr = ghost_values_.device_pointer();
+    if (!gpu_aware_) {
+        buffer.update_host();
+        send_ptr = buffer.host_pointer();
+        recv_ptr = ghost_values_.host_pointer();
+    }
+    MATAR_FENCE();
+
+    MPI_Ineighbor_alltoallv(send_ptr, plan_.send_counts_.host_pointer(), plan_.send_displs_.host_pointer(),
+                            mpi_type_map<T>::value(),
+                            recv_ptr, plan_.recv_counts_.host_pointer(), plan_.recv_displs_.host_pointer(),
+                            mpi_type_map<T>::value(),
+                            plan_.mpi_comm_graph, &request);
+}
+
+template <typename T>
+void DistributedCSRMatrix<T>::end_exchange(MPI_Request& request) const
+{
+    MATAR_PROFILE_SCOPE("DistributedCSRMatrix::end_exchange", ProfileCategory::communication);
+    MPI_Wait(&request, MPI_STATUS_IGNORE);
+    if (!gpu_aware_) {
+        DCArrayKokkos<T> ghost_values = ghost_values_;
+        ghost_values.update_device();
+    }
+}
+
+template <typename T>
+template <typename Vector>
+void DistributedCSRMatrix<T>::apply(const Vector& x, Vector& y) const
+{
+    MATAR_PROFILE_SCOPE("DistributedCSRMatrix::apply", ProfileCategory::compute);
+    MPI_Request request = MPI_REQUEST_NULL;
+    if (active()) {
+        begin_exchange(x, request);
+    }
+
+    CSRArrayKokkos<T> local = local_;
+    FOR_ALL(i, 0, num_owned_, {
+        T sum = 0;
+        for (size_t k = local.begin_index(i); k < local.end_index(i); k++) {
+            sum += local.get_val_flat(k) * x(local.get_col_flat(k));
+        }
+        y(i) = sum;
+    });
+
+    if (active()) {
+        end_exchange(request);
+
+        CSRArrayKokkos<T> ghost = ghost_;
+        DCArrayKokkos<T> ghost_values = ghost_values_;
+        FOR_ALL(i, 0, num_owned_, {
+            T sum = 0;
+            for (size_t k = ghost.begin_index(i); k < ghost.end_index(i); k++) {
+                sum += ghost.get_val_flat(k) * ghost_values(ghost.get_col_flat(k));
+            }
+            y(i) += sum;
+        });
+    }
+    MATAR_FENCE();
+}
+
+// End of DistributedCSRMatrix
+
+} // end namespace
+
+#endif // end if HAVE_MPI
+#endif // end if DISTRIBUTED_CSR_H
@@ -0,0 +1,617 @@
+#ifndef EXPRESSION_TYPES_H
+#define EXPRESSION_TYPES_H
+/**********************************************************************************************
+ © 2020. Triad National Security, LLC. All rights reserved.
+ This program was produced under U.S. Government contract 89233218CNA000001 for Los Alamos
+ National Laboratory (LANL), which is operated by Triad National Security, LLC for the U.S.
+ Department of Energy/National Nuclear Security Administration. All rights in the program are
+ reserved by Triad National Security, LLC, and the U.S. Department of Energy/National Nuclear
+ Security Administration. The Government is granted for itself and others acting on its behalf a
+ nonexclusive, paid-up, irrevocable worldwide license in this material to reproduce, prepare
+ derivative works, distribute copies to the public, perform publicly and display publicly, and
+ to permit others to do so.
+ This program is open source under the BSD-3 License.
+ Redistribution and use in source and binary forms, with or without modification, are permitted
+ provided that the following conditions are met:
+ 
+ 1.  Redistributions of source code must retain the above copyright notice, this list of
+ conditions and the following disclaimer.
+ 
+ 2.  Redistributions in binary form must reproduce the above copyright notice, this list of
+ conditions and the following disclaimer in the documentation and/or other materials
+ provided with the distribution.
+ 
+ 3.  Neither the name of the copyright holder nor the names of its contributors may be used
+ to endorse or promote products derived from this software without specific prior
+ written permission.
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+ IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **********************************************************************************************/
+#include <cassert>
+#include <cmath>
+#include <type_traits>
+
+#include "host_types.h"
+#include "kokkos_types.h"
+
+
+// -----------------------------------------
+// Expression templates for whole array arithmetic
+//
+//   assign(C, A + 2.0*B - D);       // one fused loop, no temporaries
+//   double total = sum(A*B);
+//   double err   = norm(A - B);
+//   assign(C, A + broadcast(row, A)); // row is repeated over the leading index
+//
+// Operands must share the space they live in (host types, or the device
+// side of the Kokkos and dual types) and the index family (C or F order).
+// Expressions on dual types read and write the device data.
+// -----------------------------------------
+
+// functions that are callable on the host and inside device kernels
+#ifndef MATAR_INLINE_FUNCTION
+#ifdef HAVE_KOKKOS
+#define MATAR_INLINE_FUNCTION KOKKOS_INLINE_FUNCTION
+#else
+#define MATAR_INLINE_FUNCTION inline
+#endif
+#endif
+
+namespace mtr
+{
+
+// where an expression is evaluated
+struct ExprHostSpace {};
+
+template <typename ExecSpace>
+struct ExprDeviceSpace {
+    using exec_space = ExecSpace;
+};
+
+struct ExprAnySpace {};  // scalars
+
+// flat index order of the operands
+struct ExprCFamily {};
+struct ExprFFamily {};
+struct ExprAnyFamily {}; // scalars
+
+template <typename A, typename B>
+struct expr_join {
+    static_assert(std::is_same<A, B>::value,
+                  "Expression operands must live in the same space and use the same index order");
+    using type = A;
+};
+
+template <typename B>
+struct expr_join<ExprAnySpace, B> { using type = B; };
+
+template <typename A>
+struct expr_join<A, ExprAnySpace> { using type = A; };
+
+template <>
+struct expr_join<ExprAnySpace, ExprAnySpace> { using type = ExprAnySpace; };
+
+template <typename B>
+struct expr_join<ExprAnyFamily, B> { using type = B; };
+
+template <typename A>
+struct expr_join<A, ExprAnyFamily> { using type = A; };
+
+template <>
+struct expr_join<ExprAnyFamily, ExprAnyFamily> { using type = ExprAnyFamily; };
+
+
+// -----------------------------------------
+// container traits: which MATAR types can be used as operands
+// -----------------------------------------
+template <typename Container>
+struct expr_container_traits {
+    static constexpr bool value = false;
+};
+
+// Base is 1 for the Matrix types, their dims() start at 1
+template <typename T, typename Space, typename Family, size_t Base>
+struct expr_container_base {
+    static constexpr bool value = true;
+    static constexpr size_t index_base = Base;
+    using value_type = T;
+    using space  = Space;
+    using family = Family;
+
+    template <typename Container>
+    static T* data(const Container& a) { return a.pointer(); }
+};
+
+// the dual types expose their device data
+template <typename T, typename Space, typename Family, size_t Base>
+struct expr_dual_base : expr_container_base<T, Space, Family, Base> {
+    template <typename Container>
+    static T* data(const Container& a) { return a.device_pointer(); }
+};
+
+template <typename T> struct expr_container_traits<FArray<T>>      : expr_container_base<T, ExprHostSpace, ExprFFamily, 0> {};
+template <typename T> struct expr_container_traits<ViewFArray<T>>  : expr_container_base<T, ExprHostSpace, ExprFFamily, 0> {};
+template <typename T> struct expr_container_traits<FMatrix<T>>     : expr_container_base<T, ExprHostSpace, ExprFFamily, 1> {};
+template <typename T> struct expr_container_traits<ViewFMatrix<T>> : expr_container_base<T, ExprHostSpace, ExprFFamily, 1> {};
+template <typename T> struct expr_container_traits<CArray<T>>      : expr_container_base<T, ExprHostSpace, ExprCFamily, 0> {};
+template <typename T> struct expr_container_traits<ViewCArray<T>>  : expr_container_base<T, ExprHostSpace, ExprCFamily, 0> {};
+template <typename T> struct expr_container_traits<CMatrix<T>>     : expr_container_base<T, ExprHostSpace, ExprCFamily, 1> {};
+template <typename T> struct expr_container_traits<ViewCMatrix<T>> : expr_container_base<T, ExprHostSpace, ExprCFamily, 1> {};
+
+#ifdef HAVE_KOKKOS
+template <typename T, typename L, typename E, typename M>
+struct expr_container_traits<FArrayKokkos<T, L, E, M>>       : expr_container_base<T, ExprDeviceSpace<E>, ExprFFamily, 0> {};
+template <typename T>
+struct expr_container_traits<ViewFArrayKokkos<T>>            : expr_container_base<T, ExprDeviceSpace<DefaultExecSpace>, ExprFFamily, 0> {};
+template <typename T, typename L, typename E, typename M>
+struct expr_container_traits<FMatrixKokkos<T, L, E, M>>      : expr_container_base<T, ExprDeviceSpace<E>, ExprFFamily, 1> {};
+template <typename T>
+struct expr_container_traits<ViewFMatrixKokkos<T>>           : expr_container_base<T, ExprDeviceSpace<DefaultExecSpace>, ExprFFamily, 1> {};
+template <typename T, typename L, typename E, typename M>
+struct expr_container_traits<CArrayKokkos<T, L, E, M>>       : expr_container_base<T, ExprDeviceSpace<E>, ExprCFamily, 0> {};
+template <typename T>
+struct expr_container_traits<ViewCArrayKokkos<T>>            : expr_container_base<T, ExprDeviceSpace<DefaultExecSpace>, ExprCFamily, 0> {};
+template <typename T, typename L, typename E, typename M>
+struct expr_container_traits<CMatrixKokkos<T, L, E, M>>      : expr_container_base<T, ExprDeviceSpace<E>, ExprCFamily, 1> {};
+template <typename T>
+struct expr_container_traits<ViewCMatrixKokkos<T>>           : expr_container_base<T, ExprDeviceSpace<DefaultExecSpace>, ExprCFamily, 1> {};
+
+template <typename T, typename L, typename E, typename M>
+struct expr_container_traits<DFArrayKokkos<T, L, E, M>>      : expr_dual_base<T, ExprDeviceSpace<E>, ExprFFamily, 0> {};
+template <typename T, typename L, typename E, typename M>
+struct expr_container_traits<DViewFArrayKokkos<T, L, E, M>>  : expr_dual_base<T, ExprDeviceSpace<E>, ExprFFamily, 0> {};
+template <typename T, typename L, typename E, typename M>
+struct expr_container_traits<DFMatrixKokkos<T, L, E, M>>     : expr_dual_base<T, ExprDeviceSpace<E>, ExprFFamily, 1> {};
+template <typename T, typename L, typename E, typename M>
+struct expr_container_traits<DViewFMatrixKokkos<T, L, E, M>> : expr_dual_base<T, ExprDeviceSpace<E>, ExprFFamily, 1> {};
+template <typename T, typename L, typename E, typename M>
+struct expr_container_traits<DCArrayKokkos<T, L, E, M>>      : expr_dual_base<T, ExprDeviceSpace<E>, ExprCFamily, 0> {};
+template <typename T, typename L, typename E, typename M>
+struct expr_container_traits<DViewCArrayKokkos<T, L, E, M>>  : expr_dual_base<T, ExprDeviceSpace<E>, ExprCFamily, 0> {};
+template <typename T, typename L, typename E, typename M>
+struct expr_container_traits<DCMatrixKokkos<T, L, E, M>>     : expr_dual_base<T, ExprDeviceSpace<E>, ExprCFamily, 1> {};
+template <typename T, typename L, typename E, typename M>
+struct expr_container_traits<DViewCMatrixKokkos<T, L, E, M>> : expr_dual_base<T, ExprDeviceSpace<E>, ExprCFamily, 1> {};
+#endif
+
+
+// every expression node derives from this tag
+struct ExprNode {};
+
+template <typename E>
+struct is_expr_node : std::is_base_of<ExprNode, E> {};
+
+// anything that can appear in an expression
+template <typename E>
+struct is_expr_operand {
+    static constexpr bool value = is_expr_node<E>::value || expr_container_traits<E>::value;
+};
+
+
+/////////////////////////
+// ExprShape: extents of an expression, used to check operands match
+/////////////////////////
+struct ExprShape {
+    size_t dims_[7];
+    size_t order_;
+    size_t length_;
+
+    ExprShape() : order_(0), length_(1) {
+        for (int i = 0; i < 7; i++) dims_[i] = 0;
+    }
+
+    bool operator==(const ExprShape& other) const {
+        if (order_ != other.order_ || length_ != other.length_) return false;
+        for (size_t i = 0; i < order_; i++) {
+            if (dims_[i] != other.dims_[i]) return false;
+        }
+        return true;
+    }
+}; // End of ExprShape
+
+
+/////////////////////////
+// ExprTerminal: a MATAR container inside an expression, holds the raw
+// pointer so it can be copied into a device kernel
+/////////////////////////
+template <typename T, typename Space, typename Family>
+class ExprTerminal : public ExprNode {
+
+private:
+    T* data_;
+    ExprShape shape_;
+
+public:
+    using value_type = typename std::remove_const<T>::type;
+    using space  = Space;
+    using family = Family;
+
+    template <typename Container>
+    explicit ExprTerminal(const Container& a) {
+        using traits = expr_container_traits<Container>;
+        data_ = traits::data(a);
+        shape_.order_  = a.order();
+        shape_.length_ = a.size();
+        for (size_t i = 0; i < shape_.order_; i++) {
+            shape_.dims_[i] = a.dims(i + traits::index_base);
+        }
+    }
+
+    MATAR_INLINE_FUNCTION
+    value_type operator[](size_t i) const { return data_[i]; }
+
+    MATAR_INLINE_FUNCTION
+    T* data() const { return data_; }
+
+    const ExprShape& shape() const { return shape_; }
+
+    size_t size() const { return shape_.length_; }
+}; // End of ExprTerminal
+
+
+/////////////////////////
+// ExprScalar: a number broadcast over the whole expression
+/////////////////////////
+template <typename T>
+class ExprScalar : public ExprNode {
+
+private:
+    T value_;
+    ExprShape shape_;
+
+public:
+    using value_type = T;
+    using space  = ExprAnySpace;
+    using family = ExprAnyFamily;
+
+    explicit ExprScalar(T value) : value_(value) {}
+
+    MATAR_INLINE_FUNCTION
+    value_type operator[](size_t) const { return value_; }
+
+    const ExprShape& shape() const { return shape_; }
+
+    size_t size() const { return 1; }
+}; // End of ExprScalar
+
+
+// wrap a container or a number as an expression node, nodes pass through
+template <typename E, typename std::enable_if<is_expr_node<E>::value, int>::type = 0>
+const E& as_expr(const E& e) { return e; }
+
+template <typename C, typename std::enable_if<expr_container_traits<C>::value, int>::type = 0>
+ExprTerminal<typename expr_container_traits<C>::value_type,
+             typename expr_container_traits<C>::space,
+             typename expr_container_traits<C>::family>
+as_expr(const C& a) {
+    return ExprTerminal<typename expr_container_traits<C>::value_type,
+                        typename expr_container_traits<C>::space,
+                        typename expr_container_traits<C>::family>(a);
+}
+
+template <typename S, typename std::enable_if<std::is_arithmetic<S>::value, int>::type = 0>
+ExprScalar<S> as_expr(const S& value) { return ExprScalar<S>(value); }
+
+template <typename E>
+using expr_t = typename std::decay<decltype(as_expr(std::declval<const E&>()))>::type;
+
+
+/////////////////////////
+// ExprBinary: elementwise Op(lhs, rhs)
+/////////////////////////
+template <typename Op, typename L, typename R>
+class ExprBinary : public ExprNode {
+
+private:
+    L lhs_;
+    R rhs_;
+
+public:
+    using value_type = decltype(Op::apply(std::declval<typename L::value_type>(),
+                                          std::declval<typename R::value_type>()));
+    using space  = typename expr_join<typename L::space, typename R::space>::type;
+    using family = typename expr_join<typename L::family, typename R::family>::type;
+
+    ExprBinary(const L& lhs, const R& rhs) : lhs_(lhs), rhs_(rhs) {
+        assert((lhs.shape().order_ == 0 || rhs.shape().order_ == 0 || lhs.shape() == rhs.shape())
+               && "Expression operands do not have the same dims, use broadcast()!");
+    }
+
+    MATAR_INLINE_FUNCTION
+    value_type operator[](size_t i) const { return Op::apply(lhs_[i], rhs_[i]); }
+
+    const ExprShape& shape() const { return lhs_.shape().order_ > 0 ? lhs_.shape() : rhs_.shape(); }
+
+    size_t size() const { return shape().length_; }
+}; // End of ExprBinary
+
+
+/////////////////////////
+// ExprUnary: elementwise Op(arg)
+/////////////////////////
+template <typename Op, typename E>
+class ExprUnary : public ExprNode {
+
+private:
+    E arg_;
+
+public:
+    using value_type = decltype(Op::apply(std::declval<typename E::value_type>()));
+    using space  = typename E::space;
+    using family = typename E::family;
+
+    explicit ExprUnary(const E& arg) : arg_(arg) {}
+
+    MATAR_INLINE_FUNCTION
+    value_type operator[](size_t i) const { return Op::apply(arg_[i]); }
+
+    const ExprShape& shape() const { return arg_.shape(); }
+
+    size_t size() const { return shape().length_; }
+}; // End of ExprUnary
+
+
+/////////////////////////
+// ExprBroadcast: repeats a smaller expression over the extents of a larger
+// one. Its dims must match the fastest running dims of the target, the
+// trailing dims for C order and the leading dims for F order.
+/////////////////////////
+template <typename E>
+class ExprBroadcast : public ExprNode {
+
+private:
+    E arg_;
+    size_t period_;
+    ExprShape shape_;
+
+public:
+    using value_type = typename E::value_type;
+    using space  = typename E::space;
+    using family = typename E::family;
+
+    ExprBroadcast(const E& arg, const ExprShape& target) : arg_(arg), shape_(target) {
+        const ExprShape& small = arg.shape();
+        period_ = small.length_;
+        assert(small.order_ <= target.order_ && "broadcast() source has a higher order than the target!");
+        size_t offset = std::is_same<family, ExprCFamily>::value ? target.order_ - small.order_ : 0;
+        for (size_t i = 0; i < small.order_; i++) {
+            assert(small.dims_[i] == target.dims_[i + offset] && "broadcast() dims do not match the target!");
+        }
+        (void)offset;
+    }
+
+    MATAR_INLINE_FUNCTION
+    value_type operator[](size_t i) const { return arg_[i % period_]; }
+
+    const ExprShape& shape() const { return shape_; }
+
+    size_t size() const { return shape_.length_; }
+}; // End of ExprBroadcast
+
+
+// repeat a over the dims of like
+template <typename A, typename Like,
+          typename std::enable_if<is_expr_operand<A>::value && is_expr_operand<Like>::value, int>::type = 0>
+ExprBroadcast<expr_t<A>> broadcast(const A& a, const Like& like) {
+    return ExprBroadcast<expr_t<A>>(as_expr(a), as_expr(like).shape());
+}
+
+
+// -----------------------------------------
+// elementwise operations
+// -----------------------------------------
+struct ExprAdd { template <typename A, typename B> MATAR_INLINE_FUNCTION static auto apply(A a, B b) -> decltype(a + b) { return a + b; } };
+struct ExprSub { template <typename A, typename B> MATAR_INLINE_FUNCTION static auto apply(A a, B b) -> decltype(a - b) { return a - b; } };
+struct ExprMul { template <typename A, typename B> MATAR_INLINE_FUNCTION static auto apply(A a, B b) -> decltype(a * b) { return a * b; } };
+struct ExprDiv { template <typename A, typename B> MATAR_INLINE_FUNCTION static auto apply(A a, B b) -> decltype(a / b) { return a / b; } };
+struct ExprNeg { template <typename A> MATAR_INLINE_FUNCTION static auto apply(A a) -> decltype(-a) { return -a; } };
+
+#ifdef HAVE_KOKKOS
+struct ExprAbs  { template <typename A> MATAR_INLINE_FUNCTION static A apply(A a) { return Kokkos::abs(a); } };
+struct ExprSqrt { template <typename A> MATAR_INLINE_FUNCTION static A apply(A a) { return Kokkos::sqrt(a); } };
+#else
+struct ExprAbs  { template <typename A> static A apply(A a) { return std::abs(a); } };
+struct ExprSqrt { template <typename A> static A apply(A a) { return std::sqrt(a); } };
+#endif
+
+// true when L op R should build an expression: at least one side is a
+// MATAR operand and the other side is an operand or a number
+template <typename L, typename R>
+struct expr_binary_enabled {
+    static constexpr bool value =
+        (is_expr_operand<L>::value && (is_expr_operand<R>::value || std::is_arithmetic<R>::value)) ||
+        (is_expr_operand<R>::value && std::is_arithmetic<L>::value);
+};
+
+#define MATAR_EXPR_BINARY_OPERATOR(OP, NAME) \
+template <typename L, typename R, typename std::enable_if<expr_binary_enabled<L, R>::value, int>::type = 0> \
+ExprBinary<NAME, expr_t<L>, expr_t<R>> operator OP(const L& lhs, const R& rhs) { \
+    return ExprBinary<NAME, expr_t<L>, expr_t<R>>(as_expr(lhs), as_expr(rhs)); \
+}
+
+MATAR_EXPR_BINARY_OPERATOR(+, ExprAdd)
+MATAR_EXPR_BINARY_OPERATOR(-, ExprSub)
+MATAR_EXPR_BINARY_OPERATOR(*, ExprMul)
+MATAR_EXPR_BINARY_OPERATOR(/, ExprDiv)
+
+#undef MATAR_EXPR_BINARY_OPERATOR
+
+template <typename E, typename std::enable_if<is_expr_operand<E>::value, int>::type = 0>
+ExprUnary<ExprNeg, expr_t<E>> operator-(const E& e) {
+    return ExprUnary<ExprNeg, expr_t<E>>(as_expr(e));
+}
+
+template <typename E, typename std::enable_if<is_expr_operand<E>::value, int>::type = 0>
+ExprUnary<ExprAbs, expr_t<E>> abs(const E& e) {
+    return ExprUnary<ExprAbs, expr_t<E>>(as_expr(e));
+}
+
+template <typename E, typename std::enable_if<is_expr_operand<E>::value, int>::type = 0>
+ExprUnary<ExprSqrt, expr_t<E>> sqrt(const E& e) {
+    return ExprUnary<ExprSqrt, expr_t<E>>(as_expr(e));
+}
+
+
+// -----------------------------------------
+// evaluation, every call is a single loop or kernel
+// -----------------------------------------
+
+// host loops
+template <typename T, typename E>
+void expr_assign(ExprHostSpace, T* data, const E& e, size_t length) {
+    for (size_t i = 0; i < length; i++) {
+        data[i] = e[i];
+    }
+}
+
+#ifdef HAVE_KOKKOS
+// device kernels on the execution space of the operands
+template <typename ExecSpace, typename T, typename E>
+void expr_assign(ExprDeviceSpace<ExecSpace>, T* data, const E& e, size_t length) {
+    Kokkos::parallel_for("mtr::assign", Kokkos::RangePolicy<ExecSpace>(0, length),
+                         KOKKOS_LAMBDA(const size_t i) {
+        data[i] = e[i];
+    });
+}
+#endif
+
+template <typename D, typename E>
+void assign_checked(D& dest, const E& e) {
+    using dest_expr = expr_t<D>;
+    static_assert(!std::is_same<typename dest_expr::space, ExprAnySpace>::value, "assign() needs a MATAR container");
+    using space  = typename expr_join<typename dest_expr::space, typename E::space>::type;
+    using family = typename expr_join<typename dest_expr::family, typename E::family>::type;
+    static_assert(!std::is_same<family, ExprAnyFamily>::value, "assign() needs a MATAR container");
+
+    dest_expr target = as_expr(dest);
+    assert((e.shape().order_ == 0 || e.shape() == target.shape())
+           && "assign() destination and expression do not have the same dims!");
+    expr_assign(space(), target.data(), e, target.size());
+}
+
+// dest = e, evaluated in one pass
+template <typename D, typename E,
+          typename std::enable_if<expr_container_traits<D>::value &&
+                                  (is_expr_operand<E>::value || std::is_arithmetic<E>::value), int>::type = 0>
+void assign(D& dest, const E& e) {
+    assign_checked(dest, as_expr(e));
+}
+
+
+// reductions
+struct ExprReduceSum {};
+struct ExprReduceMax {};
+struct ExprReduceMin {};
+
+template <typename E>
+typename E::value_type expr_reduce(ExprHostSpace, ExprReduceSum, const E& e, size_t length) {
+    typename E::value_type result = 0;
+    for (size_t i = 0; i < length; i++) {
+        result += e[i];
+    }
+    return result;
+}
+
+template <typename E>
+typename E::value_type expr_reduce(ExprHostSpace, ExprReduceMax, const E& e, size_t length) {
+    typename E::value_type result = e[0];
+    for (size_t i = 1; i < length; i++) {
+        if (e[i] > result) result = e[i];
+    }
+    return result;
+}
+
+template <typename E>
+typename E::value_type expr_reduce(ExprHostSpace, ExprReduceMin, const E& e, size_t length) {
+    typename E::value_type result = e[0];
+    for (size_t i = 1; i < length; i++) {
+        if (e[i] < result) result = e[i];
+    }
+    return result;
+}
+
+#ifdef HAVE_KOKKOS
+template <typename ExecSpace, typename E>
+typename E::value_type expr_reduce(ExprDeviceSpace<ExecSpace>, ExprReduceSum, const E& e, size_t length) {
+    using T = typename E::value_type;
+    T result = 0;
+    Kokkos::parallel_reduce("mtr::sum", Kokkos::RangePolicy<ExecSpace>(0, length),
+                            KOKKOS_LAMBDA(const size_t i, T& update) {
+        update += e[i];
+    }, result);
+    return result;
+}
+
+template <typename ExecSpace, typename E>
+typename E::value_type expr_reduce(ExprDeviceSpace<ExecSpace>, ExprReduceMax, const E& e, size_t length) {
+    using T = typename E::value_type;
+    T result;
+    Kokkos::parallel_reduce("mtr::max_value", Kokkos::RangePolicy<ExecSpace>(0, length),
+                            KOKKOS_LAMBDA(const size_t i, T& update) {
+        if (e[i] > update) update = e[i];
+    }, Kokkos::Max<T>(result));
+    return result;
+}
+
+template <typename ExecSpace, typename E>
+typename E::value_type expr_reduce(ExprDeviceSpace<ExecSpace>, ExprReduceMin, const E& e, size_t length) {
+    using T = typename E::value_type;
+    T result;
+    Kokkos::parallel_reduce("mtr::min_value", Kokkos::RangePolicy<ExecSpace>(0, length),
+                            KOKKOS_LAMBDA(const size_t i, T& update) {
+        if (e[i] < update) update = e[i];
+    }, Kokkos::Min<T>(result));
+    return result;
+}
+#endif
+
+template <typename Reduction, typename E>
+typename expr_t<E>::value_type reduce_expr(const E& expr) {
+    expr_t<E> e = as_expr(expr);
+    assert(e.size() > 0 && "Reduction of an empty expression!");
+    return expr_reduce(typename expr_t<E>::space(), Reduction(), e, e.size());
+}
+
+// sum of all entries
+template <typename E, typename std::enable_if<is_expr_operand<E>::value, int>::type = 0>
+typename expr_t<E>::value_type sum(const E& e) {
+    return reduce_expr<ExprReduceSum>(e);
+}
+
+// largest entry
+template <typename E, typename std::enable_if<is_expr_operand<E>::value, int>::type = 0>
+typename expr_t<E>::value_type max_value(const E& e) {
+    return reduce_expr<ExprReduceMax>(e);
+}
+
+// smallest entry
+template <typename E, typename std::enable_if<is_expr_operand<E>::value, int>::type = 0>
+typename expr_t<E>::value_type min_value(const E& e) {
+    return reduce_expr<ExprReduceMin>(e);
+}
+
+// sum of a*b
+template <typename A, typename B,
+          typename std::enable_if<is_expr_operand<A>::value && is_expr_operand<B>::value, int>::type = 0>
+auto dot(const A& a, const B& b) -> decltype(sum(a * b)) {
+    return sum(a * b);
+}
+
+// L2 norm
+template <typename E, typename std::enable_if<is_expr_operand<E>::value, int>::type = 0>
+typename expr_t<E>::value_type norm(const E& e) {
+    return std::sqrt(sum(e * e));
+}
+
+} // end namespace
+
+#endif // EXPRESSION_TYPES_H
@@ -0,0 +1,318 @@
+#ifndef FIXED_TYPES_H
+#define FIXED_TYPES_H
+/**********************************************************************************************
+ © 2020. Triad National Security, LLC. All rights reserved.
+ This program was produced under U.S. Government contract 89233218CNA000001 for Los Alamos
+ National Laboratory (LANL), which is operated by Triad National Security, LLC for the U.S.
+ Department of Energy/National Nuclear Security Administration. All rights in the program are
+ reserved by Triad National Security, LLC, and the U.S. Department of Energy/National Nuclear
+ Security Administration. The Government is granted for itself and others acting on its behalf a
+ nonexclusive, paid-up, irrevocable worldwide license in this material to reproduce, prepare
+ derivative works, distribute copies to the public, perform publicly and display publicly, and
+ to permit others to do so.
+ This program is open source under the BSD-3 License.
+ Redistribution and use in source and binary forms, with or without modification, are permitted
+ provided that the following conditions are met:
+ 
+ 1.  Redistributions of source code must retain the above copyright notice, this list of
+ conditions and the following disclaimer.
+ 
+ 2.  Redistributions in binary form must reproduce the above copyright notice, this list of
+ conditions and the following disclaimer in the documentation and/or other materials
+ provided with the distribution.
+ 
+ 3.  Neither the name of the copyright holder nor the names of its contributors may be used
+ to endorse or promote products derived from this software without specific prior
+ written permission.
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+ IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **********************************************************************************************/
+
+#include <stdio.h>
+#include <cassert>
+#include <type_traits>
+
+#ifdef HAVE_KOKKOS
+#include <Kokkos_Core.hpp>
+#endif
+
+// functions that are callable on the host and inside device kernels
+#ifndef MATAR_INLINE_FUNCTION
+#ifdef HAVE_KOKKOS
+#define MATAR_INLINE_FUNCTION KOKKOS_INLINE_FUNCTION
+#else
+#define MATAR_INLINE_FUNCTION inline
+#endif
+#endif
+
+
+// -----------------------------------------
+// Fixed size types
+//
+// The rank and every extent are template parameters, so the strides are
+// compile time constants and the data lives inside the object. They are
+// meant for small per-point tensors in inner loops, e.g. a 3x3 stress or a
+// 4x4 Jacobian declared inside a FOR_ALL, where they stay on the stack or
+// in registers like a raw C array.
+//
+//   CArrayFixed <double, 3, 3> stress;  // stress(i,j),  i,j = 0..2
+//   FMatrixFixed<double, 4, 4> jac;     // jac(i,j),     i,j = 1..4
+//
+// The data is not initialized, call set_values() when needed. Inside the
+// FOR_ALL style macros use an alias declared outside the loop, the commas in
+// the template arguments would otherwise split the macro arguments.
+// -----------------------------------------
+
+namespace mtr
+{
+
+// storage order tags
+struct FixedLayoutC {};  // last index is contiguous
+struct FixedLayoutF {};  // first index is contiguous
+
+// product of the extents
+template <size_t... Dims>
+struct fixed_product;
+
+template <>
+struct fixed_product<> {
+    static constexpr size_t value = 1;
+};
+
+template <size_t D0, size_t... Rest>
+struct fixed_product<D0, Rest...> {
+    static constexpr size_t value = D0 * fixed_product<Rest...>::value;
+};
+
+// flat offset of an index, Base is subtracted from every index
+template <typename Layout, size_t Base, size_t... Dims>
+struct fixed_offset;
+
+template <size_t Base, size_t D0>
+struct fixed_offset<FixedLayoutC, Base, D0> {
+    MATAR_INLINE_FUNCTION
+    static constexpr size_t get(size_t i) {
+        assert(i - Base < D0 && "index is out of bounds in a fixed size type!");
+        return i - Base;
+    }
+};
+
+template <size_t Base, size_t D0, size_t D1, size_t... Rest>
+struct fixed_offset<FixedLayoutC, Base, D0, D1, Rest...> {
+    template <typename... Is>
+    MATAR_INLINE_FUNCTION
+    static constexpr size_t get(size_t i, Is... rest) {
+        assert(i - Base < D0 && "index is out of bounds in a fixed size type!");
+        return (i - Base) * fixed_product<D1, Rest...>::value
+             + fixed_offset<FixedLayoutC, Base, D1, Rest...>::get(rest...);
+    }
+};
+
+template <size_t Base, size_t D0>
+struct fixed_offset<FixedLayoutF, Base, D0> {
+    MATAR_INLINE_FUNCTION
+    static constexpr size_t get(size_t i) {
+        assert(i - Base < D0 && "index is out of bounds in a fixed size type!");
+        return i - Base;
+    }
+};
+
+template <size_t Base, size_t D0, size_t D1, size_t... Rest>
+struct fixed_offset<FixedLayoutF, Base, D0, D1, Rest...> {
+    template <typename... Is>
+    MATAR_INLINE_FUNCTION
+    static constexpr size_t get(size_t i, Is... rest) {
+        assert(i - Base < D0 && "index is out of bounds in a fixed size type!");
+        return (i - Base) + D0 * fixed_offset<FixedLayoutF, Base, D1, Rest...>::get(rest...);
+    }
+};
+
+// extent of dimension i (0 based)
+template <size_t... Dims>
+struct fixed_dim;
+
+template <>
+struct fixed_dim<> {
+    MATAR_INLINE_FUNCTION
+    static constexpr size_t get(size_t) { return 0; }
+};
+
+template <size_t D0, size_t... Rest>
+struct fixed_dim<D0, Rest...> {
+    MATAR_INLINE_FUNCTION
+    static constexpr size_t get(size_t i) { return i == 0 ? D0 : fixed_dim<Rest...>::get(i - 1); }
+};
+
+
+/////////////////////////
+// FixedArray: shared implementation of the fixed size types, use the
+// CArrayFixed, FArrayFixed, CMatrixFixed and FMatrixFixed names below
+/////////////////////////
+template <typename T, typename Layout, size_t Base, size_t... Dims>
+class FixedArray {
+
+    static_assert(sizeof...(Dims) >= 1 && sizeof...(Dims) <= 7,
+                  "Fixed size types must have an order (rank) between 1 and 7!");
+    static_assert(fixed_product<Dims...>::value > 0, "Fixed size types can not have a zero extent!");
+
+private:
+    T array_[fixed_product<Dims...>::value];
+
+public:
+    // Number of elements and order (rank), usable as compile time constants
+    static constexpr size_t length = fixed_product<Dims...>::value;
+    static constexpr size_t rank   = sizeof...(Dims);
+
+    // Default constructor, the data is left uninitialized
+    FixedArray() = default;
+
+    // Index access, one index per dimension starting at Base
+    template <typename... Is>
+    MATAR_INLINE_FUNCTION
+    T& operator()(Is... idx);
+
+    template <typename... Is>
+    MATAR_INLINE_FUNCTION
+    const T& operator()(Is... idx) const;
+
+    // Flat access
+    MATAR_INLINE_FUNCTION
+    T& operator[](size_t i);
+
+    MATAR_INLINE_FUNCTION
+    const T& operator[](size_t i) const;
+
+    // Set every entry to val
+    MATAR_INLINE_FUNCTION
+    void set_values(T val);
+
+    // Extent of dimension i, i starts at Base like the indices
+    MATAR_INLINE_FUNCTION
+    static constexpr size_t dims(size_t i);
+
+    // Distance in elements between neighbours along dimension i
+    MATAR_INLINE_FUNCTION
+    static constexpr size_t stride(size_t i);
+
+    MATAR_INLINE_FUNCTION
+    static constexpr size_t size();
+
+    MATAR_INLINE_FUNCTION
+    static constexpr size_t order();
+
+    MATAR_INLINE_FUNCTION
+    T* pointer();
+
+    MATAR_INLINE_FUNCTION
+    const T* pointer() const;
+}; // End of FixedArray
+
+template <typename T, typename Layout, size_t Base, size_t... Dims>
+template <typename... Is>
+MATAR_INLINE_FUNCTION
+T& FixedArray<T, Layout, Base, Dims...>::operator()(Is... idx) {
+    static_assert(sizeof...(Is) == sizeof...(Dims), "Fixed size type indexed with the wrong number of indices!");
+    return array_[fixed_offset<Layout, Base, Dims...>::get(static_cast<size_t>(idx)...)];
+}
+
+template <typename T, typename Layout, size_t Base, size_t... Dims>
+template <typename... Is>
+MATAR_INLINE_FUNCTION
+const T& FixedArray<T, Layout, Base, Dims...>::operator()(Is... idx) const {
+    static_assert(sizeof...(Is) == sizeof...(Dims), "Fixed size type indexed with the wrong number of indices!");
+    return array_[fixed_offset<Layout, Base, Dims...>::get(static_cast<size_t>(idx)...)];
+}
+
+template <typename T, typename Layout, size_t Base, size_t... Dims>
+MATAR_INLINE_FUNCTION
+T& FixedArray<T, Layout, Base, Dims...>::operator[](size_t i) {
+    assert(i < length && "i is out of bounds in a fixed size type!");
+    return array_[i];
+}
+
+template <typename T, typename Layout, size_t Base, size_t... Dims>
+MATAR_INLINE_FUNCTION
+const T& FixedArray<T, Layout, Base, Dims...>::operator[](size_t i) const {
+    assert(i < length && "i is out of bounds in a fixed size type!");
+    return array_[i];
+}
+
+template <typename T, typename Layout, size_t Base, size_t... Dims>
+MATAR_INLINE_FUNCTION
+void FixedArray<T, Layout, Base, Dims...>::set_values(T val) {
+    for (size_t i = 0; i < length; i++) {
+        array_[i] = val;
+    }
+}
+
+template <typename T, typename Layout, size_t Base, size_t... Dims>
+MATAR_INLINE_FUNCTION
+constexpr size_t FixedArray<T, Layout, Base, Dims...>::dims(size_t i) {
+    return fixed_dim<Dims...>::get(i - Base);
+}
+
+template <typename T, typename Layout, size_t Base, size_t... Dims>
+MATAR_INLINE_FUNCTION
+constexpr size_t FixedArray<T, Layout, Base, Dims...>::stride(size_t i) {
+    size_t result = 1;
+    if (std::is_same<Layout, FixedLayoutC>::value) {
+        for (size_t j = i - Base + 1; j < rank; j++) result *= fixed_dim<Dims...>::get(j);
+    }
+    else {
+        for (size_t j = 0; j < i - Base; j++) result *= fixed_dim<Dims...>::get(j);
+    }
+    return result;
+}
+
+template <typename T, typename Layout, size_t Base, size_t... Dims>
+MATAR_INLINE_FUNCTION
+constexpr size_t FixedArray<T, Layout, Base, Dims...>::size() {
+    return length;
+}
+
+template <typename T, typename Layout, size_t Base, size_t... Dims>
+MATAR_INLINE_FUNCTION
+constexpr size_t FixedArray<T, Layout, Base, Dims...>::order() {
+    return rank;
+}
+
+template <typename T, typename Layout, size_t Base, size_t... Dims>
+MATAR_INLINE_FUNCTION
+T* FixedArray<T, Layout, Base, Dims...>::pointer() {
+    return array_;
+}
+
+template <typename T, typename Layout, size_t Base, size_t... Dims>
+MATAR_INLINE_FUNCTION
+const T* FixedArray<T, Layout, Base, Dims...>::pointer() const {
+    return array_;
+}
+
+// C order, indices start at 0
+template <typename T, size_t... Dims>
+using CArrayFixed = FixedArray<T, FixedLayoutC, 0, Dims...>;
+
+// F order, indices start at 0
+template <typename T, size_t... Dims>
+using FArrayFixed = FixedArray<T, FixedLayoutF, 0, Dims...>;
+
+// C order, indices start at 1
+template <typename T, size_t... Dims>
+using CMatrixFixed = FixedArray<T, FixedLayoutC, 1, Dims...>;
+
+// F order, indices start at 1
+template <typename T, size_t... Dims>
+using FMatrixFixed = FixedArray<T, FixedLayoutF, 1, Dims...>;
+
+} // end namespace
+
+#endif // FIXED_TYPES_H
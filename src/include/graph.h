@@ -0,0 +1,472 @@
+#ifndef GRAPH_H
+#define GRAPH_H
+/**********************************************************************************************
+ © 2020. Triad National Security, LLC. All rights reserved.
+ This program was produced under U.S. Government contract 89233218CNA000001 for Los Alamos
+ National Laboratory (LANL), which is operated by Triad National Security, LLC for the U.S.
+ Department of Energy/National Nuclear Security Administration. All rights in the program are
+ reserved by Triad National Security, LLC, and the U.S. Department of Energy/National Nuclear
+ Security Administration. The Government is granted for itself and others acting on its behalf a
+ nonexclusive, paid-up, irrevocable worldwide license in this material to reproduce, prepare
+ derivative works, distribute copies to the public, perform publicly and display publicly, and
+ to permit others to do so.
+ This program is open source under the BSD-3 License.
+ Redistribution and use in source and binary forms, with or without modification, are permitted
+ provided that the following conditions are met:
+ 
+ 1.  Redistributions of source code must retain the above copyright notice, this list of
+ conditions and the following disclaimer.
+ 
+ 2.  Redistributions in binary form must reproduce the above copyright notice, this list of
+ conditions and the following disclaimer in the documentation and/or other materials
+ provided with the distribution.
+ 
+ 3.  Neither the name of the copyright holder nor the names of its contributors may be used
+ to endorse or promote products derived from this software without specific prior
+ written permission.
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+ IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **********************************************************************************************/
+#include <cstdint>
+#include <map>
+#include <string>
+
+#include "host_types.h"
+#include "kokkos_types.h"
+#include "profile.h"
+
+
+// -----------------------------------------
+// Graph algorithms on a CSRArrayKokkos adjacency
+//
+// Row v of the matrix lists the neighbors of vertex v, the values are not
+// used. The graph is undirected, so the pattern has to be symmetric, which
+// SparseAssembler gives by adding every edge both ways. Self loops are
+// ignored.
+//
+//   CArrayKokkos<int> distance(num_nodes);
+//   GraphBFSResult bfs = graph_bfs(graph, source, distance);   // -1 when unreached
+//
+//   CArrayKokkos<size_t> component(num_nodes);
+//   size_t num_components = graph_components(graph, component);
+//
+// Coloring the element graph (elements that share a node are neighbors)
+// lets an assembly loop run one color at a time without atomics:
+//
+//   GraphColoring coloring = graph_color(elem_graph);
+//   for (size_t c = 0; c < coloring.num_colors; c++) {
+//       FOR_ALL(k, coloring.color_start.host(c), coloring.color_start.host(c + 1), {
+//           const size_t elem = coloring.vertices(k);
+//           ... scatter to the nodes of elem, no two elements share a node
+//       });
+//   }
+//
+// graph_color(graph, 2) gives a distance-2 coloring, where vertices two
+// edges apart also get different colors.
+//
+// distance, component and the coloring arrays use the Layout and ExecSpace
+// of the graph, GraphColoring is the coloring of the default ones.
+// -----------------------------------------
+
+namespace mtr
+{
+
+#ifdef HAVE_KOKKOS
+
+/////////////////////////
+// Breadth first search
+/////////////////////////
+struct GraphBFSOptions {
+    bool   direction_optimizing = true;  // false keeps every level top-down
+    double alpha = 15.0;                 // bottom-up once the frontier edges pass unvisited edges / alpha
+    double beta  = 18.0;                 // back to top-down once the frontier is below vertices / beta
+};
+
+struct GraphBFSResult {
+    size_t reached = 0;          // vertices with a distance, the source included
+    size_t levels  = 0;          // largest distance + 1
+    size_t top_down_steps  = 0;
+    size_t bottom_up_steps = 0;
+};
+
+// Direction optimizing BFS. Levels with a small frontier expand it top-down
+// with an atomic claim of every neighbor, levels with a large frontier let
+// every unvisited vertex look for a parent in the frontier instead.
+template <typename T, typename Layout, typename ExecSpace, typename MemoryTraits>
+GraphBFSResult graph_bfs(const CSRArrayKokkos<T, Layout, ExecSpace, MemoryTraits>& graph,
+                         size_t source,
+                         CArrayKokkos<int, Layout, ExecSpace>& distance,
+                         const GraphBFSOptions& options = GraphBFSOptions())
+{
+    MATAR_PROFILE_SCOPE("graph_bfs", ProfileCategory::compute);
+    const size_t n = graph.dim1();
+    assert(source < n && "source is out of bounds in graph_bfs!");
+    assert(distance.size() == n && "distance has the wrong size in graph_bfs!");
+
+    CArrayKokkos<size_t, Layout, ExecSpace> frontier(n, "bfs_frontier");
+    CArrayKokkos<size_t, Layout, ExecSpace> next(n, "bfs_next");
+    DCArrayKokkos<size_t, Layout, ExecSpace> count(1, "bfs_count");
+
+    size_t total_edges = 0;
+    size_t loc_edges;
+    FOR_REDUCE_SUM(v, 0, n, loc_edges, {
+        loc_edges += graph.stride(v);
+    }, total_edges);
+
+    distance.set_values(-1);
+    RUN({
+        distance(source) = 0;
+        frontier(0) = source;
+    });
+
+    GraphBFSResult result;
+    size_t num_frontier    = 1;
+    size_t frontier_edges  = 0;
+    size_t unvisited_edges = total_edges;
+    bool   bottom_up = false;
+    int    level = 0;
+
+    while (num_frontier > 0) {
+        result.reached += num_frontier;
+        result.levels++;
+
+        FOR_REDUCE_SUM(q, 0, num_frontier, loc_edges, {
+            loc_edges += graph.stride(frontier(q));
+        }, frontier_edges);
+        unvisited_edges -= frontier_edges;
+
+        if (options.direction_optimizing) {
+            if (!bottom_up && frontier_edges > unvisited_edges / options.alpha) {
+                bottom_up = true;
+            }
+            else if (bottom_up && num_frontier < n / options.beta) {
+                bottom_up = false;
+            }
+        }
+
+        if (bottom_up) {
+            result.bottom_up_steps++;
+            FOR_ALL(v, 0, n, {
+                if (distance(v) < 0) {
+                    for (size_t k = graph.begin_index(v); k < graph.end_index(v); k++) {
+                        if (distance(graph.get_col_flat(k)) == level) {
+                            distance(v) = level + 1;
+                            break;
+                        }
+                    }
+                }
+            });
+
+            // gather the new frontier in vertex order
+            Kokkos::parallel_scan("graph_bfs_frontier", Kokkos::RangePolicy<ExecSpace>(0, n), KOKKOS_LAMBDA(const int v, size_t& update, const bool final) {
+                if (distance(v) == level + 1) {
+                    if (final) {
+                        next(update) = v;
+                    }
+                    update++;
+                }
+            }, num_frontier);
+        }
+        else {
+            result.top_down_steps++;
+            count.set_values(0);
+            FOR_ALL(q, 0, num_frontier, {
+                const size_t u = frontier(q);
+                for (size_t k = graph.begin_index(u); k < graph.end_index(u); k++) {
+                    const size_t v = graph.get_col_flat(k);
+                    if (Kokkos::atomic_compare_exchange(&distance(v), -1, level + 1) == -1) {
+                        next(Kokkos::atomic_fetch_add(&count(0), size_t(1))) = v;
+                    }
+                }
+            });
+            count.update_host();
+            num_frontier = count.host(0);
+        }
+
+        CArrayKokkos<size_t, Layout, ExecSpace> swap = frontier;
+        frontier = next;
+        next     = swap;
+        level++;
+    }
+
+    return result;
+}
+
+// End of breadth first search
+
+/////////////////////////
+// Connected components
+/////////////////////////
+struct GraphComponentsOptions {
+    size_t neighbor_rounds = 2;      // neighbors linked before the largest component is found
+    size_t samples         = 1024;   // vertices sampled to find it
+};
+
+// Afforest: link the first few neighbors of every vertex, find the largest
+// component from a sample, then link the remaining edges of the vertices
+// outside it only. Links always hook the larger root under the smaller one,
+// so component(v) ends as the smallest vertex of v's component. Returns the
+// number of components.
+template <typename T, typename Layout, typename ExecSpace, typename MemoryTraits>
+size_t graph_components(const CSRArrayKokkos<T, Layout, ExecSpace, MemoryTraits>& graph,
+                        CArrayKokkos<size_t, Layout, ExecSpace>& component,
+                        const GraphComponentsOptions& options = GraphComponentsOptions())
+{
+    MATAR_PROFILE_SCOPE("graph_components", ProfileCategory::compute);
+    const size_t n = graph.dim1();
+    assert(component.size() == n && "component has the wrong size in graph_components!");
+
+    FOR_ALL(v, 0, n, {
+        component(v) = v;
+    });
+
+    // hook the root of the larger tree under the root of the smaller one
+    auto hook = [=] KOKKOS_FUNCTION (size_t u, size_t v) {
+        size_t p1 = component(u);
+        size_t p2 = component(v);
+        while (p1 != p2) {
+            const size_t high = p1 > p2 ? p1 : p2;
+            const size_t low  = p1 + p2 - high;
+            const size_t p_high = component(high);
+            if (p_high == low) {
+                break;
+            }
+            if (p_high == high && Kokkos::atomic_compare_exchange(&component(high), high, low) == high) {
+                break;
+            }
+            p1 = component(component(high));
+            p2 = component(low);
+        }
+    };
+
+    auto compress = [&]() {
+        FOR_ALL(v, 0, n, {
+            while (component(v) != component(component(v))) {
+                component(v) = component(component(v));
+            }
+        });
+    };
+
+    const size_t rounds = options.neighbor_rounds;
+    for (size_t r = 0; r < rounds; r++) {
+        FOR_ALL(v, 0, n, {
+            const size_t k = graph.begin_index(v) + r;
+            if (k < graph.end_index(v)) {
+                hook(v, graph.get_col_flat(k));
+            }
+        });
+        compress();
+    }
+
+    // largest component of an even sample
+    size_t largest = n;
+    if (rounds > 0 && n > 0) {
+        const size_t num_samples = options.samples < n ? options.samples : n;
+        DCArrayKokkos<size_t, Layout, ExecSpace> sample(num_samples > 0 ? num_samples : 1, "components_sample");
+        FOR_ALL(s, 0, num_samples, {
+            sample(s) = component((s * n) / num_samples);
+        });
+        sample.update_host();
+
+        std::map<size_t, size_t> frequency;
+        size_t most = 0;
+        for (size_t s = 0; s < num_samples; s++) {
+            const size_t times = ++frequency[sample.host(s)];
+            if (times > most) {
+                most    = times;
+                largest = sample.host(s);
+            }
+        }
+    }
+
+    FOR_ALL(v, 0, n, {
+        if (component(v) != largest) {
+            for (size_t k = graph.begin_index(v) + rounds; k < graph.end_index(v); k++) {
+                hook(v, graph.get_col_flat(k));
+            }
+        }
+    });
+    compress();
+
+    size_t num_components = 0;
+    size_t loc_components;
+    FOR_REDUCE_SUM(v, 0, n, loc_components, {
+        loc_components += (component(v) == size_t(v)) ? 1 : 0;
+    }, num_components);
+
+    return num_components;
+}
+
+// End of connected components
+
+/////////////////////////
+// Graph coloring
+/////////////////////////
+
+// calls visit(u) for the neighbors of v, and their neighbors when two_hop
+template <typename Graph, typename Visit>
+KOKKOS_INLINE_FUNCTION
+void graph_visit_neighbors(const Graph& graph, size_t v, bool two_hop, const Visit& visit)
+{
+    for (size_t k = graph.begin_index(v); k < graph.end_index(v); k++) {
+        const size_t u = graph.get_col_flat(k);
+        if (u == v) {
+            continue;
+        }
+        visit(u);
+        if (two_hop) {
+            for (size_t k2 = graph.begin_index(u); k2 < graph.end_index(u); k2++) {
+                const size_t w = graph.get_col_flat(k2);
+                if (w != v) {
+                    visit(w);
+                }
+            }
+        }
+    }
+}
+
+template <typename Layout = DefaultLayout, typename ExecSpace = DefaultExecSpace>
+struct GraphColoringT {
+    size_t num_colors = 0;
+    CArrayKokkos<int, Layout, ExecSpace>     color;        // color of every vertex, 0 to num_colors - 1
+    DCArrayKokkos<size_t, Layout, ExecSpace> color_start;  // vertices of color c are vertices(color_start(c)) up to color_start(c + 1)
+    CArrayKokkos<size_t, Layout, ExecSpace>  vertices;     // vertices grouped by color
+};
+
+using GraphColoring = GraphColoringT<>;
+
+// Speculative coloring: every uncolored vertex takes the smallest color its
+// neighbors do not have, then of two neighbors that took the same color the
+// larger one is uncolored again, until no conflicts remain. distance = 2
+// also keeps vertices with a common neighbor apart.
+template <typename T, typename Layout, typename ExecSpace, typename MemoryTraits>
+GraphColoringT<Layout, ExecSpace> graph_color(const CSRArrayKokkos<T, Layout, ExecSpace, MemoryTraits>& graph, int distance = 1)
+{
+    MATAR_PROFILE_SCOPE("graph_color", ProfileCategory::compute);
+    assert((distance == 1 || distance == 2) && "distance has to be 1 or 2 in graph_color!");
+    const size_t n = graph.dim1();
+    const bool two_hop = distance == 2;
+
+    GraphColoringT<Layout, ExecSpace> coloring;
+    if (n == 0) {
+        coloring.color_start = DCArrayKokkos<size_t, Layout, ExecSpace>(1, "color_start");
+        coloring.color_start.set_values(0);
+        coloring.color_start.update_host();
+        return coloring;
+    }
+
+    // colors count from 1 while coloring, 0 is uncolored
+    CArrayKokkos<int, Layout, ExecSpace> color(n, "graph_color");
+    CArrayKokkos<size_t, Layout, ExecSpace> work(n, "color_work");
+    CArrayKokkos<size_t, Layout, ExecSpace> redo(n, "color_redo");
+    DCArrayKokkos<size_t, Layout, ExecSpace> count(1, "color_count");
+
+    color.set_values(0);
+    FOR_ALL(v, 0, n, {
+        work(v) = v;
+    });
+
+    size_t num_work = n;
+    while (num_work > 0) {
+
+        // smallest free color, searched 64 colors at a time
+        FOR_ALL(q, 0, num_work, {
+            const size_t v = work(q);
+            for (int base = 0; ; base += 64) {
+                uint64_t used = 0;
+                graph_visit_neighbors(graph, v, two_hop, [&](size_t u) {
+                    const int c = color(u) - 1 - base;
+                    if (c >= 0 && c < 64) {
+                        used |= uint64_t(1) << c;
+                    }
+                });
+                if (used != ~uint64_t(0)) {
+                    int bit = 0;
+                    while (used & (uint64_t(1) << bit)) {
+                        bit++;
+                    }
+                    color(v) = base + bit + 1;
+                    break;
+                }
+            }
+        });
+
+        // the larger vertex of a conflict is colored again
+        count.set_values(0);
+        FOR_ALL(q, 0, num_work, {
+            const size_t v = work(q);
+            bool conflict = false;
+            graph_visit_neighbors(graph, v, two_hop, [&](size_t u) {
+                if (u < v && color(u) == color(v)) {
+                    conflict = true;
+                }
+            });
+            if (conflict) {
+                redo(Kokkos::atomic_fetch_add(&count(0), size_t(1))) = v;
+            }
+        });
+        count.update_host();
+        num_work = count.host(0);
+
+        FOR_ALL(q, 0, num_work, {
+            color(redo(q)) = 0;
+        });
+
+        CArrayKokkos<size_t, Layout, ExecSpace> swap = work;
+        work = redo;
+        redo = swap;
+    }
+
+    int max_color = 0;
+    int loc_max;
+    FOR_REDUCE_MAX(v, 0, n, loc_max, {
+        loc_max = color(v) > loc_max ? color(v) : loc_max;
+    }, max_color);
+    coloring.num_colors = max_color;
+
+    // group the vertices by color
+    const size_t num_colors = coloring.num_colors;
+    DCArrayKokkos<size_t, Layout, ExecSpace> color_start(num_colors + 1, "color_start");
+    CArrayKokkos<size_t, Layout, ExecSpace> fill(num_colors, "color_fill");
+    CArrayKokkos<size_t, Layout, ExecSpace> vertices(n, "color_vertices");
+    color_start.set_values(0);
+    FOR_ALL(v, 0, n, {
+        color(v) -= 1;
+        Kokkos::atomic_add(&color_start(color(v) + 1), size_t(1));
+    });
+    Kokkos::parallel_scan("graph_color_start", Kokkos::RangePolicy<ExecSpace>(0, num_colors + 1), KOKKOS_LAMBDA(const int c, size_t& update, const bool final) {
+        update += color_start(c);
+        if (final) {
+            color_start(c) = update;
+        }
+    });
+    FOR_ALL(c, 0, num_colors, {
+        fill(c) = color_start(c);
+    });
+    FOR_ALL(v, 0, n, {
+        vertices(Kokkos::atomic_fetch_add(&fill(color(v)), size_t(1))) = v;
+    });
+    color_start.update_host();
+
+    coloring.color       = color;
+    coloring.color_start = color_start;
+    coloring.vertices    = vertices;
+    return coloring;
+}
+
+// End of graph coloring
+
+#endif // HAVE_KOKKOS
+
+} // end namespace mtr
+
+#endif // GRAPH_H
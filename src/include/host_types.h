@@ -38,9 +38,22 @@
  **********************************************************************************************/
 #include <stdio.h>
 #include <stdlib.h>
+#include <cstdlib>
 #include <string>
 #include <cassert>
 #include <memory> // for shared_ptr
+#include <new>
+#include <stdexcept>
+#include <tuple>
+#include <type_traits>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h> // for mmap and madvise
+#include <sys/stat.h>
+#include <unistd.h>
+#define MATAR_HAVE_MMAP
+#endif
 
 //To disable asserts, uncomment the following line
 //#define NDEBUG
@@ -49,6 +62,278 @@
 namespace mtr
 {
 
+//---Host Memory Allocation---
+
+// Policy used by every host type when it allocates memory. Set the fields
+// once at start up, e.g.
+//
+//   mtr::host_alloc_policy().first_touch = true; // run with OMP_PROC_BIND
+//
+// alignment   : byte alignment of the data, a power of 2 (64 is a cache line)
+// huge_pages  : ask the kernel for transparent huge pages (Linux), large
+//               allocations are then aligned to 2 MB
+// first_touch : initialize the data with a static OpenMP loop so each page is
+//               placed on the NUMA domain of the thread that will use it in a
+//               loop with the same static schedule. Without OpenMP the data is
+//               left as new T[] would leave it.
+struct HostAllocPolicy {
+    size_t alignment   = 64;
+    bool   huge_pages  = false;
+    bool   first_touch = false;
+};
+
+inline HostAllocPolicy& host_alloc_policy() {
+    static HostAllocPolicy policy;
+    return policy;
+}
+
+// allocate length entries of type T following host_alloc_policy()
+template <typename T>
+std::shared_ptr <T[]> host_allocate(size_t length) {
+    const HostAllocPolicy& policy = host_alloc_policy();
+    const size_t huge_page = 2 * 1024 * 1024;
+
+    size_t alignment = policy.alignment < alignof(T) ? alignof(T) : policy.alignment;
+    size_t bytes     = (length > 0 ? length : 1) * sizeof(T);
+    if (policy.huge_pages && bytes >= huge_page) {
+        alignment = huge_page;
+    }
+    assert((alignment & (alignment - 1)) == 0 && "host_alloc_policy().alignment must be a power of 2!");
+
+    // aligned_alloc wants the size to be a multiple of the alignment
+    bytes = ((bytes + alignment - 1) / alignment) * alignment;
+    T* data = static_cast<T*>(std::aligned_alloc(alignment, bytes));
+    if (data == nullptr) {
+        throw std::bad_alloc();
+    }
+
+#ifdef __linux__
+    if (policy.huge_pages && alignment == huge_page) {
+        madvise(data, bytes, MADV_HUGEPAGE);
+    }
+#endif
+
+#ifdef _OPENMP
+    const bool first_touch = policy.first_touch;
+#else
+    const bool first_touch = false;
+#endif
+
+    // construct the entries, in parallel for first touch placement
+    if (first_touch || !std::is_trivially_default_constructible<T>::value) {
+#ifdef _OPENMP
+        #pragma omp parallel for schedule(static) if(first_touch)
+#endif
+        for (long long i = 0; i < (long long)length; i++) {
+            if (std::is_trivially_default_constructible<T>::value) {
+                new (data + i) T();  // zero, the write places the page
+            }
+            else {
+                new (data + i) T;
+            }
+        }
+    }
+
+    return std::shared_ptr <T[]> (data, [length](T* ptr) {
+        if (!std::is_trivially_destructible<T>::value) {
+            for (size_t i = 0; i < length; i++) {
+                ptr[i].~T();
+            }
+        }
+        std::free(ptr);
+    });
+}
+
+
+//---Memory-Mapped Files---
+
+// File backing for the host CArray and FArray, for arrays larger than memory.
+// The array is mapped with mmap and pages are read and written by the kernel
+// as they are used, e.g.
+//
+//   CArray<double> rho(MappedFile("rho.bin", MapMode::create), 1000, 1000, 100000);
+//
+//   FOR_ALL_STREAM(i, 0, rho.dims(0), 10, (rho), {
+//       ...                                  // rho(i, j, k), one slab of i at a time
+//   });
+//
+// read_only    : map an existing file, the array must not be written
+// read_write   : map an existing file, writes go to the file
+// create       : create or grow the file to fit the array, writes go to the file
+// private_copy : map an existing file copy on write, the file is not changed
+enum class MapMode { read_only, read_write, create, private_copy };
+
+// expected access pattern, given to the kernel with madvise
+enum class MapAdvice { normal, sequential, random };
+
+struct MappedFile {
+    std::string file_name;
+    MapMode     mode   = MapMode::read_only;
+    size_t      offset = 0;  // bytes before the array in the file, a multiple of the page size
+    MapAdvice   advice = MapAdvice::normal;
+
+    MappedFile(const std::string& name,
+               MapMode map_mode = MapMode::read_only,
+               size_t byte_offset = 0,
+               MapAdvice map_advice = MapAdvice::normal)
+        : file_name(name), mode(map_mode), offset(byte_offset), advice(map_advice) {}
+};
+
+// deleter of a mapped array, it also tells the array that it is mapped
+struct HostMapping {
+    void*   base  = nullptr;
+    size_t  bytes = 0;
+    MapMode mode  = MapMode::read_only;
+
+    template <typename T>
+    void operator()(T*) const {
+#ifdef MATAR_HAVE_MMAP
+        if (base != nullptr) {
+            munmap(base, bytes);
+        }
+#endif
+    }
+};
+
+// map length entries of type T from a file
+template <typename T>
+std::shared_ptr <T[]> host_map_file(const MappedFile& file, size_t length) {
+    static_assert(std::is_trivially_copyable<T>::value, "mapped arrays need trivially copyable types!");
+#ifdef MATAR_HAVE_MMAP
+    const size_t page = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    assert(file.offset % page == 0 && "MappedFile offset must be a multiple of the page size!");
+
+    const size_t bytes = (length > 0 ? length : 1) * sizeof(T);
+    const bool writable = file.mode == MapMode::read_write || file.mode == MapMode::create;
+
+    int flags = writable ? O_RDWR : O_RDONLY;
+    if (file.mode == MapMode::create) {
+        flags |= O_CREAT;
+    }
+    int fd = ::open(file.file_name.c_str(), flags, 0644);
+    if (fd < 0) {
+        throw std::runtime_error("could not open " + file.file_name + " to map an array");
+    }
+
+    // a created file is grown with holes, the disk is only used as pages are written
+    struct stat info;
+    fstat(fd, &info);
+    if (static_cast<size_t>(info.st_size) < file.offset + bytes) {
+        if (file.mode != MapMode::create || ftruncate(fd, static_cast<off_t>(file.offset + bytes)) != 0) {
+            ::close(fd);
+            throw std::runtime_error(file.file_name + " is too small for the mapped array");
+        }
+    }
+
+    const int protection = file.mode == MapMode::read_only ? PROT_READ : PROT_READ | PROT_WRITE;
+    const int sharing    = file.mode == MapMode::private_copy ? MAP_PRIVATE : MAP_SHARED;
+    void* base = mmap(nullptr, bytes, protection, sharing, fd, static_cast<off_t>(file.offset));
+    ::close(fd);
+    if (base == MAP_FAILED) {
+        throw std::runtime_error("could not map " + file.file_name);
+    }
+
+    if (file.advice == MapAdvice::sequential) {
+        madvise(base, bytes, MADV_SEQUENTIAL);
+    }
+    else if (file.advice == MapAdvice::random) {
+        madvise(base, bytes, MADV_RANDOM);
+    }
+
+    return std::shared_ptr <T[]> (static_cast<T*>(base), HostMapping{base, bytes, file.mode});
+#else
+    throw std::runtime_error("mapped arrays need mmap, which is not available");
+#endif
+}
+
+enum class MapHint { will_need, dont_need, flush };
+
+// madvise or msync entries [begin, end) of a mapped array, nothing for
+// arrays on the heap
+template <typename T>
+void host_map_hint(const std::shared_ptr <T[]>& data, size_t begin, size_t end, MapHint hint) {
+#ifdef MATAR_HAVE_MMAP
+    const HostMapping* mapping = std::get_deleter<HostMapping>(data);
+    if (mapping == nullptr || begin >= end) {
+        return;
+    }
+
+    // widen to whole pages, the pages are shared with the neighbors
+    const uintptr_t page  = static_cast<uintptr_t>(sysconf(_SC_PAGESIZE));
+    const uintptr_t base  = reinterpret_cast<uintptr_t>(mapping->base);
+    uintptr_t first = (reinterpret_cast<uintptr_t>(data.get() + begin) / page) * page;
+    uintptr_t last  = reinterpret_cast<uintptr_t>(data.get() + end);
+    if (last > base + mapping->bytes) {
+        last = base + mapping->bytes;
+    }
+    if (first < base) {
+        first = base;
+    }
+    void*  address = reinterpret_cast<void*>(first);
+    size_t bytes   = last - first;
+
+    switch (hint) {
+        case MapHint::will_need:
+            madvise(address, bytes, MADV_WILLNEED);
+            break;
+        case MapHint::dont_need:
+            // written pages of a shared mapping stay in the page cache until
+            // they are written back, a private copy would lose them
+            if (mapping->mode != MapMode::private_copy) {
+                madvise(address, bytes, MADV_DONTNEED);
+            }
+            break;
+        case MapHint::flush:
+            if (mapping->mode == MapMode::read_write || mapping->mode == MapMode::create) {
+                msync(address, bytes, MS_SYNC);
+            }
+            break;
+    }
+#endif
+}
+
+template <typename T>
+bool host_is_mapped(const std::shared_ptr <T[]>& data) {
+    return std::get_deleter<HostMapping>(data) != nullptr;
+}
+
+
+//---Sub-Views---
+
+// Index range [begin, end) with a step for subview(), e.g.
+//
+//   A.subview(i, Range{}, Range{2, 6})   // A(i, :, 2:6) of a 3D array
+//   A.subview(Range{0, 10, 2}, j)        // every other entry of column j
+//
+// Range{} is the whole dimension, an end past the dimension is clipped
+struct Range {
+    size_t begin = 0;
+    size_t end   = static_cast<size_t>(-1);
+    size_t step  = 1;
+};
+
+// build a view type from a pointer and order dims, used by slice()
+template <typename View, typename T>
+View view_from_dims(T* array, const size_t* dims, size_t order) {
+    switch (order) {
+        case 1:  return View(array, dims[0]);
+        case 2:  return View(array, dims[0], dims[1]);
+        case 3:  return View(array, dims[0], dims[1], dims[2]);
+        case 4:  return View(array, dims[0], dims[1], dims[2], dims[3]);
+        case 5:  return View(array, dims[0], dims[1], dims[2], dims[3], dims[4]);
+        case 6:  return View(array, dims[0], dims[1], dims[2], dims[3], dims[4], dims[5]);
+        default: return View(array, dims[0], dims[1], dims[2], dims[3], dims[4], dims[5], dims[6]);
+    }
+}
+
+template <typename T>
+class ViewFArray;
+
+template <typename T>
+class ViewCArray;
+
+template <typename T>
+class ViewStridedArray;
 
 //---Begin Standard Data Structures---
 
@@ -105,6 +390,10 @@ public:
           size_t dim5,
           size_t dim6);
 
+    // file backed array, 1D to 7D
+    template <typename... Dims>
+    FArray(const MappedFile& file, Dims... dims);
+
     FArray (const FArray& temp);
     
     // overload operator() to access data as array(i,....,n);
@@ -157,9 +446,28 @@ public:
     //return pointer
     T* pointer() const;
 
+    // slice fixing the last index, a contiguous view of order()-1
+    ViewFArray<T> slice(size_t i) const;
+
+    // strided view of part of the array, one index or Range per dimension
+    template <typename... Args>
+    ViewStridedArray<T> subview(Args... args) const;
+
     // set values to input
     void set_values(T val);
     
+    // for a file backed array, hint that entries [begin, end) of the 1D
+    // storage will be used soon, or are done with and can leave memory
+    void prefetch(size_t begin, size_t end) const;
+
+    void release(size_t begin, size_t end) const;
+
+    // write the changes of a file backed array to the file
+    void flush() const;
+
+    // true when the array is backed by a file
+    bool is_mapped() const;
+
     // deconstructor
     ~FArray ();
     
@@ -184,7 +492,7 @@ FArray<T>::FArray(size_t dim0)
     dims_[0] = dim0;
     length_ = dim0;
     order_ = 1;
-    array_ = std::shared_ptr <T []> (new T[length_]);
+    array_ = host_allocate<T>(length_);
 }
 
 template <typename T>
@@ -195,7 +503,7 @@ FArray<T>::FArray(size_t dim0,
     dims_[1] = dim1;
     order_ = 2;
     length_ = dim0*dim1;
-    array_ = std::shared_ptr <T []> (new T[length_]);
+    array_ = host_allocate<T>(length_);
 }
 
 //3D
@@ -209,7 +517,7 @@ FArray<T>::FArray(size_t dim0,
     dims_[2] = dim2;
     order_ = 3;
     length_ = dim0*dim1*dim2;
-    array_ = std::shared_ptr <T []> (new T[length_]);
+    array_ = host_allocate<T>(length_);
 }
 
 //4D
@@ -225,7 +533,7 @@ FArray<T>::FArray(size_t dim0,
     dims_[3] = dim3;
     order_ = 4;
     length_ = dim0*dim1*dim2*dim3;
-    array_ = std::shared_ptr <T []> (new T[length_]);
+    array_ = host_allocate<T>(length_);
 }
 
 //5D
@@ -243,7 +551,7 @@ FArray<T>::FArray(size_t dim0,
     dims_[4] = dim4;
     order_ = 5;
     length_ = dim0*dim1*dim2*dim3*dim4;
-    array_ = std::shared_ptr <T []> (new T[length_]);
+    array_ = host_allocate<T>(length_);
 }
 
 //6D
@@ -263,7 +571,7 @@ FArray<T>::FArray(size_t dim0,
     dims_[5] = dim5;
     order_ = 6;
     length_ = dim0*dim1*dim2*dim3*dim4*dim5;
-    array_ = std::shared_ptr <T []> (new T[length_]);
+    array_ = host_allocate<T>(length_);
 }
 
 
@@ -286,10 +594,26 @@ FArray<T>::FArray(size_t dim0,
     dims_[6] = dim6;
     order_ = 7;
     length_ = dim0*dim1*dim2*dim3*dim4*dim5*dim6;
-    array_ = std::shared_ptr <T []> (new T[length_]);
+    array_ = host_allocate<T>(length_);
         
 }
 
+// file backed constructor
+template <typename T>
+template <typename... Dims>
+FArray<T>::FArray(const MappedFile& file, Dims... dims)
+{
+    static_assert(sizeof...(Dims) >= 1 && sizeof...(Dims) <= 7, "FArray has an order (rank) of 1 to 7!");
+    const size_t list[] = {static_cast<size_t>(dims)...};
+    order_ = sizeof...(Dims);
+    length_ = 1;
+    for (size_t i = 0; i < order_; i++) {
+        dims_[i] = list[i];
+        length_ *= list[i];
+    }
+    array_ = host_map_file<T>(file, length_);
+}
+
 //Copy constructor
 
 template <typename T>
@@ -481,10 +805,46 @@ void FArray<T>::set_values(T val) {
 }
 
 
+template <typename T>
+void FArray<T>::prefetch(size_t begin, size_t end) const {
+    assert(end <= length_ && "end is out of bounds in FArray prefetch!");
+    host_map_hint(array_, begin, end, MapHint::will_need);
+}
+
+template <typename T>
+void FArray<T>::release(size_t begin, size_t end) const {
+    assert(end <= length_ && "end is out of bounds in FArray release!");
+    host_map_hint(array_, begin, end, MapHint::dont_need);
+}
+
+template <typename T>
+void FArray<T>::flush() const {
+    host_map_hint(array_, 0, length_, MapHint::flush);
+}
+
+template <typename T>
+bool FArray<T>::is_mapped() const {
+    return host_is_mapped(array_);
+}
+
 //delete FArray
 template <typename T>
 FArray<T>::~FArray(){}
 
+// slice of the last index
+template <typename T>
+ViewFArray<T> FArray<T>::slice(size_t i) const {
+    assert(order_ > 1 && "slice needs an order (rank) of 2 or more in FArray!");
+    assert(i < dims_[order_ - 1] && "i is out of bounds in FArray slice!");
+    return view_from_dims<ViewFArray<T>>(array_.get() + i * (length_ / dims_[order_ - 1]), dims_, order_ - 1);
+}
+
+template <typename T>
+template <typename... Args>
+ViewStridedArray<T> FArray<T>::subview(Args... args) const {
+    return ViewStridedArray<T>(array_.get(), dims_, order_, true).subview(args...);
+}
+
 //---end of FArray class definitions----
 
 
@@ -600,6 +960,13 @@ public:
 
     // return pointer
     T* pointer() const;
+
+    // slice fixing the last index, a contiguous view of order()-1
+    ViewFArray<T> slice(size_t i) const;
+
+    // strided view of part of the array, one index or Range per dimension
+    template <typename... Args>
+    ViewStridedArray<T> subview(Args... args) const;
     
 }; // end of viewFArray
 
@@ -896,6 +1263,20 @@ void ViewFArray<T>::set_values(T val) {
     }
 }
 
+// slice of the last index
+template <typename T>
+ViewFArray<T> ViewFArray<T>::slice(size_t i) const {
+    assert(order_ > 1 && "slice needs an order (rank) of 2 or more in ViewFArray!");
+    assert(i < dims_[order_ - 1] && "i is out of bounds in ViewFArray slice!");
+    return view_from_dims<ViewFArray<T>>(array_ + i * (length_ / dims_[order_ - 1]), dims_, order_ - 1);
+}
+
+template <typename T>
+template <typename... Args>
+ViewStridedArray<T> ViewFArray<T>::subview(Args... args) const {
+    return ViewStridedArray<T>(array_, dims_, order_, true).subview(args...);
+}
+
 //---end of ViewFArray class definitions---
 
 
@@ -1029,7 +1410,7 @@ FMatrix<T>::FMatrix(size_t dim1)
     dims_[0] = dim1;
     order_ = 1;
     length_ = dim1;
-    matrix_ = std::shared_ptr <T []> (new T[length_]);
+    matrix_ = host_allocate<T>(length_);
 }
 
 //2D
@@ -1041,7 +1422,7 @@ FMatrix<T>::FMatrix(size_t dim1,
     dims_[1] = dim2;
     order_ = 2;
     length_ = dim1 * dim2;
-    matrix_ = std::shared_ptr <T []> (new T[length_]);
+    matrix_ = host_allocate<T>(length_);
 }
 
 //3D
@@ -1055,7 +1436,7 @@ FMatrix<T>::FMatrix(size_t dim1,
     dims_[2] = dim3;
     order_ = 3;
     length_ = dim1 * dim2 * dim3;
-    matrix_ = std::shared_ptr <T []> (new T[length_]);
+    matrix_ = host_allocate<T>(length_);
 }
 
 //4D
@@ -1071,7 +1452,7 @@ FMatrix<T>::FMatrix(size_t dim1,
     dims_[3] = dim4;
     order_ = 4;
     length_ = dim1 * dim2 * dim3 * dim4;
-    matrix_ = std::shared_ptr <T []> (new T[length_]);
+    matrix_ = host_allocate<T>(length_);
 }
 
 //5D
@@ -1089,7 +1470,7 @@ FMatrix<T>::FMatrix(size_t dim1,
     dims_[4] = dim5;
     order_ = 5;
     length_ = dim1 * dim2 * dim3 * dim4 * dim5;
-    matrix_ = std::shared_ptr <T []> (new T[length_]);
+    matrix_ = host_allocate<T>(length_);
 }
 
 //6D
@@ -1109,7 +1490,7 @@ FMatrix<T>::FMatrix(size_t dim1,
     dims_[5] = dim6;
     order_ = 6;
     length_ = dim1 * dim2 * dim3 * dim4 * dim5 * dim6;
-    matrix_ = std::shared_ptr <T []> (new T[length_]);
+    matrix_ = host_allocate<T>(length_);
 
 }
 
@@ -1131,7 +1512,7 @@ FMatrix<T>::FMatrix(size_t dim1,
     dims_[6] = dim7;
     order_ = 7;
     length_ = dim1 * dim2 * dim3 * dim4 * dim5 * dim6 * dim7;
-    matrix_ = std::shared_ptr <T []> (new T[length_]);
+    matrix_ = host_allocate<T>(length_);
     
 }
 
@@ -1720,6 +2101,11 @@ inline size_t ViewFMatrix<T>::dims(size_t i) const {
     return dims_[i];
 }
 
+template <typename T>
+inline size_t ViewFMatrix<T>::size() const {
+    return length_;
+}
+
 template <typename T>
 inline size_t ViewFMatrix<T>::order() const {
     return order_;
@@ -1791,6 +2177,10 @@ public:
             size_t dim4,
             size_t dim5,
             size_t dim6);
+
+    // file backed array, 1D to 7D
+    template <typename... Dims>
+    CArray (const MappedFile& file, Dims... dims);
     
     CArray (const CArray& temp);
     
@@ -1845,9 +2235,28 @@ public:
     //return pointer
     T* pointer() const;
 
+    // slice fixing the first index, a contiguous view of order()-1
+    ViewCArray<T> slice(size_t i) const;
+
+    // strided view of part of the array, one index or Range per dimension
+    template <typename... Args>
+    ViewStridedArray<T> subview(Args... args) const;
+
     // set values to input
     void set_values(T val);
 
+    // for a file backed array, hint that entries [begin, end) of the 1D
+    // storage will be used soon, or are done with and can leave memory
+    void prefetch(size_t begin, size_t end) const;
+
+    void release(size_t begin, size_t end) const;
+
+    // write the changes of a file backed array to the file
+    void flush() const;
+
+    // true when the array is backed by a file
+    bool is_mapped() const;
+
     // Deconstructor
     ~CArray ();
 
@@ -1874,7 +2283,7 @@ CArray<T>::CArray(size_t dim0)
     dims_[0] = dim0;
     order_ = 1;
     length_ = dim0;
-    array_ = std::shared_ptr <T[]> (new T[length_]);
+    array_ = host_allocate<T>(length_);
 }
 
 //2D
@@ -1886,7 +2295,7 @@ CArray<T>::CArray(size_t dim0,
     dims_[1] = dim1;
     order_ = 2;
     length_ = dim0 * dim1;
-    array_ = std::shared_ptr <T[]> (new T[length_]);
+    array_ = host_allocate<T>(length_);
 }
 
 //3D
@@ -1900,7 +2309,7 @@ CArray<T>::CArray(size_t dim0,
     dims_[2] = dim2;
     order_ = 3;
     length_ = dim0 * dim1 * dim2;
-    array_ = std::shared_ptr <T[]> (new T[length_]);
+    array_ = host_allocate<T>(length_);
 }
 
 //4D
@@ -1916,7 +2325,7 @@ CArray<T>::CArray(size_t dim0,
     dims_[3] = dim3;
     order_ = 4;
     length_ = dim0 * dim1 * dim2 * dim3;
-    array_ = std::shared_ptr <T[]> (new T[length_]);
+    array_ = host_allocate<T>(length_);
 }
 
 //5D
@@ -1933,7 +2342,7 @@ CArray<T>::CArray(size_t dim0,
     dims_[4] = dim4;
     order_ = 5;
     length_ = dim0 * dim1 * dim2 * dim3 * dim4;
-    array_ = std::shared_ptr <T[]> (new T[length_]);
+    array_ = host_allocate<T>(length_);
 }
 
 //6D
@@ -1952,7 +2361,7 @@ CArray<T>::CArray(size_t dim0,
     dims_[5] = dim5;
     order_ = 6;
     length_ = dim0 * dim1 * dim2 * dim3 * dim4 * dim5;
-    array_ = std::shared_ptr <T[]> (new T[length_]);
+    array_ = host_allocate<T>(length_);
 }
 
 //7D
@@ -1973,7 +2382,23 @@ CArray<T>::CArray(size_t dim0,
     dims_[6] = dim6;
     order_ = 7;
     length_ = dim0 * dim1 * dim2 * dim3 * dim4 * dim5 * dim6;
-    array_ = std::shared_ptr <T[]> (new T[length_]);
+    array_ = host_allocate<T>(length_);
+}
+
+// file backed constructor
+template <typename T>
+template <typename... Dims>
+CArray<T>::CArray(const MappedFile& file, Dims... dims)
+{
+    static_assert(sizeof...(Dims) >= 1 && sizeof...(Dims) <= 7, "CArray has an order (rank) of 1 to 7!");
+    const size_t list[] = {static_cast<size_t>(dims)...};
+    order_ = sizeof...(Dims);
+    length_ = 1;
+    for (size_t i = 0; i < order_; i++) {
+        dims_[i] = list[i];
+        length_ *= list[i];
+    }
+    array_ = host_map_file<T>(file, length_);
 }
 
 //Copy constructor
@@ -2178,10 +2603,46 @@ void CArray<T>::set_values(T val) {
     }
 }
 
+template <typename T>
+void CArray<T>::prefetch(size_t begin, size_t end) const {
+    assert(end <= length_ && "end is out of bounds in CArray prefetch!");
+    host_map_hint(array_, begin, end, MapHint::will_need);
+}
+
+template <typename T>
+void CArray<T>::release(size_t begin, size_t end) const {
+    assert(end <= length_ && "end is out of bounds in CArray release!");
+    host_map_hint(array_, begin, end, MapHint::dont_need);
+}
+
+template <typename T>
+void CArray<T>::flush() const {
+    host_map_hint(array_, 0, length_, MapHint::flush);
+}
+
+template <typename T>
+bool CArray<T>::is_mapped() const {
+    return host_is_mapped(array_);
+}
+
 //destructor
 template <typename T>
 CArray<T>::~CArray() {}
 
+// slice of the first index
+template <typename T>
+ViewCArray<T> CArray<T>::slice(size_t i) const {
+    assert(order_ > 1 && "slice needs an order (rank) of 2 or more in CArray!");
+    assert(i < dims_[0] && "i is out of bounds in CArray slice!");
+    return view_from_dims<ViewCArray<T>>(array_.get() + i * (length_ / dims_[0]), dims_ + 1, order_ - 1);
+}
+
+template <typename T>
+template <typename... Args>
+ViewStridedArray<T> CArray<T>::subview(Args... args) const {
+    return ViewStridedArray<T>(array_.get(), dims_, order_, false).subview(args...);
+}
+
 //----endof carray class definitions----
 
 
@@ -2296,6 +2757,13 @@ public:
 
     // return pointer
     T* pointer() const;
+
+    // slice fixing the first index, a contiguous view of order()-1
+    ViewCArray<T> slice(size_t i) const;
+
+    // strided view of part of the array, one index or Range per dimension
+    template <typename... Args>
+    ViewStridedArray<T> subview(Args... args) const;
     
 }; // end of ViewCArray
 
@@ -2612,6 +3080,20 @@ void ViewCArray<T>::set_values(T val) {
     }
 }
 
+// slice of the first index
+template <typename T>
+ViewCArray<T> ViewCArray<T>::slice(size_t i) const {
+    assert(order_ > 1 && "slice needs an order (rank) of 2 or more in ViewCArray!");
+    assert(i < dims_[0] && "i is out of bounds in ViewCArray slice!");
+    return view_from_dims<ViewCArray<T>>(array_ + i * (length_ / dims_[0]), dims_ + 1, order_ - 1);
+}
+
+template <typename T>
+template <typename... Args>
+ViewStridedArray<T> ViewCArray<T>::subview(Args... args) const {
+    return ViewStridedArray<T>(array_, dims_, order_, false).subview(args...);
+}
+
 //---end of ViewCArray class definitions----
 
 
@@ -2749,7 +3231,7 @@ CMatrix<T>::CMatrix(size_t dim1)
     dims_[0] = dim1;
     order_ = 1;
     length_ = dim1;
-    matrix_ = std::shared_ptr <T[]> (new T[length_]);
+    matrix_ = host_allocate<T>(length_);
 }
 
 //2D
@@ -2761,7 +3243,7 @@ CMatrix<T>::CMatrix(size_t dim1,
     dims_[1] = dim2;
     order_ = 2;
     length_ = dim1 * dim2;
-    matrix_ = std::shared_ptr <T[]> (new T[length_]);
+    matrix_ = host_allocate<T>(length_);
 }
 
 //3D
@@ -2775,7 +3257,7 @@ CMatrix<T>::CMatrix(size_t dim1,
     dims_[2] = dim3;
     order_ = 3;
     length_ = dim1 * dim2 * dim3;
-    matrix_ = std::shared_ptr <T[]> (new T[length_]);
+    matrix_ = host_allocate<T>(length_);
 }
 
 //4D
@@ -2791,7 +3273,7 @@ CMatrix<T>::CMatrix(size_t dim1,
     dims_[3] = dim4;
     order_ = 4;
     length_ = dim1 * dim2 * dim3 * dim4;
-    matrix_ = std::shared_ptr <T[]> (new T[length_]);
+    matrix_ = host_allocate<T>(length_);
 }
 
 //5D
@@ -2809,7 +3291,7 @@ CMatrix<T>::CMatrix(size_t dim1,
     dims_[4] = dim5;
     order_ = 5;
     length_ = dim1 * dim2 * dim3 * dim4 * dim5;
-    matrix_ = std::shared_ptr <T[]> (new T[length_]);
+    matrix_ = host_allocate<T>(length_);
 }
 
 //6D
@@ -2829,7 +3311,7 @@ CMatrix<T>::CMatrix(size_t dim1,
     dims_[5] = dim6;
     order_ = 6;
     length_ = dim1 * dim2 * dim3 * dim4 * dim5 * dim6;
-    matrix_ = std::shared_ptr <T[]> (new T[length_]);
+    matrix_ = host_allocate<T>(length_);
 }
 
 //7D
@@ -2851,7 +3333,7 @@ CMatrix<T>::CMatrix(size_t dim1,
     dims_[6] = dim7;
     order_ = 7;
     length_ = dim1 * dim2 * dim3 * dim4 * dim5 * dim6 * dim7;
-    matrix_ = std::shared_ptr <T[]> (new T[length_]);
+    matrix_ = host_allocate<T>(length_);
 }
 
 template <typename T>
@@ -3469,6 +3951,377 @@ void ViewCMatrix<T>::set_values(T val) {
 
 //----end of ViewCMatrix class definitions----
 
+//8b. ViewStridedArray
+// A zero-copy view of part of an array, each dimension has its own stride
+// so a slice, a strided column, or a sub-block of a C or F array can be
+// addressed in place. Made with subview() on the C and F array types,
+// indicies are [0:N-1]
+template <typename T>
+class ViewStridedArray {
+
+private:
+    size_t dims_[7];
+    size_t strides_[7];
+    size_t length_; // number of entries in the view
+    size_t order_;  // tensor order (rank)
+    T * array_;
+
+    // apply one subview argument to dimension d, an index removes the
+    // dimension and a Range keeps it
+    void apply_subview_(size_t d, size_t index, ViewStridedArray& view) const;
+
+    void apply_subview_(size_t d, const Range& range, ViewStridedArray& view) const;
+
+public:
+
+    // Default constructor
+    ViewStridedArray ();
+
+    // view of order dims with the given strides (in entries)
+    ViewStridedArray (T *array,
+                      const size_t *dims,
+                      const size_t *strides,
+                      size_t order);
+
+    // view of a contiguous array, row-major (C) or column-major (F)
+    ViewStridedArray (T *array,
+                      const size_t *dims,
+                      size_t order,
+                      bool column_major);
+
+    T& operator()(size_t i) const;
+
+    T& operator()(size_t i,
+                  size_t j) const;
+
+    T& operator()(size_t i,
+                  size_t j,
+                  size_t k) const;
+
+    T& operator()(size_t i,
+                  size_t j,
+                  size_t k,
+                  size_t l) const;
+
+    T& operator()(size_t i,
+                  size_t j,
+                  size_t k,
+                  size_t l,
+                  size_t m) const;
+
+    T& operator()(size_t i,
+                  size_t j,
+                  size_t k,
+                  size_t l,
+                  size_t m,
+                  size_t n) const;
+
+    T& operator()(size_t i,
+                  size_t j,
+                  size_t k,
+                  size_t l,
+                  size_t m,
+                  size_t n,
+                  size_t o) const;
+
+    // view of part of this view, one index or Range per dimension
+    template <typename... Args>
+    ViewStridedArray subview(Args... args) const;
+
+    //return array size
+    size_t size() const;
+
+    // return array dims
+    size_t dims(size_t i) const;
+
+    // return the stride of dimension i, in entries
+    size_t stride(size_t i) const;
+
+    // return array order (rank)
+    size_t order() const;
+
+    // true if the entries are contiguous in row-major order
+    bool is_contiguous() const;
+
+    // set values to input
+    void set_values(T val);
+
+    // return pointer to the first entry
+    T* pointer() const;
+
+}; // end of ViewStridedArray
+
+//class definitions
+
+//constructors
+
+//no dim
+template <typename T>
+ViewStridedArray<T>::ViewStridedArray() {
+    array_ = NULL;
+    length_ = order_ = 0;
+    for (int i = 0; i < 7; i++) {
+        dims_[i] = 0;
+        strides_[i] = 0;
+    }
+}
+
+template <typename T>
+ViewStridedArray<T>::ViewStridedArray(T *array,
+                                      const size_t *dims,
+                                      const size_t *strides,
+                                      size_t order)
+{
+    assert(order <= 7 && "ViewStridedArray order (rank) must be 7 or less!");
+    array_ = array;
+    order_ = order;
+    length_ = 1;
+    for (size_t d = 0; d < 7; d++) {
+        dims_[d] = d < order ? dims[d] : 0;
+        strides_[d] = d < order ? strides[d] : 0;
+        if (d < order) {
+            length_ *= dims_[d];
+        }
+    }
+}
+
+template <typename T>
+ViewStridedArray<T>::ViewStridedArray(T *array,
+                                      const size_t *dims,
+                                      size_t order,
+                                      bool column_major)
+{
+    assert(order <= 7 && "ViewStridedArray order (rank) must be 7 or less!");
+    array_ = array;
+    order_ = order;
+    length_ = 1;
+    for (size_t d = 0; d < 7; d++) {
+        dims_[d] = d < order ? dims[d] : 0;
+        strides_[d] = 0;
+    }
+    for (size_t n = 0; n < order; n++) {
+        size_t d = column_major ? n : order - 1 - n;
+        strides_[d] = length_;
+        length_ *= dims_[d];
+    }
+}
+
+//overload operator () to access data as array(i,....,n);
+//1D
+template <typename T>
+inline T& ViewStridedArray<T>::operator()(size_t i) const
+{
+    assert(order_ == 1 && "Tensor order (rank) does not match constructor in ViewStridedArray 1D!");
+    assert(i < dims_[0] && "i is out of bounds in ViewStridedArray 1D!");
+
+    return array_[i * strides_[0]];
+}
+
+//2D
+template <typename T>
+inline T& ViewStridedArray<T>::operator()(size_t i,
+                                          size_t j) const
+{
+    assert(order_ == 2 && "Tensor order (rank) does not match constructor in ViewStridedArray 2D!");
+    assert(i < dims_[0] && "i is out of bounds in ViewStridedArray 2D!");
+    assert(j < dims_[1] && "j is out of bounds in ViewStridedArray 2D!");
+
+    return array_[i * strides_[0] + j * strides_[1]];
+}
+
+//3D
+template <typename T>
+inline T& ViewStridedArray<T>::operator()(size_t i,
+                                          size_t j,
+                                          size_t k) const
+{
+    assert(order_ == 3 && "Tensor order (rank) does not match constructor in ViewStridedArray 3D!");
+    assert(i < dims_[0] && "i is out of bounds in ViewStridedArray 3D!");
+    assert(j < dims_[1] && "j is out of bounds in ViewStridedArray 3D!");
+    assert(k < dims_[2] && "k is out of bounds in ViewStridedArray 3D!");
+
+    return array_[i * strides_[0] + j * strides_[1] + k * strides_[2]];
+}
+
+//4D
+template <typename T>
+inline T& ViewStridedArray<T>::operator()(size_t i,
+                                          size_t j,
+                                          size_t k,
+                                          size_t l) const
+{
+    assert(order_ == 4 && "Tensor order (rank) does not match constructor in ViewStridedArray 4D!");
+    assert(i < dims_[0] && "i is out of bounds in ViewStridedArray 4D!");
+    assert(j < dims_[1] && "j is out of bounds in ViewStridedArray 4D!");
+    assert(k < dims_[2] && "k is out of bounds in ViewStridedArray 4D!");
+    assert(l < dims_[3] && "l is out of bounds in ViewStridedArray 4D!");
+
+    return array_[i * strides_[0] + j * strides_[1] + k * strides_[2]
+                + l * strides_[3]];
+}
+
+//5D
+template <typename T>
+inline T& ViewStridedArray<T>::operator()(size_t i,
+                                          size_t j,
+                                          size_t k,
+                                          size_t l,
+                                          size_t m) const
+{
+    assert(order_ == 5 && "Tensor order (rank) does not match constructor in ViewStridedArray 5D!");
+    assert(i < dims_[0] && "i is out of bounds in ViewStridedArray 5D!");
+    assert(j < dims_[1] && "j is out of bounds in ViewStridedArray 5D!");
+    assert(k < dims_[2] && "k is out of bounds in ViewStridedArray 5D!");
+    assert(l < dims_[3] && "l is out of bounds in ViewStridedArray 5D!");
+    assert(m < dims_[4] && "m is out of bounds in ViewStridedArray 5D!");
+
+    return array_[i * strides_[0] + j * strides_[1] + k * strides_[2]
+                + l * strides_[3] + m * strides_[4]];
+}
+
+//6D
+template <typename T>
+inline T& ViewStridedArray<T>::operator()(size_t i,
+                                          size_t j,
+                                          size_t k,
+                                          size_t l,
+                                          size_t m,
+                                          size_t n) const
+{
+    assert(order_ == 6 && "Tensor order (rank) does not match constructor in ViewStridedArray 6D!");
+    assert(i < dims_[0] && "i is out of bounds in ViewStridedArray 6D!");
+    assert(j < dims_[1] && "j is out of bounds in ViewStridedArray 6D!");
+    assert(k < dims_[2] && "k is out of bounds in ViewStridedArray 6D!");
+    assert(l < dims_[3] && "l is out of bounds in ViewStridedArray 6D!");
+    assert(m < dims_[4] && "m is out of bounds in ViewStridedArray 6D!");
+    assert(n < dims_[5] && "n is out of bounds in ViewStridedArray 6D!");
+
+    return array_[i * strides_[0] + j * strides_[1] + k * strides_[2]
+                + l * strides_[3] + m * strides_[4] + n * strides_[5]];
+}
+
+//7D
+template <typename T>
+inline T& ViewStridedArray<T>::operator()(size_t i,
+                                          size_t j,
+                                          size_t k,
+                                          size_t l,
+                                          size_t m,
+                                          size_t n,
+                                          size_t o) const
+{
+    assert(order_ == 7 && "Tensor order (rank) does not match constructor in ViewStridedArray 7D!");
+    assert(i < dims_[0] && "i is out of bounds in ViewStridedArray 7D!");
+    assert(j < dims_[1] && "j is out of bounds in ViewStridedArray 7D!");
+    assert(k < dims_[2] && "k is out of bounds in ViewStridedArray 7D!");
+    assert(l < dims_[3] && "l is out of bounds in ViewStridedArray 7D!");
+    assert(m < dims_[4] && "m is out of bounds in ViewStridedArray 7D!");
+    assert(n < dims_[5] && "n is out of bounds in ViewStridedArray 7D!");
+    assert(o < dims_[6] && "o is out of bounds in ViewStridedArray 7D!");
+
+    return array_[i * strides_[0] + j * strides_[1] + k * strides_[2]
+                + l * strides_[3] + m * strides_[4] + n * strides_[5]
+                + o * strides_[6]];
+}
+
+template <typename T>
+inline void ViewStridedArray<T>::apply_subview_(size_t d, size_t index, ViewStridedArray& view) const {
+    assert(index < dims_[d] && "subview index is out of bounds in ViewStridedArray!");
+    view.array_ += index * strides_[d];
+}
+
+template <typename T>
+inline void ViewStridedArray<T>::apply_subview_(size_t d, const Range& range, ViewStridedArray& view) const {
+    size_t end = range.end > dims_[d] ? dims_[d] : range.end;
+    assert(range.step > 0 && "subview Range step must be positive in ViewStridedArray!");
+    assert(range.begin <= end && "subview Range is out of bounds in ViewStridedArray!");
+
+    size_t count = (end - range.begin + range.step - 1) / range.step;
+    view.array_ += range.begin * strides_[d];
+    view.dims_[view.order_] = count;
+    view.strides_[view.order_] = strides_[d] * range.step;
+    view.order_++;
+    view.length_ *= count;
+}
+
+template <typename T>
+template <typename... Args>
+ViewStridedArray<T> ViewStridedArray<T>::subview(Args... args) const {
+    assert(sizeof...(Args) == order_ && "subview needs an index or Range for every dimension of ViewStridedArray!");
+
+    ViewStridedArray<T> view;
+    view.array_ = array_;
+    view.length_ = 1;
+
+    size_t d = 0;
+    (apply_subview_(d++, args, view), ...);
+
+    assert(view.order_ > 0 && "subview must keep at least one dimension, use operator() for a single entry!");
+    return view;
+}
+
+template <typename T>
+inline size_t ViewStridedArray<T>::size() const {
+    return length_;
+}
+
+template <typename T>
+inline size_t ViewStridedArray<T>::dims(size_t i) const {
+    assert(i < order_ && "ViewStridedArray order (rank) does not match constructor, dim[i] does not exist!");
+    return dims_[i];
+}
+
+template <typename T>
+inline size_t ViewStridedArray<T>::stride(size_t i) const {
+    assert(i < order_ && "ViewStridedArray order (rank) does not match constructor, stride[i] does not exist!");
+    return strides_[i];
+}
+
+template <typename T>
+inline size_t ViewStridedArray<T>::order() const {
+    return order_;
+}
+
+template <typename T>
+bool ViewStridedArray<T>::is_contiguous() const {
+    size_t expected = 1;
+    for (int d = (int)order_ - 1; d >= 0; d--) {
+        if (dims_[d] > 1 && strides_[d] != expected) {
+            return false;
+        }
+        expected *= dims_[d];
+    }
+    return true;
+}
+
+template <typename T>
+void ViewStridedArray<T>::set_values(T val) {
+    size_t idx[7] = {0, 0, 0, 0, 0, 0, 0};
+    for (size_t count = 0; count < length_; count++) {
+        size_t offset = 0;
+        for (size_t d = 0; d < order_; d++) {
+            offset += idx[d] * strides_[d];
+        }
+        array_[offset] = val;
+
+        // advance the index, last dimension fastest
+        for (int d = (int)order_ - 1; d >= 0; d--) {
+            if (++idx[d] < dims_[d]) {
+                break;
+            }
+            idx[d] = 0;
+        }
+    }
+}
+
+template <typename T>
+inline T* ViewStridedArray<T>::pointer() const {
+    return array_;
+}
+
+//---end of ViewStridedArray class definitions----
+
+
 //9. RaggedRightArray
 template <typename T>
 class RaggedRightArray {
@@ -3503,6 +4356,9 @@ public:
     
     // A method to return the stride size
     size_t stride(size_t i) const;
+
+    // A method to return the number of rows
+    size_t dim1() const;
     
     // A method to increase the number of column entries, i.e.,
     // the stride size. Used with the constructor for building
@@ -3562,7 +4418,7 @@ RaggedRightArray<T>::RaggedRightArray (CArray<size_t> &strides_array){
     } // end for i
     length_ = count;
     
-    array_ = std::shared_ptr <T[]> (new T[length_]);
+    array_ = host_allocate<T>(length_);
 } // End constructor
 
 // Overloaded constructor with a view c array
@@ -3584,7 +4440,7 @@ RaggedRightArray<T>::RaggedRightArray (ViewCArray<size_t> &strides_array) {
     } // end for i
     length_ = count;
 
-    array_ = std::shared_ptr <T []> (new T[length_]);
+    array_ = host_allocate<T>(length_);
 } // End constructor
 
 // Overloaded constructor with a regular cpp array
@@ -3606,7 +4462,7 @@ RaggedRightArray<T>::RaggedRightArray (size_t *strides_array, size_t dim1){
     } // end for i
     length_ = count;
 
-    array_ = std::shared_ptr <T []> (new T[length_]);
+    array_ = host_allocate<T>(length_);
 } // End constructor
 
 // overloaded constructor for a dynamically built strides_array.
@@ -3623,7 +4479,7 @@ RaggedRightArray<T>::RaggedRightArray (size_t some_dim1, size_t buffer){
     num_saved_ = 0;
     
     length_ = some_dim1*buffer;
-    array_ = std::shared_ptr <T []> (new T[length_]);
+    array_ = host_allocate<T>(length_);
     
 } // end constructor
 
@@ -3681,6 +4537,11 @@ size_t RaggedRightArray<T>::size() const {
     return length_;
 }
 
+template <typename T>
+size_t RaggedRightArray<T>::dim1() const {
+    return dim1_;
+}
+
 template <typename T>
 RaggedRightArray<T> & RaggedRightArray<T>::operator+= (const size_t i) {
     this->num_saved_ ++;
@@ -3825,7 +4686,7 @@ RaggedRightArrayofVectors<T>::RaggedRightArrayofVectors (CArray<size_t> &strides
     } // end for i
     length_ = count;
     
-    array_ = std::shared_ptr <T []> (new T[length_]);
+    array_ = host_allocate<T>(length_);
 } // End constructor
 
 // Overloaded constructor with a view c array
@@ -3848,7 +4709,7 @@ RaggedRightArrayofVectors<T>::RaggedRightArrayofVectors (ViewCArray<size_t> &str
     } // end for i
     length_ = count;
 
-    array_ = std::shared_ptr <T []> (new T[length_]);
+    array_ = host_allocate<T>(length_);
 } // End constructor
 
 // Overloaded constructor with a regular cpp array
@@ -3871,7 +4732,7 @@ RaggedRightArrayofVectors<T>::RaggedRightArrayofVectors (size_t *strides_array,
     } // end for i
     length_ = count;
    
-    array_ = std::shared_ptr <T []> (new T[length_]);
+    array_ = host_allocate<T>(length_);
 } // End constructor
 
 // overloaded constructor for a dynamically built strides_array.
@@ -3889,7 +4750,7 @@ RaggedRightArrayofVectors<T>::RaggedRightArrayofVectors (size_t some_dim1, size_
     num_saved_ = 0;
     
     length_ = some_dim1*buffer*vector_dim;
-    array_ = std::shared_ptr <T []> (new T[some_dim1*buffer]);
+    array_ = host_allocate<T>(some_dim1*buffer);
     
 } // end constructor
 
@@ -4029,7 +4890,10 @@ public:
     RaggedDownArray (const RaggedDownArray& temp);
     
     //method to return stride size
-    size_t stride(size_t j);
+    size_t stride(size_t j) const;
+
+    // method to return the number of columns
+    size_t dim2() const;
 
     // A method to increase the number of column entries, i.e.,
     // the stride size. Used with the constructor for building
@@ -4041,7 +4905,7 @@ public:
     T& operator()(size_t i, size_t j);
 
     // method to return total size
-    size_t size();
+    size_t size() const;
 
     //return pointer
     T* pointer() const;
@@ -4090,7 +4954,7 @@ RaggedDownArray<T>::RaggedDownArray( CArray <size_t> &strides_array) {
     }
     length_ = count;
 
-    array_ = std::shared_ptr <T[]> (new T[length_]);
+    array_ = host_allocate<T>(length_);
 
 } // End constructor
 
@@ -4111,7 +4975,7 @@ RaggedDownArray<T>::RaggedDownArray( ViewCArray <size_t> &strides_array) {
         start_index_[j+1] = count;
     }
     length_ = count;
-    array_ = std::shared_ptr <T []> (new T[length_]);
+    array_ = host_allocate<T>(length_);
 
 } // End constructor
 
@@ -4133,7 +4997,7 @@ RaggedDownArray<T>::RaggedDownArray( size_t *strides_array, size_t dim2){
         start_index_[j+1] = count;
     }
     length_ = count;
-    array_ = std::shared_ptr <T[]> (new T[length_]);
+    array_ = host_allocate<T>(length_);
 
 } //end construnctor
 
@@ -4151,7 +5015,7 @@ RaggedDownArray<T>::RaggedDownArray (size_t some_dim2, size_t buffer){
     num_saved_ = 0;
     
     length_ = some_dim2*buffer;
-    array_ = std::shared_ptr <T[]> (new T[length_]);
+    array_ = host_allocate<T>(length_);
     
 } // end constructor
 
@@ -4171,7 +5035,7 @@ RaggedDownArray<T>::RaggedDownArray (const RaggedDownArray& temp) {
 
 // Check the stride size
 template <typename T>
-size_t RaggedDownArray<T>::stride(size_t j) {
+size_t RaggedDownArray<T>::stride(size_t j) const {
     assert(j < dim2_ && "j is greater than dim2_ in RaggedDownArray");
 
     return start_index_[j+1] - start_index_[j];
@@ -4188,10 +5052,15 @@ void RaggedDownArray<T>::push_back(size_t j){
 
 //return size
 template <typename T>
-size_t RaggedDownArray<T>::size() {
+size_t RaggedDownArray<T>::size() const {
     return length_;
 }
 
+template <typename T>
+size_t RaggedDownArray<T>::dim2() const {
+    return dim2_;
+}
+
 // overload operator () to access data as an array(i,j)
 // Note: i = 0:stride(j), j = 0:N-1
 template <typename T>
@@ -4320,7 +5189,7 @@ DynamicRaggedRightArray<T>::DynamicRaggedRightArray (size_t dim1, size_t dim2) {
     length_ = dim1*dim2;
     
     // Create memory on the heap for the values
-    array_ = std::shared_ptr <T[]> (new T[dim1*dim2]);
+    array_ = host_allocate<T>(dim1*dim2);
     
     // Create memory for the stride size in each row
     stride_ = std::shared_ptr <size_t[]> (new size_t[dim1]);
@@ -4487,7 +5356,7 @@ DynamicRaggedDownArray<T>::DynamicRaggedDownArray (size_t dim1, size_t dim2) {
     length_ = dim1*dim2;
     
     // Create memory on the heap for the values
-    array_ = std::shared_ptr <T[]> (new T[dim1*dim2]);
+    array_ = host_allocate<T>(dim1*dim2);
     
     // Create memory for the stride size in each row
     stride_ = std::shared_ptr <size_t[]> (new size_t[dim2]);
@@ -4722,7 +5591,7 @@ class CSRArray {
     // underscore stuff
     // Use the index into the 1d array to get what value is stored there and what is the corresponding row
     T& get_val_flat(size_t k);
-    size_t get_col_flat(size_t k);
+    size_t get_col_flat(size_t k) const;
     // reverse map function from A(i,j) to what element of data/col_pt_ it corersponds to
     size_t flat_index(size_t i, size_t j);
     // Convertor
@@ -4752,7 +5621,7 @@ CSRArray<T>::CSRArray(CArray<T> array, CArray<size_t> column_index, CArray<size_
     dim2_ = dim2;
     size_t nnz = array.size();
     start_index_ = std::shared_ptr<size_t []> (new size_t[dim1_ + 1]);
-    array_ = std::shared_ptr<T []> (new T[nnz+1]);
+    array_ = host_allocate<T>(nnz+1);
     column_index_ = std::shared_ptr<size_t []> (new size_t[nnz]);
     size_t i ;
     for(i = 0; i < nnz; i++){
@@ -4767,7 +5636,7 @@ CSRArray<T>::CSRArray(CArray<T> array, CArray<size_t> column_index, CArray<size_
 
 template<typename T>
 CSRArray<T>::CSRArray(const CSRArray<T> &temp){
-    if(this != temp) {
+    if(this != &temp) {
         nnz_ = temp.nnz_;
         dim1_ = temp.dim1_;
         dim2_ = temp.dim2_;
@@ -4782,28 +5651,33 @@ template<typename T>
 CSRArray<T>::CSRArray(CArray<T> dense){
     dim1_ = dense.dims(0);
     dim2_ = dense.dims(1);
-    nnz_ = dense.size();
+
+    // count the nonzeros of each row, then copy them in row order
     start_index_ = std::shared_ptr<size_t []> (new size_t[dim1_ + 1]);
-    array_ = std::shared_ptr<T []> (new T[nnz_ + 1]);
-    column_index_ = std::shared_ptr<size_t []> (new size_t[nnz_]);
-    size_t i,j;
-    size_t cur = 0;
-    for(i = 0; i < dim1_; i++){
-        for(j = 0; i < dim2_; j++){
-            if(j != 0){
-                    start_index_[i+1] += 1;
-                    column_index_[cur] = j;
-                    array_[cur] = dense(i,j);
-                    cur++;
+    start_index_[0] = 0;
+    for(size_t i = 0; i < dim1_; i++){
+        size_t count = 0;
+        for(size_t j = 0; j < dim2_; j++){
+            if(dense(i,j) != 0){
+                count++;
             }
         }
+        start_index_[i+1] = start_index_[i] + count;
     }
-    start_index_[0] = 0;
-    for(i = 1; i <= dim1_; i++){
-        start_index_[i] = start_index_[i] + start_index_[i+1];
-    }
-
 
+    nnz_ = start_index_[dim1_];
+    array_ = host_allocate<T>(nnz_ + 1);
+    column_index_ = std::shared_ptr<size_t []> (new size_t[nnz_ + 1]);
+    size_t cur = 0;
+    for(size_t i = 0; i < dim1_; i++){
+        for(size_t j = 0; j < dim2_; j++){
+            if(dense(i,j) != 0){
+                column_index_[cur] = j;
+                array_[cur] = dense(i,j);
+                cur++;
+            }
+        }
+    }
 }
 
 template<typename T>
@@ -4847,7 +5721,7 @@ size_t* CSRArray<T>::get_starts() const {
 
 template<typename T>
 CSRArray<T>& CSRArray<T>::operator=(const CSRArray &temp){
-    if(this != temp) {
+    if(this != &temp) {
         nnz_ = temp.nnz_;
         dim1_ = temp.dim1_;
         dim2_ = temp.dim2_;
@@ -4884,8 +5758,8 @@ void CSRArray<T>::to_dense(CArray<T>& A){
 
 template<typename T>
 size_t CSRArray<T>::stride(size_t i) const {
-   assert(i <= dim1_ && "Index i out of bounds in CSRArray.stride()");
-   return start_index_[i+i] - start_index_[i];
+   assert(i < dim1_ && "Index i out of bounds in CSRArray.stride()");
+   return start_index_[i+1] - start_index_[i];
 
 }
 
@@ -4946,7 +5820,7 @@ T& CSRArray<T>::get_val_flat(size_t k){
 }
 
 template<typename T>
-size_t CSRArray<T>::get_col_flat(size_t k){
+size_t CSRArray<T>::get_col_flat(size_t k) const {
     assert(k < nnz_ && "Index k is out of bounds in CSRArray.get_col_lat()");
     return column_index_[k];
 }
@@ -5149,7 +6023,7 @@ private: // What ought to be private ?
 
       // Use the index into the 1d array to get what value is stored there and what is the corresponding row
       T &get_val_flat(size_t k);
-      size_t get_row_flat(size_t k);
+      size_t get_row_flat(size_t k) const;
       // reverse map function from A(i,j) to what element of data/col_pt_ it corersponds to
       int flat_index(size_t i, size_t j);
       // Convertor
@@ -5176,7 +6050,7 @@ CSCArray<T>::CSCArray(CArray<T> array, CArray<size_t> row_index, CArray<size_t>
     dim2_ = dim2;
     size_t nnz = array.size();
     start_index_ = std::shared_ptr<size_t []> (new size_t[dim2_ + 1]);
-    array_ = std::shared_ptr<T []> (new T[nnz+1]);
+    array_ = host_allocate<T>(nnz+1);
     row_index_ = std::shared_ptr<size_t []> (new size_t[nnz]);
     size_t i ;
     for(i = 0; i < nnz; i++){
@@ -5230,7 +6104,7 @@ size_t* CSCArray<T>::get_starts() const{
 
 template<typename T>
 CSCArray<T>& CSCArray<T>::operator=(const CSCArray &temp){
-    if(this != temp) {
+    if(this != &temp) {
         nnz_ = temp.nnz_;
         dim2_ = temp.dim2_;
         dim1_ = temp.dim1_;
@@ -5312,7 +6186,7 @@ T& CSCArray<T>::get_val_flat(size_t k){
 }
 
 template<typename T>
-size_t CSCArray<T>::get_row_flat(size_t k){
+size_t CSCArray<T>::get_row_flat(size_t k) const {
     return row_index_[k];
 }
 
@@ -5406,6 +6280,73 @@ public:
 }; // End of TpetraCRSMatrix
 
 
+////////////////////////////////////////////////
+// Out-of-core loops over file backed arrays
+////////////////////////////////////////////////
+
+// entries of slabs [s0, s1) of the slowest index, the first index of a
+// CArray and the last index of an FArray
+template <typename T>
+void stream_slab_range(const CArray<T>& a, size_t s0, size_t s1, size_t& begin, size_t& end) {
+    const size_t slowest = a.size() > 0 ? a.dims(0) : 1;
+    const size_t slab    = a.size() / slowest;
+    begin = (s0 < slowest ? s0 : slowest) * slab;
+    end   = (s1 < slowest ? s1 : slowest) * slab;
+}
+
+template <typename T>
+void stream_slab_range(const FArray<T>& a, size_t s0, size_t s1, size_t& begin, size_t& end) {
+    const size_t slowest = a.size() > 0 ? a.dims(a.order() - 1) : 1;
+    const size_t slab    = a.size() / slowest;
+    begin = (s0 < slowest ? s0 : slowest) * slab;
+    end   = (s1 < slowest ? s1 : slowest) * slab;
+}
+
+template <typename Array>
+void stream_prefetch(const Array& a, size_t s0, size_t s1) {
+    size_t begin, end;
+    stream_slab_range(a, s0, s1, begin, end);
+    a.prefetch(begin, end);
+}
+
+template <typename Array>
+void stream_release(const Array& a, size_t s0, size_t s1) {
+    size_t begin, end;
+    stream_slab_range(a, s0, s1, begin, end);
+    a.release(begin, end);
+}
+
+// run fcn(i) for i in [x0, x1), chunk slabs at a time. The next chunk of
+// every array is read ahead while a chunk runs, and a finished chunk is
+// released so the arrays can be much larger than memory. Use it through
+// FOR_ALL_STREAM.
+template <typename Function, typename... Arrays>
+void stream_for_all(size_t x0, size_t x1, size_t chunk, const std::tuple<Arrays&...>& arrays, const Function& fcn) {
+    assert(chunk > 0 && "chunk must be positive in FOR_ALL_STREAM!");
+
+    auto each = [&arrays](auto&& apply) {
+        std::apply([&apply](auto&... a) { (apply(a), ...); }, arrays);
+    };
+
+    each([&](auto& a) { stream_prefetch(a, x0, x0 + chunk < x1 ? x0 + chunk : x1); });
+
+    for (size_t begin = x0; begin < x1; begin += chunk) {
+        const size_t end  = begin + chunk < x1 ? begin + chunk : x1;
+        const size_t next = end + chunk < x1 ? end + chunk : x1;
+        each([&](auto& a) { stream_prefetch(a, end, next); });
+
+#ifdef _OPENMP
+        #pragma omp parallel for schedule(static)
+#endif
+        for (long long i = (long long)begin; i < (long long)end; i++) {
+            fcn((size_t)i);
+        }
+
+        each([&](auto& a) { stream_release(a, begin, end); });
+    }
+}
+
+
 //=======================================================================
 //    end of standard MATAR data-types
 //========================================================================
@@ -0,0 +1,533 @@
+#ifndef INTEROP_TYPES_H
+#define INTEROP_TYPES_H
+/**********************************************************************************************
+ © 2020. Triad National Security, LLC. All rights reserved.
+ This program was produced under U.S. Government contract 89233218CNA000001 for Los Alamos
+ National Laboratory (LANL), which is operated by Triad National Security, LLC for the U.S.
+ Department of Energy/National Nuclear Security Administration. All rights in the program are
+ reserved by Triad National Security, LLC, and the U.S. Department of Energy/National Nuclear
+ Security Administration. The Government is granted for itself and others acting on its behalf a
+ nonexclusive, paid-up, irrevocable worldwide license in this material to reproduce, prepare
+ derivative works, distribute copies to the public, perform publicly and display publicly, and
+ to permit others to do so.
+ This program is open source under the BSD-3 License.
+ Redistribution and use in source and binary forms, with or without modification, are permitted
+ provided that the following conditions are met:
+ 
+ 1.  Redistributions of source code must retain the above copyright notice, this list of
+ conditions and the following disclaimer.
+ 
+ 2.  Redistributions in binary form must reproduce the above copyright notice, this list of
+ conditions and the following disclaimer in the documentation and/or other materials
+ provided with the distribution.
+ 
+ 3.  Neither the name of the copyright holder nor the names of its contributors may be used
+ to endorse or promote products derived from this software without specific prior
+ written permission.
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+ IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **********************************************************************************************/
+#include <array>
+#include <cassert>
+#include <cstdint>
+#include <memory>
+#include <type_traits>
+#include <utility>
+#if __has_include(<version>)
+#include <version>
+#endif
+
+#include "host_types.h"
+#include "kokkos_types.h"
+#include "expression_types.h"
+
+// std::mdspan with C++23, otherwise the Kokkos::mdspan that Kokkos 4 ships
+// under C++17 (on unless Kokkos is configured with -DKokkos_ENABLE_IMPL_MDSPAN=OFF)
+#if defined(__cpp_lib_mdspan)
+#include <mdspan>
+#define MATAR_HAVE_MDSPAN
+#elif defined(HAVE_KOKKOS) && defined(KOKKOS_ENABLE_IMPL_MDSPAN)
+#define MATAR_HAVE_MDSPAN
+#endif
+
+
+// -----------------------------------------
+// Zero-copy interop with other libraries
+//
+//   auto v = to_kokkos_view<2>(A);      // unmanaged Kokkos::View, same layout
+//   auto B = from_kokkos_view(v);       // ViewCArrayKokkos, ViewFArrayKokkos or
+//                                       // ViewStridedArrayKokkos
+//   auto m = to_mdspan<3>(A);           // std::mdspan (or Kokkos::mdspan)
+//   auto C = from_mdspan(m);            // ViewCArray, ViewFArray or ViewStridedArray
+//
+//   TensorDescriptor d = to_descriptor(A);       // DLPack style, keeps A alive
+//   ViewStridedArray<double> D = from_descriptor<double>(d);
+//
+// C types map to a row-major (LayoutRight) layout, F types to column-major
+// (LayoutLeft) and the strided views to LayoutStride. The dual types export
+// their device data, pass A.host to export the host side. Nothing is copied,
+// the exported objects are only valid while the memory is.
+// -----------------------------------------
+
+namespace mtr
+{
+
+#ifdef MATAR_HAVE_MDSPAN
+#if defined(__cpp_lib_mdspan)
+namespace mdspan_ns = ::std;
+#else
+namespace mdspan_ns = ::Kokkos;
+#endif
+#endif
+
+struct InteropLayoutC {};
+struct InteropLayoutF {};
+struct InteropLayoutStride {};
+
+// -----------------------------------------
+// interop traits: data pointer, shape and strides of the exportable types
+// -----------------------------------------
+template <typename A, typename = void>
+struct interop_traits {
+    static constexpr bool value = false;
+};
+
+// the dense types, reusing the expression traits
+template <typename A>
+struct interop_traits<A, typename std::enable_if<expr_container_traits<A>::value>::type> {
+    using traits     = expr_container_traits<A>;
+    using value_type = typename traits::value_type;
+    using space      = typename traits::space;
+    using layout     = typename std::conditional<std::is_same<typename traits::family, ExprCFamily>::value,
+                                                 InteropLayoutC, InteropLayoutF>::type;
+    static constexpr bool value = true;
+
+    static value_type* data(const A& a) { return traits::data(a); }
+
+    static size_t dim(const A& a, size_t d) { return a.dims(d + traits::index_base); }
+
+    // contiguous strides, in entries
+    static size_t stride(const A& a, size_t d) {
+        size_t s = 1;
+        if (std::is_same<layout, InteropLayoutC>::value) {
+            for (size_t n = d + 1; n < a.order(); n++) {
+                s *= dim(a, n);
+            }
+        }
+        else {
+            for (size_t n = 0; n < d; n++) {
+                s *= dim(a, n);
+            }
+        }
+        return s;
+    }
+};
+
+template <typename T, typename Space>
+struct interop_strided_base {
+    using value_type = T;
+    using space      = Space;
+    using layout     = InteropLayoutStride;
+    static constexpr bool value = true;
+
+    template <typename A>
+    static T* data(const A& a) { return a.pointer(); }
+
+    template <typename A>
+    static size_t dim(const A& a, size_t d) { return a.dims(d); }
+
+    template <typename A>
+    static size_t stride(const A& a, size_t d) { return a.stride(d); }
+};
+
+template <typename T>
+struct interop_traits<ViewStridedArray<T>> : interop_strided_base<T, ExprHostSpace> {};
+
+#ifdef HAVE_KOKKOS
+template <typename T>
+struct interop_traits<ViewStridedArrayKokkos<T>> : interop_strided_base<T, ExprDeviceSpace<DefaultExecSpace>> {};
+#endif
+
+// pointer type with Rank levels, e.g. double*** for Rank 3
+template <typename T, size_t Rank>
+struct interop_data_type {
+    using type = typename interop_data_type<T, Rank - 1>::type*;
+};
+
+template <typename T>
+struct interop_data_type<T, 0> {
+    using type = T;
+};
+
+
+// -----------------------------------------
+// DLPack style descriptor
+// -----------------------------------------
+
+// DLPack DLDeviceType codes
+enum class DeviceKind : int32_t {
+    CPU         = 1,
+    CUDA        = 2,
+    CUDAHost    = 3,
+    ROCM        = 10,
+    ExtDev      = 12,
+    CUDAManaged = 13
+};
+
+// DLPack DLDataTypeCode codes
+enum class DataKind : uint8_t {
+    Int   = 0,
+    UInt  = 1,
+    Float = 2,
+    Bool  = 6
+};
+
+// Mirrors the fields of a DLPack DLTensor so it can be filled in directly
+// from or into one. The strides are in entries, all zero stands for the
+// NULL strides of DLPack, a compact row-major tensor. owner keeps the exported
+// memory alive, to_descriptor stores a copy of the array in it, which
+// shares the memory of the owning MATAR types. Code importing an external
+// buffer can set owner to a pointer with the deleter of that library.
+struct TensorDescriptor {
+    void*    data        = nullptr;
+    int32_t  device_type = static_cast<int32_t>(DeviceKind::CPU);
+    int32_t  device_id   = 0;
+    int32_t  ndim        = 0;
+    uint8_t  dtype_code  = static_cast<uint8_t>(DataKind::Float);
+    uint8_t  dtype_bits  = 64;
+    uint16_t dtype_lanes = 1;
+    int64_t  shape[7]    = {0, 0, 0, 0, 0, 0, 0};
+    int64_t  strides[7]  = {0, 0, 0, 0, 0, 0, 0};
+    uint64_t byte_offset = 0;
+    std::shared_ptr<void> owner;
+};
+
+template <typename T>
+constexpr DataKind interop_data_kind() {
+    return std::is_same<T, bool>::value ? DataKind::Bool
+         : std::is_floating_point<T>::value ? DataKind::Float
+         : std::is_signed<T>::value ? DataKind::Int
+         : DataKind::UInt;
+}
+
+template <typename Space>
+struct interop_device {
+    static int32_t type() { return static_cast<int32_t>(DeviceKind::CPU); }
+};
+
+#ifdef HAVE_KOKKOS
+template <typename MemSpace>
+int32_t interop_memory_device_type() {
+    if (std::is_same<MemSpace, Kokkos::HostSpace>::value) {
+        return static_cast<int32_t>(DeviceKind::CPU);
+    }
+#ifdef KOKKOS_ENABLE_CUDA
+    if (std::is_same<MemSpace, Kokkos::CudaSpace>::value) {
+        return static_cast<int32_t>(DeviceKind::CUDA);
+    }
+    if (std::is_same<MemSpace, Kokkos::CudaHostPinnedSpace>::value) {
+        return static_cast<int32_t>(DeviceKind::CUDAHost);
+    }
+    if (std::is_same<MemSpace, Kokkos::CudaUVMSpace>::value) {
+        return static_cast<int32_t>(DeviceKind::CUDAManaged);
+    }
+#endif
+#ifdef HAVE_HIP
+    if (std::is_same<MemSpace, Kokkos::Experimental::HIPSpace>::value) {
+        return static_cast<int32_t>(DeviceKind::ROCM);
+    }
+#endif
+    return static_cast<int32_t>(DeviceKind::ExtDev);
+}
+
+template <typename ExecSpace>
+struct interop_device<ExprDeviceSpace<ExecSpace>> {
+    static int32_t type() { return interop_memory_device_type<typename ExecSpace::memory_space>(); }
+};
+#endif
+
+// describe an array without copying it. device_id is left at 0, set it
+// when more than one GPU is used per process
+template <typename A, typename std::enable_if<interop_traits<A>::value, int>::type = 0>
+TensorDescriptor to_descriptor(const A& a) {
+    using traits = interop_traits<A>;
+    using T      = typename traits::value_type;
+    assert(a.order() <= 7 && "to_descriptor supports an order (rank) of 7 or less!");
+
+    TensorDescriptor desc;
+    desc.data        = static_cast<void*>(traits::data(a));
+    desc.device_type = interop_device<typename traits::space>::type();
+    desc.ndim        = static_cast<int32_t>(a.order());
+    desc.dtype_code  = static_cast<uint8_t>(interop_data_kind<T>());
+    desc.dtype_bits  = static_cast<uint8_t>(8 * sizeof(T));
+    for (size_t d = 0; d < a.order(); d++) {
+        desc.shape[d]   = static_cast<int64_t>(traits::dim(a, d));
+        desc.strides[d] = static_cast<int64_t>(traits::stride(a, d));
+    }
+    desc.owner = std::make_shared<A>(a);
+    return desc;
+}
+
+// check the element type and find the first entry of a descriptor
+template <typename T>
+T* descriptor_data(const TensorDescriptor& desc) {
+    assert(desc.dtype_code == static_cast<uint8_t>(interop_data_kind<T>()) &&
+           desc.dtype_bits == 8 * sizeof(T) && desc.dtype_lanes == 1 &&
+           "TensorDescriptor data type does not match T!");
+    assert(desc.ndim > 0 && desc.ndim <= 7 && "TensorDescriptor ndim must be 1 to 7!");
+    return reinterpret_cast<T*>(static_cast<char*>(desc.data) + desc.byte_offset);
+}
+
+// dims and strides of a descriptor, compact row-major when no strides are set
+inline void descriptor_dims(const TensorDescriptor& desc, size_t* dims, size_t* strides) {
+    bool compact = true;
+    for (int d = 0; d < desc.ndim; d++) {
+        dims[d]    = static_cast<size_t>(desc.shape[d]);
+        strides[d] = static_cast<size_t>(desc.strides[d]);
+        compact    = compact && desc.strides[d] == 0;
+    }
+    if (compact) {
+        size_t stride = 1;
+        for (int d = desc.ndim - 1; d >= 0; d--) {
+            strides[d] = stride;
+            stride    *= dims[d];
+        }
+    }
+}
+
+// view of host memory described by desc, valid while desc.owner is
+template <typename T>
+ViewStridedArray<T> from_descriptor(const TensorDescriptor& desc) {
+    assert(desc.device_type == static_cast<int32_t>(DeviceKind::CPU) &&
+           "from_descriptor needs host memory, use from_descriptor_kokkos for device memory!");
+    size_t dims[7];
+    size_t strides[7];
+    descriptor_dims(desc, dims, strides);
+    return ViewStridedArray<T>(descriptor_data<T>(desc), dims, strides, desc.ndim);
+}
+
+#ifdef HAVE_KOKKOS
+// view of device memory described by desc, valid while desc.owner is
+template <typename T>
+ViewStridedArrayKokkos<T> from_descriptor_kokkos(const TensorDescriptor& desc) {
+    size_t dims[7];
+    size_t strides[7];
+    descriptor_dims(desc, dims, strides);
+    return ViewStridedArrayKokkos<T>(descriptor_data<T>(desc), dims, strides, desc.ndim);
+}
+
+
+// -----------------------------------------
+// Kokkos::View adapters
+// -----------------------------------------
+template <typename Space>
+struct interop_memory_space {
+    using type = Kokkos::HostSpace;
+};
+
+template <typename ExecSpace>
+struct interop_memory_space<ExprDeviceSpace<ExecSpace>> {
+    using type = typename ExecSpace::memory_space;
+};
+
+template <typename Layout>
+struct interop_kokkos_layout {
+    using type = Kokkos::LayoutRight;
+};
+
+template <>
+struct interop_kokkos_layout<InteropLayoutF> {
+    using type = Kokkos::LayoutLeft;
+};
+
+template <>
+struct interop_kokkos_layout<InteropLayoutStride> {
+    using type = Kokkos::LayoutStride;
+};
+
+template <size_t Rank, typename A>
+using interop_kokkos_view_t = Kokkos::View<typename interop_data_type<typename interop_traits<A>::value_type, Rank>::type,
+                                           typename interop_kokkos_layout<typename interop_traits<A>::layout>::type,
+                                           typename interop_memory_space<typename interop_traits<A>::space>::type,
+                                           Kokkos::MemoryUnmanaged>;
+
+template <typename ViewType, typename A, size_t... Is>
+ViewType interop_make_kokkos_view(const A& a, std::index_sequence<Is...>, InteropLayoutC) {
+    return ViewType(interop_traits<A>::data(a), interop_traits<A>::dim(a, Is)...);
+}
+
+template <typename ViewType, typename A, size_t... Is>
+ViewType interop_make_kokkos_view(const A& a, std::index_sequence<Is...>, InteropLayoutF) {
+    return ViewType(interop_traits<A>::data(a), interop_traits<A>::dim(a, Is)...);
+}
+
+template <typename ViewType, typename A, size_t... Is>
+ViewType interop_make_kokkos_view(const A& a, std::index_sequence<Is...>, InteropLayoutStride) {
+    Kokkos::LayoutStride layout;
+    for (size_t d = 0; d < sizeof...(Is); d++) {
+        layout.dimension[d] = interop_traits<A>::dim(a, d);
+        layout.stride[d]    = interop_traits<A>::stride(a, d);
+    }
+    return ViewType(interop_traits<A>::data(a), layout);
+}
+
+// unmanaged Kokkos::View of the array with the same layout, Rank must match order()
+template <size_t Rank, typename A, typename std::enable_if<interop_traits<A>::value, int>::type = 0>
+interop_kokkos_view_t<Rank, A> to_kokkos_view(const A& a) {
+    static_assert(Rank >= 1 && Rank <= 7, "to_kokkos_view supports a Rank of 1 to 7!");
+    assert(a.order() == Rank && "to_kokkos_view Rank does not match the order (rank) of the array!");
+    return interop_make_kokkos_view<interop_kokkos_view_t<Rank, A>>(a, std::make_index_sequence<Rank>(),
+                                                                    typename interop_traits<A>::layout());
+}
+
+template <typename ViewType>
+ViewCArrayKokkos<typename ViewType::value_type> interop_from_kokkos_view(const ViewType& v, Kokkos::LayoutRight) {
+    size_t dims[7];
+    for (size_t d = 0; d < ViewType::rank; d++) {
+        dims[d] = v.extent(d);
+    }
+    return view_from_dims_kokkos<ViewCArrayKokkos<typename ViewType::value_type>>(v.data(), dims, ViewType::rank);
+}
+
+template <typename ViewType>
+ViewFArrayKokkos<typename ViewType::value_type> interop_from_kokkos_view(const ViewType& v, Kokkos::LayoutLeft) {
+    size_t dims[7];
+    for (size_t d = 0; d < ViewType::rank; d++) {
+        dims[d] = v.extent(d);
+    }
+    return view_from_dims_kokkos<ViewFArrayKokkos<typename ViewType::value_type>>(v.data(), dims, ViewType::rank);
+}
+
+template <typename ViewType>
+ViewStridedArrayKokkos<typename ViewType::value_type> interop_from_kokkos_view(const ViewType& v, Kokkos::LayoutStride) {
+    size_t dims[7];
+    size_t strides[7];
+    for (size_t d = 0; d < ViewType::rank; d++) {
+        dims[d]    = v.extent(d);
+        strides[d] = v.stride(d);
+    }
+    return ViewStridedArrayKokkos<typename ViewType::value_type>(v.data(), dims, strides, ViewType::rank);
+}
+
+// MATAR view of a Kokkos::View: LayoutRight gives a ViewCArrayKokkos,
+// LayoutLeft a ViewFArrayKokkos and LayoutStride a ViewStridedArrayKokkos.
+// The view must stay allocated while the result is used
+template <typename DataType, typename... Props>
+auto from_kokkos_view(const Kokkos::View<DataType, Props...>& v)
+    -> decltype(interop_from_kokkos_view(v, typename Kokkos::View<DataType, Props...>::array_layout())) {
+    using ViewType = Kokkos::View<DataType, Props...>;
+    static_assert(ViewType::rank >= 1 && ViewType::rank <= 7, "from_kokkos_view supports a rank of 1 to 7!");
+    return interop_from_kokkos_view(v, typename ViewType::array_layout());
+}
+#endif // HAVE_KOKKOS
+
+
+#ifdef MATAR_HAVE_MDSPAN
+// -----------------------------------------
+// mdspan adapters
+// -----------------------------------------
+template <typename Layout>
+struct interop_mdspan_layout {
+    using type = mdspan_ns::layout_right;
+};
+
+template <>
+struct interop_mdspan_layout<InteropLayoutF> {
+    using type = mdspan_ns::layout_left;
+};
+
+template <>
+struct interop_mdspan_layout<InteropLayoutStride> {
+    using type = mdspan_ns::layout_stride;
+};
+
+template <size_t Rank, typename A>
+using interop_mdspan_t = mdspan_ns::mdspan<typename interop_traits<A>::value_type,
+                                           mdspan_ns::dextents<size_t, Rank>,
+                                           typename interop_mdspan_layout<typename interop_traits<A>::layout>::type>;
+
+template <typename Mdspan, typename A, size_t... Is>
+Mdspan interop_make_mdspan(const A& a, std::index_sequence<Is...>) {
+    using extents_type = typename Mdspan::extents_type;
+    using mapping_type = typename Mdspan::mapping_type;
+    if constexpr (std::is_same<typename Mdspan::layout_type, mdspan_ns::layout_stride>::value) {
+        std::array<size_t, sizeof...(Is)> strides = {interop_traits<A>::stride(a, Is)...};
+        return Mdspan(interop_traits<A>::data(a),
+                      mapping_type(extents_type(interop_traits<A>::dim(a, Is)...), strides));
+    }
+    else {
+        return Mdspan(interop_traits<A>::data(a), extents_type(interop_traits<A>::dim(a, Is)...));
+    }
+}
+
+// mdspan of the array with the same layout, Rank must match order()
+template <size_t Rank, typename A, typename std::enable_if<interop_traits<A>::value, int>::type = 0>
+interop_mdspan_t<Rank, A> to_mdspan(const A& a) {
+    static_assert(Rank >= 1 && Rank <= 7, "to_mdspan supports a Rank of 1 to 7!");
+    assert(a.order() == Rank && "to_mdspan Rank does not match the order (rank) of the array!");
+    return interop_make_mdspan<interop_mdspan_t<Rank, A>>(a, std::make_index_sequence<Rank>());
+}
+
+// shape and strides of an mdspan, in entries
+template <typename Mdspan>
+void interop_mdspan_dims(const Mdspan& m, size_t* dims, size_t* strides) {
+    constexpr size_t rank = Mdspan::extents_type::rank();
+    static_assert(rank >= 1 && rank <= 7, "from_mdspan supports a rank of 1 to 7!");
+    for (size_t d = 0; d < rank; d++) {
+        dims[d]    = m.extent(d);
+        strides[d] = m.stride(d);
+    }
+}
+
+// host view of an mdspan: layout_right gives a ViewCArray, layout_left a
+// ViewFArray and any other mapping a ViewStridedArray
+template <typename T, typename Extents, typename Layout, typename Accessor>
+auto from_mdspan(const mdspan_ns::mdspan<T, Extents, Layout, Accessor>& m) {
+    constexpr size_t rank = Extents::rank();
+    size_t dims[7];
+    size_t strides[7];
+    interop_mdspan_dims(m, dims, strides);
+    if constexpr (std::is_same<Layout, mdspan_ns::layout_right>::value) {
+        return view_from_dims<ViewCArray<T>>(m.data_handle(), dims, rank);
+    }
+    else if constexpr (std::is_same<Layout, mdspan_ns::layout_left>::value) {
+        return view_from_dims<ViewFArray<T>>(m.data_handle(), dims, rank);
+    }
+    else {
+        return ViewStridedArray<T>(m.data_handle(), dims, strides, rank);
+    }
+}
+
+#ifdef HAVE_KOKKOS
+// same for an mdspan of device memory, giving the Kokkos view types
+template <typename T, typename Extents, typename Layout, typename Accessor>
+auto from_mdspan_kokkos(const mdspan_ns::mdspan<T, Extents, Layout, Accessor>& m) {
+    constexpr size_t rank = Extents::rank();
+    size_t dims[7];
+    size_t strides[7];
+    interop_mdspan_dims(m, dims, strides);
+    if constexpr (std::is_same<Layout, mdspan_ns::layout_right>::value) {
+        return view_from_dims_kokkos<ViewCArrayKokkos<T>>(m.data_handle(), dims, rank);
+    }
+    else if constexpr (std::is_same<Layout, mdspan_ns::layout_left>::value) {
+        return view_from_dims_kokkos<ViewFArrayKokkos<T>>(m.data_handle(), dims, rank);
+    }
+    else {
+        return ViewStridedArrayKokkos<T>(m.data_handle(), dims, strides, rank);
+    }
+}
+#endif // HAVE_KOKKOS
+#endif // MATAR_HAVE_MDSPAN
+
+} // end namespace
+
+#endif // INTEROP_TYPES_H
@@ -38,10 +38,12 @@
  **********************************************************************************************/
 
 #include "host_types.h"
+#include "profile.h"
 
 #ifdef HAVE_KOKKOS
 #include <Kokkos_Core.hpp>
 #include <Kokkos_DualView.hpp>
+#include <Kokkos_ScatterView.hpp>
 
 using HostSpace    = Kokkos::HostSpace;
 using MemoryUnmanaged = Kokkos::MemoryUnmanaged;
@@ -116,6 +118,580 @@ using SHArray1D     = Kokkos::View<size_t *,DefaultLayout,Kokkos::HostSpace>;
 namespace mtr
 {
 
+/////////////////////////
+// DualModifiedRange: span of the flat storage of a dual type that was
+// modified on each side since the last update, [begin, end). Marked ranges
+// are merged into one span. It lives in a host view so that copies of a
+// dual type share it, the same way they share the DualView.
+/////////////////////////
+struct DualModifiedRange {
+    size_t host_begin   = 0;
+    size_t host_end     = 0;
+    size_t device_begin = 0;
+    size_t device_end   = 0;
+    bool   track        = false; // true: an update with nothing marked is skipped
+};
+
+using DualModifiedRangeView = Kokkos::View<DualModifiedRange, Kokkos::HostSpace>;
+
+// merge [begin, end) into the span [span_begin, span_end)
+inline void dual_mark_modified(size_t& span_begin, size_t& span_end, size_t begin, size_t end)
+{
+    if (begin >= end) return;
+    if (span_begin >= span_end) {
+        span_begin = begin;
+        span_end   = end;
+    }
+    else {
+        span_begin = begin < span_begin ? begin : span_begin;
+        span_end   = end > span_end ? end : span_end;
+    }
+}
+
+// Copy a 1D DualView to the host (to_host) or the device. Only the marked
+// span is copied if there is one, otherwise the whole view unless range
+// tracking is on. The transfer is recorded in the TransferLog. With an
+// execution space instance the copy is enqueued on it and not fenced.
+template <typename TArray1D, typename ExecInstance = typename TArray1D::execution_space>
+void dual_view_update(TArray1D& dual_view, const DualModifiedRangeView& modified, bool to_host,
+                      const ExecInstance* exec = nullptr)
+{
+    using value_type = typename TArray1D::t_host::value_type;
+
+    size_t length = dual_view.view_host().size();
+    size_t begin  = 0;
+    size_t end    = length;
+
+    if (modified.data() != nullptr) {
+        DualModifiedRange& range = modified();
+        size_t& span_begin = to_host ? range.device_begin : range.host_begin;
+        size_t& span_end   = to_host ? range.device_end : range.host_end;
+        if (span_begin < span_end) {
+            begin = span_begin;
+            end   = span_end < length ? span_end : length;
+        }
+        else if (range.track) {
+            TransferLog::instance().record(dual_view.view_host(), to_host, 0, true);
+            return;
+        }
+        span_begin = span_end = 0;
+    }
+
+    TransferLog::instance().record(dual_view.view_host(), to_host, (end - begin) * sizeof(value_type));
+
+    if (begin == 0 && end == length && exec == nullptr) {
+        if (to_host) {
+            dual_view.template modify<typename TArray1D::execution_space>();
+            dual_view.template sync<typename TArray1D::host_mirror_space>();
+        }
+        else {
+            dual_view.template modify<typename TArray1D::host_mirror_space>();
+            dual_view.template sync<typename TArray1D::execution_space>();
+        }
+    }
+    else {
+        auto host_span   = Kokkos::subview(dual_view.view_host(), std::make_pair(begin, end));
+        auto device_span = Kokkos::subview(dual_view.view_device(), std::make_pair(begin, end));
+        if (exec != nullptr) {
+            if (to_host) {
+                Kokkos::deep_copy(*exec, host_span, device_span);
+            }
+            else {
+                Kokkos::deep_copy(*exec, device_span, host_span);
+            }
+        }
+        else if (to_host) {
+            Kokkos::deep_copy(host_span, device_span);
+        }
+        else {
+            Kokkos::deep_copy(device_span, host_span);
+        }
+    }
+} // end dual_view_update
+
+
+/////////////////////////
+// ExecEvent: remembers the execution space instance that async work was
+// enqueued on. Record it after enqueueing an async update or a kernel, then
+// wait() on it before touching the data. Kokkos has no portable event, so
+// wait() fences the whole instance: it also waits for work enqueued on that
+// instance after record(). Work on other instances is not blocked, so a
+// transfer of one field can overlap compute on another:
+//
+//   auto streams = Kokkos::Experimental::partition_space(DefaultExecSpace(), 1, 1);
+//   A.update_host(streams[0]);
+//   ExecEvent<> a_on_host(streams[0]);
+//   ... kernels on streams[1] ...
+//   a_on_host.wait();
+//
+// Host to device copies only overlap when the host data is pinned. The
+// async updates are counted in the TransferLog but not timed by the
+// Profiler, whose scopes fence.
+/////////////////////////
+template <typename ExecInstance = DefaultExecSpace>
+class ExecEvent {
+
+private:
+    ExecInstance exec_;
+    bool recorded_;
+
+public:
+    ExecEvent() : recorded_(false) {}
+
+    explicit ExecEvent(const ExecInstance& exec) : exec_(exec), recorded_(true) {}
+
+    // remember the instance the work was enqueued on
+    void record(const ExecInstance& exec)
+    {
+        exec_     = exec;
+        recorded_ = true;
+    }
+
+    // block the host until all work on the instance is done
+    void wait() const
+    {
+        if (recorded_) {
+            exec_.fence("ExecEvent::wait");
+        }
+    }
+
+    bool recorded() const { return recorded_; }
+}; // End of ExecEvent
+
+
+// device callable version of view_from_dims for the Kokkos view types
+template <typename View, typename T>
+KOKKOS_INLINE_FUNCTION
+View view_from_dims_kokkos(T* array, const size_t* dims, size_t order) {
+    switch (order) {
+        case 1:  return View(array, dims[0]);
+        case 2:  return View(array, dims[0], dims[1]);
+        case 3:  return View(array, dims[0], dims[1], dims[2]);
+        case 4:  return View(array, dims[0], dims[1], dims[2], dims[3]);
+        case 5:  return View(array, dims[0], dims[1], dims[2], dims[3], dims[4]);
+        case 6:  return View(array, dims[0], dims[1], dims[2], dims[3], dims[4], dims[5]);
+        default: return View(array, dims[0], dims[1], dims[2], dims[3], dims[4], dims[5], dims[6]);
+    }
+}
+
+template <typename T>
+class ViewFArrayKokkos;
+
+template <typename T>
+class ViewCArrayKokkos;
+
+/*! \brief Kokkos version of the serial ViewStridedArray class.
+ *
+ *  A zero-copy view with a stride per dimension, made with subview() on the
+ *  C and F Kokkos and dual types, usable inside kernels.
+ */
+template <typename T>
+class ViewStridedArrayKokkos {
+
+private:
+    size_t dims_[7];
+    size_t strides_[7];
+    size_t length_; // number of entries in the view
+    size_t order_;  // tensor order (rank)
+    T * array_;
+
+    // apply one subview argument to dimension d, an index removes the
+    // dimension and a Range keeps it
+    KOKKOS_INLINE_FUNCTION
+    void apply_subview_(size_t d, size_t index, ViewStridedArrayKokkos& view) const;
+
+    KOKKOS_INLINE_FUNCTION
+    void apply_subview_(size_t d, const Range& range, ViewStridedArrayKokkos& view) const;
+
+public:
+
+    // Default constructor
+    KOKKOS_INLINE_FUNCTION
+    ViewStridedArrayKokkos ();
+
+    // view of order dims with the given strides (in entries)
+    KOKKOS_INLINE_FUNCTION
+    ViewStridedArrayKokkos (T *array,
+                            const size_t *dims,
+                            const size_t *strides,
+                            size_t order);
+
+    // view of a contiguous array, row-major (C) or column-major (F)
+    KOKKOS_INLINE_FUNCTION
+    ViewStridedArrayKokkos (T *array,
+                            const size_t *dims,
+                            size_t order,
+                            bool column_major);
+
+    KOKKOS_INLINE_FUNCTION
+    T& operator()(size_t i) const;
+
+    KOKKOS_INLINE_FUNCTION
+    T& operator()(size_t i,
+                  size_t j) const;
+
+    KOKKOS_INLINE_FUNCTION
+    T& operator()(size_t i,
+                  size_t j,
+                  size_t k) const;
+
+    KOKKOS_INLINE_FUNCTION
+    T& operator()(size_t i,
+                  size_t j,
+                  size_t k,
+                  size_t l) const;
+
+    KOKKOS_INLINE_FUNCTION
+    T& operator()(size_t i,
+                  size_t j,
+                  size_t k,
+                  size_t l,
+                  size_t m) const;
+
+    KOKKOS_INLINE_FUNCTION
+    T& operator()(size_t i,
+                  size_t j,
+                  size_t k,
+                  size_t l,
+                  size_t m,
+                  size_t n) const;
+
+    KOKKOS_INLINE_FUNCTION
+    T& operator()(size_t i,
+                  size_t j,
+                  size_t k,
+                  size_t l,
+                  size_t m,
+                  size_t n,
+                  size_t o) const;
+
+    // view of part of this view, one index or Range per dimension
+    template <typename... Args>
+    KOKKOS_INLINE_FUNCTION
+    ViewStridedArrayKokkos subview(Args... args) const;
+
+    //return array size
+    KOKKOS_INLINE_FUNCTION
+    size_t size() const;
+
+    // return array dims
+    KOKKOS_INLINE_FUNCTION
+    size_t dims(size_t i) const;
+
+    // return the stride of dimension i, in entries
+    KOKKOS_INLINE_FUNCTION
+    size_t stride(size_t i) const;
+
+    // return array order (rank)
+    KOKKOS_INLINE_FUNCTION
+    size_t order() const;
+
+    // true if the entries are contiguous in row-major order
+    KOKKOS_INLINE_FUNCTION
+    bool is_contiguous() const;
+
+    // set values on device to input
+    void set_values(T val);
+
+    // return pointer to the first entry
+    KOKKOS_INLINE_FUNCTION
+    T* pointer() const;
+
+    KOKKOS_INLINE_FUNCTION
+    ~ViewStridedArrayKokkos();
+
+}; // end of ViewStridedArrayKokkos
+
+//class definitions
+
+//constructors
+
+//no dim
+template <typename T>
+KOKKOS_INLINE_FUNCTION
+ViewStridedArrayKokkos<T>::ViewStridedArrayKokkos() {
+    array_ = NULL;
+    length_ = order_ = 0;
+    for (int i = 0; i < 7; i++) {
+        dims_[i] = 0;
+        strides_[i] = 0;
+    }
+}
+
+template <typename T>
+KOKKOS_INLINE_FUNCTION
+ViewStridedArrayKokkos<T>::ViewStridedArrayKokkos(T *array,
+                                      const size_t *dims,
+                                      const size_t *strides,
+                                      size_t order)
+{
+    assert(order <= 7 && "ViewStridedArrayKokkos order (rank) must be 7 or less!");
+    array_ = array;
+    order_ = order;
+    length_ = 1;
+    for (size_t d = 0; d < 7; d++) {
+        dims_[d] = d < order ? dims[d] : 0;
+        strides_[d] = d < order ? strides[d] : 0;
+        if (d < order) {
+            length_ *= dims_[d];
+        }
+    }
+}
+
+template <typename T>
+KOKKOS_INLINE_FUNCTION
+ViewStridedArrayKokkos<T>::ViewStridedArrayKokkos(T *array,
+                                      const size_t *dims,
+                                      size_t order,
+                                      bool column_major)
+{
+    assert(order <= 7 && "ViewStridedArrayKokkos order (rank) must be 7 or less!");
+    array_ = array;
+    order_ = order;
+    length_ = 1;
+    for (size_t d = 0; d < 7; d++) {
+        dims_[d] = d < order ? dims[d] : 0;
+        strides_[d] = 0;
+    }
+    for (size_t n = 0; n < order; n++) {
+        size_t d = column_major ? n : order - 1 - n;
+        strides_[d] = length_;
+        length_ *= dims_[d];
+    }
+}
+
+//overload operator () to access data as array(i,....,n);
+//1D
+template <typename T>
+KOKKOS_INLINE_FUNCTION
+T& ViewStridedArrayKokkos<T>::operator()(size_t i) const
+{
+    assert(order_ == 1 && "Tensor order (rank) does not match constructor in ViewStridedArrayKokkos 1D!");
+    assert(i < dims_[0] && "i is out of bounds in ViewStridedArrayKokkos 1D!");
+
+    return array_[i * strides_[0]];
+}
+
+//2D
+template <typename T>
+KOKKOS_INLINE_FUNCTION
+T& ViewStridedArrayKokkos<T>::operator()(size_t i,
+                                          size_t j) const
+{
+    assert(order_ == 2 && "Tensor order (rank) does not match constructor in ViewStridedArrayKokkos 2D!");
+    assert(i < dims_[0] && "i is out of bounds in ViewStridedArrayKokkos 2D!");
+    assert(j < dims_[1] && "j is out of bounds in ViewStridedArrayKokkos 2D!");
+
+    return array_[i * strides_[0] + j * strides_[1]];
+}
+
+//3D
+template <typename T>
+KOKKOS_INLINE_FUNCTION
+T& ViewStridedArrayKokkos<T>::operator()(size_t i,
+                                          size_t j,
+                                          size_t k) const
+{
+    assert(order_ == 3 && "Tensor order (rank) does not match constructor in ViewStridedArrayKokkos 3D!");
+    assert(i < dims_[0] && "i is out of bounds in ViewStridedArrayKokkos 3D!");
+    assert(j < dims_[1] && "j is out of bounds in ViewStridedArrayKokkos 3D!");
+    assert(k < dims_[2] && "k is out of bounds in ViewStridedArrayKokkos 3D!");
+
+    return array_[i * strides_[0] + j * strides_[1] + k * strides_[2]];
+}
+
+//4D
+template <typename T>
+KOKKOS_INLINE_FUNCTION
+T& ViewStridedArrayKokkos<T>::operator()(size_t i,
+                                          size_t j,
+                                          size_t k,
+                                          size_t l) const
+{
+    assert(order_ == 4 && "Tensor order (rank) does not match constructor in ViewStridedArrayKokkos 4D!");
+    assert(i < dims_[0] && "i is out of bounds in ViewStridedArrayKokkos 4D!");
+    assert(j < dims_[1] && "j is out of bounds in ViewStridedArrayKokkos 4D!");
+    assert(k < dims_[2] && "k is out of bounds in ViewStridedArrayKokkos 4D!");
+    assert(l < dims_[3] && "l is out of bounds in ViewStridedArrayKokkos 4D!");
+
+    return array_[i * strides_[0] + j * strides_[1] + k * strides_[2]
+                + l * strides_[3]];
+}
+
+//5D
+template <typename T>
+KOKKOS_INLINE_FUNCTION
+T& ViewStridedArrayKokkos<T>::operator()(size_t i,
+                                          size_t j,
+                                          size_t k,
+                                          size_t l,
+                                          size_t m) const
+{
+    assert(order_ == 5 && "Tensor order (rank) does not match constructor in ViewStridedArrayKokkos 5D!");
+    assert(i < dims_[0] && "i is out of bounds in ViewStridedArrayKokkos 5D!");
+    assert(j < dims_[1] && "j is out of bounds in ViewStridedArrayKokkos 5D!");
+    assert(k < dims_[2] && "k is out of bounds in ViewStridedArrayKokkos 5D!");
+    assert(l < dims_[3] && "l is out of bounds in ViewStridedArrayKokkos 5D!");
+    assert(m < dims_[4] && "m is out of bounds in ViewStridedArrayKokkos 5D!");
+
+    return array_[i * strides_[0] + j * strides_[1] + k * strides_[2]
+                + l * strides_[3] + m * strides_[4]];
+}
+
+//6D
+template <typename T>
+KOKKOS_INLINE_FUNCTION
+T& ViewStridedArrayKokkos<T>::operator()(size_t i,
+                                          size_t j,
+                                          size_t k,
+                                          size_t l,
+                                          size_t m,
+                                          size_t n) const
+{
+    assert(order_ == 6 && "Tensor order (rank) does not match constructor in ViewStridedArrayKokkos 6D!");
+    assert(i < dims_[0] && "i is out of bounds in ViewStridedArrayKokkos 6D!");
+    assert(j < dims_[1] && "j is out of bounds in ViewStridedArrayKokkos 6D!");
+    assert(k < dims_[2] && "k is out of bounds in ViewStridedArrayKokkos 6D!");
+    assert(l < dims_[3] && "l is out of bounds in ViewStridedArrayKokkos 6D!");
+    assert(m < dims_[4] && "m is out of bounds in ViewStridedArrayKokkos 6D!");
+    assert(n < dims_[5] && "n is out of bounds in ViewStridedArrayKokkos 6D!");
+
+    return array_[i * strides_[0] + j * strides_[1] + k * strides_[2]
+                + l * strides_[3] + m * strides_[4] + n * strides_[5]];
+}
+
+//7D
+template <typename T>
+KOKKOS_INLINE_FUNCTION
+T& ViewStridedArrayKokkos<T>::operator()(size_t i,
+                                          size_t j,
+                                          size_t k,
+                                          size_t l,
+                                          size_t m,
+                                          size_t n,
+                                          size_t o) const
+{
+    assert(order_ == 7 && "Tensor order (rank) does not match constructor in ViewStridedArrayKokkos 7D!");
+    assert(i < dims_[0] && "i is out of bounds in ViewStridedArrayKokkos 7D!");
+    assert(j < dims_[1] && "j is out of bounds in ViewStridedArrayKokkos 7D!");
+    assert(k < dims_[2] && "k is out of bounds in ViewStridedArrayKokkos 7D!");
+    assert(l < dims_[3] && "l is out of bounds in ViewStridedArrayKokkos 7D!");
+    assert(m < dims_[4] && "m is out of bounds in ViewStridedArrayKokkos 7D!");
+    assert(n < dims_[5] && "n is out of bounds in ViewStridedArrayKokkos 7D!");
+    assert(o < dims_[6] && "o is out of bounds in ViewStridedArrayKokkos 7D!");
+
+    return array_[i * strides_[0] + j * strides_[1] + k * strides_[2]
+                + l * strides_[3] + m * strides_[4] + n * strides_[5]
+                + o * strides_[6]];
+}
+
+template <typename T>
+KOKKOS_INLINE_FUNCTION
+void ViewStridedArrayKokkos<T>::apply_subview_(size_t d, size_t index, ViewStridedArrayKokkos& view) const {
+    assert(index < dims_[d] && "subview index is out of bounds in ViewStridedArrayKokkos!");
+    view.array_ += index * strides_[d];
+}
+
+template <typename T>
+KOKKOS_INLINE_FUNCTION
+void ViewStridedArrayKokkos<T>::apply_subview_(size_t d, const Range& range, ViewStridedArrayKokkos& view) const {
+    size_t end = range.end > dims_[d] ? dims_[d] : range.end;
+    assert(range.step > 0 && "subview Range step must be positive in ViewStridedArrayKokkos!");
+    assert(range.begin <= end && "subview Range is out of bounds in ViewStridedArrayKokkos!");
+
+    size_t count = (end - range.begin + range.step - 1) / range.step;
+    view.array_ += range.begin * strides_[d];
+    view.dims_[view.order_] = count;
+    view.strides_[view.order_] = strides_[d] * range.step;
+    view.order_++;
+    view.length_ *= count;
+}
+
+template <typename T>
+template <typename... Args>
+KOKKOS_INLINE_FUNCTION
+ViewStridedArrayKokkos<T> ViewStridedArrayKokkos<T>::subview(Args... args) const {
+    assert(sizeof...(Args) == order_ && "subview needs an index or Range for every dimension of ViewStridedArrayKokkos!");
+
+    ViewStridedArrayKokkos<T> view;
+    view.array_ = array_;
+    view.length_ = 1;
+
+    size_t d = 0;
+    (apply_subview_(d++, args, view), ...);
+
+    assert(view.order_ > 0 && "subview must keep at least one dimension, use operator() for a single entry!");
+    return view;
+}
+
+template <typename T>
+KOKKOS_INLINE_FUNCTION
+size_t ViewStridedArrayKokkos<T>::size() const {
+    return length_;
+}
+
+template <typename T>
+KOKKOS_INLINE_FUNCTION
+size_t ViewStridedArrayKokkos<T>::dims(size_t i) const {
+    assert(i < order_ && "ViewStridedArrayKokkos order (rank) does not match constructor, dim[i] does not exist!");
+    return dims_[i];
+}
+
+template <typename T>
+KOKKOS_INLINE_FUNCTION
+size_t ViewStridedArrayKokkos<T>::stride(size_t i) const {
+    assert(i < order_ && "ViewStridedArrayKokkos order (rank) does not match constructor, stride[i] does not exist!");
+    return strides_[i];
+}
+
+template <typename T>
+KOKKOS_INLINE_FUNCTION
+size_t ViewStridedArrayKokkos<T>::order() const {
+    return order_;
+}
+
+template <typename T>
+KOKKOS_INLINE_FUNCTION
+bool ViewStridedArrayKokkos<T>::is_contiguous() const {
+    size_t expected = 1;
+    for (int d = (int)order_ - 1; d >= 0; d--) {
+        if (dims_[d] > 1 && strides_[d] != expected) {
+            return false;
+        }
+        expected *= dims_[d];
+    }
+    return true;
+}
+
+template <typename T>
+void ViewStridedArrayKokkos<T>::set_values(T val) {
+    ViewStridedArrayKokkos<T> view = *this;
+    Kokkos::parallel_for("SetValues_ViewStridedArrayKokkos", Kokkos::RangePolicy<> ( 0, length_), KOKKOS_LAMBDA(const int flat){
+        size_t rest = flat;
+        size_t offset = 0;
+        for (int d = (int)view.order_ - 1; d >= 0; d--) {
+            offset += (rest % view.dims_[d]) * view.strides_[d];
+            rest /= view.dims_[d];
+        }
+        view.array_[offset] = val;
+    });
+}
+
+template <typename T>
+KOKKOS_INLINE_FUNCTION
+T* ViewStridedArrayKokkos<T>::pointer() const {
+    return array_;
+}
+
+template <typename T>
+KOKKOS_INLINE_FUNCTION
+ViewStridedArrayKokkos<T>::~ViewStridedArrayKokkos() {}
+
+////////////////////////////////////////////////////////////////////////////////
+// End of ViewStridedArrayKokkos
+////////////////////////////////////////////////////////////////////////////////
+
+
 /*! \brief Kokkos version of the serial FArray class.
  *
  *  This is the Kokkos version of the serial FArray class.
@@ -240,6 +816,15 @@ public:
     KOKKOS_INLINE_FUNCTION
     const std::string get_name() const;
 
+    // slice fixing the last index, a contiguous view of order()-1
+    KOKKOS_INLINE_FUNCTION
+    ViewFArrayKokkos<T> slice(size_t i) const;
+
+    // strided view of part of the array, one index or Range per dimension
+    template <typename... Args>
+    KOKKOS_INLINE_FUNCTION
+    ViewStridedArrayKokkos<T> subview(Args... args) const;
+
     // Destructor
     KOKKOS_INLINE_FUNCTION
     ~FArrayKokkos();
@@ -550,11 +1135,26 @@ void FArrayKokkos<T,Layout,ExecSpace,MemoryTraits>::set_values(T val) {
 // Destructor
 template <typename T, typename Layout, typename ExecSpace, typename MemoryTraits>
 KOKKOS_INLINE_FUNCTION
-FArrayKokkos<T,Layout,ExecSpace,MemoryTraits>::~FArrayKokkos() {}
-
-////////////////////////////////////////////////////////////////////////////////
-// End of FArrayKokkos
-////////////////////////////////////////////////////////////////////////////////
+ViewFArrayKokkos<T> FArrayKokkos<T,Layout,ExecSpace,MemoryTraits>::slice(size_t i) const {
+    assert(order_ > 1 && "slice needs an order (rank) of 2 or more in FArrayKokkos!");
+    assert(i < dims_[order_ - 1] && "i is out of bounds in FArrayKokkos slice!");
+    return view_from_dims_kokkos<ViewFArrayKokkos<T>>(this_array_.data() + i * (length_ / dims_[order_ - 1]), dims_, order_ - 1);
+}
+
+template <typename T, typename Layout, typename ExecSpace, typename MemoryTraits>
+template <typename... Args>
+KOKKOS_INLINE_FUNCTION
+ViewStridedArrayKokkos<T> FArrayKokkos<T,Layout,ExecSpace,MemoryTraits>::subview(Args... args) const {
+    return ViewStridedArrayKokkos<T>(this_array_.data(), dims_, order_, true).subview(args...);
+}
+
+template <typename T, typename Layout, typename ExecSpace, typename MemoryTraits>
+KOKKOS_INLINE_FUNCTION
+FArrayKokkos<T,Layout,ExecSpace,MemoryTraits>::~FArrayKokkos() {}
+
+////////////////////////////////////////////////////////////////////////////////
+// End of FArrayKokkos
+////////////////////////////////////////////////////////////////////////////////
 
 /*! \brief Kokkos version of the serial ViewFArray class.
  *
@@ -641,6 +1241,15 @@ public:
     // set values on host to input
     void set_values(T val);
 
+    // slice fixing the last index, a contiguous view of order()-1
+    KOKKOS_INLINE_FUNCTION
+    ViewFArrayKokkos<T> slice(size_t i) const;
+
+    // strided view of part of the array, one index or Range per dimension
+    template <typename... Args>
+    KOKKOS_INLINE_FUNCTION
+    ViewStridedArrayKokkos<T> subview(Args... args) const;
+
     KOKKOS_INLINE_FUNCTION
     ~ViewFArrayKokkos();
 
@@ -898,6 +1507,21 @@ void ViewFArrayKokkos<T>::set_values(T val) {
     });
 }
 
+template <typename T>
+KOKKOS_INLINE_FUNCTION
+ViewFArrayKokkos<T> ViewFArrayKokkos<T>::slice(size_t i) const {
+    assert(order_ > 1 && "slice needs an order (rank) of 2 or more in ViewFArrayKokkos!");
+    assert(i < dims_[order_ - 1] && "i is out of bounds in ViewFArrayKokkos slice!");
+    return view_from_dims_kokkos<ViewFArrayKokkos<T>>(this_array_ + i * (length_ / dims_[order_ - 1]), dims_, order_ - 1);
+}
+
+template <typename T>
+template <typename... Args>
+KOKKOS_INLINE_FUNCTION
+ViewStridedArrayKokkos<T> ViewFArrayKokkos<T>::subview(Args... args) const {
+    return ViewStridedArrayKokkos<T>(this_array_, dims_, order_, true).subview(args...);
+}
+
 template <typename T>
 KOKKOS_INLINE_FUNCTION
 ViewFArrayKokkos<T>::~ViewFArrayKokkos() {}
@@ -1664,6 +2288,7 @@ private:
     size_t order_;  // tensor order (rank)
     bool   lock_ = false;
     TArray1D this_array_;
+    DualModifiedRangeView modified_;
 
 public:
     // Data member to access host view
@@ -1746,6 +2371,23 @@ public:
     // Method that update device view
     void update_device();
 
+    // Methods that enqueue the update on the execution space instance exec
+    // and return without fencing, fence exec or wait on an ExecEvent first
+    template <typename ExecInstance>
+    void update_host(const ExecInstance& exec);
+
+    template <typename ExecInstance>
+    void update_device(const ExecInstance& exec);
+
+    // Methods that mark the flat index range [begin, end) as modified on the
+    // host or device, the next update then copies only the marked span
+    void modified_host(size_t begin, size_t end);
+
+    void modified_device(size_t begin, size_t end);
+
+    // Method that turns on range tracking, an update with nothing marked is skipped
+    void track_modified(bool track);
+
     // Method that locks updates
     void lock_update();
 
@@ -1760,6 +2402,15 @@ public:
     KOKKOS_INLINE_FUNCTION
     const std::string get_name() const;
 
+    // slice fixing the last index of the device data, a contiguous view of
+    // order()-1. host.slice() and host.subview() give views of the host data
+    KOKKOS_INLINE_FUNCTION
+    ViewFArrayKokkos<T> slice(size_t i) const;
+
+    // strided view of part of the array, one index or Range per dimension
+    template <typename... Args>
+    KOKKOS_INLINE_FUNCTION
+    ViewStridedArrayKokkos<T> subview(Args... args) const;
 
     // Deconstructor
     KOKKOS_INLINE_FUNCTION
@@ -1784,6 +2435,7 @@ DFArrayKokkos<T,Layout,ExecSpace,MemoryTraits>::DFArrayKokkos(size_t dim0, const
     order_ = 1;
     length_ = dim0;
     this_array_ = TArray1D(tag_string, length_);
+    modified_ = DualModifiedRangeView(tag_string + "_modified");
     // Create host ViewFArray
     host = ViewFArray <T> (this_array_.view_host().data(), dim0);
 }
@@ -1797,6 +2449,7 @@ DFArrayKokkos<T,Layout,ExecSpace,MemoryTraits>::DFArrayKokkos(size_t dim0, size_
     order_ = 2;
     length_ = (dim0 * dim1);
     this_array_ = TArray1D(tag_string, length_);
+    modified_ = DualModifiedRangeView(tag_string + "_modified");
     // Create host ViewFArray
     host = ViewFArray <T> (this_array_.view_host().data(), dim0, dim1);
 }
@@ -1811,6 +2464,7 @@ DFArrayKokkos<T,Layout,ExecSpace,MemoryTraits>::DFArrayKokkos(size_t dim0, size_
     order_ = 3;
     length_ = (dim0 * dim1 * dim2);
     this_array_ = TArray1D(tag_string, length_);
+    modified_ = DualModifiedRangeView(tag_string + "_modified");
     // Create host ViewFArray
     host = ViewFArray <T> (this_array_.view_host().data(), dim0, dim1, dim2);
 }
@@ -1826,6 +2480,7 @@ DFArrayKokkos<T,Layout,ExecSpace,MemoryTraits>::DFArrayKokkos(size_t dim0, size_
     order_ = 4;
     length_ = (dim0 * dim1 * dim2 * dim3);
     this_array_ = TArray1D(tag_string, length_);
+    modified_ = DualModifiedRangeView(tag_string + "_modified");
     // Create host ViewFArray
     host = ViewFArray <T> (this_array_.view_host().data(), dim0, dim1, dim2, dim3);
 }
@@ -1843,6 +2498,7 @@ DFArrayKokkos<T,Layout,ExecSpace,MemoryTraits>::DFArrayKokkos(size_t dim0, size_
     order_ = 5;
     length_ = (dim0 * dim1 * dim2 * dim3 * dim4);
     this_array_ = TArray1D(tag_string, length_);
+    modified_ = DualModifiedRangeView(tag_string + "_modified");
     // Create host ViewFArray
     host = ViewFArray <T> (this_array_.view_host().data(), dim0, dim1, dim2, dim3, dim4);
 }
@@ -1861,6 +2517,7 @@ DFArrayKokkos<T,Layout,ExecSpace,MemoryTraits>::DFArrayKokkos(size_t dim0, size_
     order_ = 6;
     length_ = (dim0 * dim1 * dim2 * dim3 * dim4 * dim5);
     this_array_ = TArray1D(tag_string, length_);
+    modified_ = DualModifiedRangeView(tag_string + "_modified");
     // Create host ViewFArray
     host = ViewFArray <T> (this_array_.view_host().data(), dim0, dim1, dim2, dim3, dim4, dim5);
 }
@@ -1881,6 +2538,7 @@ DFArrayKokkos<T,Layout,ExecSpace,MemoryTraits>::DFArrayKokkos(size_t dim0, size_
     order_ = 7;
     length_ = (dim0 * dim1 * dim2 * dim3 * dim4 * dim5 * dim6);
     this_array_ = TArray1D(tag_string, length_);
+    modified_ = DualModifiedRangeView(tag_string + "_modified");
     // Create host ViewFArray
     host = ViewFArray <T> (this_array_.view_host().data(), dim0, dim1, dim2, dim3, dim4, dim5, dim6);
 }
@@ -1995,6 +2653,7 @@ DFArrayKokkos<T,Layout,ExecSpace,MemoryTraits>& DFArrayKokkos<T,Layout,ExecSpace
         this_array_ = temp.this_array_;
         host = temp.host;
         lock_ = temp.lock_;
+        modified_ = temp.modified_;
     }
     
     return *this;
@@ -2041,18 +2700,54 @@ T* DFArrayKokkos<T,Layout,ExecSpace,MemoryTraits>::host_pointer() const {
 
 template <typename T, typename Layout, typename ExecSpace, typename MemoryTraits>
 void DFArrayKokkos<T,Layout,ExecSpace,MemoryTraits>::update_host() {
+    MATAR_PROFILE_SCOPE("DFArrayKokkos::update_host", ProfileCategory::transfer);
     assert(!lock_ && "This data is locked, no copy will be done.");
     if (lock_) return;
-    this_array_.template modify<typename TArray1D::execution_space>();
-    this_array_.template sync<typename TArray1D::host_mirror_space>();
+    dual_view_update(this_array_, modified_, true);
 }
 
 template <typename T, typename Layout, typename ExecSpace, typename MemoryTraits>
 void DFArrayKokkos<T,Layout,ExecSpace,MemoryTraits>::update_device() {
+    MATAR_PROFILE_SCOPE("DFArrayKokkos::update_device", ProfileCategory::transfer);
     assert(!lock_ && "This data is locked, no copy will be done.");
     if (lock_) return;
-    this_array_.template modify<typename TArray1D::host_mirror_space>();
-    this_array_.template sync<typename TArray1D::execution_space>();
+    dual_view_update(this_array_, modified_, false);
+}
+
+template <typename T, typename Layout, typename ExecSpace, typename MemoryTraits>
+template <typename ExecInstance>
+void DFArrayKokkos<T,Layout,ExecSpace,MemoryTraits>::update_host(const ExecInstance& exec) {
+    assert(!lock_ && "This data is locked, no copy will be done.");
+    if (lock_) return;
+    dual_view_update(this_array_, modified_, true, &exec);
+}
+
+template <typename T, typename Layout, typename ExecSpace, typename MemoryTraits>
+template <typename ExecInstance>
+void DFArrayKokkos<T,Layout,ExecSpace,MemoryTraits>::update_device(const ExecInstance& exec) {
+    assert(!lock_ && "This data is locked, no copy will be done.");
+    if (lock_) return;
+    dual_view_update(this_array_, modified_, false, &exec);
+}
+
+template <typename T, typename Layout, typename ExecSpace, typename MemoryTraits>
+void DFArrayKokkos<T,Layout,ExecSpace,MemoryTraits>::modified_host(size_t begin, size_t end) {
+    assert(end <= length_ && "Modified range is out of bounds in DFArrayKokkos!");
+    if (modified_.data() == nullptr) return;
+    dual_mark_modified(modified_().host_begin, modified_().host_end, begin, end);
+}
+
+template <typename T, typename Layout, typename ExecSpace, typename MemoryTraits>
+void DFArrayKokkos<T,Layout,ExecSpace,MemoryTraits>::modified_device(size_t begin, size_t end) {
+    assert(end <= length_ && "Modified range is out of bounds in DFArrayKokkos!");
+    if (modified_.data() == nullptr) return;
+    dual_mark_modified(modified_().device_begin, modified_().device_end, begin, end);
+}
+
+template <typename T, typename Layout, typename ExecSpace, typename MemoryTraits>
+void DFArrayKokkos<T,Layout,ExecSpace,MemoryTraits>::track_modified(bool track) {
+    if (modified_.data() == nullptr) return;
+    modified_().track = track;
 }
 
 // Get the name of the view
@@ -2079,6 +2774,21 @@ void DFArrayKokkos<T,Layout,ExecSpace,MemoryTraits>::unlock_update() {
     lock_ = false;
 }
 
+template <typename T, typename Layout, typename ExecSpace, typename MemoryTraits>
+KOKKOS_INLINE_FUNCTION
+ViewFArrayKokkos<T> DFArrayKokkos<T,Layout,ExecSpace,MemoryTraits>::slice(size_t i) const {
+    assert(order_ > 1 && "slice needs an order (rank) of 2 or more in DFArrayKokkos!");
+    assert(i < dims_[order_ - 1] && "i is out of bounds in DFArrayKokkos slice!");
+    return view_from_dims_kokkos<ViewFArrayKokkos<T>>(this_array_.view_device().data() + i * (length_ / dims_[order_ - 1]), dims_, order_ - 1);
+}
+
+template <typename T, typename Layout, typename ExecSpace, typename MemoryTraits>
+template <typename... Args>
+KOKKOS_INLINE_FUNCTION
+ViewStridedArrayKokkos<T> DFArrayKokkos<T,Layout,ExecSpace,MemoryTraits>::subview(Args... args) const {
+    return ViewStridedArrayKokkos<T>(this_array_.view_device().data(), dims_, order_, true).subview(args...);
+}
+
 template <typename T, typename Layout, typename ExecSpace, typename MemoryTraits>
 KOKKOS_INLINE_FUNCTION
 DFArrayKokkos<T,Layout,ExecSpace,MemoryTraits>::~DFArrayKokkos() {}
@@ -2191,6 +2901,14 @@ public:
     // Method that update device view
     void update_device();
 
+    // Methods that enqueue the update on the execution space instance exec
+    // and return without fencing, fence exec or wait on an ExecEvent first
+    template <typename ExecInstance>
+    void update_host(const ExecInstance& exec);
+
+    template <typename ExecInstance>
+    void update_device(const ExecInstance& exec);
+
 
     // set values on host to input
     void set_values(T val);
@@ -2199,6 +2917,15 @@ public:
     KOKKOS_INLINE_FUNCTION
     const std::string get_name() const;
 
+    // slice fixing the last index of the device data, a contiguous view of
+    // order()-1. host.slice() and host.subview() give views of the host data
+    KOKKOS_INLINE_FUNCTION
+    ViewFArrayKokkos<T> slice(size_t i) const;
+
+    // strided view of part of the array, one index or Range per dimension
+    template <typename... Args>
+    KOKKOS_INLINE_FUNCTION
+    ViewStridedArrayKokkos<T> subview(Args... args) const;
 
     // Deconstructor
     KOKKOS_INLINE_FUNCTION
@@ -2528,16 +3255,34 @@ T* DViewFArrayKokkos<T,Layout,ExecSpace,MemoryTraits>::host_pointer() const {
 
 template <typename T, typename Layout, typename ExecSpace, typename MemoryTraits>
 void DViewFArrayKokkos<T,Layout,ExecSpace,MemoryTraits>::update_host() {
+    MATAR_PROFILE_SCOPE("DViewFArrayKokkos::update_host", ProfileCategory::transfer);
+    TransferLog::instance().record(this_array_, true, this_array_.size() * sizeof(T));
     // Deep copy of device view to host view
     deep_copy(this_array_host_, this_array_);
 }
 
 template <typename T, typename Layout, typename ExecSpace, typename MemoryTraits>
 void DViewFArrayKokkos<T,Layout,ExecSpace,MemoryTraits>::update_device() {
+    MATAR_PROFILE_SCOPE("DViewFArrayKokkos::update_device", ProfileCategory::transfer);
+    TransferLog::instance().record(this_array_, false, this_array_.size() * sizeof(T));
     // Deep copy of host view to device view
     deep_copy(this_array_, this_array_host_);
 }
 
+template <typename T, typename Layout, typename ExecSpace, typename MemoryTraits>
+template <typename ExecInstance>
+void DViewFArrayKokkos<T,Layout,ExecSpace,MemoryTraits>::update_host(const ExecInstance& exec) {
+    TransferLog::instance().record(this_array_, true, this_array_.size() * sizeof(T));
+    deep_copy(exec, this_array_host_, this_array_);
+}
+
+template <typename T, typename Layout, typename ExecSpace, typename MemoryTraits>
+template <typename ExecInstance>
+void DViewFArrayKokkos<T,Layout,ExecSpace,MemoryTraits>::update_device(const ExecInstance& exec) {
+    TransferLog::instance().record(this_array_, false, this_array_.size() * sizeof(T));
+    deep_copy(exec, this_array_, this_array_host_);
+}
+
 // Get the name of the view
 template <typename T, typename Layout, typename ExecSpace, typename MemoryTraits>
 KOKKOS_INLINE_FUNCTION
@@ -2552,6 +3297,21 @@ void DViewFArrayKokkos<T,Layout,ExecSpace,MemoryTraits>::set_values(T val) {
     });
 }
 
+template <typename T, typename Layout, typename ExecSpace, typename MemoryTraits>
+KOKKOS_INLINE_FUNCTION
+ViewFArrayKokkos<T> DViewFArrayKokkos<T,Layout,ExecSpace,MemoryTraits>::slice(size_t i) const {
+    assert(order_ > 1 && "slice needs an order (rank) of 2 or more in DViewFArrayKokkos!");
+    assert(i < dims_[order_ - 1] && "i is out of bounds in DViewFArrayKokkos slice!");
+    return view_from_dims_kokkos<ViewFArrayKokkos<T>>(this_array_.data() + i * (length_ / dims_[order_ - 1]), dims_, order_ - 1);
+}
+
+template <typename T, typename Layout, typename ExecSpace, typename MemoryTraits>
+template <typename... Args>
+KOKKOS_INLINE_FUNCTION
+ViewStridedArrayKokkos<T> DViewFArrayKokkos<T,Layout,ExecSpace,MemoryTraits>::subview(Args... args) const {
+    return ViewStridedArrayKokkos<T>(this_array_.data(), dims_, order_, true).subview(args...);
+}
+
 template <typename T, typename Layout, typename ExecSpace, typename MemoryTraits>
 KOKKOS_INLINE_FUNCTION
 DViewFArrayKokkos<T,Layout,ExecSpace,MemoryTraits>::~DViewFArrayKokkos() {}
@@ -2573,6 +3333,7 @@ private:
     size_t order_;  // tensor order (rank)
     bool   lock_ = false;
     TArray1D this_matrix_;
+    DualModifiedRangeView modified_;
 
 public:
     DFMatrixKokkos();
@@ -2655,6 +3416,23 @@ public:
     // Method that update device view
     void update_device();
 
+    // Methods that enqueue the update on the execution space instance exec
+    // and return without fencing, fence exec or wait on an ExecEvent first
+    template <typename ExecInstance>
+    void update_host(const ExecInstance& exec);
+
+    template <typename ExecInstance>
+    void update_device(const ExecInstance& exec);
+
+    // Methods that mark the flat index range [begin, end) as modified on the
+    // host or device, the next update then copies only the marked span
+    void modified_host(size_t begin, size_t end);
+
+    void modified_device(size_t begin, size_t end);
+
+    // Method that turns on range tracking, an update with nothing marked is skipped
+    void track_modified(bool track);
+
     // Method that locks updates
     void lock_update();
 
@@ -2692,6 +3470,7 @@ DFMatrixKokkos<T,Layout,ExecSpace,MemoryTraits>::DFMatrixKokkos(size_t dim1, con
     order_ = 1;
     length_ = dim1;
     this_matrix_ = TArray1D(tag_string, length_);
+    modified_ = DualModifiedRangeView(tag_string + "_modified");
     // Create host ViewFMatrix
     host = ViewFMatrix <T> (this_matrix_.view_host().data(), dim1);
 }
@@ -2705,6 +3484,7 @@ DFMatrixKokkos<T,Layout,ExecSpace,MemoryTraits>::DFMatrixKokkos(size_t dim1, siz
     order_ = 2;
     length_ = (dim1 * dim2);
     this_matrix_ = TArray1D(tag_string, length_);
+    modified_ = DualModifiedRangeView(tag_string + "_modified");
     // Create host ViewFMatrix
     host = ViewFMatrix <T> (this_matrix_.view_host().data(), dim1, dim2);
 }
@@ -2719,6 +3499,7 @@ DFMatrixKokkos<T,Layout,ExecSpace,MemoryTraits>::DFMatrixKokkos(size_t dim1, siz
     order_ = 3;
     length_ = (dim1 * dim2 * dim3);
     this_matrix_ = TArray1D(tag_string, length_);
+    modified_ = DualModifiedRangeView(tag_string + "_modified");
     // Create host ViewFMatrix
     host = ViewFMatrix <T> (this_matrix_.view_host().data(), dim1, dim2, dim3);
 }
@@ -2734,6 +3515,7 @@ DFMatrixKokkos<T,Layout,ExecSpace,MemoryTraits>::DFMatrixKokkos(size_t dim1, siz
     order_ = 4;
     length_ = (dim1 * dim2 * dim3 * dim4);
     this_matrix_ = TArray1D(tag_string, length_);
+    modified_ = DualModifiedRangeView(tag_string + "_modified");
     // Create host ViewFMatrix
     host = ViewFMatrix <T> (this_matrix_.view_host().data(), dim1, dim2, dim3, dim4);
 }
@@ -2751,6 +3533,7 @@ DFMatrixKokkos<T,Layout,ExecSpace,MemoryTraits>::DFMatrixKokkos(size_t dim1, siz
     order_ = 5;
     length_ = (dim1 * dim2 * dim3 * dim4 * dim5);
     this_matrix_ = TArray1D(tag_string, length_);
+    modified_ = DualModifiedRangeView(tag_string + "_modified");
     // Create host ViewFMatrix
     host = ViewFMatrix <T> (this_matrix_.view_host().data(), dim1, dim2, dim3, dim4, dim5);
 }
@@ -2769,6 +3552,7 @@ DFMatrixKokkos<T,Layout,ExecSpace,MemoryTraits>::DFMatrixKokkos(size_t dim1, siz
     order_ = 6;
     length_ = (dim1 * dim2 * dim3 * dim4 * dim5 * dim6);
     this_matrix_ = TArray1D(tag_string, length_);
+    modified_ = DualModifiedRangeView(tag_string + "_modified");
     // Create host ViewFMatrix
     host = ViewFMatrix <T> (this_matrix_.view_host().data(), dim1, dim2, dim3, dim4, dim5, dim6);
 }
@@ -2789,6 +3573,7 @@ DFMatrixKokkos<T,Layout,ExecSpace,MemoryTraits>::DFMatrixKokkos(size_t dim1, siz
     order_ = 7;
     length_ = (dim1 * dim2 * dim3 * dim4 * dim5 * dim6 * dim7);
     this_matrix_ = TArray1D(tag_string, length_);
+    modified_ = DualModifiedRangeView(tag_string + "_modified");
     // Create host ViewFMatrix
     host = ViewFMatrix <T> (this_matrix_.view_host().data(), dim1, dim2, dim3, dim4, dim5, dim6, dim7);
 }
@@ -2903,6 +3688,7 @@ DFMatrixKokkos<T,Layout,ExecSpace,MemoryTraits>& DFMatrixKokkos<T,Layout,ExecSpa
         this_matrix_ = temp.this_matrix_;
         host = temp.host;
         lock_ = temp.lock_;
+        modified_ = temp.modified_;
     }
     
     return *this;
@@ -2950,18 +3736,54 @@ T* DFMatrixKokkos<T,Layout,ExecSpace,MemoryTraits>::host_pointer() const {
 
 template <typename T, typename Layout, typename ExecSpace, typename MemoryTraits>
 void DFMatrixKokkos<T,Layout,ExecSpace,MemoryTraits>::update_host() {
+    MATAR_PROFILE_SCOPE("DFMatrixKokkos::update_host", ProfileCategory::transfer);
     assert(!lock_ && "This data is locked, no copy will be done.");
     if (lock_) return;
-    this_matrix_.template modify<typename TArray1D::execution_space>();
-    this_matrix_.template sync<typename TArray1D::host_mirror_space>();
+    dual_view_update(this_matrix_, modified_, true);
 }
 
 template <typename T, typename Layout, typename ExecSpace, typename MemoryTraits>
 void DFMatrixKokkos<T,Layout,ExecSpace,MemoryTraits>::update_device() {
+    MATAR_PROFILE_SCOPE("DFMatrixKokkos::update_device", ProfileCategory::transfer);
+    assert(!lock_ && "This data is locked, no copy will be done.");
+    if (lock_) return;
+    dual_view_update(this_matrix_, modified_, false);
+}
+
+template <typename T, typename Layout, typename ExecSpace, typename MemoryTraits>
+template <typename ExecInstance>
+void DFMatrixKokkos<T,Layout,ExecSpace,MemoryTraits>::update_host(const ExecInstance& exec) {
+    assert(!lock_ && "This data is locked, no copy will be done.");
+    if (lock_) return;
+    dual_view_update(this_matrix_, modified_, true, &exec);
+}
+
+template <typename T, typename Layout, typename ExecSpace, typename MemoryTraits>
+template <typename ExecInstance>
+void DFMatrixKokkos<T,Layout,ExecSpace,MemoryTraits>::update_device(const ExecInstance& exec) {
     assert(!lock_ && "This data is locked, no copy will be done.");
     if (lock_) return;
-    this_matrix_.template modify<typename TArray1D::host_mirror_space>();
-    this_matrix_.template sync<typename TArray1D::execution_space>();
+    dual_view_update(this_matrix_, modified_, false, &exec);
+}
+
+template <typename T, typename Layout, typename ExecSpace, typename MemoryTraits>
+void DFMatrixKokkos<T,Layout,ExecSpace,MemoryTraits>::modified_host(size_t begin, size_t end) {
+    assert(end <= length_ && "Modified range is out of bounds in DFMatrixKokkos!");
+    if (modified_.data() == nullptr) return;
+    dual_mark_modified(modified_().host_begin, modified_().host_end, begin, end);
+}
+
+template <typename T, typename Layout, typename ExecSpace, typename MemoryTraits>
+void DFMatrixKokkos<T,Layout,ExecSpace,MemoryTraits>::modified_device(size_t begin, size_t end) {
+    assert(end <= length_ && "Modified range is out of bounds in DFMatrixKokkos!");
+    if (modified_.data() == nullptr) return;
+    dual_mark_modified(modified_().device_begin, modified_().device_end, begin, end);
+}
+
+template <typename T, typename Layout, typename ExecSpace, typename MemoryTraits>
+void DFMatrixKokkos<T,Layout,ExecSpace,MemoryTraits>::track_modified(bool track) {
+    if (modified_.data() == nullptr) return;
+    modified_().track = track;
 }
 
 // Get the name of the view
@@ -3095,6 +3917,14 @@ public:
     // Method that update device view
     void update_device();
 
+    // Methods that enqueue the update on the execution space instance exec
+    // and return without fencing, fence exec or wait on an ExecEvent first
+    template <typename ExecInstance>
+    void update_host(const ExecInstance& exec);
+
+    template <typename ExecInstance>
+    void update_device(const ExecInstance& exec);
+
 
     // set values on host to input
     void set_values(T val);
@@ -3422,16 +4252,34 @@ T* DViewFMatrixKokkos<T,Layout,ExecSpace,MemoryTraits>::host_pointer() const {
 
 template <typename T, typename Layout, typename ExecSpace, typename MemoryTraits>
 void DViewFMatrixKokkos<T,Layout,ExecSpace,MemoryTraits>::update_host() {
+    MATAR_PROFILE_SCOPE("DViewFMatrixKokkos::update_host", ProfileCategory::transfer);
+    TransferLog::instance().record(this_matrix_, true, this_matrix_.size() * sizeof(T));
     // Deep copy of device view to host view
     deep_copy(this_matrix_host_, this_matrix_);
 }
 
 template <typename T, typename Layout, typename ExecSpace, typename MemoryTraits>
 void DViewFMatrixKokkos<T,Layout,ExecSpace,MemoryTraits>::update_device() {
+    MATAR_PROFILE_SCOPE("DViewFMatrixKokkos::update_device", ProfileCategory::transfer);
+    TransferLog::instance().record(this_matrix_, false, this_matrix_.size() * sizeof(T));
     // Deep copy of host view to device view
     deep_copy(this_matrix_, this_matrix_host_);
 }
 
+template <typename T, typename Layout, typename ExecSpace, typename MemoryTraits>
+template <typename ExecInstance>
+void DViewFMatrixKokkos<T,Layout,ExecSpace,MemoryTraits>::update_host(const ExecInstance& exec) {
+    TransferLog::instance().record(this_matrix_, true, this_matrix_.size() * sizeof(T));
+    deep_copy(exec, this_matrix_host_, this_matrix_);
+}
+
+template <typename T, typename Layout, typename ExecSpace, typename MemoryTraits>
+template <typename ExecInstance>
+void DViewFMatrixKokkos<T,Layout,ExecSpace,MemoryTraits>::update_device(const ExecInstance& exec) {
+    TransferLog::instance().record(this_matrix_, false, this_matrix_.size() * sizeof(T));
+    deep_copy(exec, this_matrix_, this_matrix_host_);
+}
+
 // Get the name of the view
 template <typename T, typename Layout, typename ExecSpace, typename MemoryTraits>
 KOKKOS_INLINE_FUNCTION
@@ -3546,6 +4394,15 @@ public:
     KOKKOS_INLINE_FUNCTION
     const std::string get_name() const;
 
+    // slice fixing the first index, a contiguous view of order()-1
+    KOKKOS_INLINE_FUNCTION
+    ViewCArrayKokkos<T> slice(size_t i) const;
+
+    // strided view of part of the array, one index or Range per dimension
+    template <typename... Args>
+    KOKKOS_INLINE_FUNCTION
+    ViewStridedArrayKokkos<T> subview(Args... args) const;
+
     // Deconstructor
     KOKKOS_INLINE_FUNCTION
     ~CArrayKokkos ();
@@ -3832,6 +4689,21 @@ void CArrayKokkos<T,Layout,ExecSpace,MemoryTraits>::set_values(T val) {
     });
 }
 
+template <typename T, typename Layout, typename ExecSpace, typename MemoryTraits>
+KOKKOS_INLINE_FUNCTION
+ViewCArrayKokkos<T> CArrayKokkos<T,Layout,ExecSpace,MemoryTraits>::slice(size_t i) const {
+    assert(order_ > 1 && "slice needs an order (rank) of 2 or more in CArrayKokkos!");
+    assert(i < dims_[0] && "i is out of bounds in CArrayKokkos slice!");
+    return view_from_dims_kokkos<ViewCArrayKokkos<T>>(this_array_.data() + i * (length_ / dims_[0]), dims_ + 1, order_ - 1);
+}
+
+template <typename T, typename Layout, typename ExecSpace, typename MemoryTraits>
+template <typename... Args>
+KOKKOS_INLINE_FUNCTION
+ViewStridedArrayKokkos<T> CArrayKokkos<T,Layout,ExecSpace,MemoryTraits>::subview(Args... args) const {
+    return ViewStridedArrayKokkos<T>(this_array_.data(), dims_, order_, false).subview(args...);
+}
+
 template <typename T, typename Layout, typename ExecSpace, typename MemoryTraits>
 KOKKOS_INLINE_FUNCTION
 CArrayKokkos<T,Layout,ExecSpace,MemoryTraits>::~CArrayKokkos() {}
@@ -3925,6 +4797,15 @@ public:
     // set values on host to input
     void set_values(T val);
 
+    // slice fixing the first index, a contiguous view of order()-1
+    KOKKOS_INLINE_FUNCTION
+    ViewCArrayKokkos<T> slice(size_t i) const;
+
+    // strided view of part of the array, one index or Range per dimension
+    template <typename... Args>
+    KOKKOS_INLINE_FUNCTION
+    ViewStridedArrayKokkos<T> subview(Args... args) const;
+
     KOKKOS_INLINE_FUNCTION
     ~ViewCArrayKokkos();
     
@@ -4179,6 +5060,21 @@ void ViewCArrayKokkos<T>::set_values(T val) {
     });
 }
 
+template <typename T>
+KOKKOS_INLINE_FUNCTION
+ViewCArrayKokkos<T> ViewCArrayKokkos<T>::slice(size_t i) const {
+    assert(order_ > 1 && "slice needs an order (rank) of 2 or more in ViewCArrayKokkos!");
+    assert(i < dims_[0] && "i is out of bounds in ViewCArrayKokkos slice!");
+    return view_from_dims_kokkos<ViewCArrayKokkos<T>>(this_array_ + i * (length_ / dims_[0]), dims_ + 1, order_ - 1);
+}
+
+template <typename T>
+template <typename... Args>
+KOKKOS_INLINE_FUNCTION
+ViewStridedArrayKokkos<T> ViewCArrayKokkos<T>::subview(Args... args) const {
+    return ViewStridedArrayKokkos<T>(this_array_, dims_, order_, false).subview(args...);
+}
+
 template <typename T>
 KOKKOS_INLINE_FUNCTION
 ViewCArrayKokkos<T>::~ViewCArrayKokkos() {}
@@ -4930,6 +5826,7 @@ private:
     size_t order_;  // tensor order (rank)
     bool   lock_ = false;
     TArray1D this_array_;
+    DualModifiedRangeView modified_;
 
 public:
     // Data member to access host view
@@ -5020,6 +5917,23 @@ public:
     // Method that update device view
     void update_device();
 
+    // Methods that enqueue the update on the execution space instance exec
+    // and return without fencing, fence exec or wait on an ExecEvent first
+    template <typename ExecInstance>
+    void update_host(const ExecInstance& exec);
+
+    template <typename ExecInstance>
+    void update_device(const ExecInstance& exec);
+
+    // Methods that mark the flat index range [begin, end) as modified on the
+    // host or device, the next update then copies only the marked span
+    void modified_host(size_t begin, size_t end);
+
+    void modified_device(size_t begin, size_t end);
+
+    // Method that turns on range tracking, an update with nothing marked is skipped
+    void track_modified(bool track);
+
     // Method that locks updates
     void lock_update();
 
@@ -5028,6 +5942,15 @@ public:
 
     // set values on host to input
     void set_values(T val);
+    // slice fixing the first index of the device data, a contiguous view of
+    // order()-1. host.slice() and host.subview() give views of the host data
+    KOKKOS_INLINE_FUNCTION
+    ViewCArrayKokkos<T> slice(size_t i) const;
+
+    // strided view of part of the array, one index or Range per dimension
+    template <typename... Args>
+    KOKKOS_INLINE_FUNCTION
+    ViewStridedArrayKokkos<T> subview(Args... args) const;
 
     // Deconstructor
     KOKKOS_INLINE_FUNCTION
@@ -5051,6 +5974,7 @@ DCArrayKokkos<T,Layout,ExecSpace,MemoryTraits>::DCArrayKokkos(size_t dim0, const
     order_ = 1;
     length_ = dim0;
     this_array_ = TArray1D(tag_string, length_);
+    modified_ = DualModifiedRangeView(tag_string + "_modified");
 
     // Create host ViewCArray
     host = ViewCArray <T> (this_array_.view_host().data(), dim0);
@@ -5065,6 +5989,7 @@ DCArrayKokkos<T,Layout,ExecSpace,MemoryTraits>::DCArrayKokkos(size_t dim0, size_
     order_ = 2;
     length_ = (dim0 * dim1);
     this_array_ = TArray1D(tag_string, length_);
+    modified_ = DualModifiedRangeView(tag_string + "_modified");
     // Create host ViewCArray
     host = ViewCArray <T> (this_array_.view_host().data(), dim0, dim1);
 }
@@ -5079,6 +6004,7 @@ DCArrayKokkos<T,Layout,ExecSpace,MemoryTraits>::DCArrayKokkos(size_t dim0, size_
     order_ = 3;
     length_ = (dim0 * dim1 * dim2);
     this_array_ = TArray1D(tag_string, length_);
+    modified_ = DualModifiedRangeView(tag_string + "_modified");
     // Create host ViewCArray
     host = ViewCArray <T> (this_array_.view_host().data(), dim0, dim1, dim2);
 }
@@ -5094,6 +6020,7 @@ DCArrayKokkos<T,Layout,ExecSpace,MemoryTraits>::DCArrayKokkos(size_t dim0, size_
     order_ = 4;
     length_ = (dim0 * dim1 * dim2 * dim3);
     this_array_ = TArray1D(tag_string, length_);
+    modified_ = DualModifiedRangeView(tag_string + "_modified");
     // Create host ViewCArray
     host = ViewCArray <T> (this_array_.view_host().data(), dim0, dim1, dim2, dim3);
 }
@@ -5111,6 +6038,7 @@ DCArrayKokkos<T,Layout,ExecSpace,MemoryTraits>::DCArrayKokkos(size_t dim0, size_
     order_ = 5;
     length_ = (dim0 * dim1 * dim2 * dim3 * dim4);
     this_array_ = TArray1D(tag_string, length_);
+    modified_ = DualModifiedRangeView(tag_string + "_modified");
     // Create host ViewCArray
     host = ViewCArray <T> (this_array_.view_host().data(), dim0, dim1, dim2, dim3, dim4);
 }
@@ -5129,6 +6057,7 @@ DCArrayKokkos<T,Layout,ExecSpace,MemoryTraits>::DCArrayKokkos(size_t dim0, size_
     order_ = 6;
     length_ = (dim0 * dim1 * dim2 * dim3 * dim4 * dim5);
     this_array_ = TArray1D(tag_string, length_);
+    modified_ = DualModifiedRangeView(tag_string + "_modified");
     // Create host ViewCArray
     host = ViewCArray <T> (this_array_.view_host().data(), dim0, dim1, dim2, dim3, dim4, dim5);
 }
@@ -5149,6 +6078,7 @@ DCArrayKokkos<T,Layout,ExecSpace,MemoryTraits>::DCArrayKokkos(size_t dim0, size_
     order_ = 7;
     length_ = (dim0 * dim1 * dim2 * dim3 * dim4 * dim5 * dim6);
     this_array_ = TArray1D(tag_string, length_);
+    modified_ = DualModifiedRangeView(tag_string + "_modified");
     // Create host ViewCArray
     host = ViewCArray <T> (this_array_.view_host().data(), dim0, dim1, dim2, dim3, dim4, dim5, dim6);
 }
@@ -5263,6 +6193,7 @@ DCArrayKokkos<T,Layout,ExecSpace,MemoryTraits>& DCArrayKokkos<T,Layout,ExecSpace
         this_array_ = temp.this_array_;
         host = temp.host;
         lock_ = temp.lock_;
+        modified_ = temp.modified_;
     }
     
     return *this;
@@ -5322,18 +6253,54 @@ const std::string DCArrayKokkos<T,Layout,ExecSpace,MemoryTraits>::get_name() con
 
 template <typename T, typename Layout, typename ExecSpace, typename MemoryTraits>
 void DCArrayKokkos<T,Layout,ExecSpace,MemoryTraits>::update_host() {
+    MATAR_PROFILE_SCOPE("DCArrayKokkos::update_host", ProfileCategory::transfer);
     assert(!lock_ && "This data is locked, no copy will be done.");
     if (lock_) return;
-    this_array_.template modify<typename TArray1D::execution_space>();
-    this_array_.template sync<typename TArray1D::host_mirror_space>();
+    dual_view_update(this_array_, modified_, true);
 }
 
 template <typename T, typename Layout, typename ExecSpace, typename MemoryTraits>
 void DCArrayKokkos<T,Layout,ExecSpace,MemoryTraits>::update_device() {
+    MATAR_PROFILE_SCOPE("DCArrayKokkos::update_device", ProfileCategory::transfer);
     assert(!lock_ && "This data is locked, no copy will be done.");
     if (lock_) return;
-    this_array_.template modify<typename TArray1D::host_mirror_space>();
-    this_array_.template sync<typename TArray1D::execution_space>();
+    dual_view_update(this_array_, modified_, false);
+}
+
+template <typename T, typename Layout, typename ExecSpace, typename MemoryTraits>
+template <typename ExecInstance>
+void DCArrayKokkos<T,Layout,ExecSpace,MemoryTraits>::update_host(const ExecInstance& exec) {
+    assert(!lock_ && "This data is locked, no copy will be done.");
+    if (lock_) return;
+    dual_view_update(this_array_, modified_, true, &exec);
+}
+
+template <typename T, typename Layout, typename ExecSpace, typename MemoryTraits>
+template <typename ExecInstance>
+void DCArrayKokkos<T,Layout,ExecSpace,MemoryTraits>::update_device(const ExecInstance& exec) {
+    assert(!lock_ && "This data is locked, no copy will be done.");
+    if (lock_) return;
+    dual_view_update(this_array_, modified_, false, &exec);
+}
+
+template <typename T, typename Layout, typename ExecSpace, typename MemoryTraits>
+void DCArrayKokkos<T,Layout,ExecSpace,MemoryTraits>::modified_host(size_t begin, size_t end) {
+    assert(end <= length_ && "Modified range is out of bounds in DCArrayKokkos!");
+    if (modified_.data() == nullptr) return;
+    dual_mark_modified(modified_().host_begin, modified_().host_end, begin, end);
+}
+
+template <typename T, typename Layout, typename ExecSpace, typename MemoryTraits>
+void DCArrayKokkos<T,Layout,ExecSpace,MemoryTraits>::modified_device(size_t begin, size_t end) {
+    assert(end <= length_ && "Modified range is out of bounds in DCArrayKokkos!");
+    if (modified_.data() == nullptr) return;
+    dual_mark_modified(modified_().device_begin, modified_().device_end, begin, end);
+}
+
+template <typename T, typename Layout, typename ExecSpace, typename MemoryTraits>
+void DCArrayKokkos<T,Layout,ExecSpace,MemoryTraits>::track_modified(bool track) {
+    if (modified_.data() == nullptr) return;
+    modified_().track = track;
 }
 
 template <typename T, typename Layout, typename ExecSpace, typename MemoryTraits>
@@ -5353,6 +6320,21 @@ void DCArrayKokkos<T,Layout,ExecSpace,MemoryTraits>::unlock_update() {
     lock_ = false;
 }
 
+template <typename T, typename Layout, typename ExecSpace, typename MemoryTraits>
+KOKKOS_INLINE_FUNCTION
+ViewCArrayKokkos<T> DCArrayKokkos<T,Layout,ExecSpace,MemoryTraits>::slice(size_t i) const {
+    assert(order_ > 1 && "slice needs an order (rank) of 2 or more in DCArrayKokkos!");
+    assert(i < dims_[0] && "i is out of bounds in DCArrayKokkos slice!");
+    return view_from_dims_kokkos<ViewCArrayKokkos<T>>(this_array_.view_device().data() + i * (length_ / dims_[0]), dims_ + 1, order_ - 1);
+}
+
+template <typename T, typename Layout, typename ExecSpace, typename MemoryTraits>
+template <typename... Args>
+KOKKOS_INLINE_FUNCTION
+ViewStridedArrayKokkos<T> DCArrayKokkos<T,Layout,ExecSpace,MemoryTraits>::subview(Args... args) const {
+    return ViewStridedArrayKokkos<T>(this_array_.view_device().data(), dims_, order_, false).subview(args...);
+}
+
 template <typename T, typename Layout, typename ExecSpace, typename MemoryTraits>
 KOKKOS_INLINE_FUNCTION
 DCArrayKokkos<T,Layout,ExecSpace,MemoryTraits>::~DCArrayKokkos() {}
@@ -5461,6 +6443,14 @@ public:
     // Method that update device view
     void update_device();
 
+    // Methods that enqueue the update on the execution space instance exec
+    // and return without fencing, fence exec or wait on an ExecEvent first
+    template <typename ExecInstance>
+    void update_host(const ExecInstance& exec);
+
+    template <typename ExecInstance>
+    void update_device(const ExecInstance& exec);
+
 
     // set values on host to input
     void set_values(T val);
@@ -5469,6 +6459,15 @@ public:
     KOKKOS_INLINE_FUNCTION
     const std::string get_name() const;
 
+    // slice fixing the first index of the device data, a contiguous view of
+    // order()-1. host.slice() and host.subview() give views of the host data
+    KOKKOS_INLINE_FUNCTION
+    ViewCArrayKokkos<T> slice(size_t i) const;
+
+    // strided view of part of the array, one index or Range per dimension
+    template <typename... Args>
+    KOKKOS_INLINE_FUNCTION
+    ViewStridedArrayKokkos<T> subview(Args... args) const;
 
     // Deconstructor
     KOKKOS_INLINE_FUNCTION
@@ -5805,16 +6804,34 @@ T* DViewCArrayKokkos<T,Layout,ExecSpace,MemoryTraits>::host_pointer() const {
 
 template <typename T, typename Layout, typename ExecSpace, typename MemoryTraits>
 void DViewCArrayKokkos<T,Layout,ExecSpace,MemoryTraits>::update_host() {
+    MATAR_PROFILE_SCOPE("DViewCArrayKokkos::update_host", ProfileCategory::transfer);
+    TransferLog::instance().record(this_array_, true, this_array_.size() * sizeof(T));
     // Deep copy of device view to host view
     deep_copy(this_array_host_, this_array_);
 }
 
 template <typename T, typename Layout, typename ExecSpace, typename MemoryTraits>
 void DViewCArrayKokkos<T,Layout,ExecSpace,MemoryTraits>::update_device() {
+    MATAR_PROFILE_SCOPE("DViewCArrayKokkos::update_device", ProfileCategory::transfer);
+    TransferLog::instance().record(this_array_, false, this_array_.size() * sizeof(T));
     // Deep copy of host view to device view
     deep_copy(this_array_, this_array_host_);
 }
 
+template <typename T, typename Layout, typename ExecSpace, typename MemoryTraits>
+template <typename ExecInstance>
+void DViewCArrayKokkos<T,Layout,ExecSpace,MemoryTraits>::update_host(const ExecInstance& exec) {
+    TransferLog::instance().record(this_array_, true, this_array_.size() * sizeof(T));
+    deep_copy(exec, this_array_host_, this_array_);
+}
+
+template <typename T, typename Layout, typename ExecSpace, typename MemoryTraits>
+template <typename ExecInstance>
+void DViewCArrayKokkos<T,Layout,ExecSpace,MemoryTraits>::update_device(const ExecInstance& exec) {
+    TransferLog::instance().record(this_array_, false, this_array_.size() * sizeof(T));
+    deep_copy(exec, this_array_, this_array_host_);
+}
+
 template <typename T, typename Layout, typename ExecSpace, typename MemoryTraits>
 void DViewCArrayKokkos<T,Layout,ExecSpace,MemoryTraits>::set_values(T val) {
     Kokkos::parallel_for( Kokkos::RangePolicy<> ( 0, length_), KOKKOS_CLASS_LAMBDA(const int i){
@@ -5828,6 +6845,21 @@ const std::string DViewCArrayKokkos<T,Layout,ExecSpace,MemoryTraits>::get_name()
     return this_array_.label();
 }
 
+template <typename T, typename Layout, typename ExecSpace, typename MemoryTraits>
+KOKKOS_INLINE_FUNCTION
+ViewCArrayKokkos<T> DViewCArrayKokkos<T,Layout,ExecSpace,MemoryTraits>::slice(size_t i) const {
+    assert(order_ > 1 && "slice needs an order (rank) of 2 or more in DViewCArrayKokkos!");
+    assert(i < dims_[0] && "i is out of bounds in DViewCArrayKokkos slice!");
+    return view_from_dims_kokkos<ViewCArrayKokkos<T>>(this_array_.data() + i * (length_ / dims_[0]), dims_ + 1, order_ - 1);
+}
+
+template <typename T, typename Layout, typename ExecSpace, typename MemoryTraits>
+template <typename... Args>
+KOKKOS_INLINE_FUNCTION
+ViewStridedArrayKokkos<T> DViewCArrayKokkos<T,Layout,ExecSpace,MemoryTraits>::subview(Args... args) const {
+    return ViewStridedArrayKokkos<T>(this_array_.data(), dims_, order_, false).subview(args...);
+}
+
 template <typename T, typename Layout, typename ExecSpace, typename MemoryTraits>
 KOKKOS_INLINE_FUNCTION
 DViewCArrayKokkos<T,Layout,ExecSpace,MemoryTraits>::~DViewCArrayKokkos() {}
@@ -5849,6 +6881,7 @@ private:
     size_t order_;  // tensor order (rank)
     bool   lock_ = false;
     TArray1D this_matrix_;
+    DualModifiedRangeView modified_;
 
 public:
     // Data member to access host view
@@ -5931,6 +6964,23 @@ public:
     // Method that update device view
     void update_device();
 
+    // Methods that enqueue the update on the execution space instance exec
+    // and return without fencing, fence exec or wait on an ExecEvent first
+    template <typename ExecInstance>
+    void update_host(const ExecInstance& exec);
+
+    template <typename ExecInstance>
+    void update_device(const ExecInstance& exec);
+
+    // Methods that mark the flat index range [begin, end) as modified on the
+    // host or device, the next update then copies only the marked span
+    void modified_host(size_t begin, size_t end);
+
+    void modified_device(size_t begin, size_t end);
+
+    // Method that turns on range tracking, an update with nothing marked is skipped
+    void track_modified(bool track);
+
     // Method that locks updates
     void lock_update();
 
@@ -5967,6 +7017,7 @@ DCMatrixKokkos<T,Layout,ExecSpace,MemoryTraits>::DCMatrixKokkos(size_t dim1, con
     order_ = 1;
     length_ = dim1;
     this_matrix_ = TArray1D(tag_string, length_);
+    modified_ = DualModifiedRangeView(tag_string + "_modified");
     // Create host ViewCMatrix
     host = ViewCMatrix <T> (this_matrix_.view_host().data(), dim1);
 }
@@ -5980,6 +7031,7 @@ DCMatrixKokkos<T,Layout,ExecSpace,MemoryTraits>::DCMatrixKokkos(size_t dim1, siz
     order_ = 2;
     length_ = (dim1 * dim2);
     this_matrix_ = TArray1D(tag_string, length_);
+    modified_ = DualModifiedRangeView(tag_string + "_modified");
     // Create host ViewCMatrix
     host = ViewCMatrix <T> (this_matrix_.view_host().data(), dim1, dim2);
 }
@@ -5994,6 +7046,7 @@ DCMatrixKokkos<T,Layout,ExecSpace,MemoryTraits>::DCMatrixKokkos(size_t dim1, siz
     order_ = 3;
     length_ = (dim1 * dim2 * dim3);
     this_matrix_ = TArray1D(tag_string, length_);
+    modified_ = DualModifiedRangeView(tag_string + "_modified");
     // Create host ViewCMatrix
     host = ViewCMatrix <T> (this_matrix_.view_host().data(), dim1, dim2, dim3);
 }
@@ -6009,6 +7062,7 @@ DCMatrixKokkos<T,Layout,ExecSpace,MemoryTraits>::DCMatrixKokkos(size_t dim1, siz
     order_ = 4;
     length_ = (dim1 * dim2 * dim3 * dim4);
     this_matrix_ = TArray1D(tag_string, length_);
+    modified_ = DualModifiedRangeView(tag_string + "_modified");
     // Create host ViewCMatrix
     host = ViewCMatrix <T> (this_matrix_.view_host().data(), dim1, dim2, dim3, dim4);
 }
@@ -6026,6 +7080,7 @@ DCMatrixKokkos<T,Layout,ExecSpace,MemoryTraits>::DCMatrixKokkos(size_t dim1, siz
     order_ = 5;
     length_ = (dim1 * dim2 * dim3 * dim4 * dim5);
     this_matrix_ = TArray1D(tag_string, length_);
+    modified_ = DualModifiedRangeView(tag_string + "_modified");
     // Create host ViewCMatrix
     host = ViewCMatrix <T> (this_matrix_.view_host().data(), dim1, dim2, dim3, dim4, dim5);
 }
@@ -6044,6 +7099,7 @@ DCMatrixKokkos<T,Layout,ExecSpace,MemoryTraits>::DCMatrixKokkos(size_t dim1, siz
     order_ = 6;
     length_ = (dim1 * dim2 * dim3 * dim4 * dim5 * dim6);
     this_matrix_ = TArray1D(tag_string, length_);
+    modified_ = DualModifiedRangeView(tag_string + "_modified");
     // Create host ViewCMatrix
     host = ViewCMatrix <T> (this_matrix_.view_host().data(), dim1, dim2, dim3, dim4, dim5, dim6);
 }
@@ -6064,6 +7120,7 @@ DCMatrixKokkos<T,Layout,ExecSpace,MemoryTraits>::DCMatrixKokkos(size_t dim1, siz
     order_ = 7;
     length_ = (dim1 * dim2 * dim3 * dim4 * dim5 * dim6 * dim7);
     this_matrix_ = TArray1D(tag_string, length_);
+    modified_ = DualModifiedRangeView(tag_string + "_modified");
     // Create host ViewCMatrix
     host = ViewCMatrix <T> (this_matrix_.view_host().data(), dim1, dim2, dim3, dim4, dim5, dim6, dim7);
 }
@@ -6178,6 +7235,7 @@ DCMatrixKokkos<T,Layout,ExecSpace,MemoryTraits>& DCMatrixKokkos<T,Layout,ExecSpa
         this_matrix_ = temp.this_matrix_;
         host = temp.host;
         lock_ = temp.lock_;
+        modified_ = temp.modified_;
     }
     
     return *this;
@@ -6225,18 +7283,54 @@ T* DCMatrixKokkos<T,Layout,ExecSpace,MemoryTraits>::host_pointer() const {
 
 template <typename T, typename Layout, typename ExecSpace, typename MemoryTraits>
 void DCMatrixKokkos<T,Layout,ExecSpace,MemoryTraits>::update_host() {
+    MATAR_PROFILE_SCOPE("DCMatrixKokkos::update_host", ProfileCategory::transfer);
     assert(!lock_ && "This data is locked, no copy will be done.");
     if (lock_) return;
-    this_matrix_.template modify<typename TArray1D::execution_space>();
-    this_matrix_.template sync<typename TArray1D::host_mirror_space>();
+    dual_view_update(this_matrix_, modified_, true);
 }
 
 template <typename T, typename Layout, typename ExecSpace, typename MemoryTraits>
 void DCMatrixKokkos<T,Layout,ExecSpace,MemoryTraits>::update_device() {
+    MATAR_PROFILE_SCOPE("DCMatrixKokkos::update_device", ProfileCategory::transfer);
+    assert(!lock_ && "This data is locked, no copy will be done.");
+    if (lock_) return;
+    dual_view_update(this_matrix_, modified_, false);
+}
+
+template <typename T, typename Layout, typename ExecSpace, typename MemoryTraits>
+template <typename ExecInstance>
+void DCMatrixKokkos<T,Layout,ExecSpace,MemoryTraits>::update_host(const ExecInstance& exec) {
+    assert(!lock_ && "This data is locked, no copy will be done.");
+    if (lock_) return;
+    dual_view_update(this_matrix_, modified_, true, &exec);
+}
+
+template <typename T, typename Layout, typename ExecSpace, typename MemoryTraits>
+template <typename ExecInstance>
+void DCMatrixKokkos<T,Layout,ExecSpace,MemoryTraits>::update_device(const ExecInstance& exec) {
     assert(!lock_ && "This data is locked, no copy will be done.");
     if (lock_) return;
-    this_matrix_.template modify<typename TArray1D::host_mirror_space>();
-    this_matrix_.template sync<typename TArray1D::execution_space>();
+    dual_view_update(this_matrix_, modified_, false, &exec);
+}
+
+template <typename T, typename Layout, typename ExecSpace, typename MemoryTraits>
+void DCMatrixKokkos<T,Layout,ExecSpace,MemoryTraits>::modified_host(size_t begin, size_t end) {
+    assert(end <= length_ && "Modified range is out of bounds in DCMatrixKokkos!");
+    if (modified_.data() == nullptr) return;
+    dual_mark_modified(modified_().host_begin, modified_().host_end, begin, end);
+}
+
+template <typename T, typename Layout, typename ExecSpace, typename MemoryTraits>
+void DCMatrixKokkos<T,Layout,ExecSpace,MemoryTraits>::modified_device(size_t begin, size_t end) {
+    assert(end <= length_ && "Modified range is out of bounds in DCMatrixKokkos!");
+    if (modified_.data() == nullptr) return;
+    dual_mark_modified(modified_().device_begin, modified_().device_end, begin, end);
+}
+
+template <typename T, typename Layout, typename ExecSpace, typename MemoryTraits>
+void DCMatrixKokkos<T,Layout,ExecSpace,MemoryTraits>::track_modified(bool track) {
+    if (modified_.data() == nullptr) return;
+    modified_().track = track;
 }
 
 // Get the name of the view
@@ -6370,6 +7464,14 @@ public:
     // Method that update device view
     void update_device();
 
+    // Methods that enqueue the update on the execution space instance exec
+    // and return without fencing, fence exec or wait on an ExecEvent first
+    template <typename ExecInstance>
+    void update_host(const ExecInstance& exec);
+
+    template <typename ExecInstance>
+    void update_device(const ExecInstance& exec);
+
     // set values on host to input
     void set_values(T val);
 
@@ -6554,175 +7656,626 @@ T& DViewCMatrixKokkos<T,Layout,ExecSpace,MemoryTraits>::operator()(size_t i, siz
     return this_matrix_((j - 1) + ((i - 1) * dims_[1]));
 }
 
-template <typename T, typename Layout, typename ExecSpace, typename MemoryTraits>
+template <typename T, typename Layout, typename ExecSpace, typename MemoryTraits>
+KOKKOS_INLINE_FUNCTION
+T& DViewCMatrixKokkos<T,Layout,ExecSpace,MemoryTraits>::operator()(size_t i, size_t j, size_t k) const {
+    assert(order_ == 3 && "Tensor order (rank) does not match constructor in DViewCMatrixKokkos 3D!");
+    assert(i >= 1 && i <= dims_[0] && "i is out of bounds in DViewCMatrixKokkos 3D!");
+    assert(j >= 1 && j <= dims_[1] && "j is out of bounds in DViewCMatrixKokkos 3D!");
+    assert(k >= 1 && k <= dims_[2] && "k is out of bounds in DViewCMatrixKokkos 3D!");
+    return this_matrix_((k - 1) + ((j - 1) * dims_[2])
+                                + ((i - 1) * dims_[2] * dims_[1]));
+}
+
+template <typename T, typename Layout, typename ExecSpace, typename MemoryTraits>
+KOKKOS_INLINE_FUNCTION
+T& DViewCMatrixKokkos<T,Layout,ExecSpace,MemoryTraits>::operator()(size_t i, size_t j, size_t k, size_t l) const {
+    assert(order_ == 4 && "Tensor order (rank) does not match constructor in DViewCMatrixKokkos 4D!");
+    assert(i >= 1 && i <= dims_[0] && "i is out of bounds in DViewCMatrixKokkos 4D!");
+    assert(j >= 1 && j <= dims_[1] && "j is out of bounds in DViewCMatrixKokkos 4D!");
+    assert(k >= 1 && k <= dims_[2] && "k is out of bounds in DViewCMatrixKokkos 4D!");
+    assert(l >= 1 && l <= dims_[3] && "l is out of bounds in DViewCMatrixKokkos 4D!");
+    return this_matrix_((l - 1) + ((k - 1) * dims_[3])
+                                + ((j - 1) * dims_[3] * dims_[2])
+                                + ((i - 1) * dims_[3] * dims_[2] * dims_[1]));
+}
+
+template <typename T, typename Layout, typename ExecSpace, typename MemoryTraits>
+KOKKOS_INLINE_FUNCTION
+T& DViewCMatrixKokkos<T,Layout,ExecSpace,MemoryTraits>::operator()(size_t i, size_t j, size_t k, size_t l,
+                               size_t m) const {
+    assert(order_ == 5 && "Tensor order (rank) does not match constructor in DViewCMatrixKokkos 5D!");
+    assert(i >= 1 && i <= dims_[0] && "i is out of bounds in DViewCMatrixKokkos 5D!");
+    assert(j >= 1 && j <= dims_[1] && "j is out of bounds in DViewCMatrixKokkos 5D!");
+    assert(k >= 1 && k <= dims_[2] && "k is out of bounds in DViewCMatrixKokkos 5D!");
+    assert(l >= 1 && l <= dims_[3] && "l is out of bounds in DViewCMatrixKokkos 5D!");
+    assert(m >= 1 && m <= dims_[4] && "m is out of bounds in DViewCMatrixKokkos 5D!");
+    return this_matrix_((m - 1) + ((l - 1) * dims_[4])
+                                + ((k - 1) * dims_[4] * dims_[3])
+                                + ((j - 1) * dims_[4] * dims_[3] * dims_[2])
+                                + ((i - 1) * dims_[4] * dims_[3] * dims_[2] * dims_[1]));
+}
+
+template <typename T, typename Layout, typename ExecSpace, typename MemoryTraits>
+KOKKOS_INLINE_FUNCTION
+T& DViewCMatrixKokkos<T,Layout,ExecSpace,MemoryTraits>::operator()(size_t i, size_t j, size_t k, size_t l,
+                               size_t m, size_t n) const {
+    assert(order_ == 6 && "Tensor order (rank) does not match constructor in DViewCMatrixKokkos 6D!");
+    assert(i >= 1 && i <= dims_[0] && "i is out of bounds in DViewCMatrixKokkos 6D!");
+    assert(j >= 1 && j <= dims_[1] && "j is out of bounds in DViewCMatrixKokkos 6D!");
+    assert(k >= 1 && k <= dims_[2] && "k is out of bounds in DViewCMatrixKokkos 6D!");
+    assert(l >= 1 && l <= dims_[3] && "l is out of bounds in DViewCMatrixKokkos 6D!");
+    assert(m >= 1 && m <= dims_[4] && "m is out of bounds in DViewCMatrixKokkos 6D!");
+    assert(n >= 1 && n <= dims_[5] && "n is out of bounds in DViewCMatrixKokkos 6D!");
+    return this_matrix_((n - 1) + ((m - 1) * dims_[5])
+                                + ((l - 1) * dims_[5] * dims_[4])
+                                + ((k - 1) * dims_[5] * dims_[4] * dims_[3])
+                                + ((j - 1) * dims_[5] * dims_[4] * dims_[3] * dims_[2])
+                                + ((i - 1) * dims_[5] * dims_[4] * dims_[3] * dims_[2] * dims_[1]));
+}
+
+template <typename T, typename Layout, typename ExecSpace, typename MemoryTraits>
+KOKKOS_INLINE_FUNCTION
+T& DViewCMatrixKokkos<T,Layout,ExecSpace,MemoryTraits>::operator()(size_t i, size_t j, size_t k, size_t l,
+                               size_t m, size_t n, size_t o) const {
+    assert(order_ == 7 && "Tensor order (rank) does not match constructor in DViewCMatrixKokkos 7D!");
+    assert(i >= 1 && i <= dims_[0] && "i is out of bounds in DViewCMatrixKokkos 7D!");
+    assert(j >= 1 && j <= dims_[1] && "j is out of bounds in DViewCMatrixKokkos 7D!");
+    assert(k >= 1 && k <= dims_[2] && "k is out of bounds in DViewCMatrixKokkos 7D!");
+    assert(l >= 1 && l <= dims_[3] && "l is out of bounds in DViewCMatrixKokkos 7D!");
+    assert(m >= 1 && m <= dims_[4] && "m is out of bounds in DViewCMatrixKokkos 7D!");
+    assert(n >= 1 && n <= dims_[5] && "n is out of bounds in DViewCMatrixKokkos 7D!");
+    assert(o >= 1 && o <= dims_[6] && "o is out of bounds in DViewCMatrixKokkos 7D!");
+    return this_matrix_(o + ((n - 1) * dims_[6])
+                          + ((m - 1) * dims_[6] * dims_[5])
+                          + ((l - 1) * dims_[6] * dims_[5] * dims_[4])
+                          + ((k - 1) * dims_[6] * dims_[5] * dims_[4] * dims_[3])
+                          + ((j - 1) * dims_[6] * dims_[5] * dims_[4] * dims_[3] * dims_[2])
+                          + ((i - 1) * dims_[6] * dims_[5] * dims_[4] * dims_[3] * dims_[2] * dims_[1]));
+}
+
+template <typename T, typename Layout, typename ExecSpace, typename MemoryTraits>
+KOKKOS_INLINE_FUNCTION
+DViewCMatrixKokkos<T,Layout,ExecSpace,MemoryTraits>& DViewCMatrixKokkos<T,Layout,ExecSpace,MemoryTraits>::operator= (const DViewCMatrixKokkos& temp) {
+    
+    // Do nothing if the assignment is of the form x = x
+    if (this != &temp) {
+        for (int iter = 0; iter < temp.order_; iter++){
+            dims_[iter] = temp.dims_[iter];
+        } // end for
+
+        order_ = temp.order_;
+        length_ = temp.length_;
+        temp_inp_matrix_ = temp.temp_inp_matrix_;
+        this_matrix_host_ = temp.this_matrix_host_;
+        this_matrix_ = temp.this_matrix_;
+        host = temp.host;
+    }
+    
+    return *this;
+}
+
+// Return size
+template <typename T, typename Layout, typename ExecSpace, typename MemoryTraits>
+KOKKOS_INLINE_FUNCTION
+size_t DViewCMatrixKokkos<T,Layout,ExecSpace,MemoryTraits>::size() const {
+    return length_;
+}
+
+template <typename T, typename Layout, typename ExecSpace, typename MemoryTraits>
+KOKKOS_INLINE_FUNCTION
+size_t DViewCMatrixKokkos<T,Layout,ExecSpace,MemoryTraits>::extent() const {
+    return length_;
+}
+
+template <typename T, typename Layout, typename ExecSpace, typename MemoryTraits>
+KOKKOS_INLINE_FUNCTION
+size_t DViewCMatrixKokkos<T,Layout,ExecSpace,MemoryTraits>::dims(size_t i) const {
+    i--;
+    assert(i < order_ && "DViewCMatrixKokkos order (rank) does not match constructor, dim[i] does not exist!");
+    assert(dims_[i]>0 && "Access to DViewCMatrixKokkos dims is out of bounds!");
+    return dims_[i];
+}
+
+template <typename T, typename Layout, typename ExecSpace, typename MemoryTraits>
+KOKKOS_INLINE_FUNCTION
+size_t DViewCMatrixKokkos<T,Layout,ExecSpace,MemoryTraits>::order() const {
+    return order_;
+}
+
+template <typename T, typename Layout, typename ExecSpace, typename MemoryTraits>
+KOKKOS_INLINE_FUNCTION
+T* DViewCMatrixKokkos<T,Layout,ExecSpace,MemoryTraits>::device_pointer() const {
+    return this_matrix_.data();
+}
+
+template <typename T, typename Layout, typename ExecSpace, typename MemoryTraits>
+KOKKOS_INLINE_FUNCTION
+T* DViewCMatrixKokkos<T,Layout,ExecSpace,MemoryTraits>::host_pointer() const {
+    return this_matrix_host_.data();
+}
+
+template <typename T, typename Layout, typename ExecSpace, typename MemoryTraits>
+void DViewCMatrixKokkos<T,Layout,ExecSpace,MemoryTraits>::update_host() {
+    MATAR_PROFILE_SCOPE("DViewCMatrixKokkos::update_host", ProfileCategory::transfer);
+    TransferLog::instance().record(this_matrix_, true, this_matrix_.size() * sizeof(T));
+    // Deep copy of device view to host view
+    deep_copy(this_matrix_host_, this_matrix_);
+}
+
+template <typename T, typename Layout, typename ExecSpace, typename MemoryTraits>
+void DViewCMatrixKokkos<T,Layout,ExecSpace,MemoryTraits>::update_device() {
+    MATAR_PROFILE_SCOPE("DViewCMatrixKokkos::update_device", ProfileCategory::transfer);
+    TransferLog::instance().record(this_matrix_, false, this_matrix_.size() * sizeof(T));
+    // Deep copy of host view to device view
+    deep_copy(this_matrix_, this_matrix_host_);
+}
+
+template <typename T, typename Layout, typename ExecSpace, typename MemoryTraits>
+template <typename ExecInstance>
+void DViewCMatrixKokkos<T,Layout,ExecSpace,MemoryTraits>::update_host(const ExecInstance& exec) {
+    TransferLog::instance().record(this_matrix_, true, this_matrix_.size() * sizeof(T));
+    deep_copy(exec, this_matrix_host_, this_matrix_);
+}
+
+template <typename T, typename Layout, typename ExecSpace, typename MemoryTraits>
+template <typename ExecInstance>
+void DViewCMatrixKokkos<T,Layout,ExecSpace,MemoryTraits>::update_device(const ExecInstance& exec) {
+    TransferLog::instance().record(this_matrix_, false, this_matrix_.size() * sizeof(T));
+    deep_copy(exec, this_matrix_, this_matrix_host_);
+}
+
+// Get the name of the view
+template <typename T, typename Layout, typename ExecSpace, typename MemoryTraits>
+KOKKOS_INLINE_FUNCTION
+const std::string DViewCMatrixKokkos<T,Layout,ExecSpace,MemoryTraits>::get_name() const{
+    return this_matrix_.label();
+}
+
+template <typename T, typename Layout, typename ExecSpace, typename MemoryTraits>
+void DViewCMatrixKokkos<T,Layout,ExecSpace,MemoryTraits>::set_values(T val) {
+    Kokkos::parallel_for( Kokkos::RangePolicy<> ( 0, length_), KOKKOS_CLASS_LAMBDA(const int i){
+        this_matrix_(i) = val;
+    });
+}
+
+template <typename T, typename Layout, typename ExecSpace, typename MemoryTraits>
+KOKKOS_INLINE_FUNCTION
+DViewCMatrixKokkos<T,Layout,ExecSpace,MemoryTraits>::~DViewCMatrixKokkos() {}
+// End DViewCMatrixKokkos
+
+/////////////////////////
+// ScatterArrayKokkos: adds contributions from many threads into the entries
+// of a CArrayKokkos, or the device side of a DCArrayKokkos, e.g. corner
+// forces summed to the nodes or a histogram. It wraps a
+// Kokkos::Experimental::ScatterView, which uses atomics on GPUs and per
+// thread copies of the array on multi-threaded CPUs.
+//
+//   ScatterArrayKokkos <double> node_force(force);
+//   FOR_ALL(corner, 0, num_corners, {
+//       node_force.contribute(corners_in_node(corner), corner_force(corner));
+//   });
+//   node_force.merge(); // force now holds the sums
+//
+// Contributions are added to the values already in the target. After
+// merge() the scatter array can be used again for the next sum.
+/////////////////////////
+template <typename T, typename Layout = DefaultLayout, typename ExecSpace = DefaultExecSpace, typename MemoryTraits = void>
+class ScatterArrayKokkos {
+
+    using TArray1D = Kokkos::View<T*, Layout, ExecSpace, MemoryTraits>;
+    using TScatter = Kokkos::Experimental::ScatterView<T*, Layout, ExecSpace>;
+
+private:
+    size_t dims_[7];
+    size_t order_;
+    size_t length_;
+    TArray1D target_;
+    TScatter scatter_;
+
+public:
+    ScatterArrayKokkos();
+
+    ScatterArrayKokkos(const CArrayKokkos<T, Layout, ExecSpace, MemoryTraits>& target);
+
+    ScatterArrayKokkos(const DCArrayKokkos<T, Layout, ExecSpace, MemoryTraits>& target);
+
+    // Add val to the target entry, safe to call from any thread
+    KOKKOS_INLINE_FUNCTION
+    void contribute(size_t i, T val) const;
+
+    KOKKOS_INLINE_FUNCTION
+    void contribute(size_t i, size_t j, T val) const;
+
+    KOKKOS_INLINE_FUNCTION
+    void contribute(size_t i, size_t j, size_t k, T val) const;
+
+    KOKKOS_INLINE_FUNCTION
+    void contribute(size_t i, size_t j, size_t k, size_t l, T val) const;
+
+    // Add the per thread copies into the target and clear them, does
+    // nothing extra when atomics are used
+    void merge();
+
+    KOKKOS_INLINE_FUNCTION
+    size_t size() const;
+
+    KOKKOS_INLINE_FUNCTION
+    size_t dims(size_t i) const;
+
+    KOKKOS_INLINE_FUNCTION
+    size_t order() const;
+
+    // Deconstructor
+    KOKKOS_INLINE_FUNCTION
+    ~ScatterArrayKokkos ();
+}; // End of ScatterArrayKokkos
+
+// Default constructor
+template <typename T, typename Layout, typename ExecSpace, typename MemoryTraits>
+ScatterArrayKokkos<T,Layout,ExecSpace,MemoryTraits>::ScatterArrayKokkos() {
+    length_ = order_ = 0;
+    for (int i = 0; i < 7; i++) {
+        dims_[i] = 0;
+    }
+}
+
+// Scatter into a device array
+template <typename T, typename Layout, typename ExecSpace, typename MemoryTraits>
+ScatterArrayKokkos<T,Layout,ExecSpace,MemoryTraits>::ScatterArrayKokkos(const CArrayKokkos<T, Layout, ExecSpace, MemoryTraits>& target) {
+    order_  = target.order();
+    length_ = target.size();
+    for (size_t i = 0; i < 7; i++) {
+        dims_[i] = (i < order_) ? target.dims(i) : 0;
+    }
+    target_  = target.get_kokkos_view();
+    scatter_ = TScatter(target_);
+}
+
+// Scatter into the device side of a dual array, call update_host() after merge()
+template <typename T, typename Layout, typename ExecSpace, typename MemoryTraits>
+ScatterArrayKokkos<T,Layout,ExecSpace,MemoryTraits>::ScatterArrayKokkos(const DCArrayKokkos<T, Layout, ExecSpace, MemoryTraits>& target) {
+    order_  = target.order();
+    length_ = target.size();
+    for (size_t i = 0; i < 7; i++) {
+        dims_[i] = (i < order_) ? target.dims(i) : 0;
+    }
+    target_  = target.get_kokkos_dual_view().view_device();
+    scatter_ = TScatter(target_);
+}
+
+template <typename T, typename Layout, typename ExecSpace, typename MemoryTraits>
+KOKKOS_INLINE_FUNCTION
+void ScatterArrayKokkos<T,Layout,ExecSpace,MemoryTraits>::contribute(size_t i, T val) const {
+    assert(order_ == 1 && "Tensor order (rank) does not match constructor in ScatterArrayKokkos 1D!");
+    assert(i < dims_[0] && "i is out of bounds in ScatterArrayKokkos 1D!");
+    scatter_.access()(i) += val;
+}
+
+template <typename T, typename Layout, typename ExecSpace, typename MemoryTraits>
+KOKKOS_INLINE_FUNCTION
+void ScatterArrayKokkos<T,Layout,ExecSpace,MemoryTraits>::contribute(size_t i, size_t j, T val) const {
+    assert(order_ == 2 && "Tensor order (rank) does not match constructor in ScatterArrayKokkos 2D!");
+    assert(i < dims_[0] && "i is out of bounds in ScatterArrayKokkos 2D!");
+    assert(j < dims_[1] && "j is out of bounds in ScatterArrayKokkos 2D!");
+    scatter_.access()(j + (i * dims_[1])) += val;
+}
+
+template <typename T, typename Layout, typename ExecSpace, typename MemoryTraits>
+KOKKOS_INLINE_FUNCTION
+void ScatterArrayKokkos<T,Layout,ExecSpace,MemoryTraits>::contribute(size_t i, size_t j, size_t k, T val) const {
+    assert(order_ == 3 && "Tensor order (rank) does not match constructor in ScatterArrayKokkos 3D!");
+    assert(i < dims_[0] && "i is out of bounds in ScatterArrayKokkos 3D!");
+    assert(j < dims_[1] && "j is out of bounds in ScatterArrayKokkos 3D!");
+    assert(k < dims_[2] && "k is out of bounds in ScatterArrayKokkos 3D!");
+    scatter_.access()(k + (j * dims_[2])
+                        + (i * dims_[2] * dims_[1])) += val;
+}
+
+template <typename T, typename Layout, typename ExecSpace, typename MemoryTraits>
+KOKKOS_INLINE_FUNCTION
+void ScatterArrayKokkos<T,Layout,ExecSpace,MemoryTraits>::contribute(size_t i, size_t j, size_t k, size_t l, T val) const {
+    assert(order_ == 4 && "Tensor order (rank) does not match constructor in ScatterArrayKokkos 4D!");
+    assert(i < dims_[0] && "i is out of bounds in ScatterArrayKokkos 4D!");
+    assert(j < dims_[1] && "j is out of bounds in ScatterArrayKokkos 4D!");
+    assert(k < dims_[2] && "k is out of bounds in ScatterArrayKokkos 4D!");
+    assert(l < dims_[3] && "l is out of bounds in ScatterArrayKokkos 4D!");
+    scatter_.access()(l + (k * dims_[3])
+                        + (j * dims_[3] * dims_[2])
+                        + (i * dims_[3] * dims_[2] * dims_[1])) += val;
+}
+
+template <typename T, typename Layout, typename ExecSpace, typename MemoryTraits>
+void ScatterArrayKokkos<T,Layout,ExecSpace,MemoryTraits>::merge() {
+    MATAR_PROFILE_SCOPE("ScatterArrayKokkos::merge", ProfileCategory::compute);
+    Kokkos::Experimental::contribute(target_, scatter_);
+    scatter_.reset_except(target_);
+}
+
+template <typename T, typename Layout, typename ExecSpace, typename MemoryTraits>
+KOKKOS_INLINE_FUNCTION
+size_t ScatterArrayKokkos<T,Layout,ExecSpace,MemoryTraits>::size() const {
+    return length_;
+}
+
+template <typename T, typename Layout, typename ExecSpace, typename MemoryTraits>
+KOKKOS_INLINE_FUNCTION
+size_t ScatterArrayKokkos<T,Layout,ExecSpace,MemoryTraits>::dims(size_t i) const {
+    assert(i < order_ && "ScatterArrayKokkos order (rank) does not match constructor, dim[i] does not exist!");
+    assert(dims_[i]>0 && "Access to ScatterArrayKokkos dims is out of bounds!");
+    return dims_[i];
+}
+
+template <typename T, typename Layout, typename ExecSpace, typename MemoryTraits>
+KOKKOS_INLINE_FUNCTION
+size_t ScatterArrayKokkos<T,Layout,ExecSpace,MemoryTraits>::order() const {
+    return order_;
+}
+
+template <typename T, typename Layout, typename ExecSpace, typename MemoryTraits>
+KOKKOS_INLINE_FUNCTION
+ScatterArrayKokkos<T,Layout,ExecSpace,MemoryTraits>::~ScatterArrayKokkos() {}
+// End ScatterArrayKokkos
+
+/////////////////////////
+// CArrayVec: an array of small vectors, e.g. node coordinates (num_nodes, 3),
+// stored as blocks of Width vectors where each component is contiguous
+// within a block (AoSoA). Component d of vectors s*Width .. s*Width+Width-1
+// is one SIMD pack, so loops over the lanes of a pack vectorize.
+//
+//   CArrayVec <double, 8> coords(num_nodes, 3);
+//   coords(node, 0) = x;                      // same syntax as CArrayKokkos
+//
+//   FOR_ALL_SIMD(s, a0, a1, 0, num_nodes, 8, {   // pack s, lanes [a0, a1)
+//       double* x = coords.pack(s, 0);
+//       const double* v = vel.pack(s, 0);
+//       for (int a = a0; a < a1; a++) {
+//           x[a] += dt * v[a];
+//       }
+//   });
+//
+// Width must be a power of 2. The last block is padded with zeros.
+/////////////////////////
+template <typename T, size_t Width = 8, typename Layout = DefaultLayout, typename ExecSpace = DefaultExecSpace, typename MemoryTraits = void>
+class CArrayVec {
+
+    static_assert(Width > 0 && (Width & (Width - 1)) == 0, "CArrayVec Width must be a power of 2!");
+
+    using TArray1D = Kokkos::View<T*, Layout, ExecSpace, MemoryTraits>;
+
+private:
+    size_t dims_[2];
+    size_t num_packs_;
+    size_t length_;   // padded length of the storage
+    TArray1D this_array_;
+
+public:
+    CArrayVec();
+
+    // dim0 vectors with dim1 components each
+    CArrayVec(size_t dim0, size_t dim1, const std::string& tag_string = DEFAULTSTRINGARRAY);
+
+    // component d of vector i
+    KOKKOS_INLINE_FUNCTION
+    T& operator()(size_t i, size_t d) const;
+
+    // component d of lane a in pack s, vector s*Width + a
+    KOKKOS_INLINE_FUNCTION
+    T& access(size_t s, size_t a, size_t d) const;
+
+    // pointer to the Width contiguous values of component d in pack s
+    KOKKOS_INLINE_FUNCTION
+    T* pack(size_t s, size_t d) const;
+
+    // copy to and from the row-major (dim0, dim1) layout, on the device for
+    // the Kokkos types and on the host for CArray
+    void copy_from(const CArrayKokkos<T, Layout, ExecSpace, MemoryTraits>& source);
+
+    void copy_from(const DCArrayKokkos<T, Layout, ExecSpace, MemoryTraits>& source);
+
+    void copy_from(const CArray<T>& source);
+
+    void copy_to(const CArrayKokkos<T, Layout, ExecSpace, MemoryTraits>& dest) const;
+
+    void copy_to(const DCArrayKokkos<T, Layout, ExecSpace, MemoryTraits>& dest) const;
+
+    void copy_to(CArray<T>& dest) const;
+
+    void set_values(T val);
+
+    static constexpr size_t width() { return Width; }
+
+    KOKKOS_INLINE_FUNCTION
+    size_t num_packs() const;
+
+    // number of vectors times components, the padding is not counted
+    KOKKOS_INLINE_FUNCTION
+    size_t size() const;
+
+    KOKKOS_INLINE_FUNCTION
+    size_t dims(size_t i) const;
+
+    KOKKOS_INLINE_FUNCTION
+    size_t order() const;
+
+    KOKKOS_INLINE_FUNCTION
+    T* pointer() const;
+
+    TArray1D get_kokkos_view() const;
+
+    const std::string get_name() const;
+
+    // Deconstructor
+    KOKKOS_INLINE_FUNCTION
+    ~CArrayVec ();
+}; // End of CArrayVec
+
+// Default constructor
+template <typename T, size_t Width, typename Layout, typename ExecSpace, typename MemoryTraits>
+CArrayVec<T,Width,Layout,ExecSpace,MemoryTraits>::CArrayVec() {
+    dims_[0] = dims_[1] = 0;
+    num_packs_ = length_ = 0;
+}
+
+template <typename T, size_t Width, typename Layout, typename ExecSpace, typename MemoryTraits>
+CArrayVec<T,Width,Layout,ExecSpace,MemoryTraits>::CArrayVec(size_t dim0, size_t dim1, const std::string& tag_string) {
+    dims_[0] = dim0;
+    dims_[1] = dim1;
+    num_packs_ = (dim0 + Width - 1) / Width;
+    length_ = num_packs_ * dim1 * Width;
+    this_array_ = TArray1D(tag_string, length_);
+}
+
+template <typename T, size_t Width, typename Layout, typename ExecSpace, typename MemoryTraits>
 KOKKOS_INLINE_FUNCTION
-T& DViewCMatrixKokkos<T,Layout,ExecSpace,MemoryTraits>::operator()(size_t i, size_t j, size_t k) const {
-    assert(order_ == 3 && "Tensor order (rank) does not match constructor in DViewCMatrixKokkos 3D!");
-    assert(i >= 1 && i <= dims_[0] && "i is out of bounds in DViewCMatrixKokkos 3D!");
-    assert(j >= 1 && j <= dims_[1] && "j is out of bounds in DViewCMatrixKokkos 3D!");
-    assert(k >= 1 && k <= dims_[2] && "k is out of bounds in DViewCMatrixKokkos 3D!");
-    return this_matrix_((k - 1) + ((j - 1) * dims_[2])
-                                + ((i - 1) * dims_[2] * dims_[1]));
+T& CArrayVec<T,Width,Layout,ExecSpace,MemoryTraits>::operator()(size_t i, size_t d) const {
+    assert(i < dims_[0] && "i is out of bounds in CArrayVec!");
+    assert(d < dims_[1] && "d is out of bounds in CArrayVec!");
+    return this_array_(((i / Width) * dims_[1] + d) * Width + (i % Width));
 }
 
-template <typename T, typename Layout, typename ExecSpace, typename MemoryTraits>
+template <typename T, size_t Width, typename Layout, typename ExecSpace, typename MemoryTraits>
 KOKKOS_INLINE_FUNCTION
-T& DViewCMatrixKokkos<T,Layout,ExecSpace,MemoryTraits>::operator()(size_t i, size_t j, size_t k, size_t l) const {
-    assert(order_ == 4 && "Tensor order (rank) does not match constructor in DViewCMatrixKokkos 4D!");
-    assert(i >= 1 && i <= dims_[0] && "i is out of bounds in DViewCMatrixKokkos 4D!");
-    assert(j >= 1 && j <= dims_[1] && "j is out of bounds in DViewCMatrixKokkos 4D!");
-    assert(k >= 1 && k <= dims_[2] && "k is out of bounds in DViewCMatrixKokkos 4D!");
-    assert(l >= 1 && l <= dims_[3] && "l is out of bounds in DViewCMatrixKokkos 4D!");
-    return this_matrix_((l - 1) + ((k - 1) * dims_[3])
-                                + ((j - 1) * dims_[3] * dims_[2])
-                                + ((i - 1) * dims_[3] * dims_[2] * dims_[1]));
+T& CArrayVec<T,Width,Layout,ExecSpace,MemoryTraits>::access(size_t s, size_t a, size_t d) const {
+    assert(s < num_packs_ && "s is out of bounds in CArrayVec!");
+    assert(a < Width && "a is out of bounds in CArrayVec!");
+    assert(d < dims_[1] && "d is out of bounds in CArrayVec!");
+    return this_array_((s * dims_[1] + d) * Width + a);
 }
 
-template <typename T, typename Layout, typename ExecSpace, typename MemoryTraits>
+template <typename T, size_t Width, typename Layout, typename ExecSpace, typename MemoryTraits>
 KOKKOS_INLINE_FUNCTION
-T& DViewCMatrixKokkos<T,Layout,ExecSpace,MemoryTraits>::operator()(size_t i, size_t j, size_t k, size_t l,
-                               size_t m) const {
-    assert(order_ == 5 && "Tensor order (rank) does not match constructor in DViewCMatrixKokkos 5D!");
-    assert(i >= 1 && i <= dims_[0] && "i is out of bounds in DViewCMatrixKokkos 5D!");
-    assert(j >= 1 && j <= dims_[1] && "j is out of bounds in DViewCMatrixKokkos 5D!");
-    assert(k >= 1 && k <= dims_[2] && "k is out of bounds in DViewCMatrixKokkos 5D!");
-    assert(l >= 1 && l <= dims_[3] && "l is out of bounds in DViewCMatrixKokkos 5D!");
-    assert(m >= 1 && m <= dims_[4] && "m is out of bounds in DViewCMatrixKokkos 5D!");
-    return this_matrix_((m - 1) + ((l - 1) * dims_[4])
-                                + ((k - 1) * dims_[4] * dims_[3])
-                                + ((j - 1) * dims_[4] * dims_[3] * dims_[2])
-                                + ((i - 1) * dims_[4] * dims_[3] * dims_[2] * dims_[1]));
+T* CArrayVec<T,Width,Layout,ExecSpace,MemoryTraits>::pack(size_t s, size_t d) const {
+    assert(s < num_packs_ && "s is out of bounds in CArrayVec!");
+    assert(d < dims_[1] && "d is out of bounds in CArrayVec!");
+    return this_array_.data() + (s * dims_[1] + d) * Width;
 }
 
-template <typename T, typename Layout, typename ExecSpace, typename MemoryTraits>
-KOKKOS_INLINE_FUNCTION
-T& DViewCMatrixKokkos<T,Layout,ExecSpace,MemoryTraits>::operator()(size_t i, size_t j, size_t k, size_t l,
-                               size_t m, size_t n) const {
-    assert(order_ == 6 && "Tensor order (rank) does not match constructor in DViewCMatrixKokkos 6D!");
-    assert(i >= 1 && i <= dims_[0] && "i is out of bounds in DViewCMatrixKokkos 6D!");
-    assert(j >= 1 && j <= dims_[1] && "j is out of bounds in DViewCMatrixKokkos 6D!");
-    assert(k >= 1 && k <= dims_[2] && "k is out of bounds in DViewCMatrixKokkos 6D!");
-    assert(l >= 1 && l <= dims_[3] && "l is out of bounds in DViewCMatrixKokkos 6D!");
-    assert(m >= 1 && m <= dims_[4] && "m is out of bounds in DViewCMatrixKokkos 6D!");
-    assert(n >= 1 && n <= dims_[5] && "n is out of bounds in DViewCMatrixKokkos 6D!");
-    return this_matrix_((n - 1) + ((m - 1) * dims_[5])
-                                + ((l - 1) * dims_[5] * dims_[4])
-                                + ((k - 1) * dims_[5] * dims_[4] * dims_[3])
-                                + ((j - 1) * dims_[5] * dims_[4] * dims_[3] * dims_[2])
-                                + ((i - 1) * dims_[5] * dims_[4] * dims_[3] * dims_[2] * dims_[1]));
+template <typename T, size_t Width, typename Layout, typename ExecSpace, typename MemoryTraits>
+void CArrayVec<T,Width,Layout,ExecSpace,MemoryTraits>::copy_from(const CArrayKokkos<T, Layout, ExecSpace, MemoryTraits>& source) {
+    assert(source.order() == 2 && source.dims(0) == dims_[0] && source.dims(1) == dims_[1]
+           && "CArrayVec copy_from needs a (dim0, dim1) array!");
+    CArrayVec<T,Width,Layout,ExecSpace,MemoryTraits> dest = *this;
+    Kokkos::parallel_for("CopyFrom_CArrayVec",
+                         Kokkos::MDRangePolicy< Kokkos::Rank<2,LOOP_ORDER,LOOP_ORDER>, ExecSpace > ( {0, 0}, {dims_[0], dims_[1]} ),
+                         KOKKOS_LAMBDA(const int i, const int d) {
+        dest(i, d) = source(i, d);
+    });
 }
 
-template <typename T, typename Layout, typename ExecSpace, typename MemoryTraits>
-KOKKOS_INLINE_FUNCTION
-T& DViewCMatrixKokkos<T,Layout,ExecSpace,MemoryTraits>::operator()(size_t i, size_t j, size_t k, size_t l,
-                               size_t m, size_t n, size_t o) const {
-    assert(order_ == 7 && "Tensor order (rank) does not match constructor in DViewCMatrixKokkos 7D!");
-    assert(i >= 1 && i <= dims_[0] && "i is out of bounds in DViewCMatrixKokkos 7D!");
-    assert(j >= 1 && j <= dims_[1] && "j is out of bounds in DViewCMatrixKokkos 7D!");
-    assert(k >= 1 && k <= dims_[2] && "k is out of bounds in DViewCMatrixKokkos 7D!");
-    assert(l >= 1 && l <= dims_[3] && "l is out of bounds in DViewCMatrixKokkos 7D!");
-    assert(m >= 1 && m <= dims_[4] && "m is out of bounds in DViewCMatrixKokkos 7D!");
-    assert(n >= 1 && n <= dims_[5] && "n is out of bounds in DViewCMatrixKokkos 7D!");
-    assert(o >= 1 && o <= dims_[6] && "o is out of bounds in DViewCMatrixKokkos 7D!");
-    return this_matrix_(o + ((n - 1) * dims_[6])
-                          + ((m - 1) * dims_[6] * dims_[5])
-                          + ((l - 1) * dims_[6] * dims_[5] * dims_[4])
-                          + ((k - 1) * dims_[6] * dims_[5] * dims_[4] * dims_[3])
-                          + ((j - 1) * dims_[6] * dims_[5] * dims_[4] * dims_[3] * dims_[2])
-                          + ((i - 1) * dims_[6] * dims_[5] * dims_[4] * dims_[3] * dims_[2] * dims_[1]));
+template <typename T, size_t Width, typename Layout, typename ExecSpace, typename MemoryTraits>
+void CArrayVec<T,Width,Layout,ExecSpace,MemoryTraits>::copy_from(const DCArrayKokkos<T, Layout, ExecSpace, MemoryTraits>& source) {
+    assert(source.order() == 2 && source.dims(0) == dims_[0] && source.dims(1) == dims_[1]
+           && "CArrayVec copy_from needs a (dim0, dim1) array!");
+    CArrayVec<T,Width,Layout,ExecSpace,MemoryTraits> dest = *this;
+    Kokkos::parallel_for("CopyFrom_CArrayVec",
+                         Kokkos::MDRangePolicy< Kokkos::Rank<2,LOOP_ORDER,LOOP_ORDER>, ExecSpace > ( {0, 0}, {dims_[0], dims_[1]} ),
+                         KOKKOS_LAMBDA(const int i, const int d) {
+        dest(i, d) = source(i, d);
+    });
 }
 
-template <typename T, typename Layout, typename ExecSpace, typename MemoryTraits>
-KOKKOS_INLINE_FUNCTION
-DViewCMatrixKokkos<T,Layout,ExecSpace,MemoryTraits>& DViewCMatrixKokkos<T,Layout,ExecSpace,MemoryTraits>::operator= (const DViewCMatrixKokkos& temp) {
-    
-    // Do nothing if the assignment is of the form x = x
-    if (this != &temp) {
-        for (int iter = 0; iter < temp.order_; iter++){
-            dims_[iter] = temp.dims_[iter];
-        } // end for
-
-        order_ = temp.order_;
-        length_ = temp.length_;
-        temp_inp_matrix_ = temp.temp_inp_matrix_;
-        this_matrix_host_ = temp.this_matrix_host_;
-        this_matrix_ = temp.this_matrix_;
-        host = temp.host;
+template <typename T, size_t Width, typename Layout, typename ExecSpace, typename MemoryTraits>
+void CArrayVec<T,Width,Layout,ExecSpace,MemoryTraits>::copy_from(const CArray<T>& source) {
+    assert(source.order() == 2 && source.dims(0) == dims_[0] && source.dims(1) == dims_[1]
+           && "CArrayVec copy_from needs a (dim0, dim1) array!");
+    auto host = Kokkos::create_mirror_view(this_array_);
+    for (size_t i = 0; i < dims_[0]; i++) {
+        for (size_t d = 0; d < dims_[1]; d++) {
+            host(((i / Width) * dims_[1] + d) * Width + (i % Width)) = source(i, d);
+        }
     }
-    
-    return *this;
+    Kokkos::deep_copy(this_array_, host);
+}
+
+template <typename T, size_t Width, typename Layout, typename ExecSpace, typename MemoryTraits>
+void CArrayVec<T,Width,Layout,ExecSpace,MemoryTraits>::copy_to(const CArrayKokkos<T, Layout, ExecSpace, MemoryTraits>& dest) const {
+    assert(dest.order() == 2 && dest.dims(0) == dims_[0] && dest.dims(1) == dims_[1]
+           && "CArrayVec copy_to needs a (dim0, dim1) array!");
+    CArrayVec<T,Width,Layout,ExecSpace,MemoryTraits> source = *this;
+    Kokkos::parallel_for("CopyTo_CArrayVec",
+                         Kokkos::MDRangePolicy< Kokkos::Rank<2,LOOP_ORDER,LOOP_ORDER>, ExecSpace > ( {0, 0}, {dims_[0], dims_[1]} ),
+                         KOKKOS_LAMBDA(const int i, const int d) {
+        dest(i, d) = source(i, d);
+    });
 }
 
-// Return size
-template <typename T, typename Layout, typename ExecSpace, typename MemoryTraits>
-KOKKOS_INLINE_FUNCTION
-size_t DViewCMatrixKokkos<T,Layout,ExecSpace,MemoryTraits>::size() const {
-    return length_;
+// the device side of dest is written, call dest.update_host() to see it on the host
+template <typename T, size_t Width, typename Layout, typename ExecSpace, typename MemoryTraits>
+void CArrayVec<T,Width,Layout,ExecSpace,MemoryTraits>::copy_to(const DCArrayKokkos<T, Layout, ExecSpace, MemoryTraits>& dest) const {
+    assert(dest.order() == 2 && dest.dims(0) == dims_[0] && dest.dims(1) == dims_[1]
+           && "CArrayVec copy_to needs a (dim0, dim1) array!");
+    CArrayVec<T,Width,Layout,ExecSpace,MemoryTraits> source = *this;
+    Kokkos::parallel_for("CopyTo_CArrayVec",
+                         Kokkos::MDRangePolicy< Kokkos::Rank<2,LOOP_ORDER,LOOP_ORDER>, ExecSpace > ( {0, 0}, {dims_[0], dims_[1]} ),
+                         KOKKOS_LAMBDA(const int i, const int d) {
+        dest(i, d) = source(i, d);
+    });
 }
 
-template <typename T, typename Layout, typename ExecSpace, typename MemoryTraits>
-KOKKOS_INLINE_FUNCTION
-size_t DViewCMatrixKokkos<T,Layout,ExecSpace,MemoryTraits>::extent() const {
-    return length_;
+template <typename T, size_t Width, typename Layout, typename ExecSpace, typename MemoryTraits>
+void CArrayVec<T,Width,Layout,ExecSpace,MemoryTraits>::copy_to(CArray<T>& dest) const {
+    assert(dest.order() == 2 && dest.dims(0) == dims_[0] && dest.dims(1) == dims_[1]
+           && "CArrayVec copy_to needs a (dim0, dim1) array!");
+    auto host = Kokkos::create_mirror_view(this_array_);
+    Kokkos::deep_copy(host, this_array_);
+    for (size_t i = 0; i < dims_[0]; i++) {
+        for (size_t d = 0; d < dims_[1]; d++) {
+            dest(i, d) = host(((i / Width) * dims_[1] + d) * Width + (i % Width));
+        }
+    }
 }
 
-template <typename T, typename Layout, typename ExecSpace, typename MemoryTraits>
-KOKKOS_INLINE_FUNCTION
-size_t DViewCMatrixKokkos<T,Layout,ExecSpace,MemoryTraits>::dims(size_t i) const {
-    i--;
-    assert(i < order_ && "DViewCMatrixKokkos order (rank) does not match constructor, dim[i] does not exist!");
-    assert(dims_[i]>0 && "Access to DViewCMatrixKokkos dims is out of bounds!");
-    return dims_[i];
+template <typename T, size_t Width, typename Layout, typename ExecSpace, typename MemoryTraits>
+void CArrayVec<T,Width,Layout,ExecSpace,MemoryTraits>::set_values(T val) {
+    Kokkos::deep_copy(this_array_, val);
 }
 
-template <typename T, typename Layout, typename ExecSpace, typename MemoryTraits>
+template <typename T, size_t Width, typename Layout, typename ExecSpace, typename MemoryTraits>
 KOKKOS_INLINE_FUNCTION
-size_t DViewCMatrixKokkos<T,Layout,ExecSpace,MemoryTraits>::order() const {
-    return order_;
+size_t CArrayVec<T,Width,Layout,ExecSpace,MemoryTraits>::num_packs() const {
+    return num_packs_;
 }
 
-template <typename T, typename Layout, typename ExecSpace, typename MemoryTraits>
+template <typename T, size_t Width, typename Layout, typename ExecSpace, typename MemoryTraits>
 KOKKOS_INLINE_FUNCTION
-T* DViewCMatrixKokkos<T,Layout,ExecSpace,MemoryTraits>::device_pointer() const {
-    return this_matrix_.data();
+size_t CArrayVec<T,Width,Layout,ExecSpace,MemoryTraits>::size() const {
+    return dims_[0] * dims_[1];
 }
 
-template <typename T, typename Layout, typename ExecSpace, typename MemoryTraits>
+template <typename T, size_t Width, typename Layout, typename ExecSpace, typename MemoryTraits>
 KOKKOS_INLINE_FUNCTION
-T* DViewCMatrixKokkos<T,Layout,ExecSpace,MemoryTraits>::host_pointer() const {
-    return this_matrix_host_.data();
+size_t CArrayVec<T,Width,Layout,ExecSpace,MemoryTraits>::dims(size_t i) const {
+    assert(i < 2 && "CArrayVec order (rank) is 2, dim[i] does not exist!");
+    return dims_[i];
 }
 
-template <typename T, typename Layout, typename ExecSpace, typename MemoryTraits>
-void DViewCMatrixKokkos<T,Layout,ExecSpace,MemoryTraits>::update_host() {
-    // Deep copy of device view to host view
-    deep_copy(this_matrix_host_, this_matrix_);
+template <typename T, size_t Width, typename Layout, typename ExecSpace, typename MemoryTraits>
+KOKKOS_INLINE_FUNCTION
+size_t CArrayVec<T,Width,Layout,ExecSpace,MemoryTraits>::order() const {
+    return 2;
 }
 
-template <typename T, typename Layout, typename ExecSpace, typename MemoryTraits>
-void DViewCMatrixKokkos<T,Layout,ExecSpace,MemoryTraits>::update_device() {
-    // Deep copy of host view to device view
-    deep_copy(this_matrix_, this_matrix_host_);
+template <typename T, size_t Width, typename Layout, typename ExecSpace, typename MemoryTraits>
+KOKKOS_INLINE_FUNCTION
+T* CArrayVec<T,Width,Layout,ExecSpace,MemoryTraits>::pointer() const {
+    return this_array_.data();
 }
 
-// Get the name of the view
-template <typename T, typename Layout, typename ExecSpace, typename MemoryTraits>
-KOKKOS_INLINE_FUNCTION
-const std::string DViewCMatrixKokkos<T,Layout,ExecSpace,MemoryTraits>::get_name() const{
-    return this_matrix_.label();
+template <typename T, size_t Width, typename Layout, typename ExecSpace, typename MemoryTraits>
+Kokkos::View<T*, Layout, ExecSpace, MemoryTraits> CArrayVec<T,Width,Layout,ExecSpace,MemoryTraits>::get_kokkos_view() const {
+    return this_array_;
 }
 
-template <typename T, typename Layout, typename ExecSpace, typename MemoryTraits>
-void DViewCMatrixKokkos<T,Layout,ExecSpace,MemoryTraits>::set_values(T val) {
-    Kokkos::parallel_for( Kokkos::RangePolicy<> ( 0, length_), KOKKOS_CLASS_LAMBDA(const int i){
-        this_matrix_(i) = val;
-    });
+template <typename T, size_t Width, typename Layout, typename ExecSpace, typename MemoryTraits>
+const std::string CArrayVec<T,Width,Layout,ExecSpace,MemoryTraits>::get_name() const {
+    return this_array_.label();
 }
 
-template <typename T, typename Layout, typename ExecSpace, typename MemoryTraits>
+template <typename T, size_t Width, typename Layout, typename ExecSpace, typename MemoryTraits>
 KOKKOS_INLINE_FUNCTION
-DViewCMatrixKokkos<T,Layout,ExecSpace,MemoryTraits>::~DViewCMatrixKokkos() {}
-// End DViewCMatrixKokkos
+CArrayVec<T,Width,Layout,ExecSpace,MemoryTraits>::~CArrayVec() {}
+// End CArrayVec
 
 /*! \brief Dual Kokkos version of the serial RaggedRightArray class.
  *
@@ -6863,6 +8416,14 @@ public:
     // Method that update device view
     void update_device();
 
+    // Methods that enqueue the update on the execution space instance exec
+    // and return without fencing, fence exec or wait on an ExecEvent first
+    template <typename ExecInstance>
+    void update_host(const ExecInstance& exec);
+
+    template <typename ExecInstance>
+    void update_device(const ExecInstance& exec);
+
 
     
     KOKKOS_INLINE_FUNCTION
@@ -6891,7 +8452,7 @@ public:
             mytemp_strides_ = temp_strides_;
             tmp_block_length_ = block_length_;
         }
-        KOKKOS_INLINE_FUNCTION void operator()(const int index, int& update, bool final) const {
+        KOKKOS_INLINE_FUNCTION void operator()(const int index, size_t& update, bool final) const {
             // Load old value in case we update it before accumulating
             const size_t count = mytemp_strides_.view_device()(index) * tmp_block_length_;
             update += count;
@@ -6930,7 +8491,7 @@ public:
             mystart_index_ = tempstart_index_;
             tmp_block_length_ = block_length_;
         }
-        KOKKOS_INLINE_FUNCTION void operator()(const int index, int& update, bool final) const {
+        KOKKOS_INLINE_FUNCTION void operator()(const int index, size_t& update, bool final) const {
             // Load old value in case we update it before accumulating
             const size_t count = mystart_index_.view_device()(index+1) * tmp_block_length_;
             update += count;
@@ -7207,7 +8768,7 @@ void DRaggedRightArrayKokkos<T,Layout,ExecSpace,MemoryTraits,ILayout>::data_setu
     #endif
     // Setup the start indices
     #ifdef HAVE_CLASS_LAMBDA
-    Kokkos::parallel_scan("StartValuesSetup", dims_[0], KOKKOS_CLASS_LAMBDA(const int i, int& update, const bool final) {
+    Kokkos::parallel_scan("StartValuesSetup", dims_[0], KOKKOS_CLASS_LAMBDA(const int i, size_t& update, const bool final) {
         // Load old value in case we update it before accumulating
         const size_t count = mystrides_dev_(i) * block_length_;
         update += count;
@@ -7221,7 +8782,7 @@ void DRaggedRightArrayKokkos<T,Layout,ExecSpace,MemoryTraits,ILayout>::data_setu
     #endif
     //compute length of the storage
     #ifdef HAVE_CLASS_LAMBDA
-    Kokkos::parallel_reduce("LengthSetup", dims_[0], KOKKOS_CLASS_LAMBDA(const int i, int& update) {
+    Kokkos::parallel_reduce("LengthSetup", dims_[0], KOKKOS_CLASS_LAMBDA(const int i, size_t& update) {
         // Load old value in case we update it before accumulating
         update += mystrides_dev_(i) * block_length_;
     }, length_);
@@ -7282,7 +8843,7 @@ KOKKOS_INLINE_FUNCTION
 void DRaggedRightArrayKokkos<T,Layout,ExecSpace,MemoryTraits,ILayout>::stride_finalize() const {
     
     #ifdef HAVE_CLASS_LAMBDA
-    Kokkos::parallel_scan("StartValues", dims_[0], KOKKOS_CLASS_LAMBDA(const int i, int& update, const bool final) {
+    Kokkos::parallel_scan("StartValues", dims_[0], KOKKOS_CLASS_LAMBDA(const int i, size_t& update, const bool final) {
         // Load old value in case we update it before accumulating
         const size_t count = start_index_dev_(i+1);
         update += count;
@@ -7422,6 +8983,8 @@ T* DRaggedRightArrayKokkos<T,Layout,ExecSpace,MemoryTraits,ILayout>::host_pointe
 
 template <typename T, typename Layout, typename ExecSpace, typename MemoryTraits, typename ILayout>
 void DRaggedRightArrayKokkos<T,Layout,ExecSpace,MemoryTraits,ILayout>::update_host() {
+    MATAR_PROFILE_SCOPE("DRaggedRightArrayKokkos::update_host", ProfileCategory::transfer);
+    TransferLog::instance().record(this_array_.view_host(), true, this_array_.view_host().size() * sizeof(T));
 
     this_array_.template modify<typename TArray1D::execution_space>();
     this_array_.template sync<typename TArray1D::host_mirror_space>();
@@ -7429,11 +8992,25 @@ void DRaggedRightArrayKokkos<T,Layout,ExecSpace,MemoryTraits,ILayout>::update_ho
 
 template <typename T, typename Layout, typename ExecSpace, typename MemoryTraits, typename ILayout>
 void DRaggedRightArrayKokkos<T,Layout,ExecSpace,MemoryTraits,ILayout>::update_device() {
+    MATAR_PROFILE_SCOPE("DRaggedRightArrayKokkos::update_device", ProfileCategory::transfer);
+    TransferLog::instance().record(this_array_.view_host(), false, this_array_.view_host().size() * sizeof(T));
 
     this_array_.template modify<typename TArray1D::host_mirror_space>();
     this_array_.template sync<typename TArray1D::execution_space>();
 }
 
+template <typename T, typename Layout, typename ExecSpace, typename MemoryTraits, typename ILayout>
+template <typename ExecInstance>
+void DRaggedRightArrayKokkos<T,Layout,ExecSpace,MemoryTraits,ILayout>::update_host(const ExecInstance& exec) {
+    dual_view_update(this_array_, DualModifiedRangeView(), true, &exec);
+}
+
+template <typename T, typename Layout, typename ExecSpace, typename MemoryTraits, typename ILayout>
+template <typename ExecInstance>
+void DRaggedRightArrayKokkos<T,Layout,ExecSpace,MemoryTraits,ILayout>::update_device(const ExecInstance& exec) {
+    dual_view_update(this_array_, DualModifiedRangeView(), false, &exec);
+}
+
 template <typename T, typename Layout, typename ExecSpace, typename MemoryTraits, typename ILayout>
 KOKKOS_INLINE_FUNCTION
 DRaggedRightArrayKokkos<T,Layout,ExecSpace,MemoryTraits,ILayout> & DRaggedRightArrayKokkos<T,Layout,ExecSpace,MemoryTraits,ILayout>::
@@ -8593,7 +10170,7 @@ public:
           mystart_index_ = tempstart_index_;
           mytemp_strides_ = temp_strides_;
         }
-        KOKKOS_INLINE_FUNCTION void operator()(const int index, int& update, bool final) const {
+        KOKKOS_INLINE_FUNCTION void operator()(const int index, size_t& update, bool final) const {
           // Load old value in case we update it before accumulating
             const size_t count = mytemp_strides_(index);
             update += count;
@@ -8628,7 +10205,7 @@ public:
         finalize_stride_functor(SArray1D tempstart_index_){
           mystart_index_ = tempstart_index_;
         }
-        KOKKOS_INLINE_FUNCTION void operator()(const int index, int& update, bool final) const {
+        KOKKOS_INLINE_FUNCTION void operator()(const int index, size_t& update, bool final) const {
           // Load old value in case we update it before accumulating
             const size_t count = mystart_index_(index+1);
             update += count;
@@ -8704,7 +10281,7 @@ void RaggedRightArrayKokkos<T,Layout,ExecSpace,MemoryTraits,ILayout>::data_setup
     #endif
 
     #ifdef HAVE_CLASS_LAMBDA
-    Kokkos::parallel_scan("StartValuesSetup", dim1_, KOKKOS_CLASS_LAMBDA(const int i, int& update, const bool final) {
+    Kokkos::parallel_scan("StartValuesSetup", dim1_, KOKKOS_CLASS_LAMBDA(const int i, size_t& update, const bool final) {
             // Load old value in case we update it before accumulating
             const size_t count = mystrides_(i);
             update += count;
@@ -8720,7 +10297,7 @@ void RaggedRightArrayKokkos<T,Layout,ExecSpace,MemoryTraits,ILayout>::data_setup
 
     //compute length of the storage
     #ifdef HAVE_CLASS_LAMBDA
-    Kokkos::parallel_reduce("LengthSetup", dim1_, KOKKOS_CLASS_LAMBDA(const int i, int& update) {
+    Kokkos::parallel_reduce("LengthSetup", dim1_, KOKKOS_CLASS_LAMBDA(const int i, size_t& update) {
             // Load old value in case we update it before accumulating
             update += mystrides_(i);
         }, length_);
@@ -8764,7 +10341,7 @@ KOKKOS_INLINE_FUNCTION
 void RaggedRightArrayKokkos<T,Layout,ExecSpace,MemoryTraits,ILayout>::stride_finalize() const {
     
     #ifdef HAVE_CLASS_LAMBDA
-    Kokkos::parallel_scan("StartValues", dim1_, KOKKOS_CLASS_LAMBDA(const int i, int& update, const bool final) {
+    Kokkos::parallel_scan("StartValues", dim1_, KOKKOS_CLASS_LAMBDA(const int i, size_t& update, const bool final) {
             // Load old value in case we update it before accumulating
             const size_t count = start_index_(i+1);
             update += count;
@@ -9020,7 +10597,7 @@ public:
           mytemp_strides_ = temp_strides_;
           myvector_dim_ = myvector_dim;
         }
-        KOKKOS_INLINE_FUNCTION void operator()(const int index, int& update, bool final) const {
+        KOKKOS_INLINE_FUNCTION void operator()(const int index, size_t& update, bool final) const {
           // Load old value in case we update it before accumulating
             const size_t count = mytemp_strides_(index)*myvector_dim_;
             update += count;
@@ -9059,7 +10636,7 @@ public:
         finalize_stride_functor(SArray1D tempstart_index_){
           mystart_index_ = tempstart_index_;
         }
-        KOKKOS_INLINE_FUNCTION void operator()(const int index, int& update, bool final) const {
+        KOKKOS_INLINE_FUNCTION void operator()(const int index, size_t& update, bool final) const {
           // Load old value in case we update it before accumulating
             const size_t count = mystart_index_(index+1);
             update += count;
@@ -9143,7 +10720,7 @@ void RaggedRightArrayofVectorsKokkos<T,Layout,ExecSpace,MemoryTraits,ILayout>::d
     #endif
 
     #ifdef HAVE_CLASS_LAMBDA
-    Kokkos::parallel_scan("StartValuesSetup", dim1_, KOKKOS_CLASS_LAMBDA(const int i, int& update, const bool final) {
+    Kokkos::parallel_scan("StartValuesSetup", dim1_, KOKKOS_CLASS_LAMBDA(const int i, size_t& update, const bool final) {
             // Load old value in case we update it before accumulating
             const size_t count = mystrides_(i)*vector_dim_;
             update += count;
@@ -9159,7 +10736,7 @@ void RaggedRightArrayofVectorsKokkos<T,Layout,ExecSpace,MemoryTraits,ILayout>::d
 
     //compute length of the storage
     #ifdef HAVE_CLASS_LAMBDA
-    Kokkos::parallel_reduce("LengthSetup", dim1_, KOKKOS_CLASS_LAMBDA(const int i, int& update) {
+    Kokkos::parallel_reduce("LengthSetup", dim1_, KOKKOS_CLASS_LAMBDA(const int i, size_t& update) {
             // Load old value in case we update it before accumulating
             update += mystrides_(i)*vector_dim_;
         }, length_);
@@ -9194,7 +10771,7 @@ KOKKOS_INLINE_FUNCTION
 void RaggedRightArrayofVectorsKokkos<T,Layout,ExecSpace,MemoryTraits,ILayout>::stride_finalize() const {
     
     #ifdef HAVE_CLASS_LAMBDA
-    Kokkos::parallel_scan("StartValues", dim1_, KOKKOS_CLASS_LAMBDA(const int i, int& update, const bool final) {
+    Kokkos::parallel_scan("StartValues", dim1_, KOKKOS_CLASS_LAMBDA(const int i, size_t& update, const bool final) {
             // Load old value in case we update it before accumulating
             const size_t count = start_index_(i+1);
             update += count;
@@ -9373,7 +10950,7 @@ public:
           mystart_index_ = tempstart_index_;
           mytemp_strides_ = temp_strides_;
         }
-        KOKKOS_INLINE_FUNCTION void operator()(const int index, int& update, bool final) const {
+        KOKKOS_INLINE_FUNCTION void operator()(const int index, size_t& update, bool final) const {
           // Load old value in case we update it before accumulating
             const size_t count = mytemp_strides_(index);
             update += count;
@@ -9458,7 +11035,7 @@ void RaggedDownArrayKokkos<T,Layout,ExecSpace,MemoryTraits,ILayout>::data_setup(
     #endif
 
     #ifdef HAVE_CLASS_LAMBDA
-    Kokkos::parallel_scan("StartValuesSetup", dim2_, KOKKOS_CLASS_LAMBDA(const int i, int& update, const bool final) {
+    Kokkos::parallel_scan("StartValuesSetup", dim2_, KOKKOS_CLASS_LAMBDA(const int i, size_t& update, const bool final) {
             // Load old value in case we update it before accumulating
             const size_t count = mystrides_(i);
             update += count;
@@ -9474,7 +11051,7 @@ void RaggedDownArrayKokkos<T,Layout,ExecSpace,MemoryTraits,ILayout>::data_setup(
 
     //compute length of the storage
     #ifdef HAVE_CLASS_LAMBDA
-    Kokkos::parallel_reduce("LengthSetup", dim2_, KOKKOS_CLASS_LAMBDA(const int i, int& update) {
+    Kokkos::parallel_reduce("LengthSetup", dim2_, KOKKOS_CLASS_LAMBDA(const int i, size_t& update) {
             // Load old value in case we update it before accumulating
             update += mystrides_(i);
         }, length_);
@@ -9605,7 +11182,7 @@ operator= (const RaggedDownArrayKokkos<T,Layout,ExecSpace,MemoryTraits,ILayout>
     Kokkos::fence();
     */
     length_ = temp.length_;
-    array_ = temp.length_;
+    array_ = temp.array_;
     mystrides_ = temp.mystrides_;
 
     /*
@@ -9674,6 +11251,12 @@ private:
     // THIS WILL BE A GPU POINTER!
     SArray1D stride_;
     TArray1D array_;
+
+    // values pushed to full rows
+    SArray1D spill_row_;
+    TArray1D spill_array_;
+    SArray1D spill_count_;  // one entry, includes the dropped pushes
+    size_t spill_capacity_;
     
     size_t dim1_;
     size_t dim2_;
@@ -9685,8 +11268,10 @@ public:
     
     //--- 2D array access of a ragged right array ---
     
-    // overload constructor
-    DynamicRaggedRightArrayKokkos (size_t dim1, size_t dim2, const std::string& tag_string = DEFAULTSTRINGARRAY);
+    // overload constructor, rows hold up to dim2 values and spill_capacity
+    // more values are kept for rows that fill up during push
+    DynamicRaggedRightArrayKokkos (size_t dim1, size_t dim2, const std::string& tag_string = DEFAULTSTRINGARRAY,
+                                  size_t spill_capacity = 0);
     
     // A method to return or set the stride size
     KOKKOS_INLINE_FUNCTION
@@ -9736,6 +11321,24 @@ public:
     // set values to only previously non-empty indices based upon stride value
     void set_values_sparse(T val);
 
+    // Thread safe append of a value to row i, for building rows in parallel.
+    // A value that does not fit in a full row goes to the spill area, false
+    // is returned when the spill area is full too and the value is dropped
+    KOKKOS_INLINE_FUNCTION
+    bool push(size_t i, const T& value) const;
+
+    // number of values pushed to the spill area, and the number dropped
+    size_t num_spilled() const;
+
+    size_t num_dropped() const;
+
+    // empty every row and the spill area
+    void clear();
+
+    // copy the rows and the spill area to a RaggedRightArrayKokkos with the
+    // exact strides
+    RaggedRightArrayKokkos<T,Layout,ExecSpace,MemoryTraits> compact(const std::string& tag_string = DEFAULTSTRINGARRAY) const;
+
     // Destructor
     KOKKOS_INLINE_FUNCTION
     ~DynamicRaggedRightArrayKokkos ();
@@ -9745,11 +11348,13 @@ public:
 template <typename T, typename Layout, typename ExecSpace, typename MemoryTraits>
 DynamicRaggedRightArrayKokkos<T,Layout,ExecSpace,MemoryTraits>::DynamicRaggedRightArrayKokkos () {
     dim1_ = dim2_ = length_ = 0;
+    spill_capacity_ = 0;
 }
 
 // Overloaded constructor
 template <typename T, typename Layout, typename ExecSpace, typename MemoryTraits>
-DynamicRaggedRightArrayKokkos<T,Layout,ExecSpace,MemoryTraits>::DynamicRaggedRightArrayKokkos (size_t dim1, size_t dim2, const std::string& tag_string) {
+DynamicRaggedRightArrayKokkos<T,Layout,ExecSpace,MemoryTraits>::DynamicRaggedRightArrayKokkos (size_t dim1, size_t dim2, const std::string& tag_string,
+                                                                                               size_t spill_capacity) {
     // The dimensions of the array;
     dim1_  = dim1;
     dim2_  = dim2;
@@ -9773,6 +11378,12 @@ DynamicRaggedRightArrayKokkos<T,Layout,ExecSpace,MemoryTraits>::DynamicRaggedRig
 
     //allocate view
     array_ = TArray1D(tag_string, length_);
+
+    // spill area for full rows
+    spill_capacity_ = spill_capacity;
+    spill_row_ = SArray1D(tag_string + "spill_rows", spill_capacity_);
+    spill_array_ = TArray1D(tag_string + "spill", spill_capacity_);
+    spill_count_ = SArray1D(tag_string + "spill_count", 1);
 }
 
 // A method to set the stride size for row i
@@ -9816,6 +11427,10 @@ DynamicRaggedRightArrayKokkos<T,Layout,ExecSpace,MemoryTraits>&
         length_ = temp.length_;
         stride_ = temp.stride_;
         array_ = temp.array_;
+        spill_row_ = temp.spill_row_;
+        spill_array_ = temp.spill_array_;
+        spill_count_ = temp.spill_count_;
+        spill_capacity_ = temp.spill_capacity_;
         /*
         #ifdef HAVE_CLASS_LAMBDA
         Kokkos::parallel_for("StrideZeroOut", dim1_, KOKKOS_CLASS_LAMBDA(const int i) {
@@ -9865,6 +11480,105 @@ const std::string DynamicRaggedRightArrayKokkos<T,Layout,ExecSpace,MemoryTraits>
     return array_.label();
 }
 
+// Thread safe append to row i. The stride is bumped atomically and a push to
+// a full row is undone and goes to the spill area instead.
+template <typename T, typename Layout, typename ExecSpace, typename MemoryTraits>
+KOKKOS_INLINE_FUNCTION
+bool DynamicRaggedRightArrayKokkos<T,Layout,ExecSpace,MemoryTraits>::push(size_t i, const T& value) const {
+    assert(i < dim1_ && "i is out of dim1 bounds in DynamicRaggedRightArrayKokkos push");
+
+    const size_t j = Kokkos::atomic_fetch_add(&stride_(i), size_t(1));
+    if (j < dim2_) {
+        array_(j + i*dim2_) = value;
+        return true;
+    }
+
+    // the row is full, the stride settles at dim2 once every overflow is undone
+    Kokkos::atomic_fetch_sub(&stride_(i), size_t(1));
+
+    const size_t k = Kokkos::atomic_fetch_add(&spill_count_(0), size_t(1));
+    if (k < spill_capacity_) {
+        spill_row_(k) = i;
+        spill_array_(k) = value;
+        return true;
+    }
+    return false;
+}
+
+template <typename T, typename Layout, typename ExecSpace, typename MemoryTraits>
+size_t DynamicRaggedRightArrayKokkos<T,Layout,ExecSpace,MemoryTraits>::num_spilled() const {
+    if (spill_count_.size() == 0) {
+        return 0;
+    }
+    auto count = Kokkos::create_mirror_view(spill_count_);
+    Kokkos::deep_copy(count, spill_count_);
+    return count(0) < spill_capacity_ ? count(0) : spill_capacity_;
+}
+
+template <typename T, typename Layout, typename ExecSpace, typename MemoryTraits>
+size_t DynamicRaggedRightArrayKokkos<T,Layout,ExecSpace,MemoryTraits>::num_dropped() const {
+    if (spill_count_.size() == 0) {
+        return 0;
+    }
+    auto count = Kokkos::create_mirror_view(spill_count_);
+    Kokkos::deep_copy(count, spill_count_);
+    return count(0) > spill_capacity_ ? count(0) - spill_capacity_ : 0;
+}
+
+// empty every row and the spill area
+template <typename T, typename Layout, typename ExecSpace, typename MemoryTraits>
+void DynamicRaggedRightArrayKokkos<T,Layout,ExecSpace,MemoryTraits>::clear() {
+    SArray1D strides = stride_;
+    Kokkos::parallel_for("Clear_DynamicRaggedRightArrayKokkos", dim1_, KOKKOS_LAMBDA(const int i) {
+        strides(i) = 0;
+    });
+    if (spill_count_.size() > 0) {
+        Kokkos::deep_copy(spill_count_, size_t(0));
+    }
+}
+
+// tight copy, the spilled values follow the stored values of their row in
+// no particular order
+template <typename T, typename Layout, typename ExecSpace, typename MemoryTraits>
+RaggedRightArrayKokkos<T,Layout,ExecSpace,MemoryTraits>
+DynamicRaggedRightArrayKokkos<T,Layout,ExecSpace,MemoryTraits>::compact(const std::string& tag_string) const {
+    MATAR_PROFILE_SCOPE("DynamicRaggedRightArrayKokkos::compact", ProfileCategory::compute);
+
+    const size_t num_spilled = this->num_spilled();
+    const size_t dim2 = dim2_;
+    SArray1D stride = stride_;
+    TArray1D array = array_;
+    SArray1D spill_row = spill_row_;
+    TArray1D spill_array = spill_array_;
+
+    // entries per row, including the spilled ones
+    CArrayKokkos<size_t,Layout,ExecSpace,MemoryTraits> strides(dim1_, tag_string + "strides");
+    SArray1D fill = SArray1D(tag_string + "fill", dim1_);
+    Kokkos::parallel_for("CompactStrides", dim1_, KOKKOS_LAMBDA(const int i) {
+        strides(i) = stride(i);
+        fill(i) = stride(i);
+    });
+    Kokkos::parallel_for("CompactSpillStrides", num_spilled, KOKKOS_LAMBDA(const int k) {
+        Kokkos::atomic_add(&strides(spill_row(k)), size_t(1));
+    });
+
+    RaggedRightArrayKokkos<T,Layout,ExecSpace,MemoryTraits> tight(strides, tag_string);
+
+    Kokkos::parallel_for("CompactRows", dim1_, KOKKOS_LAMBDA(const int i) {
+        for (size_t j = 0; j < stride(i); j++) {
+            tight(i, j) = array(j + i*dim2);
+        }
+    });
+    Kokkos::parallel_for("CompactSpill", num_spilled, KOKKOS_LAMBDA(const int k) {
+        const size_t i = spill_row(k);
+        const size_t j = Kokkos::atomic_fetch_add(&fill(i), size_t(1));
+        tight(i, j) = spill_array(k);
+    });
+    Kokkos::fence();
+
+    return tight;
+}
+
 // Destructor
 template <typename T, typename Layout, typename ExecSpace, typename MemoryTraits>
 KOKKOS_INLINE_FUNCTION
@@ -10422,10 +12136,11 @@ size_t* CSRArrayKokkos<T, Layout, ExecSpace, MemoryTraits>::get_starts() const {
 template<typename T,typename Layout, typename ExecSpace, typename MemoryTraits>
 KOKKOS_INLINE_FUNCTION
 CSRArrayKokkos<T,Layout, ExecSpace, MemoryTraits>& CSRArrayKokkos<T, Layout, ExecSpace, MemoryTraits>::operator=(const CSRArrayKokkos<T, Layout,ExecSpace,MemoryTraits> &temp){
-    if(this != temp) {
+    if(this != &temp) {
         nnz_ = temp.nnz_;
         dim1_ = temp.dim1_;
         dim2_ = temp.dim2_;
+        miss_ = temp.miss_;
         
         start_index_ = temp.start_index_;
         column_index_ = temp.column_index_;
@@ -10447,8 +12162,8 @@ void CSRArrayKokkos<T,Layout, ExecSpace, MemoryTraits>::to_dense(CArrayKokkos<T,
 template<typename T, typename Layout, typename ExecSpace, typename MemoryTraits>
 KOKKOS_INLINE_FUNCTION
 size_t CSRArrayKokkos<T, Layout, ExecSpace, MemoryTraits>::stride(size_t i) const {
-   assert(i <= dim1_ && "Index i out of bounds in CSRArray.stride()");
-   return start_index_.data()[i+i] - start_index_.data()[i];
+   assert(i < dim1_ && "Index i out of bounds in CSRArray.stride()");
+   return start_index_.data()[i+1] - start_index_.data()[i];
 }
 
 
@@ -10759,7 +12474,7 @@ private: // What ought to be private ?
     T &get_val_flat(size_t k);
 
     KOKKOS_INLINE_FUNCTION
-    size_t get_row_flat(size_t k);
+    size_t get_row_flat(size_t k) const;
 
     // reverse map function from A(i,j) to what element of data/col_pt_ it corersponds to
     KOKKOS_INLINE_FUNCTION
@@ -10946,7 +12661,7 @@ T& CSCArrayKokkos<T,Layout, ExecSpace, MemoryTraits>::get_val_flat(size_t k){
 
 template<typename T, typename Layout, typename ExecSpace, typename MemoryTraits>
 KOKKOS_INLINE_FUNCTION
-size_t CSCArrayKokkos<T,Layout, ExecSpace, MemoryTraits>::get_row_flat(size_t k){
+size_t CSCArrayKokkos<T,Layout, ExecSpace, MemoryTraits>::get_row_flat(size_t k) const{
     return row_index_.data()[k];
 }
 
@@ -11040,7 +12755,14 @@ private:
     Strides1D mystrides_;
     typename Strides1D::t_dev mystrides_dev_;
     typename Strides1D::t_host mystrides_host_;
-    
+
+    // values pushed to full rows, on the device
+    using SArray1D = Kokkos::View<size_t *,Layout, ExecSpace, MemoryTraits>;
+    using TArray1DDev = Kokkos::View<T*, Layout, ExecSpace, MemoryTraits>;
+    SArray1D spill_row_;
+    TArray1DDev spill_array_;
+    SArray1D spill_count_;  // one entry, includes the dropped pushes
+    size_t spill_capacity_;
     
     size_t dim1_;
     size_t dim2_;
@@ -11052,8 +12774,10 @@ public:
     
     //--- 2D array access of a ragged right array ---
     
-    // overload constructor
-    DDynamicRaggedRightArrayKokkos (size_t dim1, size_t dim2, const std::string& tag_string = DEFAULTSTRINGARRAY);
+    // overload constructor, rows hold up to dim2 values and spill_capacity
+    // more values are kept for rows that fill up during push
+    DDynamicRaggedRightArrayKokkos (size_t dim1, size_t dim2, const std::string& tag_string = DEFAULTSTRINGARRAY,
+                                   size_t spill_capacity = 0);
 
     //setup start indices
     void data_setup();
@@ -11082,6 +12806,14 @@ public:
     // Method that update device view
     void update_device();
 
+    // Methods that enqueue the update on the execution space instance exec
+    // and return without fencing, fence exec or wait on an ExecEvent first
+    template <typename ExecInstance>
+    void update_host(const ExecInstance& exec);
+
+    template <typename ExecInstance>
+    void update_device(const ExecInstance& exec);
+
     // Method that update host view
     void update_strides_host();
 
@@ -11111,6 +12843,24 @@ public:
     // set values to only previously non-empty indices based upon stride value
     void set_values_sparse(T val);
 
+    // Thread safe append of a value to row i, for building rows in parallel.
+    // A value that does not fit in a full row goes to the spill area, false
+    // is returned when the spill area is full too and the value is dropped
+    KOKKOS_INLINE_FUNCTION
+    bool push(size_t i, const T& value) const;
+
+    // number of values pushed to the spill area, and the number dropped
+    size_t num_spilled() const;
+
+    size_t num_dropped() const;
+
+    // empty every row and the spill area
+    void clear();
+
+    // copy the device rows and the spill area to a RaggedRightArrayKokkos with the
+    // exact strides
+    RaggedRightArrayKokkos<T,Layout,ExecSpace,MemoryTraits> compact(const std::string& tag_string = DEFAULTSTRINGARRAY) const;
+
     // Destructor
     KOKKOS_INLINE_FUNCTION
     ~DDynamicRaggedRightArrayKokkos ();
@@ -11120,11 +12870,13 @@ public:
 template <typename T, typename Layout, typename ExecSpace, typename MemoryTraits>
 DDynamicRaggedRightArrayKokkos<T,Layout,ExecSpace,MemoryTraits>::DDynamicRaggedRightArrayKokkos () {
     dim1_ = dim2_ = length_ = 0;
+    spill_capacity_ = 0;
 }
 
 // Overloaded constructor
 template <typename T, typename Layout, typename ExecSpace, typename MemoryTraits>
-DDynamicRaggedRightArrayKokkos<T,Layout,ExecSpace,MemoryTraits>::DDynamicRaggedRightArrayKokkos (size_t dim1, size_t dim2, const std::string& tag_string) {
+DDynamicRaggedRightArrayKokkos<T,Layout,ExecSpace,MemoryTraits>::DDynamicRaggedRightArrayKokkos (size_t dim1, size_t dim2, const std::string& tag_string,
+                                                                                                 size_t spill_capacity) {
     // The dimensions of the array;
     dim1_  = dim1;
     dim2_  = dim2;
@@ -11144,6 +12896,12 @@ DDynamicRaggedRightArrayKokkos<T,Layout,ExecSpace,MemoryTraits>::DDynamicRaggedR
     array_ = TArray1D(tag_string, length_);
     array_host_ = array_.view_host();
     array_dev_ = array_.view_device();
+
+    // spill area for full rows
+    spill_capacity_ = spill_capacity;
+    spill_row_ = SArray1D(tag_string + "_spill_rows", spill_capacity_);
+    spill_array_ = TArray1DDev(tag_string + "_spill", spill_capacity_);
+    spill_count_ = SArray1D(tag_string + "_spill_count", 1);
 }
 
 //setup start indices
@@ -11236,6 +12994,10 @@ DDynamicRaggedRightArrayKokkos<T,Layout,ExecSpace,MemoryTraits>&
         array_ = temp.array_;
         array_dev_ = temp.array_dev_;
         array_host_ = temp.array_host_;
+        spill_row_ = temp.spill_row_;
+        spill_array_ = temp.spill_array_;
+        spill_count_ = temp.spill_count_;
+        spill_capacity_ = temp.spill_capacity_;
         /*
         #ifdef HAVE_CLASS_LAMBDA
         Kokkos::parallel_for("StrideZeroOut", dim1_, KOKKOS_CLASS_LAMBDA(const int i) {
@@ -11268,6 +13030,8 @@ void DDynamicRaggedRightArrayKokkos<T,Layout,ExecSpace,MemoryTraits>::set_values
 
 template <typename T, typename Layout, typename ExecSpace, typename MemoryTraits>
 void DDynamicRaggedRightArrayKokkos<T,Layout,ExecSpace,MemoryTraits>::update_host() {
+    MATAR_PROFILE_SCOPE("DDynamicRaggedRightArrayKokkos::update_host", ProfileCategory::transfer);
+    TransferLog::instance().record(array_.view_host(), true, array_.view_host().size() * sizeof(T));
 
     array_.template modify<typename TArray1D::execution_space>();
     array_.template sync<typename TArray1D::host_mirror_space>();
@@ -11275,11 +13039,25 @@ void DDynamicRaggedRightArrayKokkos<T,Layout,ExecSpace,MemoryTraits>::update_hos
 
 template <typename T, typename Layout, typename ExecSpace, typename MemoryTraits>
 void DDynamicRaggedRightArrayKokkos<T,Layout,ExecSpace,MemoryTraits>::update_device() {
+    MATAR_PROFILE_SCOPE("DDynamicRaggedRightArrayKokkos::update_device", ProfileCategory::transfer);
+    TransferLog::instance().record(array_.view_host(), false, array_.view_host().size() * sizeof(T));
 
     array_.template modify<typename TArray1D::host_mirror_space>();
     array_.template sync<typename TArray1D::execution_space>();
 }
 
+template <typename T, typename Layout, typename ExecSpace, typename MemoryTraits>
+template <typename ExecInstance>
+void DDynamicRaggedRightArrayKokkos<T,Layout,ExecSpace,MemoryTraits>::update_host(const ExecInstance& exec) {
+    dual_view_update(array_, DualModifiedRangeView(), true, &exec);
+}
+
+template <typename T, typename Layout, typename ExecSpace, typename MemoryTraits>
+template <typename ExecInstance>
+void DDynamicRaggedRightArrayKokkos<T,Layout,ExecSpace,MemoryTraits>::update_device(const ExecInstance& exec) {
+    dual_view_update(array_, DualModifiedRangeView(), false, &exec);
+}
+
 template <typename T, typename Layout, typename ExecSpace, typename MemoryTraits>
 void DDynamicRaggedRightArrayKokkos<T,Layout,ExecSpace,MemoryTraits>::update_strides_host() {
 
@@ -11313,6 +13091,106 @@ const std::string DDynamicRaggedRightArrayKokkos<T,Layout,ExecSpace,MemoryTraits
     return array_.view_host().label();
 }
 
+// Thread safe append to row i. The stride is bumped atomically and a push to
+// a full row is undone and goes to the spill area instead.
+template <typename T, typename Layout, typename ExecSpace, typename MemoryTraits>
+KOKKOS_INLINE_FUNCTION
+bool DDynamicRaggedRightArrayKokkos<T,Layout,ExecSpace,MemoryTraits>::push(size_t i, const T& value) const {
+    assert(i < dim1_ && "i is out of dim1 bounds in DDynamicRaggedRightArrayKokkos push");
+
+    const size_t j = Kokkos::atomic_fetch_add(&mystrides_dev_(i), size_t(1));
+    if (j < dim2_) {
+        array_dev_(j + i*dim2_) = value;
+        return true;
+    }
+
+    // the row is full, the stride settles at dim2 once every overflow is undone
+    Kokkos::atomic_fetch_sub(&mystrides_dev_(i), size_t(1));
+
+    const size_t k = Kokkos::atomic_fetch_add(&spill_count_(0), size_t(1));
+    if (k < spill_capacity_) {
+        spill_row_(k) = i;
+        spill_array_(k) = value;
+        return true;
+    }
+    return false;
+}
+
+template <typename T, typename Layout, typename ExecSpace, typename MemoryTraits>
+size_t DDynamicRaggedRightArrayKokkos<T,Layout,ExecSpace,MemoryTraits>::num_spilled() const {
+    if (spill_count_.size() == 0) {
+        return 0;
+    }
+    auto count = Kokkos::create_mirror_view(spill_count_);
+    Kokkos::deep_copy(count, spill_count_);
+    return count(0) < spill_capacity_ ? count(0) : spill_capacity_;
+}
+
+template <typename T, typename Layout, typename ExecSpace, typename MemoryTraits>
+size_t DDynamicRaggedRightArrayKokkos<T,Layout,ExecSpace,MemoryTraits>::num_dropped() const {
+    if (spill_count_.size() == 0) {
+        return 0;
+    }
+    auto count = Kokkos::create_mirror_view(spill_count_);
+    Kokkos::deep_copy(count, spill_count_);
+    return count(0) > spill_capacity_ ? count(0) - spill_capacity_ : 0;
+}
+
+// empty every row and the spill area
+template <typename T, typename Layout, typename ExecSpace, typename MemoryTraits>
+void DDynamicRaggedRightArrayKokkos<T,Layout,ExecSpace,MemoryTraits>::clear() {
+    typename Strides1D::t_dev strides = mystrides_dev_;
+    Kokkos::parallel_for("Clear_DDynamicRaggedRightArrayKokkos", dim1_, KOKKOS_LAMBDA(const int i) {
+        strides(i) = 0;
+    });
+    mystrides_.template modify<typename Strides1D::execution_space>();
+    if (spill_count_.size() > 0) {
+        Kokkos::deep_copy(spill_count_, size_t(0));
+    }
+}
+
+// tight copy, the spilled values follow the stored values of their row in
+// no particular order
+template <typename T, typename Layout, typename ExecSpace, typename MemoryTraits>
+RaggedRightArrayKokkos<T,Layout,ExecSpace,MemoryTraits>
+DDynamicRaggedRightArrayKokkos<T,Layout,ExecSpace,MemoryTraits>::compact(const std::string& tag_string) const {
+    MATAR_PROFILE_SCOPE("DDynamicRaggedRightArrayKokkos::compact", ProfileCategory::compute);
+
+    const size_t num_spilled = this->num_spilled();
+    const size_t dim2 = dim2_;
+    typename Strides1D::t_dev stride = mystrides_dev_;
+    TArray1DDev array = array_dev_;
+    SArray1D spill_row = spill_row_;
+    TArray1DDev spill_array = spill_array_;
+
+    // entries per row, including the spilled ones
+    CArrayKokkos<size_t,Layout,ExecSpace,MemoryTraits> strides(dim1_, tag_string + "_strides");
+    SArray1D fill = SArray1D(tag_string + "_fill", dim1_);
+    Kokkos::parallel_for("CompactStrides", dim1_, KOKKOS_LAMBDA(const int i) {
+        strides(i) = stride(i);
+        fill(i) = stride(i);
+    });
+    Kokkos::parallel_for("CompactSpillStrides", num_spilled, KOKKOS_LAMBDA(const int k) {
+        Kokkos::atomic_add(&strides(spill_row(k)), size_t(1));
+    });
+
+    RaggedRightArrayKokkos<T,Layout,ExecSpace,MemoryTraits> tight(strides, tag_string);
+
+    Kokkos::parallel_for("CompactRows", dim1_, KOKKOS_LAMBDA(const int i) {
+        for (size_t j = 0; j < stride(i); j++) {
+            tight(i, j) = array(j + i*dim2);
+        }
+    });
+    Kokkos::parallel_for("CompactSpill", num_spilled, KOKKOS_LAMBDA(const int k) {
+        const size_t i = spill_row(k);
+        const size_t j = Kokkos::atomic_fetch_add(&fill(i), size_t(1));
+        tight(i, j) = spill_array(k);
+    });
+    Kokkos::fence();
+
+    return tight;
+}
+
 // Destructor
 template <typename T, typename Layout, typename ExecSpace, typename MemoryTraits>
 KOKKOS_INLINE_FUNCTION
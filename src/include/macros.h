@@ -88,6 +88,10 @@
 
 #include <stdio.h>
 #include <iostream>
+#include <climits>
+#include <cstdint>
+
+#include "profile.h"
 
 
 // -----------------------------------------
@@ -103,6 +107,37 @@
 #define \
     GET_MACRO(_1, _2, _3, _4, _5, _6, _7, _8, _9, _10, _11, _12, _13, NAME,...) NAME
 
+// Index type of the 1D loops. The loops use an int index, which is the fast
+// path on GPUs. Defining MATAR_INDEX_64 adds a run time check on the range of
+// each 1D loop, a loop with bounds that do not fit in an int runs with an
+// int64_t index instead, so arrays with more than 2^31 entries can be looped
+// over. Both versions of the loop body are compiled in that case. The 2D and
+// 3D loops keep int indices, MATAR types compute the flat offset in size_t.
+template <typename B0, typename B1>
+inline bool matar_index_fits_int(const B0 x0, const B1 x1) {
+    return static_cast<long long>(x0) >= INT_MIN && static_cast<long long>(x1) < INT_MAX;
+}
+
+#ifdef MATAR_INDEX_64
+#define \
+    MATAR_INDEX_SELECT(x0, x1, LOOP, ...) \
+    do { \
+        if (matar_index_fits_int((x0), (x1))) { LOOP(int, __VA_ARGS__); } \
+        else { LOOP(int64_t, __VA_ARGS__); } \
+    } while (0)
+#else
+#define \
+    MATAR_INDEX_SELECT(x0, x1, LOOP, ...) \
+    LOOP(int, __VA_ARGS__)
+#endif
+
+// the index type is only set explicitly by the loop macros, direct calls
+// to the serial loop functions keep using int
+template <typename I>
+struct matar_index_identity {
+    using type = I;
+};
+
 
 // -----------------------------------------
 // MACROS for kokkos
@@ -132,9 +167,13 @@
 
 // the FOR_ALL loop
 #define \
-    FOR1D(i, x0, x1,fcn) \
-    Kokkos::parallel_for( Kokkos::RangePolicy<> ( (x0), (x1)), \
-                          KOKKOS_LAMBDA( const int (i) ){fcn} )
+    FOR1D_IDX(IT, i, x0, x1, fcn) \
+    Kokkos::parallel_for( Kokkos::RangePolicy< Kokkos::IndexType<IT> > ( (x0), (x1)), \
+                          KOKKOS_LAMBDA( const IT (i) ){fcn} )
+
+#define \
+    FOR1D(i, x0, x1, fcn) \
+    MATAR_INDEX_SELECT((x0), (x1), FOR1D_IDX, i, x0, x1, fcn)
 
 #define \
     FOR2D(i, x0, x1, j, y0, y1,fcn) \
@@ -150,14 +189,19 @@
 
 #define \
     FOR_ALL(...) \
-    EXPAND(GET_MACRO(__VA_ARGS__, _13, _12, _11, FOR3D, _9, _8, FOR2D, _6, _5, FOR1D)(__VA_ARGS__))
+    MATAR_PROFILE_LOOP(MATAR_PROFILE_LOOP_NAME("FOR_ALL"), \
+        EXPAND(GET_MACRO(__VA_ARGS__, _13, _12, _11, FOR3D, _9, _8, FOR2D, _6, _5, FOR1D)(__VA_ARGS__)))
 
 
 // the DO_ALL loop
 #define \
-    DO1D(i, x0, x1,fcn) \
-    Kokkos::parallel_for( Kokkos::RangePolicy<> ( (x0), (x1)+1), \
-                          KOKKOS_LAMBDA( const int (i) ){fcn} )
+    DO1D_IDX(IT, i, x0, x1, fcn) \
+    Kokkos::parallel_for( Kokkos::RangePolicy< Kokkos::IndexType<IT> > ( (x0), (x1)+1), \
+                          KOKKOS_LAMBDA( const IT (i) ){fcn} )
+
+#define \
+    DO1D(i, x0, x1, fcn) \
+    MATAR_INDEX_SELECT((x0), (x1), DO1D_IDX, i, x0, x1, fcn)
 
 #define \
     DO2D(i, x0, x1, j, y0, y1,fcn) \
@@ -173,14 +217,19 @@
 
 #define \
     DO_ALL(...) \
-    EXPAND(GET_MACRO(__VA_ARGS__, _13, _12, _11, DO3D, _9, _8, DO2D, _6, _5, DO1D)(__VA_ARGS__))
+    MATAR_PROFILE_LOOP(MATAR_PROFILE_LOOP_NAME("DO_ALL"), \
+        EXPAND(GET_MACRO(__VA_ARGS__, _13, _12, _11, DO3D, _9, _8, DO2D, _6, _5, DO1D)(__VA_ARGS__)))
 
 
 // the REDUCE SUM loop
+#define \
+    RSUM1D_IDX(IT, i, x0, x1, var, fcn, result) \
+    Kokkos::parallel_reduce( Kokkos::RangePolicy< Kokkos::IndexType<IT> > ( (x0), (x1) ),  \
+                             KOKKOS_LAMBDA(const IT (i), decltype(var) &(var)){fcn}, (result))
+
 #define \
     RSUM1D(i, x0, x1, var, fcn, result) \
-    Kokkos::parallel_reduce( Kokkos::RangePolicy<> ( (x0), (x1) ),  \
-                             KOKKOS_LAMBDA(const int (i), decltype(var) &(var)){fcn}, (result))
+    MATAR_INDEX_SELECT((x0), (x1), RSUM1D_IDX, i, x0, x1, var, fcn, result)
 
 #define \
     RSUM2D(i, x0, x1, j, y0, y1, var, fcn, result) \
@@ -198,19 +247,24 @@
 
 #define \
     FOR_REDUCE_SUM(...) \
-    EXPAND(GET_MACRO(__VA_ARGS__, _13, RSUM3D, _11, _10, RSUM2D, _8, _7, RSUM1D)(__VA_ARGS__))
+    MATAR_PROFILE_LOOP(MATAR_PROFILE_LOOP_NAME("FOR_REDUCE_SUM"), \
+        EXPAND(GET_MACRO(__VA_ARGS__, _13, RSUM3D, _11, _10, RSUM2D, _8, _7, RSUM1D)(__VA_ARGS__)))
 
 
 // the REDUCE Product loop
 
 
 #define \
-    RPROD1D(i, x0, x1, var, fcn, result) \
+    RPROD1D_IDX(IT, i, x0, x1, var, fcn, result) \
     Kokkos::parallel_reduce( \
-                        Kokkos::RangePolicy<> ( (x0), (x1) ),  \
-                        KOKKOS_LAMBDA(const int (i), decltype(var) &(var)){fcn}, \
+                        Kokkos::RangePolicy< Kokkos::IndexType<IT> > ( (x0), (x1) ),  \
+                        KOKKOS_LAMBDA(const IT (i), decltype(var) &(var)){fcn}, \
                         Kokkos::Prod< decltype(result) > ( (result) ) )
 
+#define \
+    RPROD1D(i, x0, x1, var, fcn, result) \
+    MATAR_INDEX_SELECT((x0), (x1), RPROD1D_IDX, i, x0, x1, var, fcn, result)
+
 #define \
     RPROD2D(i, x0, x1, j, y0, y1, var, fcn, result) \
     Kokkos::parallel_reduce( \
@@ -227,14 +281,19 @@
 
 #define \
     FOR_REDUCE_PRODUCT(...) \
-    EXPAND(GET_MACRO(__VA_ARGS__, _13, RPROD3D, _11, _10, RPROD2D, _8, _7, RPROD1D)(__VA_ARGS__))
+    MATAR_PROFILE_LOOP(MATAR_PROFILE_LOOP_NAME("FOR_REDUCE_PRODUCT"), \
+        EXPAND(GET_MACRO(__VA_ARGS__, _13, RPROD3D, _11, _10, RPROD2D, _8, _7, RPROD1D)(__VA_ARGS__)))
 
 
 // the DO_REDUCE_SUM loop
+#define \
+    DO_RSUM1D_IDX(IT, i, x0, x1, var, fcn, result) \
+    Kokkos::parallel_reduce( Kokkos::RangePolicy< Kokkos::IndexType<IT> > ( (x0), (x1)+1 ),  \
+                             KOKKOS_LAMBDA(const IT (i), decltype(var) &(var)){fcn}, (result))
+
 #define \
     DO_RSUM1D(i, x0, x1, var, fcn, result) \
-    Kokkos::parallel_reduce( Kokkos::RangePolicy<> ( (x0), (x1)+1 ),  \
-                             KOKKOS_LAMBDA(const int (i), decltype(var) &(var)){fcn}, (result))
+    MATAR_INDEX_SELECT((x0), (x1), DO_RSUM1D_IDX, i, x0, x1, var, fcn, result)
 
 #define \
     DO_RSUM2D(i, x0, x1, j, y0, y1, var, fcn, result) \
@@ -252,17 +311,22 @@
 
 #define \
     DO_REDUCE_SUM(...) \
-    EXPAND(GET_MACRO(__VA_ARGS__, _13, DO_RSUM3D, _11, _10, DO_RSUM2D, _8, _7, DO_RSUM1D)(__VA_ARGS__))
+    MATAR_PROFILE_LOOP(MATAR_PROFILE_LOOP_NAME("DO_REDUCE_SUM"), \
+        EXPAND(GET_MACRO(__VA_ARGS__, _13, DO_RSUM3D, _11, _10, DO_RSUM2D, _8, _7, DO_RSUM1D)(__VA_ARGS__)))
 
 
 // the REDUCE MAX loop
 #define \
-    RMAX1D(i, x0, x1, var, fcn, result) \
+    RMAX1D_IDX(IT, i, x0, x1, var, fcn, result) \
     Kokkos::parallel_reduce( \
-                        Kokkos::RangePolicy<> ( (x0), (x1) ),  \
-                        KOKKOS_LAMBDA(const int (i), decltype(var) &(var)){fcn}, \
+                        Kokkos::RangePolicy< Kokkos::IndexType<IT> > ( (x0), (x1) ),  \
+                        KOKKOS_LAMBDA(const IT (i), decltype(var) &(var)){fcn}, \
                         Kokkos::Max< decltype(result) > ( (result) ) )
 
+#define \
+    RMAX1D(i, x0, x1, var, fcn, result) \
+    MATAR_INDEX_SELECT((x0), (x1), RMAX1D_IDX, i, x0, x1, var, fcn, result)
+
 #define \
     RMAX2D(i, x0, x1, j, y0, y1, var, fcn, result) \
     Kokkos::parallel_reduce( \
@@ -279,17 +343,22 @@
 
 #define \
     FOR_REDUCE_MAX(...) \
-    EXPAND(GET_MACRO(__VA_ARGS__, _13, RMAX3D, _11, _10, RMAX2D, _8, _7, RMAX1D)(__VA_ARGS__))
+    MATAR_PROFILE_LOOP(MATAR_PROFILE_LOOP_NAME("FOR_REDUCE_MAX"), \
+        EXPAND(GET_MACRO(__VA_ARGS__, _13, RMAX3D, _11, _10, RMAX2D, _8, _7, RMAX1D)(__VA_ARGS__)))
 
 
 // the DO_REDUCE_MAX loop
 #define \
-    DO_RMAX1D(i, x0, x1, var, fcn, result) \
+    DO_RMAX1D_IDX(IT, i, x0, x1, var, fcn, result) \
     Kokkos::parallel_reduce( \
-                        Kokkos::RangePolicy<> ( (x0), (x1)+1 ),  \
-                        KOKKOS_LAMBDA(const int (i), decltype(var) &(var)){fcn}, \
+                        Kokkos::RangePolicy< Kokkos::IndexType<IT> > ( (x0), (x1)+1 ),  \
+                        KOKKOS_LAMBDA(const IT (i), decltype(var) &(var)){fcn}, \
                         Kokkos::Max< decltype(result) > ( (result) ) )
 
+#define \
+    DO_RMAX1D(i, x0, x1, var, fcn, result) \
+    MATAR_INDEX_SELECT((x0), (x1), DO_RMAX1D_IDX, i, x0, x1, var, fcn, result)
+
 #define \
     DO_RMAX2D(i, x0, x1, j, y0, y1, var, fcn, result) \
     Kokkos::parallel_reduce( \
@@ -318,18 +387,23 @@
 
 #define \
     DO_REDUCE_MAX(...) \
-    EXPAND(GET_MACRO(__VA_ARGS__, _13, DO_RMAX3D, _11, _10, DO_RMAX2D, _8, _7, DO_RMAX1D)(__VA_ARGS__))
+    MATAR_PROFILE_LOOP(MATAR_PROFILE_LOOP_NAME("DO_REDUCE_MAX"), \
+        EXPAND(GET_MACRO(__VA_ARGS__, _13, DO_RMAX3D, _11, _10, DO_RMAX2D, _8, _7, DO_RMAX1D)(__VA_ARGS__)))
 
 
 
 // the REDUCE MIN loop
 #define \
-    RMIN1D(i, x0, x1, var, fcn, result) \
+    RMIN1D_IDX(IT, i, x0, x1, var, fcn, result) \
     Kokkos::parallel_reduce( \
-                        Kokkos::RangePolicy<> ( (x0), (x1) ),  \
-                        KOKKOS_LAMBDA( const int (i), decltype(var) &(var) ){fcn}, \
+                        Kokkos::RangePolicy< Kokkos::IndexType<IT> > ( (x0), (x1) ),  \
+                        KOKKOS_LAMBDA( const IT (i), decltype(var) &(var) ){fcn}, \
                         Kokkos::Min< decltype(result) >(result))
 
+#define \
+    RMIN1D(i, x0, x1, var, fcn, result) \
+    MATAR_INDEX_SELECT((x0), (x1), RMIN1D_IDX, i, x0, x1, var, fcn, result)
+
 #define \
     RMIN2D(i, x0, x1, j, y0, y1, var, fcn, result) \
     Kokkos::parallel_reduce( \
@@ -358,17 +432,22 @@
 
 #define \
     FOR_REDUCE_MIN(...) \
-    EXPAND(GET_MACRO(__VA_ARGS__, _13, RMIN3D, _11, _10, RMIN2D, _8, _7, RMIN1D)(__VA_ARGS__))
+    MATAR_PROFILE_LOOP(MATAR_PROFILE_LOOP_NAME("FOR_REDUCE_MIN"), \
+        EXPAND(GET_MACRO(__VA_ARGS__, _13, RMIN3D, _11, _10, RMIN2D, _8, _7, RMIN1D)(__VA_ARGS__)))
 
 
 // the DO_REDUCE MIN loop
 #define \
-    DO_RMIN1D(i, x0, x1, var, fcn, result) \
+    DO_RMIN1D_IDX(IT, i, x0, x1, var, fcn, result) \
     Kokkos::parallel_reduce( \
-                        Kokkos::RangePolicy<> ( (x0), (x1)+1 ),  \
-                        KOKKOS_LAMBDA( const int (i), decltype(var) &(var) ){fcn}, \
+                        Kokkos::RangePolicy< Kokkos::IndexType<IT> > ( (x0), (x1)+1 ),  \
+                        KOKKOS_LAMBDA( const IT (i), decltype(var) &(var) ){fcn}, \
                         Kokkos::Min< decltype(result) >(result))
 
+#define \
+    DO_RMIN1D(i, x0, x1, var, fcn, result) \
+    MATAR_INDEX_SELECT((x0), (x1), DO_RMIN1D_IDX, i, x0, x1, var, fcn, result)
+
 #define \
     DO_RMIN2D(i, x0, x1, j, y0, y1, var, fcn, result) \
     Kokkos::parallel_reduce( \
@@ -385,15 +464,20 @@
 
 #define \
     DO_REDUCE_MIN(...) \
-    EXPAND(GET_MACRO(__VA_ARGS__, _13, DO_RMIN3D, _11, _10, DO_RMIN2D, _8, _7, DO_RMIN1D)(__VA_ARGS__))
+    MATAR_PROFILE_LOOP(MATAR_PROFILE_LOOP_NAME("DO_REDUCE_MIN"), \
+        EXPAND(GET_MACRO(__VA_ARGS__, _13, DO_RMIN3D, _11, _10, DO_RMIN2D, _8, _7, DO_RMIN1D)(__VA_ARGS__)))
 
 
 
 // the FOR_ALL loop with variables in a class
 #define \
-FORCLASS1D(i, x0, x1,fcn) \
-Kokkos::parallel_for( Kokkos::RangePolicy<> ( (x0), (x1)), \
-                     KOKKOS_CLASS_LAMBDA( const int (i) ){fcn} )
+FORCLASS1D_IDX(IT, i, x0, x1, fcn) \
+Kokkos::parallel_for( Kokkos::RangePolicy< Kokkos::IndexType<IT> > ( (x0), (x1)), \
+                     KOKKOS_CLASS_LAMBDA( const IT (i) ){fcn} )
+
+#define \
+FORCLASS1D(i, x0, x1, fcn) \
+MATAR_INDEX_SELECT((x0), (x1), FORCLASS1D_IDX, i, x0, x1, fcn)
 
 #define \
 FORCLASS2D(i, x0, x1, j, y0, y1,fcn) \
@@ -409,14 +493,19 @@ Kokkos::parallel_for( \
 
 #define \
 FOR_ALL_CLASS(...) \
-EXPAND(GET_MACRO(__VA_ARGS__, _13, _12, _11, FORCLASS3D, _9, _8, FORCLASS2D, _6, _5, FORCLASS1D)(__VA_ARGS__))
+MATAR_PROFILE_LOOP(MATAR_PROFILE_LOOP_NAME("FOR_ALL_CLASS"), \
+    EXPAND(GET_MACRO(__VA_ARGS__, _13, _12, _11, FORCLASS3D, _9, _8, FORCLASS2D, _6, _5, FORCLASS1D)(__VA_ARGS__)))
 
 
 // the REDUCE SUM loop
+#define \
+RSUMCLASS1D_IDX(IT, i, x0, x1, var, fcn, result) \
+Kokkos::parallel_reduce( Kokkos::RangePolicy< Kokkos::IndexType<IT> > ( (x0), (x1) ),  \
+                        KOKKOS_CLASS_LAMBDA(const IT (i), decltype(var) &(var)){fcn}, (result))
+
 #define \
 RSUMCLASS1D(i, x0, x1, var, fcn, result) \
-Kokkos::parallel_reduce( Kokkos::RangePolicy<> ( (x0), (x1) ),  \
-                        KOKKOS_CLASS_LAMBDA(const int (i), decltype(var) &(var)){fcn}, (result))
+MATAR_INDEX_SELECT((x0), (x1), RSUMCLASS1D_IDX, i, x0, x1, var, fcn, result)
 
 #define \
 RSUMCLASS2D(i, x0, x1, j, y0, y1, var, fcn, result) \
@@ -434,19 +523,24 @@ Kokkos::parallel_reduce( \
 
 #define \
 FOR_REDUCE_SUM_CLASS(...) \
-EXPAND(GET_MACRO(__VA_ARGS__, _13, RSUMCLASS3D, _11, _10, RSUMCLASS2D, _8, _7, RSUMCLASS1D)(__VA_ARGS__))
+MATAR_PROFILE_LOOP(MATAR_PROFILE_LOOP_NAME("FOR_REDUCE_SUM_CLASS"), \
+    EXPAND(GET_MACRO(__VA_ARGS__, _13, RSUMCLASS3D, _11, _10, RSUMCLASS2D, _8, _7, RSUMCLASS1D)(__VA_ARGS__)))
 
 
 
 // the REDUCE MAX loop with variables in a class
 
 #define \
-RMAXCLASS1D(i, x0, x1, var, fcn, result) \
+RMAXCLASS1D_IDX(IT, i, x0, x1, var, fcn, result) \
 Kokkos::parallel_reduce( \
-                        Kokkos::RangePolicy<> ( (x0), (x1) ),  \
-                        KOKKOS_CLASS_LAMBDA(const int (i), decltype(var) &(var)){fcn}, \
+                        Kokkos::RangePolicy< Kokkos::IndexType<IT> > ( (x0), (x1) ),  \
+                        KOKKOS_CLASS_LAMBDA(const IT (i), decltype(var) &(var)){fcn}, \
                         Kokkos::Max< decltype(result) > ( (result) ) )
 
+#define \
+RMAXCLASS1D(i, x0, x1, var, fcn, result) \
+MATAR_INDEX_SELECT((x0), (x1), RMAXCLASS1D_IDX, i, x0, x1, var, fcn, result)
+
 #define \
 RMAXCLASS2D(i, x0, x1, j, y0, y1, var, fcn, result) \
 Kokkos::parallel_reduce( \
@@ -463,17 +557,22 @@ Kokkos::parallel_reduce( \
 
 #define \
 FOR_REDUCE_MAX_CLASS(...) \
-EXPAND(GET_MACRO(__VA_ARGS__, _13, RMAXCLASS3D, _11, _10, RMAXCLASS2D, _8, _7, RMAXCLASS1D)(__VA_ARGS__))
+MATAR_PROFILE_LOOP(MATAR_PROFILE_LOOP_NAME("FOR_REDUCE_MAX_CLASS"), \
+    EXPAND(GET_MACRO(__VA_ARGS__, _13, RMAXCLASS3D, _11, _10, RMAXCLASS2D, _8, _7, RMAXCLASS1D)(__VA_ARGS__)))
 
 
 // the REDUCE MIN loop with variables in a class
 #define \
-RMINCLASS1D(i, x0, x1, var, fcn, result) \
+RMINCLASS1D_IDX(IT, i, x0, x1, var, fcn, result) \
 Kokkos::parallel_reduce( \
-                        Kokkos::RangePolicy<> ( (x0), (x1) ),  \
-                        KOKKOS_CLASS_LAMBDA( const int (i), decltype(var) &(var) ){fcn}, \
+                        Kokkos::RangePolicy< Kokkos::IndexType<IT> > ( (x0), (x1) ),  \
+                        KOKKOS_CLASS_LAMBDA( const IT (i), decltype(var) &(var) ){fcn}, \
                         Kokkos::Min< decltype(result) >(result))
 
+#define \
+RMINCLASS1D(i, x0, x1, var, fcn, result) \
+MATAR_INDEX_SELECT((x0), (x1), RMINCLASS1D_IDX, i, x0, x1, var, fcn, result)
+
 #define \
 RMINCLASS2D(i, x0, x1, j, y0, y1, var, fcn, result) \
 Kokkos::parallel_reduce( \
@@ -490,7 +589,8 @@ Kokkos::parallel_reduce( \
 
 #define \
 FOR_REDUCE_MIN_CLASS(...) \
-EXPAND(GET_MACRO(__VA_ARGS__, _13, RMINCLASS3D, _11, _10, RMINCLASS2D, _8, _7, RMINCLASS1D)(__VA_ARGS__))
+MATAR_PROFILE_LOOP(MATAR_PROFILE_LOOP_NAME("FOR_REDUCE_MIN_CLASS"), \
+    EXPAND(GET_MACRO(__VA_ARGS__, _13, RMINCLASS3D, _11, _10, RMINCLASS2D, _8, _7, RMINCLASS1D)(__VA_ARGS__)))
 
 #define \
 TEAM_ID \
@@ -562,6 +662,21 @@ Kokkos::parallel_reduce( \
                         Kokkos::ThreadVectorRange( teamMember, (z0), (z1)+1 ), [&] ( const int (k), decltype(lsum) &(lsum) ) \
                         {fcn}, (result) )
 
+// SIMD blocked loop over the range [x0, x1) in packs of width entries. The
+// body runs once per pack s and gets the lanes [a0, a1) of that pack that
+// lie in the range, entry s*width + a. Full packs have a0 = 0 and a1 = width,
+// only the first and last pack can be partial. Meant for CArrayVec, the body
+// loops over the contiguous lanes of pack(s, d) so the compiler vectorizes it.
+#define \
+FOR_ALL_SIMD(s, a0, a1, x0, x1, width, fcn) \
+MATAR_PROFILE_LOOP(MATAR_PROFILE_LOOP_NAME("FOR_ALL_SIMD"), \
+Kokkos::parallel_for( \
+                        Kokkos::RangePolicy<> ( (x0)/(width), ((x1)+(width)-1)/(width) ), \
+                        KOKKOS_LAMBDA ( const int s ) \
+                        { const int a0 = (s*(width) < (x0)) ? (x0) - s*(width) : 0; \
+                          const int a1 = (s*(width) + (width) > (x1)) ? (x1) - s*(width) : (width); \
+                          {fcn} } ))
+
 //Kokkos Initialize
 #define \
     MATAR_KOKKOS_INIT \
@@ -585,11 +700,12 @@ Kokkos::parallel_reduce( \
 // with the non-kokkos MACROS
 // -----------------------------------------
 
-template <typename F>
-void for_all (int i_start, int i_end,
+template <typename I = int, typename F>
+void for_all (typename matar_index_identity<I>::type i_start,
+              typename matar_index_identity<I>::type i_end,
               const F &lambda_fcn){
     
-    for (int i=i_start; i<i_end; i++){
+    for (I i=i_start; i<i_end; i++){
         lambda_fcn(i);
     }
     
@@ -758,12 +874,13 @@ void for_all_delta (int i_start, int i_end, int i_delta,
 #include <limits>  // for the max and min values of a int, double, etc.
 
 // SUM
-template <typename T, typename F>
-void reduce_sum (int i_start, int i_end,
+template <typename I = int, typename T, typename F>
+void reduce_sum (typename matar_index_identity<I>::type i_start,
+                 typename matar_index_identity<I>::type i_end,
                  T var,
                  const F &lambda_fcn, T &result){
     var = 0;
-    for (int i=i_start; i<i_end; i++){
+    for (I i=i_start; i<i_end; i++){
         lambda_fcn(i, var);
     }
     result = var;
@@ -806,12 +923,13 @@ void reduce_sum (int i_start, int i_end,
 
 
 // MIN
-template <typename T, typename F>
-void reduce_min (int i_start, int i_end,
+template <typename I = int, typename T, typename F>
+void reduce_min (typename matar_index_identity<I>::type i_start,
+                 typename matar_index_identity<I>::type i_end,
                  T var,
                  const F &lambda_fcn, T &result){
     var = std::numeric_limits<T>::max(); //2147483647;
-    for (int i=i_start; i<i_end; i++){
+    for (I i=i_start; i<i_end; i++){
         lambda_fcn(i, var);
     }
     result = var;
@@ -853,12 +971,13 @@ void reduce_min (int i_start, int i_end,
 };  // end for_reduce
 
 // MAX
-template <typename T, typename F>
-void reduce_max (int i_start, int i_end,
+template <typename I = int, typename T, typename F>
+void reduce_max (typename matar_index_identity<I>::type i_start,
+                 typename matar_index_identity<I>::type i_end,
                  T var,
                  const F &lambda_fcn, T &result){
     var = std::numeric_limits<T>::min(); // -2147483647 - 1;
-    for (int i=i_start; i<i_end; i++){
+    for (I i=i_start; i<i_end; i++){
         lambda_fcn(i, var);
     }
     result = var;
@@ -903,12 +1022,13 @@ void reduce_max (int i_start, int i_end,
 
 
 // MIN
-template <typename T, typename F>
-void reduce_prod (int i_start, int i_end,
+template <typename I = int, typename T, typename F>
+void reduce_prod (typename matar_index_identity<I>::type i_start,
+                  typename matar_index_identity<I>::type i_end,
                   T var,
                  const F &lambda_fcn, T &result){
     var = 1.0;
-    for (int i=i_start; i<i_end; i++){
+    for (I i=i_start; i<i_end; i++){
         lambda_fcn(i, var);
     }
     result = var;
@@ -935,10 +1055,14 @@ void reduce_prod (int i_start, int i_end,
 
 // the FOR_ALL loop
 // 1D FOR loop has 4 inputs
+#define \
+    FOR1D_IDX(IT, i, x0, x1, fcn) \
+    for_all<IT>( (x0), (x1), \
+             [&]( const IT (i) ){fcn} )
+
 #define \
     FOR1D(i, x0, x1, fcn) \
-    for_all( (x0), (x1), \
-             [&]( const int (i) ){fcn} )
+    MATAR_INDEX_SELECT((x0), (x1), FOR1D_IDX, i, x0, x1, fcn)
 // 2D FOR loop has 7 inputs
 #define \
     FOR2D(i, x0, x1, j, y0, y1, fcn)  \
@@ -951,15 +1075,30 @@ void reduce_prod (int i_start, int i_end,
              [&]( const int (i), const int (j), const int (k) ) {fcn} )
 #define \
     FOR_ALL(...) \
-    EXPAND(GET_MACRO(__VA_ARGS__, _13, _12, _11, FOR3D, _9, _8, FOR2D, _6, _5, FOR1D)(__VA_ARGS__))
+    MATAR_PROFILE_LOOP(MATAR_PROFILE_LOOP_NAME("FOR_ALL"), \
+        EXPAND(GET_MACRO(__VA_ARGS__, _13, _12, _11, FOR3D, _9, _8, FOR2D, _6, _5, FOR1D)(__VA_ARGS__)))
+
+// SIMD blocked loop, pack s with the lanes [a0, a1) in the range [x0, x1)
+#define \
+    FOR_ALL_SIMD(s, a0, a1, x0, x1, width, fcn) \
+    MATAR_PROFILE_LOOP(MATAR_PROFILE_LOOP_NAME("FOR_ALL_SIMD"), \
+    for (int s = (x0)/(width); s < ((x1)+(width)-1)/(width); s++) { \
+        const int a0 = (s*(width) < (x0)) ? (x0) - s*(width) : 0; \
+        const int a1 = (s*(width) + (width) > (x1)) ? (x1) - s*(width) : (width); \
+        {fcn} \
+    })
 
 
 // the DO_ALL loop
 // 1D DOloop has 4 inputs
+#define \
+    DO1D_IDX(IT, i, x0, x1, fcn) \
+    for_all<IT>( (x0), (x1)+1, \
+             [&]( const IT (i) ){fcn} )
+
 #define \
     DO1D(i, x0, x1, fcn) \
-    for_all( (x0), (x1)+1, \
-             [&]( const int (i) ){fcn} )
+    MATAR_INDEX_SELECT((x0), (x1), DO1D_IDX, i, x0, x1, fcn)
 // 2D DO loop has 7 inputs
 #define \
     DO2D(i, x0, x1, j, y0, y1, fcn)  \
@@ -972,15 +1111,20 @@ void reduce_prod (int i_start, int i_end,
              [&]( const int (i), const int (j), const int (k) ) {fcn} )
 #define \
     DO_ALL(...) \
-    EXPAND(GET_MACRO(__VA_ARGS__, _13, _12, _11, DO3D, _9, _8, DO2D, _6, _5, DO1D)(__VA_ARGS__))
+    MATAR_PROFILE_LOOP(MATAR_PROFILE_LOOP_NAME("DO_ALL"), \
+        EXPAND(GET_MACRO(__VA_ARGS__, _13, _12, _11, DO3D, _9, _8, DO2D, _6, _5, DO1D)(__VA_ARGS__)))
 
 
 // the REDUCE loops, no kokkos
 #define \
-    RSUM1D(i, x0, x1, var, fcn, result) \
-    reduce_sum( (x0), (x1), (var),  \
-                [=]( const int (i), decltype(var) &(var) ){fcn}, \
+    RSUM1D_IDX(IT, i, x0, x1, var, fcn, result) \
+    reduce_sum<IT>( (x0), (x1), (var),  \
+                [=]( const IT (i), decltype(var) &(var) ){fcn}, \
                 (result) )
+
+#define \
+    RSUM1D(i, x0, x1, var, fcn, result) \
+    MATAR_INDEX_SELECT((x0), (x1), RSUM1D_IDX, i, x0, x1, var, fcn, result)
 #define \
     RSUM2D(i, x0, x1, j, y0, y1, var, fcn, result) \
     reduce_sum( (x0), (x1), (y0), (y1), (var),  \
@@ -994,15 +1138,20 @@ void reduce_prod (int i_start, int i_end,
 
 #define \
     FOR_REDUCE_SUM(...) \
-    EXPAND(GET_MACRO(__VA_ARGS__, _13, RSUM3D, _11, _10, RSUM2D, _8, _7, RSUM1D)(__VA_ARGS__))
+    MATAR_PROFILE_LOOP(MATAR_PROFILE_LOOP_NAME("FOR_REDUCE_SUM"), \
+        EXPAND(GET_MACRO(__VA_ARGS__, _13, RSUM3D, _11, _10, RSUM2D, _8, _7, RSUM1D)(__VA_ARGS__)))
 
 
 // DO_REDUCE_SUM
 #define \
-    DO_RSUM1D(i, x0, x1, var, fcn, result) \
-    reduce_sum( (x0), (x1)+1, (var),  \
-                [=]( const int (i), decltype(var) &(var) ){fcn}, \
+    DO_RSUM1D_IDX(IT, i, x0, x1, var, fcn, result) \
+    reduce_sum<IT>( (x0), (x1)+1, (var),  \
+                [=]( const IT (i), decltype(var) &(var) ){fcn}, \
                 (result) )
+
+#define \
+    DO_RSUM1D(i, x0, x1, var, fcn, result) \
+    MATAR_INDEX_SELECT((x0), (x1), DO_RSUM1D_IDX, i, x0, x1, var, fcn, result)
 #define \
     DO_RSUM2D(i, x0, x1, j, y0, y1, var, fcn, result) \
     reduce_sum( (x0), (x1)+1, (y0), (y1)+1, (var),  \
@@ -1016,15 +1165,20 @@ void reduce_prod (int i_start, int i_end,
 
 #define \
     DO_REDUCE_SUM(...) \
-    EXPAND(GET_MACRO(__VA_ARGS__, _13, DO_RSUM3D, _11, _10, DO_RSUM2D, _8, _7, DO_RSUM1D)(__VA_ARGS__))
+    MATAR_PROFILE_LOOP(MATAR_PROFILE_LOOP_NAME("DO_REDUCE_SUM"), \
+        EXPAND(GET_MACRO(__VA_ARGS__, _13, DO_RSUM3D, _11, _10, DO_RSUM2D, _8, _7, DO_RSUM1D)(__VA_ARGS__)))
 
 
 // Reduce max
 #define \
-    RMAX1D(i, x0, x1, var, fcn, result) \
-    reduce_max( (x0), (x1), (var),  \
-                [=]( const int (i), decltype(var) &(var) ){fcn}, \
+    RMAX1D_IDX(IT, i, x0, x1, var, fcn, result) \
+    reduce_max<IT>( (x0), (x1), (var),  \
+                [=]( const IT (i), decltype(var) &(var) ){fcn}, \
                 (result) )
+
+#define \
+    RMAX1D(i, x0, x1, var, fcn, result) \
+    MATAR_INDEX_SELECT((x0), (x1), RMAX1D_IDX, i, x0, x1, var, fcn, result)
 #define \
     RMAX2D(i, x0, x1, j, y0, y1, var, fcn, result) \
     reduce_max( (x0), (x1), (y0), (y1), (var),  \
@@ -1038,17 +1192,22 @@ void reduce_prod (int i_start, int i_end,
 
 #define \
     FOR_REDUCE_MAX(...) \
-    EXPAND(GET_MACRO(__VA_ARGS__, _13, RMAX3D, _11, _10, RMAX2D, _8, _7, RMAX1D)(__VA_ARGS__))
+    MATAR_PROFILE_LOOP(MATAR_PROFILE_LOOP_NAME("FOR_REDUCE_MAX"), \
+        EXPAND(GET_MACRO(__VA_ARGS__, _13, RMAX3D, _11, _10, RMAX2D, _8, _7, RMAX1D)(__VA_ARGS__)))
 
 
 
 
 // DO_REDUCE_MAX
 #define \
-    DO_RMAX1D(i, x0, x1, var, fcn, result) \
-    reduce_max( (x0), (x1)+1, (var),  \
-                [=]( const int (i), decltype(var) &(var) ){fcn}, \
+    DO_RMAX1D_IDX(IT, i, x0, x1, var, fcn, result) \
+    reduce_max<IT>( (x0), (x1)+1, (var),  \
+                [=]( const IT (i), decltype(var) &(var) ){fcn}, \
                 (result) )
+
+#define \
+    DO_RMAX1D(i, x0, x1, var, fcn, result) \
+    MATAR_INDEX_SELECT((x0), (x1), DO_RMAX1D_IDX, i, x0, x1, var, fcn, result)
 #define \
     DO_RMAX2D(i, x0, x1, j, y0, y1, var, fcn, result) \
     reduce_max( (x0), (x1)+1, (y0), (y1)+1, (var),  \
@@ -1062,15 +1221,20 @@ void reduce_prod (int i_start, int i_end,
 
 #define \
     DO_REDUCE_MAX(...) \
-    EXPAND(GET_MACRO(__VA_ARGS__, _13, DO_RMAX3D, _11, _10, DO_RMAX2D, _8, _7, DO_RMAX1D)(__VA_ARGS__))
+    MATAR_PROFILE_LOOP(MATAR_PROFILE_LOOP_NAME("DO_REDUCE_MAX"), \
+        EXPAND(GET_MACRO(__VA_ARGS__, _13, DO_RMAX3D, _11, _10, DO_RMAX2D, _8, _7, DO_RMAX1D)(__VA_ARGS__)))
 
 
 // reduce min
 #define \
-    RMIN1D(i, x0, x1, var, fcn, result) \
-    reduce_min( (x0), (x1), (var),  \
-                [=]( const int (i), decltype(var) &(var) ){fcn}, \
+    RMIN1D_IDX(IT, i, x0, x1, var, fcn, result) \
+    reduce_min<IT>( (x0), (x1), (var),  \
+                [=]( const IT (i), decltype(var) &(var) ){fcn}, \
                 (result) )
+
+#define \
+    RMIN1D(i, x0, x1, var, fcn, result) \
+    MATAR_INDEX_SELECT((x0), (x1), RMIN1D_IDX, i, x0, x1, var, fcn, result)
 #define \
     RMIN2D(i, x0, x1, j, y0, y1, var, fcn, result) \
     reduce_min( (x0), (x1), (y0), (y1), (var),  \
@@ -1084,15 +1248,20 @@ void reduce_prod (int i_start, int i_end,
 
 #define \
     FOR_REDUCE_MIN(...) \
-    EXPAND(GET_MACRO(__VA_ARGS__, _13, RMIN3D, _11, _10, RMIN2D, _8, _7, RMIN1D)(__VA_ARGS__))
+    MATAR_PROFILE_LOOP(MATAR_PROFILE_LOOP_NAME("FOR_REDUCE_MIN"), \
+        EXPAND(GET_MACRO(__VA_ARGS__, _13, RMIN3D, _11, _10, RMIN2D, _8, _7, RMIN1D)(__VA_ARGS__)))
 
 
 // DO_REDUCE_MIN
 #define \
-    DO_RMIN1D(i, x0, x1, var, fcn, result) \
-    reduce_min( (x0), (x1)+1, (var),  \
-                [=]( const int (i), decltype(var) &(var) ){fcn}, \
+    DO_RMIN1D_IDX(IT, i, x0, x1, var, fcn, result) \
+    reduce_min<IT>( (x0), (x1)+1, (var),  \
+                [=]( const IT (i), decltype(var) &(var) ){fcn}, \
                 (result) )
+
+#define \
+    DO_RMIN1D(i, x0, x1, var, fcn, result) \
+    MATAR_INDEX_SELECT((x0), (x1), DO_RMIN1D_IDX, i, x0, x1, var, fcn, result)
 #define \
     DO_RMIN2D(i, x0, x1, j, y0, y1, var, fcn, result) \
     reduce_min( (x0), (x1)+1, (y0), (y1)+1, (var),  \
@@ -1106,11 +1275,31 @@ void reduce_prod (int i_start, int i_end,
 
 #define \
     DO_REDUCE_MIN(...) \
-    EXPAND(GET_MACRO(__VA_ARGS__, _13, DO_RMIN3D, _11, _10, DO_RMIN2D, _8, _7, DO_RMIN1D)(__VA_ARGS__))
+    MATAR_PROFILE_LOOP(MATAR_PROFILE_LOOP_NAME("DO_REDUCE_MIN"), \
+        EXPAND(GET_MACRO(__VA_ARGS__, _13, DO_RMIN3D, _11, _10, DO_RMIN2D, _8, _7, DO_RMIN1D)(__VA_ARGS__)))
 
 
 #endif  // if not kokkos
 
+
+// -----------------------------------------
+// Out-of-core loop over the host CArray and FArray, usually file backed,
+// with the same syntax with and without kokkos
+//
+//   FOR_ALL_STREAM(i, 0, A.dims(0), 16, (A, B), {
+//       B(i, j) = 2.0*A(i, j);   // loop over j inside
+//   });
+//
+// i is the slowest index of the arrays in the parentheses, the first of a
+// CArray and the last of an FArray. The loop runs chunk values of i at a
+// time, reading ahead the next chunk and releasing the finished one.
+// -----------------------------------------
+#define \
+    FOR_ALL_STREAM(i, x0, x1, chunk, arrays, fcn) \
+    MATAR_PROFILE_LOOP(MATAR_PROFILE_LOOP_NAME("FOR_ALL_STREAM"), \
+    mtr::stream_for_all( (x0), (x1), (chunk), std::tie arrays, \
+                         [&]( const size_t (i) ){fcn} ))
+
 #ifdef HAVE_MPI
 
 // MPI Init
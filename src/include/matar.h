@@ -76,13 +76,48 @@
 //   31. DViewFArrayKokkos
 //   32. DViewFMatrixKokkos
 
+//  ----
+//   Fixed size data structures (host and device)
+//   33. CArrayFixed
+//   34. FArrayFixed
+//   35. CMatrixFixed
+//   36. FMatrixFixed
+
+//  ----
+//   SIMD blocked data structures (device types)
+//   37. CArrayVec
+
+//  ----
+//   Strided sub-views (from subview() on the C and F array types)
+//   38. ViewStridedArray
+//   39. ViewStridedArrayKokkos
+
+//  ----
+//   Structured grid stencils (device types)
+//   40. StencilGrid
+
+//  ----
+//   Sparse matrix assembly (device builder of the CSR and CSC types)
+//   41. SparseAssembler
+
 
 #include "macros.h"
 #include "host_types.h"
 #include "kokkos_types.h"
+#include "fixed_types.h"
+#include "memory_arena.h"
 #include "aliases.h"
+#include "expression_types.h"
+#include "interop_types.h"
+#include "sparse_assembly.h"
+#include "graph.h"
+#include "checkpoint.h"
+#include "stencil.h"
+#include "convergence.h"
 #include "mpi_types.h"
 #include "mapped_mpi_types.h"
+#include "cartesian_decomposition.h"
+#include "distributed_csr.h"
 #include "tpetra_wrapper_types.h"
 
 
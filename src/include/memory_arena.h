@@ -0,0 +1,350 @@
+#ifndef MEMORY_ARENA_H
+#define MEMORY_ARENA_H
+/**********************************************************************************************
+ © 2020. Triad National Security, LLC. All rights reserved.
+ This program was produced under U.S. Government contract 89233218CNA000001 for Los Alamos
+ National Laboratory (LANL), which is operated by Triad National Security, LLC for the U.S.
+ Department of Energy/National Nuclear Security Administration. All rights in the program are
+ reserved by Triad National Security, LLC, and the U.S. Department of Energy/National Nuclear
+ Security Administration. The Government is granted for itself and others acting on its behalf a
+ nonexclusive, paid-up, irrevocable worldwide license in this material to reproduce, prepare
+ derivative works, distribute copies to the public, perform publicly and display publicly, and
+ to permit others to do so.
+ This program is open source under the BSD-3 License.
+ Redistribution and use in source and binary forms, with or without modification, are permitted
+ provided that the following conditions are met:
+ 
+ 1.  Redistributions of source code must retain the above copyright notice, this list of
+ conditions and the following disclaimer.
+ 
+ 2.  Redistributions in binary form must reproduce the above copyright notice, this list of
+ conditions and the following disclaimer in the documentation and/or other materials
+ provided with the distribution.
+ 
+ 3.  Neither the name of the copyright holder nor the names of its contributors may be used
+ to endorse or promote products derived from this software without specific prior
+ written permission.
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+ IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **********************************************************************************************/
+
+#include <stdio.h>
+#include <cassert>
+#include <string>
+#include <vector>
+
+#include "host_types.h"
+#include "kokkos_types.h"
+
+
+// -----------------------------------------
+// Memory arenas for short lived scratch arrays
+//
+// An arena keeps a list of large blocks and hands out pieces of them with a
+// bump pointer, so a scratch array costs neither a malloc nor an
+// initialization kernel. An ArenaScope gives back everything allocated
+// after it was opened when it goes out of scope. The blocks are kept for the
+// next scope and only freed with the arena.
+//
+//   DeviceArena scratch(64*1024*1024, "scratch");   // lives across time steps
+//
+//   for (int cycle = 0; cycle < num_cycles; cycle++) {
+//       ArenaScope<DeviceArena> scope(scratch);
+//       ViewCArrayKokkos <double> v = scratch.carray<double>(num_elems, 3);
+//       ...
+//   } // v's memory goes back to the arena here
+//
+// Arrays from an arena are not initialized and must not be used after the
+// scope that allocated them closes. Arenas are not thread safe.
+// -----------------------------------------
+
+namespace mtr
+{
+
+// position in an arena, used to release everything allocated after it
+struct ArenaMark {
+    size_t block  = 0;
+    size_t offset = 0;
+};
+
+/////////////////////////
+// MemoryArena: block list and bump allocation shared by the host and
+// device arenas. Block provides the storage, see HostArenaBlock.
+/////////////////////////
+template <typename Block>
+class MemoryArena {
+
+private:
+    std::vector<Block> blocks_;
+    size_t block_bytes_;
+    size_t current_;   // block being allocated from
+    size_t offset_;    // first free byte in the current block
+    size_t alignment_;
+    std::string label_;
+
+protected:
+    // raw aligned memory, bytes are rounded up to the alignment
+    char* allocate_bytes(size_t bytes);
+
+public:
+    MemoryArena(size_t block_bytes, const std::string& label, size_t alignment);
+
+    // raw memory for length entries of type T
+    template <typename T>
+    T* allocate(size_t length);
+
+    // current position, pass to release() to free what comes after
+    ArenaMark mark() const;
+
+    void release(const ArenaMark& mark);
+
+    // release everything, the blocks are kept
+    void reset();
+
+    // bytes in use and bytes held in blocks
+    size_t used() const;
+
+    size_t capacity() const;
+
+    size_t num_blocks() const;
+
+    const std::string& get_name() const;
+}; // End of MemoryArena
+
+template <typename Block>
+MemoryArena<Block>::MemoryArena(size_t block_bytes, const std::string& label, size_t alignment)
+    : block_bytes_(block_bytes), current_(0), offset_(0), alignment_(alignment), label_(label) {
+    assert((alignment & (alignment - 1)) == 0 && "MemoryArena alignment must be a power of 2!");
+}
+
+template <typename Block>
+char* MemoryArena<Block>::allocate_bytes(size_t bytes) {
+    bytes = ((bytes + alignment_ - 1) / alignment_) * alignment_;
+    if (bytes == 0) {
+        bytes = alignment_;
+    }
+
+    // move on to the next block when the current one is full
+    if (current_ < blocks_.size() && offset_ + bytes > blocks_[current_].size()) {
+        current_++;
+        offset_ = 0;
+    }
+
+    // a free block that is too small is replaced, blocks after current_ are unused
+    if (current_ < blocks_.size() && bytes > blocks_[current_].size()) {
+        blocks_[current_] = Block(label_ + "_block", bytes > block_bytes_ ? bytes : block_bytes_);
+    }
+    if (current_ == blocks_.size()) {
+        blocks_.push_back(Block(label_ + "_block", bytes > block_bytes_ ? bytes : block_bytes_));
+    }
+
+    char* ptr = blocks_[current_].data() + offset_;
+    offset_ += bytes;
+    return ptr;
+}
+
+template <typename Block>
+template <typename T>
+T* MemoryArena<Block>::allocate(size_t length) {
+    assert(alignof(T) <= alignment_ && "MemoryArena alignment is smaller than the alignment of the type!");
+    return reinterpret_cast<T*>(allocate_bytes(length * sizeof(T)));
+}
+
+template <typename Block>
+ArenaMark MemoryArena<Block>::mark() const {
+    ArenaMark mark;
+    mark.block  = current_;
+    mark.offset = offset_;
+    return mark;
+}
+
+template <typename Block>
+void MemoryArena<Block>::release(const ArenaMark& mark) {
+    assert((mark.block < current_ || (mark.block == current_ && mark.offset <= offset_))
+           && "MemoryArena released to a mark that is ahead of the arena!");
+    current_ = mark.block;
+    offset_  = mark.offset;
+}
+
+template <typename Block>
+void MemoryArena<Block>::reset() {
+    current_ = 0;
+    offset_  = 0;
+}
+
+template <typename Block>
+size_t MemoryArena<Block>::used() const {
+    size_t bytes = offset_;
+    for (size_t i = 0; i < current_ && i < blocks_.size(); i++) {
+        bytes += blocks_[i].size();
+    }
+    return bytes;
+}
+
+template <typename Block>
+size_t MemoryArena<Block>::capacity() const {
+    size_t bytes = 0;
+    for (size_t i = 0; i < blocks_.size(); i++) {
+        bytes += blocks_[i].size();
+    }
+    return bytes;
+}
+
+template <typename Block>
+size_t MemoryArena<Block>::num_blocks() const {
+    return blocks_.size();
+}
+
+template <typename Block>
+const std::string& MemoryArena<Block>::get_name() const {
+    return label_;
+}
+// End of MemoryArena
+
+
+/////////////////////////
+// ArenaScope: releases an arena back to where it was when the scope opened
+/////////////////////////
+template <typename Arena>
+class ArenaScope {
+
+private:
+    Arena& arena_;
+    ArenaMark mark_;
+
+public:
+    explicit ArenaScope(Arena& arena) : arena_(arena), mark_(arena.mark()) {}
+
+    ~ArenaScope() { arena_.release(mark_); }
+
+    ArenaScope(const ArenaScope&) = delete;
+    ArenaScope& operator=(const ArenaScope&) = delete;
+}; // End of ArenaScope
+
+
+// host block, uses the host allocation policy
+class HostArenaBlock {
+
+private:
+    std::shared_ptr <char[]> data_;
+    size_t size_;
+
+public:
+    HostArenaBlock(const std::string&, size_t bytes) : data_(host_allocate<char>(bytes)), size_(bytes) {}
+
+    char* data() const { return data_.get(); }
+
+    size_t size() const { return size_; }
+}; // End of HostArenaBlock
+
+
+/////////////////////////
+// HostArena: scratch memory for the host types
+/////////////////////////
+class HostArena : public MemoryArena<HostArenaBlock> {
+
+public:
+    explicit HostArena(size_t block_bytes = 16 * 1024 * 1024,
+                       const std::string& label = "host_arena",
+                       size_t alignment = 64)
+        : MemoryArena<HostArenaBlock>(block_bytes, label, alignment) {}
+
+    // ViewCArray, ViewFArray, ViewCMatrix and ViewFMatrix on arena memory
+    template <typename T, typename... Dims>
+    ViewCArray<T> carray(Dims... dims) {
+        return ViewCArray<T>(allocate<T>((static_cast<size_t>(dims) * ...)), static_cast<size_t>(dims)...);
+    }
+
+    template <typename T, typename... Dims>
+    ViewFArray<T> farray(Dims... dims) {
+        return ViewFArray<T>(allocate<T>((static_cast<size_t>(dims) * ...)), static_cast<size_t>(dims)...);
+    }
+
+    template <typename T, typename... Dims>
+    ViewCMatrix<T> cmatrix(Dims... dims) {
+        return ViewCMatrix<T>(allocate<T>((static_cast<size_t>(dims) * ...)), static_cast<size_t>(dims)...);
+    }
+
+    template <typename T, typename... Dims>
+    ViewFMatrix<T> fmatrix(Dims... dims) {
+        return ViewFMatrix<T>(allocate<T>((static_cast<size_t>(dims) * ...)), static_cast<size_t>(dims)...);
+    }
+}; // End of HostArena
+
+
+#ifdef HAVE_KOKKOS
+
+// device block, a Kokkos allocation in the memory space of ExecSpace
+template <typename ExecSpace>
+class DeviceArenaBlock {
+
+    using TBlock = Kokkos::View<char*, typename ExecSpace::memory_space>;
+
+private:
+    TBlock data_;
+
+public:
+    DeviceArenaBlock(const std::string& label, size_t bytes)
+        : data_(Kokkos::view_alloc(label, Kokkos::WithoutInitializing), bytes) {}
+
+    char* data() const { return data_.data(); }
+
+    size_t size() const { return data_.size(); }
+}; // End of DeviceArenaBlock
+
+
+/////////////////////////
+// DeviceArena: scratch memory for the device types. 256 byte alignment
+// keeps every array aligned for coalesced access.
+/////////////////////////
+template <typename ExecSpace = DefaultExecSpace>
+class DeviceArenaT : public MemoryArena<DeviceArenaBlock<ExecSpace>> {
+
+public:
+    explicit DeviceArenaT(size_t block_bytes = 64 * 1024 * 1024,
+                          const std::string& label = "device_arena",
+                          size_t alignment = 256)
+        : MemoryArena<DeviceArenaBlock<ExecSpace>>(block_bytes, label, alignment) {}
+
+    // ViewCArrayKokkos, ViewFArrayKokkos, ViewCMatrixKokkos and ViewFMatrixKokkos on arena memory
+    template <typename T, typename... Dims>
+    ViewCArrayKokkos<T> carray(Dims... dims) {
+        return ViewCArrayKokkos<T>(this->template allocate<T>((static_cast<size_t>(dims) * ...)),
+                                   static_cast<size_t>(dims)...);
+    }
+
+    template <typename T, typename... Dims>
+    ViewFArrayKokkos<T> farray(Dims... dims) {
+        return ViewFArrayKokkos<T>(this->template allocate<T>((static_cast<size_t>(dims) * ...)),
+                                   static_cast<size_t>(dims)...);
+    }
+
+    template <typename T, typename... Dims>
+    ViewCMatrixKokkos<T> cmatrix(Dims... dims) {
+        return ViewCMatrixKokkos<T>(this->template allocate<T>((static_cast<size_t>(dims) * ...)),
+                                    static_cast<size_t>(dims)...);
+    }
+
+    template <typename T, typename... Dims>
+    ViewFMatrixKokkos<T> fmatrix(Dims... dims) {
+        return ViewFMatrixKokkos<T>(this->template allocate<T>((static_cast<size_t>(dims) * ...)),
+                                    static_cast<size_t>(dims)...);
+    }
+}; // End of DeviceArenaT
+
+using DeviceArena = DeviceArenaT<DefaultExecSpace>;
+
+#endif
+
+} // end namespace
+
+#endif // MEMORY_ARENA_H
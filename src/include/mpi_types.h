@@ -213,6 +213,11 @@ public:
         }
     };
 
+    // Method that returns the comm plan, NULL if none was set
+    CommunicationPlan* comm_plan() const {
+        return comm_plan_;
+    };
+
 
     // GPU Method
     // Method that returns size
@@ -319,20 +324,24 @@ public:
     // MPI_Wait(&req);
 
     void communicate(){
+        MATAR_PROFILE_SCOPE("MPICArrayKokkos::communicate", ProfileCategory::communication);
 
         fill_send_buffer();
 
-        MPI_Neighbor_alltoallv(
-            send_buffer_.host_pointer(),
-            send_counts_.host_pointer(),
-            send_displs_.host_pointer(),
-            mpi_type_map<T>::value(),  // MPI_TYPE
-            recv_buffer_.host_pointer(),
-            recv_counts_.host_pointer(),
-            recv_displs_.host_pointer(), 
-            mpi_type_map<T>::value(),  // MPI_TYPE
-            comm_plan_->mpi_comm_graph);
-        
+        {
+            MATAR_PROFILE_SCOPE("MPI_Neighbor_alltoallv", ProfileCategory::communication);
+            MPI_Neighbor_alltoallv(
+                send_buffer_.host_pointer(),
+                send_counts_.host_pointer(),
+                send_displs_.host_pointer(),
+                mpi_type_map<T>::value(),  // MPI_TYPE
+                recv_buffer_.host_pointer(),
+                recv_counts_.host_pointer(),
+                recv_displs_.host_pointer(), 
+                mpi_type_map<T>::value(),  // MPI_TYPE
+                comm_plan_->mpi_comm_graph);
+        }
+
         copy_recv_buffer();
         this_array_.update_device();
         MATAR_FENCE();
@@ -39,10 +39,38 @@
 
 #include "host_types.h"
 #include "kokkos_types.h"
+#include <cstdint>
+#include <stdexcept>
 #include <typeinfo>
 #ifdef HAVE_MPI
 #include <mpi.h>
 
+
+// -----------------------------------------
+// Global indices of the entries a rank holds, with lookups both ways
+//
+//   PartitionMap<long long> rows(num_global, MPI_COMM_WORLD);    // contiguous blocks
+//   PartitionMap<long long> nodes(node_gids, MPI_COMM_WORLD);    // any set of indices
+//
+//   FOR_ALL(i, 0, num_ghosts, {
+//       const int lid = nodes.getLocalIndex(ghost_gid(i));       // -1 when not held here
+//       const long long gid = nodes.getGlobalIndex(lid);
+//   });
+//
+// The lookups are plain inline functions, so they run inside kernels on a
+// copy of the map. Local to global reads the index array. Global to local
+// is a subtraction when local i holds first + i, and otherwise probes an
+// open addressing hash table, kept at most half full. Global indices are
+// not negative, -1 marks an empty slot.
+//
+// getLocalIndex and getGlobalIndex read device memory and are for kernels.
+// Host code calls getLocalIndexHost and getGlobalIndexHost, which read a
+// host copy of the indices and the table.
+//
+// After filling host(i) by hand, update_device() copies the indices and
+// rebuilds the table.
+// -----------------------------------------
+
 namespace mtr
 {
 
@@ -60,9 +88,34 @@ protected:
     size_t order_;  // tensor order (rank)
     MPI_Datatype mpi_datatype_;
     TArray1D this_array_;
+
+    // global to local lookup
+    using KeyArray   = Kokkos::View <T*, Layout, ExecSpace, MemoryTraits>;
+    using LocalArray = Kokkos::View <int*, Layout, ExecSpace, MemoryTraits>;
+    bool contiguous_ = true;    // local i holds first_global_ + i
+    T first_global_ = 0;
+    size_t mask_ = 0;           // table size - 1, a power of two
+    KeyArray keys_;
+    LocalArray locals_;
+    typename KeyArray::HostMirror keys_host_;
+    typename LocalArray::HostMirror locals_host_;
     
     void set_mpi_type();
 
+    // contiguous check, or the hash table, from the device indices
+    void build_lookup();
+
+    KOKKOS_INLINE_FUNCTION
+    static size_t hash(T global_index);
+
+    // walk the table from the slot of global_index, on either copy
+    template <typename Keys, typename Locals>
+    KOKKOS_INLINE_FUNCTION
+    static int probe(const Keys& keys, const Locals& locals, size_t mask, T global_index);
+
+    // entries of this rank when global_length is split evenly
+    static size_t even_share(size_t global_length, MPI_Comm mpi_comm);
+
 public:
     // Data member to access host view
     ViewCArray <T> host;
@@ -76,6 +129,15 @@ public:
      
     PartitionMap(size_t length, const std::string& tag_string = DEFAULTSTRINGARRAY);
 
+    // contiguous blocks of a global range, the first ranks get one more when it does not divide
+    PartitionMap(size_t global_length, MPI_Comm mpi_comm, const std::string& tag_string = DEFAULTSTRINGARRAY);
+
+    // contiguous blocks in rank order, num_local_indices on this rank
+    PartitionMap(size_t num_global_indices, size_t num_local_indices, MPI_Comm mpi_comm, const std::string& tag_string = DEFAULTSTRINGARRAY);
+
+    // a copy of any set of global indices, each held by one local entry
+    PartitionMap(const DCArrayKokkos<T, Layout, ExecSpace, MemoryTraits> &indices, MPI_Comm mpi_comm, const std::string& tag_string = DEFAULTSTRINGARRAY);
+
     KOKKOS_INLINE_FUNCTION
     T& operator()(size_t i) const;
 
@@ -92,13 +154,26 @@ public:
     KOKKOS_INLINE_FUNCTION
     size_t extent() const;
 
-    virtual int getLocalIndex(int global_index) const {return 0;}
+    // local index of a global one, -1 when this rank does not hold it
+    KOKKOS_INLINE_FUNCTION
+    int getLocalIndex(T global_index) const;
+
+    KOKKOS_INLINE_FUNCTION
+    T getGlobalIndex(int local_index) const;
+
+    // the same lookups from host code
+    int getLocalIndexHost(T global_index) const;
 
-    virtual int getGlobalIndex(int local_index) const {return 0;}
+    T getGlobalIndexHost(int local_index) const;
 
-    virtual bool isProcessGlobalIndex(int global_index) const {return 0;}
+    KOKKOS_INLINE_FUNCTION
+    bool isProcessGlobalIndex(T global_index) const;
+
+    KOKKOS_INLINE_FUNCTION
+    bool isProcessLocalIndex(int local_index) const;
 
-    virtual bool isProcessLocalIndex(int local_index) const {return 0;}
+    // true when the lookup is a subtraction, no table
+    bool contiguous() const { return contiguous_; }
 
     // Method returns the raw device pointer of the Kokkos DualView
     KOKKOS_INLINE_FUNCTION
@@ -115,7 +190,7 @@ public:
     // Method that update host view
     void update_host();
 
-    // Method that update device view
+    // Method that update device view, and rebuilds the global to local lookup
     void update_device();
 
     // Deconstructor
@@ -141,6 +216,193 @@ PartitionMap<T,Layout,ExecSpace,MemoryTraits>::PartitionMap(size_t dim0, const s
     set_mpi_type();
 }
 
+// Contiguous constructor, even split
+template <typename T, typename Layout, typename ExecSpace, typename MemoryTraits>
+PartitionMap<T,Layout,ExecSpace,MemoryTraits>::PartitionMap(size_t global_length, MPI_Comm mpi_comm, const std::string& tag_string)
+    : PartitionMap(global_length, even_share(global_length, mpi_comm), mpi_comm, tag_string) {}
+
+template <typename T, typename Layout, typename ExecSpace, typename MemoryTraits>
+size_t PartitionMap<T,Layout,ExecSpace,MemoryTraits>::even_share(size_t global_length, MPI_Comm mpi_comm) {
+    int rank, num_ranks;
+    MPI_Comm_rank(mpi_comm, &rank);
+    MPI_Comm_size(mpi_comm, &num_ranks);
+    return global_length / num_ranks + ((size_t) rank < global_length % num_ranks ? 1 : 0);
+}
+
+// Contiguous constructor, local counts given
+template <typename T, typename Layout, typename ExecSpace, typename MemoryTraits>
+PartitionMap<T,Layout,ExecSpace,MemoryTraits>::PartitionMap(size_t num_global_indices, size_t num_local_indices, MPI_Comm mpi_comm, const std::string& tag_string) {
+
+    long long local_count = (long long) num_local_indices;
+    long long first = 0;
+    long long total = 0;
+    MPI_Exscan(&local_count, &first, 1, MPI_LONG_LONG, MPI_SUM, mpi_comm);
+    MPI_Allreduce(&local_count, &total, 1, MPI_LONG_LONG, MPI_SUM, mpi_comm);
+
+    int rank;
+    MPI_Comm_rank(mpi_comm, &rank);
+    if (rank == 0) {
+        first = 0;  // MPI_Exscan leaves rank 0 undefined
+    }
+    if ((size_t) total != num_global_indices) {
+        throw std::runtime_error("PartitionMap: the local counts do not add up to the global count");
+    }
+
+    length_ = num_local_indices;
+    this_array_ = TArray1D(tag_string, length_);
+    host = ViewCArray <T> (this_array_.h_view.data(), length_);
+    set_mpi_type();
+
+    for (size_t i = 0; i < length_; i++) {
+        host(i) = (T) (first + (long long) i);
+    }
+    update_device();
+}
+
+// Constructor from any set of global indices
+template <typename T, typename Layout, typename ExecSpace, typename MemoryTraits>
+PartitionMap<T,Layout,ExecSpace,MemoryTraits>::PartitionMap(const DCArrayKokkos<T, Layout, ExecSpace, MemoryTraits> &indices, MPI_Comm mpi_comm, const std::string& tag_string) {
+
+    length_ = indices.size();
+    this_array_ = TArray1D(tag_string, length_);
+    host = ViewCArray <T> (this_array_.h_view.data(), length_);
+    set_mpi_type();
+
+    auto device = this_array_.d_view;
+    FOR_ALL(i, 0, length_, {
+        device(i) = indices(i);
+    });
+    update_host();
+    build_lookup();
+}
+
+template <typename T, typename Layout, typename ExecSpace, typename MemoryTraits>
+void PartitionMap<T,Layout,ExecSpace,MemoryTraits>::build_lookup() {
+
+    keys_   = KeyArray();
+    locals_ = LocalArray();
+    keys_host_   = typename KeyArray::HostMirror();
+    locals_host_ = typename LocalArray::HostMirror();
+    mask_   = 0;
+    contiguous_ = true;
+    first_global_ = length_ > 0 ? this_array_.h_view(0) : 0;
+
+    auto device = this_array_.d_view;
+    const T first = first_global_;
+    size_t breaks = 0;
+    size_t loc_breaks;
+    FOR_REDUCE_SUM(i, 0, length_, loc_breaks, {
+        loc_breaks += (device(i) == first + (T) i) ? 0 : 1;
+    }, breaks);
+    if (breaks == 0) {
+        return;
+    }
+
+    contiguous_ = false;
+    size_t capacity = 2;
+    while (capacity < 2 * length_) {
+        capacity *= 2;
+    }
+    mask_   = capacity - 1;
+    keys_   = KeyArray("partition_map_keys", capacity);
+    locals_ = LocalArray("partition_map_locals", capacity);
+
+    KeyArray keys = keys_;
+    LocalArray locals = locals_;
+    const size_t mask = mask_;
+    FOR_ALL(slot, 0, capacity, {
+        keys(slot) = (T) -1;
+    });
+    FOR_ALL(i, 0, length_, {
+        const T key = device(i);
+        size_t slot = hash(key) & mask;
+        while (true) {
+            const T prev = Kokkos::atomic_compare_exchange(&keys(slot), (T) -1, key);
+            if (prev == (T) -1 || prev == key) {
+                locals(slot) = i;
+                break;
+            }
+            slot = (slot + 1) & mask;
+        }
+    });
+
+    keys_host_   = Kokkos::create_mirror_view(keys_);
+    locals_host_ = Kokkos::create_mirror_view(locals_);
+    Kokkos::deep_copy(keys_host_, keys_);
+    Kokkos::deep_copy(locals_host_, locals_);
+}
+
+template <typename T, typename Layout, typename ExecSpace, typename MemoryTraits>
+KOKKOS_INLINE_FUNCTION
+size_t PartitionMap<T,Layout,ExecSpace,MemoryTraits>::hash(T global_index) {
+    uint64_t x = (uint64_t) global_index;
+    x ^= x >> 33;
+    x *= 0xff51afd7ed558ccdULL;
+    x ^= x >> 33;
+    return (size_t) x;
+}
+
+template <typename T, typename Layout, typename ExecSpace, typename MemoryTraits>
+KOKKOS_INLINE_FUNCTION
+int PartitionMap<T,Layout,ExecSpace,MemoryTraits>::getLocalIndex(T global_index) const {
+    if (contiguous_) {
+        const T local = global_index - first_global_;
+        return (global_index >= first_global_ && local < (T) length_) ? (int) local : -1;
+    }
+    return probe(keys_, locals_, mask_, global_index);
+}
+
+template <typename T, typename Layout, typename ExecSpace, typename MemoryTraits>
+int PartitionMap<T,Layout,ExecSpace,MemoryTraits>::getLocalIndexHost(T global_index) const {
+    if (contiguous_) {
+        const T local = global_index - first_global_;
+        return (global_index >= first_global_ && local < (T) length_) ? (int) local : -1;
+    }
+    return probe(keys_host_, locals_host_, mask_, global_index);
+}
+
+template <typename T, typename Layout, typename ExecSpace, typename MemoryTraits>
+template <typename Keys, typename Locals>
+KOKKOS_INLINE_FUNCTION
+int PartitionMap<T,Layout,ExecSpace,MemoryTraits>::probe(const Keys& keys, const Locals& locals, size_t mask, T global_index) {
+    size_t slot = hash(global_index) & mask;
+    while (true) {
+        const T key = keys(slot);
+        if (key == global_index) {
+            return locals(slot);
+        }
+        if (key == (T) -1) {
+            return -1;
+        }
+        slot = (slot + 1) & mask;
+    }
+}
+
+template <typename T, typename Layout, typename ExecSpace, typename MemoryTraits>
+KOKKOS_INLINE_FUNCTION
+T PartitionMap<T,Layout,ExecSpace,MemoryTraits>::getGlobalIndex(int local_index) const {
+    assert(local_index >= 0 && (size_t) local_index < length_ && "local_index is out of bounds in PartitionMap getGlobalIndex!");
+    return this_array_.d_view(local_index);
+}
+
+template <typename T, typename Layout, typename ExecSpace, typename MemoryTraits>
+T PartitionMap<T,Layout,ExecSpace,MemoryTraits>::getGlobalIndexHost(int local_index) const {
+    assert(local_index >= 0 && (size_t) local_index < length_ && "local_index is out of bounds in PartitionMap getGlobalIndexHost!");
+    return this_array_.h_view(local_index);
+}
+
+template <typename T, typename Layout, typename ExecSpace, typename MemoryTraits>
+KOKKOS_INLINE_FUNCTION
+bool PartitionMap<T,Layout,ExecSpace,MemoryTraits>::isProcessGlobalIndex(T global_index) const {
+    return getLocalIndex(global_index) >= 0;
+}
+
+template <typename T, typename Layout, typename ExecSpace, typename MemoryTraits>
+KOKKOS_INLINE_FUNCTION
+bool PartitionMap<T,Layout,ExecSpace,MemoryTraits>::isProcessLocalIndex(int local_index) const {
+    return local_index >= 0 && (size_t) local_index < length_;
+}
+
 template <typename T, typename Layout, typename ExecSpace, typename MemoryTraits>
 void PartitionMap<T,Layout,ExecSpace,MemoryTraits>::set_mpi_type() {
     if (typeid(T).name() == typeid(bool).name()) {
@@ -155,6 +417,12 @@ void PartitionMap<T,Layout,ExecSpace,MemoryTraits>::set_mpi_type() {
     else if (typeid(T).name() == typeid(long long int).name()) {
         mpi_datatype_ = MPI_LONG_LONG_INT;
     }
+    else if (typeid(T).name() == typeid(unsigned long int).name()) {
+        mpi_datatype_ = MPI_UNSIGNED_LONG;
+    }
+    else if (typeid(T).name() == typeid(unsigned long long int).name()) {
+        mpi_datatype_ = MPI_UNSIGNED_LONG_LONG;
+    }
     else if (typeid(T).name() == typeid(float).name()) {
         mpi_datatype_ = MPI_FLOAT;
     }
@@ -184,6 +452,13 @@ PartitionMap<T,Layout,ExecSpace,MemoryTraits>& PartitionMap<T,Layout,ExecSpace,M
         this_array_ = temp.this_array_;
         host = temp.host;
         mpi_datatype_ = temp.mpi_datatype_;
+        contiguous_ = temp.contiguous_;
+        first_global_ = temp.first_global_;
+        mask_ = temp.mask_;
+        keys_ = temp.keys_;
+        locals_ = temp.locals_;
+        keys_host_ = temp.keys_host_;
+        locals_host_ = temp.locals_host_;
     }
     
     return *this;
@@ -232,6 +507,7 @@ void PartitionMap<T,Layout,ExecSpace,MemoryTraits>::update_device() {
 
     this_array_.template modify<typename TArray1D::host_mirror_space>();
     this_array_.template sync<typename TArray1D::execution_space>();
+    build_lookup();
 }
 
 template <typename T, typename Layout, typename ExecSpace, typename MemoryTraits>
@@ -0,0 +1,681 @@
+#ifndef PROFILE_H
+#define PROFILE_H
+/**********************************************************************************************
+ © 2020. Triad National Security, LLC. All rights reserved.
+ This program was produced under U.S. Government contract 89233218CNA000001 for Los Alamos
+ National Laboratory (LANL), which is operated by Triad National Security, LLC for the U.S.
+ Department of Energy/National Nuclear Security Administration. All rights in the program are
+ reserved by Triad National Security, LLC, and the U.S. Department of Energy/National Nuclear
+ Security Administration. The Government is granted for itself and others acting on its behalf a
+ nonexclusive, paid-up, irrevocable worldwide license in this material to reproduce, prepare
+ derivative works, distribute copies to the public, perform publicly and display publicly, and
+ to permit others to do so.
+ This program is open source under the BSD-3 License.
+ Redistribution and use in source and binary forms, with or without modification, are permitted
+ provided that the following conditions are met:
+ 
+ 1.  Redistributions of source code must retain the above copyright notice, this list of
+ conditions and the following disclaimer.
+ 
+ 2.  Redistributions in binary form must reproduce the above copyright notice, this list of
+ conditions and the following disclaimer in the documentation and/or other materials
+ provided with the distribution.
+ 
+ 3.  Neither the name of the copyright holder nor the names of its contributors may be used
+ to endorse or promote products derived from this software without specific prior
+ written permission.
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+ IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **********************************************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <cfloat>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#ifdef HAVE_KOKKOS
+#include <Kokkos_Core.hpp>
+#endif
+
+#ifdef HAVE_MPI
+#include <mpi.h>
+#endif
+
+
+// -----------------------------------------
+// Instrumentation hooks
+//
+// Compile with -DMATAR_ENABLE_PROFILING to time the FOR_ALL style loops,
+// the dual type update_host()/update_device() copies and the MPI
+// communicate() calls. Without the flag the hooks expand to nothing.
+// -----------------------------------------
+#define MATAR_PROFILE_STRINGIFY_(x) #x
+#define MATAR_PROFILE_STRINGIFY(x) MATAR_PROFILE_STRINGIFY_(x)
+#define MATAR_PROFILE_CONCAT_(a, b) a##b
+#define MATAR_PROFILE_CONCAT(a, b) MATAR_PROFILE_CONCAT_(a, b)
+
+// name of a loop region, e.g. "FOR_ALL@solver.cpp:42"
+#define MATAR_PROFILE_LOOP_NAME(kind) \
+    kind "@" __FILE__ ":" MATAR_PROFILE_STRINGIFY(__LINE__)
+
+#ifdef MATAR_ENABLE_PROFILING
+
+// time the rest of the enclosing scope
+#define \
+    MATAR_PROFILE_SCOPE(name, category) \
+    mtr::ProfileScope MATAR_PROFILE_CONCAT(matar_profile_scope_, __LINE__)((name), (category))
+
+// time a single loop statement
+#define \
+    MATAR_PROFILE_LOOP(name, ...) \
+    do { mtr::ProfileScope matar_profile_loop_scope((name), mtr::ProfileCategory::compute); \
+         __VA_ARGS__; } while (0)
+
+#else
+
+#define MATAR_PROFILE_SCOPE(name, category)
+#define MATAR_PROFILE_LOOP(name, ...) __VA_ARGS__
+
+#endif
+
+
+namespace mtr
+{
+
+// what a timed region is spending its time on
+enum class ProfileCategory {
+    compute,
+    transfer,
+    communication,
+    user
+};
+
+inline const char* profile_category_name(ProfileCategory category)
+{
+    switch (category) {
+        case ProfileCategory::compute:       return "compute";
+        case ProfileCategory::transfer:      return "transfer";
+        case ProfileCategory::communication: return "communication";
+        default:                             return "user";
+    }
+} // end profile_category_name
+
+
+/////////////////////////
+// ProfileEvent: one node in the timer tree. A node is identified by its
+// name and its parent, so the same name under two different parents is
+// timed separately.
+/////////////////////////
+class ProfileEvent {
+
+    using clock_t = std::chrono::steady_clock;
+
+public:
+    std::string name_;
+    ProfileCategory category_;
+    ProfileEvent* parent_;
+    std::vector<std::unique_ptr<ProfileEvent>> children_;
+
+    clock_t::time_point start_time_;
+    double total_time_ = 0.0;     // seconds, summed over all calls
+    double min_time_   = DBL_MAX; // fastest single call
+    double max_time_   = 0.0;     // slowest single call
+    size_t count_      = 0;       // number of calls
+
+    ProfileEvent(const std::string& name, ProfileCategory category, ProfileEvent* parent)
+        : name_(name), category_(category), parent_(parent) {}
+
+    // find or create the child with this name
+    ProfileEvent* child(const char* name, ProfileCategory category)
+    {
+        for (auto& event : children_) {
+            if (event->name_ == name) {
+                return event.get();
+            }
+        }
+        children_.emplace_back(new ProfileEvent(name, category, this));
+        return children_.back().get();
+    }
+
+    void start()
+    {
+        start_time_ = clock_t::now();
+    }
+
+    void stop()
+    {
+        double seconds = std::chrono::duration<double>(clock_t::now() - start_time_).count();
+        total_time_ += seconds;
+        if (seconds < min_time_) min_time_ = seconds;
+        if (seconds > max_time_) max_time_ = seconds;
+        count_++;
+    }
+
+    // time not accounted for by the children
+    double self_time() const
+    {
+        double time = total_time_;
+        for (auto& event : children_) {
+            time -= event->total_time_;
+        }
+        return time > 0.0 ? time : 0.0;
+    }
+}; // End of ProfileEvent
+
+
+// Flattened, optionally rank-reduced, view of one ProfileEvent
+struct ProfileStats {
+    std::string path;          // '|' separated names from the root
+    ProfileCategory category;
+    int    depth;
+    int    ranks;              // number of ranks that recorded this event
+    size_t count;              // calls, summed over ranks
+    double total_min, total_max, total_avg; // total time across ranks
+    double self_min,  self_max,  self_avg;  // self time across ranks
+};
+
+
+/////////////////////////
+// Profiler: process wide timer tree. Scopes are pushed and popped on the
+// host thread that launches the kernels; it is not thread safe.
+/////////////////////////
+class Profiler {
+
+private:
+    ProfileEvent root_;
+    ProfileEvent* current_;
+    bool enabled_;
+    bool fence_;
+
+    Profiler() : root_("root", ProfileCategory::user, nullptr), current_(&root_),
+                 enabled_(true), fence_(true) {}
+
+    static void flatten(const ProfileEvent& event, const std::string& prefix, int depth,
+                        std::vector<ProfileStats>& stats)
+    {
+        for (auto& child : event.children_) {
+            std::string path = prefix.empty() ? child->name_ : prefix + "|" + child->name_;
+            double self = child->self_time();
+            stats.push_back({path, child->category_, depth, 1, child->count_,
+                             child->total_time_, child->total_time_, child->total_time_,
+                             self, self, self});
+            flatten(*child, path, depth + 1, stats);
+        }
+    }
+
+    static void write_json_string(std::ostream& out, const std::string& str)
+    {
+        out << '"';
+        for (char c : str) {
+            if (c == '"' || c == '\\') out << '\\';
+            out << c;
+        }
+        out << '"';
+    }
+
+public:
+    static Profiler& instance()
+    {
+        static Profiler profiler;
+        return profiler;
+    }
+
+    // runtime switches, both on by default
+    void enable(bool on)     { enabled_ = on; }
+    bool is_enabled() const  { return enabled_; }
+
+    // fence before starting and stopping a timer so asynchronous
+    // device work is charged to the region that launched it
+    void set_fence(bool on)  { fence_ = on; }
+    bool fence_enabled() const { return fence_; }
+
+    void fence() const
+    {
+#ifdef HAVE_KOKKOS
+        if (fence_) Kokkos::fence();
+#endif
+    }
+
+    void push(const char* name, ProfileCategory category)
+    {
+        fence();
+        current_ = current_->child(name, category);
+#ifdef HAVE_KOKKOS
+        Kokkos::Profiling::pushRegion(current_->name_);
+#endif
+        current_->start();
+    }
+
+    void pop()
+    {
+        if (current_ == &root_) return;
+        fence();
+        current_->stop();
+#ifdef HAVE_KOKKOS
+        Kokkos::Profiling::popRegion();
+#endif
+        current_ = current_->parent_;
+    }
+
+    // discard every recorded time, must not be called inside a scope
+    void reset()
+    {
+        root_.children_.clear();
+        current_ = &root_;
+    }
+
+    // per-rank statistics of this process
+    std::vector<ProfileStats> local_stats() const
+    {
+        std::vector<ProfileStats> stats;
+        flatten(root_, "", 0, stats);
+        return stats;
+    }
+
+#ifdef HAVE_MPI
+    // min/max/avg of every event over the ranks of comm, the result is
+    // only meaningful on rank 0. Ranks may have recorded different trees,
+    // the union of all paths is reported.
+    std::vector<ProfileStats> reduce_stats(MPI_Comm comm) const
+    {
+        int rank, num_ranks;
+        MPI_Comm_rank(comm, &rank);
+        MPI_Comm_size(comm, &num_ranks);
+
+        std::vector<ProfileStats> local = local_stats();
+
+        // pack "category depth path\n" for every local event
+        std::string packed;
+        for (auto& s : local) {
+            packed += std::to_string(static_cast<int>(s.category)) + " " +
+                      std::to_string(s.depth) + " " + s.path + "\n";
+        }
+
+        // gather the paths on rank 0 and build their union in tree order
+        int length = static_cast<int>(packed.size());
+        std::vector<int> lengths(num_ranks), displs(num_ranks, 0);
+        MPI_Gather(&length, 1, MPI_INT, lengths.data(), 1, MPI_INT, 0, comm);
+
+        std::vector<char> all_packed;
+        if (rank == 0) {
+            for (int r = 1; r < num_ranks; r++) displs[r] = displs[r - 1] + lengths[r - 1];
+            all_packed.resize(displs[num_ranks - 1] + lengths[num_ranks - 1] + 1);
+        }
+        MPI_Gatherv(packed.data(), length, MPI_CHAR, all_packed.data(), lengths.data(),
+                    displs.data(), MPI_CHAR, 0, comm);
+
+        std::string merged;
+        if (rank == 0) {
+            // path components -> line, ordering by components keeps every
+            // child directly below its parent
+            std::map<std::vector<std::string>, std::string> lines;
+            size_t begin = 0;
+            std::string text(all_packed.data(), all_packed.size() - 1);
+            while (begin < text.size()) {
+                size_t end  = text.find('\n', begin);
+                std::string line = text.substr(begin, end - begin);
+                std::string path = line.substr(line.find(' ', line.find(' ') + 1) + 1);
+                std::vector<std::string> components;
+                size_t start = 0, bar;
+                while ((bar = path.find('|', start)) != std::string::npos) {
+                    components.push_back(path.substr(start, bar - start));
+                    start = bar + 1;
+                }
+                components.push_back(path.substr(start));
+                lines.emplace(components, line);
+                begin = end + 1;
+            }
+            for (auto& entry : lines) merged += entry.second + "\n";
+        }
+
+        // everyone needs the union to reduce in the same order
+        int merged_length = static_cast<int>(merged.size());
+        MPI_Bcast(&merged_length, 1, MPI_INT, 0, comm);
+        merged.resize(merged_length);
+        MPI_Bcast(&merged[0], merged_length, MPI_CHAR, 0, comm);
+
+        std::map<std::string, const ProfileStats*> lookup;
+        for (auto& s : local) lookup[s.path] = &s;
+
+        std::vector<ProfileStats> global;
+        size_t begin = 0;
+        while (begin < merged.size()) {
+            size_t end = merged.find('\n', begin);
+            std::string line = merged.substr(begin, end - begin);
+            size_t first  = line.find(' ');
+            size_t second = line.find(' ', first + 1);
+            ProfileStats s{};
+            s.category = static_cast<ProfileCategory>(std::stoi(line.substr(0, first)));
+            s.depth    = std::stoi(line.substr(first + 1, second - first - 1));
+            s.path     = line.substr(second + 1);
+            global.push_back(s);
+            begin = end + 1;
+        }
+
+        // [total, self] as min, max and sum plus the count and presence
+        size_t num = global.size();
+        std::vector<double> mins(2 * num), maxs(2 * num), sums(2 * num);
+        std::vector<double> counts(2 * num);
+        for (size_t i = 0; i < num; i++) {
+            auto found = lookup.find(global[i].path);
+            bool has = found != lookup.end();
+            double total = has ? found->second->total_avg : 0.0;
+            double self  = has ? found->second->self_avg : 0.0;
+            mins[2 * i] = has ? total : DBL_MAX;
+            mins[2 * i + 1] = has ? self : DBL_MAX;
+            maxs[2 * i] = total;
+            maxs[2 * i + 1] = self;
+            sums[2 * i] = total;
+            sums[2 * i + 1] = self;
+            counts[2 * i] = has ? static_cast<double>(found->second->count) : 0.0;
+            counts[2 * i + 1] = has ? 1.0 : 0.0;
+        }
+        MPI_Reduce(rank == 0 ? MPI_IN_PLACE : mins.data(), mins.data(), static_cast<int>(2 * num), MPI_DOUBLE, MPI_MIN, 0, comm);
+        MPI_Reduce(rank == 0 ? MPI_IN_PLACE : maxs.data(), maxs.data(), static_cast<int>(2 * num), MPI_DOUBLE, MPI_MAX, 0, comm);
+        MPI_Reduce(rank == 0 ? MPI_IN_PLACE : sums.data(), sums.data(), static_cast<int>(2 * num), MPI_DOUBLE, MPI_SUM, 0, comm);
+        MPI_Reduce(rank == 0 ? MPI_IN_PLACE : counts.data(), counts.data(), static_cast<int>(2 * num), MPI_DOUBLE, MPI_SUM, 0, comm);
+
+        for (size_t i = 0; i < num; i++) {
+            ProfileStats& s = global[i];
+            s.ranks = static_cast<int>(counts[2 * i + 1]);
+            s.count = static_cast<size_t>(counts[2 * i]);
+            double ranks = s.ranks > 0 ? s.ranks : 1.0;
+            s.total_min = mins[2 * i];
+            s.self_min  = mins[2 * i + 1];
+            s.total_max = maxs[2 * i];
+            s.self_max  = maxs[2 * i + 1];
+            s.total_avg = sums[2 * i] / ranks;
+            s.self_avg  = sums[2 * i + 1] / ranks;
+        }
+        return global;
+    }
+#endif
+
+    // JSON report, self times are also summed per category to give the
+    // compute/transfer/communication breakdown
+    static void write_json(std::ostream& out, const std::vector<ProfileStats>& stats)
+    {
+        double category_time[4] = {0.0, 0.0, 0.0, 0.0};
+        out << "{\n  \"events\": [\n";
+        for (size_t i = 0; i < stats.size(); i++) {
+            const ProfileStats& s = stats[i];
+            category_time[static_cast<int>(s.category)] += s.self_avg;
+            out << "    {\"path\": ";
+            write_json_string(out, s.path);
+            out << ", \"category\": \"" << profile_category_name(s.category) << "\""
+                << ", \"depth\": " << s.depth
+                << ", \"ranks\": " << s.ranks
+                << ", \"count\": " << s.count
+                << ", \"total_min\": " << s.total_min
+                << ", \"total_max\": " << s.total_max
+                << ", \"total_avg\": " << s.total_avg
+                << ", \"self_min\": " << s.self_min
+                << ", \"self_max\": " << s.self_max
+                << ", \"self_avg\": " << s.self_avg << "}"
+                << (i + 1 < stats.size() ? ",\n" : "\n");
+        }
+        out << "  ],\n  \"categories\": {";
+        for (int c = 0; c < 4; c++) {
+            out << "\"" << profile_category_name(static_cast<ProfileCategory>(c)) << "\": "
+                << category_time[c] << (c < 3 ? ", " : "");
+        }
+        out << "}\n}\n";
+    }
+
+    static void write_csv(std::ostream& out, const std::vector<ProfileStats>& stats)
+    {
+        out << "path,category,depth,ranks,count,total_min,total_max,total_avg,self_min,self_max,self_avg\n";
+        for (auto& s : stats) {
+            out << "\"" << s.path << "\"," << profile_category_name(s.category) << ","
+                << s.depth << "," << s.ranks << "," << s.count << ","
+                << s.total_min << "," << s.total_max << "," << s.total_avg << ","
+                << s.self_min << "," << s.self_max << "," << s.self_avg << "\n";
+        }
+    }
+
+    // human readable tree, one line per event
+    static void print(const std::vector<ProfileStats>& stats, std::ostream& out = std::cout)
+    {
+        char line[256];
+        snprintf(line, sizeof(line), "%-48s %-13s %10s %12s %12s %12s\n",
+                 "event", "category", "count", "avg [s]", "min [s]", "max [s]");
+        out << line;
+        for (auto& s : stats) {
+            std::string name = std::string(2 * s.depth, ' ') + s.path.substr(s.path.rfind('|') + 1);
+            snprintf(line, sizeof(line), "%-48s %-13s %10zu %12.6f %12.6f %12.6f\n",
+                     name.c_str(), profile_category_name(s.category), s.count,
+                     s.total_avg, s.total_min, s.total_max);
+            out << line;
+        }
+    }
+
+    // rank reduced statistics when MPI is running, local ones otherwise
+    std::vector<ProfileStats> stats() const
+    {
+#ifdef HAVE_MPI
+        int initialized = 0, finalized = 0;
+        MPI_Initialized(&initialized);
+        MPI_Finalized(&finalized);
+        if (initialized && !finalized) {
+            return reduce_stats(MPI_COMM_WORLD);
+        }
+#endif
+        return local_stats();
+    }
+
+    // write a report, the format follows the extension (.json or .csv).
+    // With MPI this is collective and only rank 0 writes the file.
+    void write(const std::string& filename) const
+    {
+        std::vector<ProfileStats> all = stats();
+
+        int rank = 0;
+#ifdef HAVE_MPI
+        int initialized = 0, finalized = 0;
+        MPI_Initialized(&initialized);
+        MPI_Finalized(&finalized);
+        if (initialized && !finalized) {
+            MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+        }
+#endif
+        if (rank != 0) return;
+
+        std::ofstream out(filename);
+        if (!out) {
+            std::cerr << "Profiler: unable to open " << filename << std::endl;
+            return;
+        }
+        bool csv = filename.size() >= 4 && filename.compare(filename.size() - 4, 4, ".csv") == 0;
+        if (csv) {
+            write_csv(out, all);
+        }
+        else {
+            write_json(out, all);
+        }
+    }
+}; // End of Profiler
+
+
+/////////////////////////
+// ProfileScope: RAII timer, nested scopes build the event tree.
+//
+//   {
+//       ProfileScope scope("assemble");
+//       ...
+//   }
+/////////////////////////
+class ProfileScope {
+
+private:
+    bool active_;
+
+public:
+    explicit ProfileScope(const char* name, ProfileCategory category = ProfileCategory::user)
+        : active_(Profiler::instance().is_enabled())
+    {
+        if (active_) Profiler::instance().push(name, category);
+    }
+
+    explicit ProfileScope(const std::string& name, ProfileCategory category = ProfileCategory::user)
+        : ProfileScope(name.c_str(), category) {}
+
+    ProfileScope(const ProfileScope&) = delete;
+    ProfileScope& operator=(const ProfileScope&) = delete;
+
+    ~ProfileScope()
+    {
+        if (active_) Profiler::instance().pop();
+    }
+}; // End of ProfileScope
+
+
+// host <-> device traffic of one array label
+struct TransferStats {
+    size_t to_host_bytes   = 0;
+    size_t to_device_bytes = 0;
+    size_t to_host_calls   = 0;
+    size_t to_device_calls = 0;
+    size_t skipped_calls   = 0; // updates that found nothing modified
+};
+
+
+/////////////////////////
+// TransferLog: counts the bytes and calls of every dual type update per
+// array label. Off by default, it is switched on by enable(true), by
+// building with MATAR_ENABLE_PROFILING or by setting the environment
+// variable MATAR_TRANSFER_LOG. The bytes are what the update asked to move,
+// on host only builds the two views alias and nothing is copied.
+/////////////////////////
+class TransferLog {
+
+private:
+    std::map<std::string, TransferStats> stats_;
+    bool enabled_;
+
+    TransferLog() : enabled_(false)
+    {
+#ifdef MATAR_ENABLE_PROFILING
+        enabled_ = true;
+#endif
+        if (getenv("MATAR_TRANSFER_LOG") != nullptr) {
+            enabled_ = true;
+        }
+    }
+
+public:
+    static TransferLog& instance()
+    {
+        static TransferLog log;
+        return log;
+    }
+
+    void enable(bool on)    { enabled_ = on; }
+    bool is_enabled() const { return enabled_; }
+
+    // record one update of view, bytes = 0 with skipped marks a no-op update
+    template <typename ViewT>
+    void record(const ViewT& view, bool to_host, size_t bytes, bool skipped = false)
+    {
+        if (!enabled_) return;
+
+        TransferStats& stats = stats_[view.label()];
+        if (skipped) {
+            stats.skipped_calls++;
+        }
+        else if (to_host) {
+            stats.to_host_bytes += bytes;
+            stats.to_host_calls++;
+        }
+        else {
+            stats.to_device_bytes += bytes;
+            stats.to_device_calls++;
+        }
+    }
+
+    // counters of one label, zero if it never moved
+    TransferStats get(const std::string& label) const
+    {
+        auto found = stats_.find(label);
+        return found == stats_.end() ? TransferStats() : found->second;
+    }
+
+    // counters summed over all labels
+    TransferStats total() const
+    {
+        TransferStats sum;
+        for (auto& entry : stats_) {
+            sum.to_host_bytes   += entry.second.to_host_bytes;
+            sum.to_device_bytes += entry.second.to_device_bytes;
+            sum.to_host_calls   += entry.second.to_host_calls;
+            sum.to_device_calls += entry.second.to_device_calls;
+            sum.skipped_calls   += entry.second.skipped_calls;
+        }
+        return sum;
+    }
+
+    const std::map<std::string, TransferStats>& all() const { return stats_; }
+
+    void reset() { stats_.clear(); }
+
+    void write_csv(std::ostream& out) const
+    {
+        out << "label,to_host_bytes,to_host_calls,to_device_bytes,to_device_calls,skipped_calls\n";
+        for (auto& entry : stats_) {
+            const TransferStats& s = entry.second;
+            out << "\"" << entry.first << "\"," << s.to_host_bytes << "," << s.to_host_calls << ","
+                << s.to_device_bytes << "," << s.to_device_calls << "," << s.skipped_calls << "\n";
+        }
+    }
+
+    // table sorted by label, heaviest traffic is easy to spot by eye
+    void print(std::ostream& out = std::cout) const
+    {
+        char line[256];
+        snprintf(line, sizeof(line), "%-32s %14s %8s %14s %8s %8s\n",
+                 "label", "to host [B]", "calls", "to device [B]", "calls", "skipped");
+        out << line;
+        for (auto& entry : stats_) {
+            const TransferStats& s = entry.second;
+            snprintf(line, sizeof(line), "%-32s %14zu %8zu %14zu %8zu %8zu\n",
+                     entry.first.c_str(), s.to_host_bytes, s.to_host_calls,
+                     s.to_device_bytes, s.to_device_calls, s.skipped_calls);
+            out << line;
+        }
+    }
+
+    // called by MATAR_FINALIZE, prints the table if anything was recorded
+    void finalize() const
+    {
+        if (!enabled_ || stats_.empty()) return;
+
+        int rank = 0;
+#ifdef HAVE_MPI
+        int initialized = 0, finalized = 0;
+        MPI_Initialized(&initialized);
+        MPI_Finalized(&finalized);
+        if (initialized && !finalized) {
+            MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+        }
+#endif
+        std::cout << "MATAR host/device transfers on rank " << rank << "\n";
+        print(std::cout);
+    }
+}; // End of TransferLog
+
+} // end namespace
+
+#endif // PROFILE_H
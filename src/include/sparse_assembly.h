@@ -0,0 +1,385 @@
+#ifndef SPARSE_ASSEMBLY_H
+#define SPARSE_ASSEMBLY_H
+/**********************************************************************************************
+ © 2020. Triad National Security, LLC. All rights reserved.
+ This program was produced under U.S. Government contract 89233218CNA000001 for Los Alamos
+ National Laboratory (LANL), which is operated by Triad National Security, LLC for the U.S.
+ Department of Energy/National Nuclear Security Administration. All rights in the program are
+ reserved by Triad National Security, LLC, and the U.S. Department of Energy/National Nuclear
+ Security Administration. The Government is granted for itself and others acting on its behalf a
+ nonexclusive, paid-up, irrevocable worldwide license in this material to reproduce, prepare
+ derivative works, distribute copies to the public, perform publicly and display publicly, and
+ to permit others to do so.
+ This program is open source under the BSD-3 License.
+ Redistribution and use in source and binary forms, with or without modification, are permitted
+ provided that the following conditions are met:
+ 
+ 1.  Redistributions of source code must retain the above copyright notice, this list of
+ conditions and the following disclaimer.
+ 
+ 2.  Redistributions in binary form must reproduce the above copyright notice, this list of
+ conditions and the following disclaimer in the documentation and/or other materials
+ provided with the distribution.
+ 
+ 3.  Neither the name of the copyright holder nor the names of its contributors may be used
+ to endorse or promote products derived from this software without specific prior
+ written permission.
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+ IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **********************************************************************************************/
+#include <stdexcept>
+#include <string>
+
+#include "host_types.h"
+#include "kokkos_types.h"
+#include "profile.h"
+
+
+// -----------------------------------------
+// Parallel assembly of sparse matrices from (row, column, value) triplets
+//
+//   SparseAssembler<double> assembler(num_nodes, num_nodes, 4*num_elems);
+//
+//   FOR_ALL(elem, 0, num_elems, {                 // any order, any thread
+//       for (int a = 0; a < 2; a++) {
+//           for (int b = 0; b < 2; b++) {
+//               assembler.add(node(elem, a), node(elem, b), k(elem, a, b));
+//           }
+//       }
+//   });
+//   CSRArrayKokkos<double> A = assembler.to_csr(); // sorted, duplicates summed
+//
+// Triplets go in with add(), which appends, or with insert(n, ...), which
+// writes slot n, for loops that know where each contribution goes. to_csr()
+// and to_csc() bucket them by row (column), sort each bucket and sum the
+// duplicates, all on the device. Duplicates are summed in triplet order,
+// so with insert() the values do not depend on the thread schedule.
+//
+// The returned matrix shares its values with the assembler. When the
+// pattern does not change, later steps skip the sort:
+//
+//   assembler.zero_values();
+//   FOR_ALL(elem, 0, num_elems, {
+//       ... assembler.sum_into(n, value);         // slot n of the first insert()
+//       ... assembler.sum_into(i, j, value);      // or by row and column
+//   });                                           // A holds the new values
+// -----------------------------------------
+
+namespace mtr
+{
+
+#ifdef HAVE_KOKKOS
+
+/////////////////////////
+// SparseAssembler:  COO triplets to CSRArrayKokkos or CSCArrayKokkos
+/////////////////////////
+template <typename T, typename Layout = DefaultLayout, typename ExecSpace = DefaultExecSpace, typename MemoryTraits = void>
+class SparseAssembler {
+
+    using IndexArray = CArrayKokkos<size_t, Layout, ExecSpace, MemoryTraits>;
+    using ValueArray = CArrayKokkos<T, Layout, ExecSpace, MemoryTraits>;
+
+private:
+    size_t dim1_ = 0;
+    size_t dim2_ = 0;
+    size_t capacity_ = 0;
+
+    // triplets
+    IndexArray rows_;
+    IndexArray cols_;
+    ValueArray vals_;
+    DCArrayKokkos<size_t> count_;   // triplets added, may pass the capacity
+
+    // pattern of the last to_csr() or to_csc()
+    bool   by_rows_ = true;
+    size_t nnz_     = 0;
+    IndexArray starts_;             // per row (column)
+    IndexArray index_;              // column (row) of every entry
+    ValueArray values_;
+    IndexArray slots_;              // entry each triplet was summed into
+
+    void compress(bool by_rows);
+
+public:
+    SparseAssembler();
+
+    // capacity is the largest number of triplets
+    SparseAssembler(size_t dim1, size_t dim2, size_t capacity);
+
+    // append a triplet, thread safe
+    KOKKOS_INLINE_FUNCTION
+    void add(size_t i, size_t j, T value) const;
+
+    // write triplet n, every slot below the highest one written has to be filled
+    KOKKOS_INLINE_FUNCTION
+    void insert(size_t n, size_t i, size_t j, T value) const;
+
+    // add to the entry triplet n went into, thread safe
+    KOKKOS_INLINE_FUNCTION
+    void sum_into(size_t n, T value) const;
+
+    // add to entry (i, j), thread safe, false when it is not in the pattern
+    KOKKOS_INLINE_FUNCTION
+    bool sum_into(size_t i, size_t j, T value) const;
+
+    // forget the triplets, the pattern is kept
+    void clear();
+
+    // zero the values of the pattern before summing into it again
+    void zero_values();
+
+    size_t num_triplets();
+
+    // entries of the last to_csr() or to_csc()
+    size_t nnz() const;
+
+    CSRArrayKokkos<T, Layout, ExecSpace, MemoryTraits> to_csr(const std::string& tag_string = DEFAULTSTRINGARRAY);
+
+    CSCArrayKokkos<T, Layout, ExecSpace, MemoryTraits> to_csc(const std::string& tag_string = DEFAULTSTRINGARRAY);
+
+}; // End of SparseAssembler
+
+template <typename T, typename Layout, typename ExecSpace, typename MemoryTraits>
+SparseAssembler<T,Layout,ExecSpace,MemoryTraits>::SparseAssembler() {}
+
+template <typename T, typename Layout, typename ExecSpace, typename MemoryTraits>
+SparseAssembler<T,Layout,ExecSpace,MemoryTraits>::SparseAssembler(size_t dim1, size_t dim2, size_t capacity)
+{
+    dim1_     = dim1;
+    dim2_     = dim2;
+    capacity_ = capacity;
+    rows_  = IndexArray(capacity > 0 ? capacity : 1, "assembly_rows");
+    cols_  = IndexArray(capacity > 0 ? capacity : 1, "assembly_cols");
+    vals_  = ValueArray(capacity > 0 ? capacity : 1, "assembly_vals");
+    count_ = DCArrayKokkos<size_t>(1, "assembly_count");
+    count_.set_values(0);
+}
+
+template <typename T, typename Layout, typename ExecSpace, typename MemoryTraits>
+KOKKOS_INLINE_FUNCTION
+void SparseAssembler<T,Layout,ExecSpace,MemoryTraits>::add(size_t i, size_t j, T value) const
+{
+    assert(i < dim1_ && "i is out of bounds in SparseAssembler add!");
+    assert(j < dim2_ && "j is out of bounds in SparseAssembler add!");
+    const size_t n = Kokkos::atomic_fetch_add(&count_(0), size_t(1));
+    if (n < capacity_) {
+        rows_(n) = i;
+        cols_(n) = j;
+        vals_(n) = value;
+    }
+}
+
+template <typename T, typename Layout, typename ExecSpace, typename MemoryTraits>
+KOKKOS_INLINE_FUNCTION
+void SparseAssembler<T,Layout,ExecSpace,MemoryTraits>::insert(size_t n, size_t i, size_t j, T value) const
+{
+    assert(n < capacity_ && "n is out of bounds in SparseAssembler insert!");
+    assert(i < dim1_ && "i is out of bounds in SparseAssembler insert!");
+    assert(j < dim2_ && "j is out of bounds in SparseAssembler insert!");
+    rows_(n) = i;
+    cols_(n) = j;
+    vals_(n) = value;
+    Kokkos::atomic_max(&count_(0), n + 1);
+}
+
+template <typename T, typename Layout, typename ExecSpace, typename MemoryTraits>
+KOKKOS_INLINE_FUNCTION
+void SparseAssembler<T,Layout,ExecSpace,MemoryTraits>::sum_into(size_t n, T value) const
+{
+    Kokkos::atomic_add(&values_(slots_(n)), value);
+}
+
+template <typename T, typename Layout, typename ExecSpace, typename MemoryTraits>
+KOKKOS_INLINE_FUNCTION
+bool SparseAssembler<T,Layout,ExecSpace,MemoryTraits>::sum_into(size_t i, size_t j, T value) const
+{
+    assert(i < dim1_ && "i is out of bounds in SparseAssembler sum_into!");
+    assert(j < dim2_ && "j is out of bounds in SparseAssembler sum_into!");
+    const size_t major = by_rows_ ? i : j;
+    const size_t minor = by_rows_ ? j : i;
+
+    // binary search of the sorted bucket
+    size_t lo = starts_(major);
+    size_t hi = starts_(major + 1);
+    while (lo < hi) {
+        const size_t mid = lo + (hi - lo) / 2;
+        if (index_(mid) < minor) {
+            lo = mid + 1;
+        }
+        else {
+            hi = mid;
+        }
+    }
+    if (lo == starts_(major + 1) || index_(lo) != minor) {
+        return false;
+    }
+    Kokkos::atomic_add(&values_(lo), value);
+    return true;
+}
+
+template <typename T, typename Layout, typename ExecSpace, typename MemoryTraits>
+void SparseAssembler<T,Layout,ExecSpace,MemoryTraits>::clear()
+{
+    count_.set_values(0);
+}
+
+template <typename T, typename Layout, typename ExecSpace, typename MemoryTraits>
+void SparseAssembler<T,Layout,ExecSpace,MemoryTraits>::zero_values()
+{
+    assert(nnz_ > 0 && "no pattern in SparseAssembler zero_values, call to_csr or to_csc first!");
+    values_.set_values(T(0));
+}
+
+template <typename T, typename Layout, typename ExecSpace, typename MemoryTraits>
+size_t SparseAssembler<T,Layout,ExecSpace,MemoryTraits>::num_triplets()
+{
+    count_.update_host();
+    return count_.host(0);
+}
+
+template <typename T, typename Layout, typename ExecSpace, typename MemoryTraits>
+size_t SparseAssembler<T,Layout,ExecSpace,MemoryTraits>::nnz() const
+{
+    return nnz_;
+}
+
+template <typename T, typename Layout, typename ExecSpace, typename MemoryTraits>
+void SparseAssembler<T,Layout,ExecSpace,MemoryTraits>::compress(bool by_rows)
+{
+    MATAR_PROFILE_SCOPE("SparseAssembler::compress", ProfileCategory::compute);
+    const size_t num = num_triplets();
+    if (num > capacity_) {
+        throw std::runtime_error("SparseAssembler: more triplets were added than the capacity");
+    }
+
+    // the bucket is the row for CSR and the column for CSC
+    const size_t dim = by_rows ? dim1_ : dim2_;
+    IndexArray major = by_rows ? rows_ : cols_;
+    IndexArray minor = by_rows ? cols_ : rows_;
+    ValueArray vals  = vals_;
+
+    IndexArray bucket_start(dim + 1, "assembly_bucket_start");
+    IndexArray fill(dim > 0 ? dim : 1, "assembly_fill");
+    IndexArray order(num > 0 ? num : 1, "assembly_order");
+    IndexArray starts(dim + 1, "assembly_starts");
+    IndexArray slots(num > 0 ? num : 1, "assembly_slots");
+
+    // counting sort of the triplets into buckets
+    bucket_start.set_values(0);
+    FOR_ALL(t, 0, num, {
+        Kokkos::atomic_add(&bucket_start(major(t) + 1), size_t(1));
+    });
+    Kokkos::parallel_scan("SparseAssemblerBuckets", dim + 1, KOKKOS_LAMBDA(const int i, size_t& update, const bool final) {
+        update += bucket_start(i);
+        if (final) {
+            bucket_start(i) = update;
+        }
+    });
+    FOR_ALL(i, 0, dim, {
+        fill(i) = bucket_start(i);
+    });
+    FOR_ALL(t, 0, num, {
+        const size_t pos = Kokkos::atomic_fetch_add(&fill(major(t)), size_t(1));
+        order(pos) = t;
+    });
+
+    // insertion sort of each bucket by (minor, triplet), then count the distinct entries
+    starts.set_values(0);
+    FOR_ALL(i, 0, dim, {
+        const size_t begin = bucket_start(i);
+        const size_t end   = bucket_start(i + 1);
+        for (size_t a = begin + 1; a < end; a++) {
+            const size_t t = order(a);
+            size_t b = a;
+            while (b > begin && (minor(order(b - 1)) > minor(t) ||
+                                 (minor(order(b - 1)) == minor(t) && order(b - 1) > t))) {
+                order(b) = order(b - 1);
+                b--;
+            }
+            order(b) = t;
+        }
+
+        size_t distinct = 0;
+        for (size_t a = begin; a < end; a++) {
+            if (a == begin || minor(order(a)) != minor(order(a - 1))) {
+                distinct++;
+            }
+        }
+        starts(i + 1) = distinct;
+    });
+
+    size_t nnz = 0;
+    size_t loc_nnz;
+    FOR_REDUCE_SUM(i, 0, dim, loc_nnz, {
+        loc_nnz += starts(i + 1);
+    }, nnz);
+    Kokkos::parallel_scan("SparseAssemblerStarts", dim + 1, KOKKOS_LAMBDA(const int i, size_t& update, const bool final) {
+        update += starts(i);
+        if (final) {
+            starts(i) = update;
+        }
+    });
+
+    // sum the duplicates in triplet order
+    IndexArray index(nnz > 0 ? nnz : 1, "assembly_index");
+    ValueArray values(nnz > 0 ? nnz : 1, "assembly_values");
+    FOR_ALL(i, 0, dim, {
+        const size_t begin = bucket_start(i);
+        size_t slot = starts(i);
+        for (size_t a = begin; a < bucket_start(i + 1); a++) {
+            const size_t t = order(a);
+            const bool first = (a == begin) || minor(t) != minor(order(a - 1));
+            if (first && a != begin) {
+                slot++;
+            }
+            if (first) {
+                index(slot)  = minor(t);
+                values(slot) = vals(t);
+            }
+            else {
+                values(slot) += vals(t);
+            }
+            slots(t) = slot;
+        }
+    });
+
+    by_rows_ = by_rows;
+    nnz_     = nnz;
+    starts_  = starts;
+    index_   = index;
+    values_  = values;
+    slots_   = slots;
+}
+
+template <typename T, typename Layout, typename ExecSpace, typename MemoryTraits>
+CSRArrayKokkos<T, Layout, ExecSpace, MemoryTraits>
+SparseAssembler<T,Layout,ExecSpace,MemoryTraits>::to_csr(const std::string& tag_string)
+{
+    compress(true);
+    return CSRArrayKokkos<T, Layout, ExecSpace, MemoryTraits>(values_, starts_, index_, dim1_, dim2_, tag_string);
+}
+
+template <typename T, typename Layout, typename ExecSpace, typename MemoryTraits>
+CSCArrayKokkos<T, Layout, ExecSpace, MemoryTraits>
+SparseAssembler<T,Layout,ExecSpace,MemoryTraits>::to_csc(const std::string& tag_string)
+{
+    compress(false);
+    return CSCArrayKokkos<T, Layout, ExecSpace, MemoryTraits>(values_, starts_, index_, dim1_, dim2_, tag_string);
+}
+
+// End of SparseAssembler
+
+#endif // HAVE_KOKKOS
+
+} // end namespace mtr
+
+#endif // SPARSE_ASSEMBLY_H
@@ -0,0 +1,526 @@
+#ifndef STENCIL_H
+#define STENCIL_H
+/**********************************************************************************************
+ © 2020. Triad National Security, LLC. All rights reserved.
+ This program was produced under U.S. Government contract 89233218CNA000001 for Los Alamos
+ National Laboratory (LANL), which is operated by Triad National Security, LLC for the U.S.
+ Department of Energy/National Nuclear Security Administration. All rights in the program are
+ reserved by Triad National Security, LLC, and the U.S. Department of Energy/National Nuclear
+ Security Administration. The Government is granted for itself and others acting on its behalf a
+ nonexclusive, paid-up, irrevocable worldwide license in this material to reproduce, prepare
+ derivative works, distribute copies to the public, perform publicly and display publicly, and
+ to permit others to do so.
+ This program is open source under the BSD-3 License.
+ Redistribution and use in source and binary forms, with or without modification, are permitted
+ provided that the following conditions are met:
+ 
+ 1.  Redistributions of source code must retain the above copyright notice, this list of
+ conditions and the following disclaimer.
+ 
+ 2.  Redistributions in binary form must reproduce the above copyright notice, this list of
+ conditions and the following disclaimer in the documentation and/or other materials
+ provided with the distribution.
+ 
+ 3.  Neither the name of the copyright holder nor the names of its contributors may be used
+ to endorse or promote products derived from this software without specific prior
+ written permission.
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+ IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **********************************************************************************************/
+#include <string>
+
+#include "host_types.h"
+#include "kokkos_types.h"
+#include "profile.h"
+
+
+// -----------------------------------------
+// Stencils on structured grids
+//
+//   StencilShape shape;                         // radius 1, fixed ghost values
+//   StencilGrid<double, 2> grid(shape, height, width, "temperature");
+//
+//   auto u = grid.current();                    // set the interior and ghosts,
+//   FOR_ALL(i, 0, height + 2,                   // interior is [1, height+1)
+//           j, 0, width + 2, { u(i, j) = ...; });
+//
+//   Laplace stencil;                            // functor, see below
+//   while (grid.sweep(stencil) > tolerance) {}  // one sweep per pass, or
+//   grid.sweep(stencil, 100, 4);                // 100 sweeps, 4 per pass
+//
+// The stencil is a functor, or a generic lambda, that returns the new value of
+// point (i, j) or (i, j, k) from the old field u:
+//
+//   struct Laplace {
+//       template <typename Field>
+//       KOKKOS_INLINE_FUNCTION
+//       double operator()(const Field& u, const int i, const int j) const {
+//           return 0.25*(u(i+1, j) + u(i-1, j) + u(i, j+1) + u(i, j-1));
+//       }
+//   };
+//
+// The grid holds two padded arrays and swaps them after a sweep, so there is
+// no copy of the old field, and the largest change of a sweep is reduced in
+// the same pass as the update.
+//
+// sweep(fcn, n, per_pass) does per_pass sweeps per pass over memory with
+// overlapped tiles: a team loads a tile plus per_pass*radius layers into
+// scratch memory, sweeps it there, and writes back only the tile. The extra
+// work on the overlap is paid once per pass instead of a trip to memory per
+// sweep. It needs fixed ghost values, other ghost kinds sweep one at a time.
+// -----------------------------------------
+
+namespace mtr
+{
+
+#ifdef HAVE_KOKKOS
+
+// how the ghost layers are filled before a sweep
+enum class GhostKind {
+    fixed,          // set by the user once, e.g. Dirichlet values
+    periodic,       // copied from the other side of the interior
+    zero_gradient   // copied from the nearest interior point
+};
+
+struct StencilShape {
+    size_t    radius = 1;                 // reach of the stencil, also the ghost layer width
+    GhostKind ghosts = GhostKind::fixed;
+};
+
+// tile of a grid in scratch memory, indexed with the grid indices
+template <typename T, size_t Rank>
+struct StencilTile {
+    T*  data_;
+    int origin_[3];
+    int extent_[3];
+
+    KOKKOS_INLINE_FUNCTION
+    T& operator()(const int i, const int j) const {
+        return data_[(i - origin_[0])*extent_[1] + (j - origin_[1])];
+    }
+
+    KOKKOS_INLINE_FUNCTION
+    T& operator()(const int i, const int j, const int k) const {
+        return data_[((i - origin_[0])*extent_[1] + (j - origin_[1]))*extent_[2] + (k - origin_[2])];
+    }
+};
+
+
+/////////////////////////
+// StencilGrid:  ping-pong pair of padded 2D or 3D arrays with ghost layers
+/////////////////////////
+template <typename T, size_t Rank, typename Layout = DefaultLayout, typename ExecSpace = DefaultExecSpace, typename MemoryTraits = void>
+class StencilGrid {
+
+    static_assert(Rank == 2 || Rank == 3, "StencilGrid is for 2D and 3D grids!");
+
+    using Field = CArrayKokkos<T, Layout, ExecSpace, MemoryTraits>;
+
+private:
+    Field  buffer_[2];
+    size_t current_;
+    size_t dims_[3];   // interior points
+    size_t tile_;      // tile width for the blocked sweeps
+    StencilShape shape_;
+
+    // copy the ghost layers, or fill them from the interior of the current field
+    void update_ghosts();
+
+    template <typename Stencil>
+    T blocked_pass(const Stencil& fcn, size_t num_sweeps);
+
+public:
+    StencilGrid();
+
+    StencilGrid(const StencilShape& shape, size_t dim0, size_t dim1,
+                const std::string& tag_string = DEFAULTSTRINGARRAY);
+
+    StencilGrid(const StencilShape& shape, size_t dim0, size_t dim1, size_t dim2,
+                const std::string& tag_string = DEFAULTSTRINGARRAY);
+
+    // the newest field and the one before it, padded by radius ghost layers,
+    // the interior is [radius, dims(i) + radius)
+    Field& current();
+
+    Field& previous();
+
+    // number of interior points
+    size_t dims(size_t i) const;
+
+    size_t radius() const;
+
+    // tile width of the blocked sweeps, default 32 in 2D and 8 in 3D
+    void set_tile(size_t tile);
+
+    void swap();
+
+    // one sweep, returns the largest change |new - old| over the interior
+    template <typename Stencil>
+    T sweep(const Stencil& fcn);
+
+    // num_sweeps sweeps, sweeps_per_pass at a time in scratch memory,
+    // returns the largest change of the last sweep
+    template <typename Stencil>
+    T sweep(const Stencil& fcn, size_t num_sweeps, size_t sweeps_per_pass);
+
+}; // End of StencilGrid
+
+template <typename T, size_t Rank, typename Layout, typename ExecSpace, typename MemoryTraits>
+StencilGrid<T, Rank, Layout, ExecSpace, MemoryTraits>::StencilGrid()
+{
+    current_ = 0;
+    tile_    = 0;
+    dims_[0] = dims_[1] = dims_[2] = 0;
+}
+
+template <typename T, size_t Rank, typename Layout, typename ExecSpace, typename MemoryTraits>
+StencilGrid<T, Rank, Layout, ExecSpace, MemoryTraits>::StencilGrid(const StencilShape& shape, size_t dim0, size_t dim1,
+                                                                  const std::string& tag_string)
+{
+    static_assert(Rank == 2, "this StencilGrid constructor is for 2D grids!");
+    shape_   = shape;
+    current_ = 0;
+    tile_    = 32;
+    dims_[0] = dim0;
+    dims_[1] = dim1;
+    dims_[2] = 1;
+
+    const size_t pad = 2 * shape_.radius;
+    buffer_[0] = Field(dim0 + pad, dim1 + pad, tag_string + "_0");
+    buffer_[1] = Field(dim0 + pad, dim1 + pad, tag_string + "_1");
+}
+
+template <typename T, size_t Rank, typename Layout, typename ExecSpace, typename MemoryTraits>
+StencilGrid<T, Rank, Layout, ExecSpace, MemoryTraits>::StencilGrid(const StencilShape& shape, size_t dim0, size_t dim1, size_t dim2,
+                                                                  const std::string& tag_string)
+{
+    static_assert(Rank == 3, "this StencilGrid constructor is for 3D grids!");
+    shape_   = shape;
+    current_ = 0;
+    tile_    = 8;
+    dims_[0] = dim0;
+    dims_[1] = dim1;
+    dims_[2] = dim2;
+
+    const size_t pad = 2 * shape_.radius;
+    buffer_[0] = Field(dim0 + pad, dim1 + pad, dim2 + pad, tag_string + "_0");
+    buffer_[1] = Field(dim0 + pad, dim1 + pad, dim2 + pad, tag_string + "_1");
+}
+
+template <typename T, size_t Rank, typename Layout, typename ExecSpace, typename MemoryTraits>
+CArrayKokkos<T, Layout, ExecSpace, MemoryTraits>& StencilGrid<T, Rank, Layout, ExecSpace, MemoryTraits>::current()
+{
+    return buffer_[current_];
+}
+
+template <typename T, size_t Rank, typename Layout, typename ExecSpace, typename MemoryTraits>
+CArrayKokkos<T, Layout, ExecSpace, MemoryTraits>& StencilGrid<T, Rank, Layout, ExecSpace, MemoryTraits>::previous()
+{
+    return buffer_[1 - current_];
+}
+
+template <typename T, size_t Rank, typename Layout, typename ExecSpace, typename MemoryTraits>
+size_t StencilGrid<T, Rank, Layout, ExecSpace, MemoryTraits>::dims(size_t i) const
+{
+    assert(i < Rank && "i is out of bounds in StencilGrid dims!");
+    return dims_[i];
+}
+
+template <typename T, size_t Rank, typename Layout, typename ExecSpace, typename MemoryTraits>
+size_t StencilGrid<T, Rank, Layout, ExecSpace, MemoryTraits>::radius() const
+{
+    return shape_.radius;
+}
+
+template <typename T, size_t Rank, typename Layout, typename ExecSpace, typename MemoryTraits>
+void StencilGrid<T, Rank, Layout, ExecSpace, MemoryTraits>::set_tile(size_t tile)
+{
+    assert(tile > 0 && "StencilGrid tile must be positive!");
+    tile_ = tile;
+}
+
+template <typename T, size_t Rank, typename Layout, typename ExecSpace, typename MemoryTraits>
+void StencilGrid<T, Rank, Layout, ExecSpace, MemoryTraits>::swap()
+{
+    current_ = 1 - current_;
+}
+
+template <typename T, size_t Rank, typename Layout, typename ExecSpace, typename MemoryTraits>
+void StencilGrid<T, Rank, Layout, ExecSpace, MemoryTraits>::update_ghosts()
+{
+    const int g = static_cast<int>(shape_.radius);
+    if (g == 0) {
+        return;
+    }
+
+    Field cur  = buffer_[current_];
+    Field next = buffer_[1 - current_];
+    const GhostKind kind = shape_.ghosts;
+    const int n[3] = {static_cast<int>(dims_[0]), static_cast<int>(dims_[1]), static_cast<int>(dims_[2])};
+    const int padded[3] = {n[0] + 2*g, n[1] + 2*g, Rank == 3 ? n[2] + 2*g : 1};
+
+    // one face pair at a time, the 2*g ghost layers of dimension d over the
+    // whole padded extent of the others, so the corners come out right
+    for (size_t d = 0; d < Rank; d++) {
+        const int nd = n[d];
+        int extent[3] = {padded[0], padded[1], padded[2]};
+        extent[d] = 2*g;
+
+        // a ghost index and the interior index it is filled from
+        auto ghost_index = [=] KOKKOS_FUNCTION (const int c) -> int {
+            return c < g ? c : c + nd;
+        };
+        auto source_index = [=] KOKKOS_FUNCTION (const int c) -> int {
+            if (kind == GhostKind::periodic) {
+                return g + ((c - g) % nd + nd) % nd;
+            }
+            return c < g ? g : g + nd - 1;  // zero gradient
+        };
+
+        if constexpr (Rank == 2) {
+            Kokkos::parallel_for("StencilGhosts", Kokkos::MDRangePolicy<ExecSpace, Kokkos::Rank<2>>({0, 0}, {extent[0], extent[1]}),
+                                 KOKKOS_LAMBDA(const int a, const int b) {
+                int idx[2] = {a, b};
+                idx[d] = ghost_index(idx[d]);
+                if (kind == GhostKind::fixed) {
+                    next(idx[0], idx[1]) = cur(idx[0], idx[1]);
+                }
+                else {
+                    int src[2] = {idx[0], idx[1]};
+                    src[d] = source_index(idx[d]);
+                    cur(idx[0], idx[1]) = cur(src[0], src[1]);
+                }
+            });
+        }
+        else {
+            Kokkos::parallel_for("StencilGhosts", Kokkos::MDRangePolicy<ExecSpace, Kokkos::Rank<3>>({0, 0, 0}, {extent[0], extent[1], extent[2]}),
+                                 KOKKOS_LAMBDA(const int a, const int b, const int c) {
+                int idx[3] = {a, b, c};
+                idx[d] = ghost_index(idx[d]);
+                if (kind == GhostKind::fixed) {
+                    next(idx[0], idx[1], idx[2]) = cur(idx[0], idx[1], idx[2]);
+                }
+                else {
+                    int src[3] = {idx[0], idx[1], idx[2]};
+                    src[d] = source_index(idx[d]);
+                    cur(idx[0], idx[1], idx[2]) = cur(src[0], src[1], src[2]);
+                }
+            });
+        }
+    }
+}
+
+template <typename T, size_t Rank, typename Layout, typename ExecSpace, typename MemoryTraits>
+template <typename Stencil>
+T StencilGrid<T, Rank, Layout, ExecSpace, MemoryTraits>::sweep(const Stencil& fcn)
+{
+    MATAR_PROFILE_SCOPE("StencilGrid::sweep", ProfileCategory::compute);
+    update_ghosts();
+
+    Field cur  = buffer_[current_];
+    Field next = buffer_[1 - current_];
+    const int g = static_cast<int>(shape_.radius);
+    const int e0 = g + static_cast<int>(dims_[0]);
+    const int e1 = g + static_cast<int>(dims_[1]);
+    const int e2 = g + static_cast<int>(dims_[2]);
+
+    // update and largest change in one pass
+    T change = T(0);
+    if constexpr (Rank == 2) {
+        Kokkos::parallel_reduce("StencilSweep", Kokkos::MDRangePolicy<ExecSpace, Kokkos::Rank<2>>({g, g}, {e0, e1}),
+                                KOKKOS_LAMBDA(const int i, const int j, T& local_change) {
+            const T value = fcn(cur, i, j);
+            const T old   = cur(i, j);
+            next(i, j) = value;
+            const T diff = value > old ? value - old : old - value;
+            local_change = diff > local_change ? diff : local_change;
+        }, Kokkos::Max<T>(change));
+    }
+    else {
+        Kokkos::parallel_reduce("StencilSweep", Kokkos::MDRangePolicy<ExecSpace, Kokkos::Rank<3>>({g, g, g}, {e0, e1, e2}),
+                                KOKKOS_LAMBDA(const int i, const int j, const int k, T& local_change) {
+            const T value = fcn(cur, i, j, k);
+            const T old   = cur(i, j, k);
+            next(i, j, k) = value;
+            const T diff = value > old ? value - old : old - value;
+            local_change = diff > local_change ? diff : local_change;
+        }, Kokkos::Max<T>(change));
+    }
+
+    current_ = 1 - current_;
+    return change;
+}
+
+template <typename T, size_t Rank, typename Layout, typename ExecSpace, typename MemoryTraits>
+template <typename Stencil>
+T StencilGrid<T, Rank, Layout, ExecSpace, MemoryTraits>::sweep(const Stencil& fcn, size_t num_sweeps, size_t sweeps_per_pass)
+{
+    T change = T(0);
+    size_t done = 0;
+    while (done < num_sweeps) {
+        const size_t left = num_sweeps - done;
+        if (shape_.ghosts != GhostKind::fixed || sweeps_per_pass <= 1 || left == 1) {
+            change = sweep(fcn);
+            done++;
+        }
+        else {
+            const size_t depth = sweeps_per_pass < left ? sweeps_per_pass : left;
+            change = blocked_pass(fcn, depth);
+            done += depth;
+        }
+    }
+    return change;
+}
+
+template <typename T, size_t Rank, typename Layout, typename ExecSpace, typename MemoryTraits>
+template <typename Stencil>
+T StencilGrid<T, Rank, Layout, ExecSpace, MemoryTraits>::blocked_pass(const Stencil& fcn, size_t num_sweeps)
+{
+    MATAR_PROFILE_SCOPE("StencilGrid::blocked_pass", ProfileCategory::compute);
+    update_ghosts();
+
+    using team_t = typename Kokkos::TeamPolicy<ExecSpace>::member_type;
+
+    Field cur  = buffer_[current_];
+    Field next = buffer_[1 - current_];
+    const int r     = static_cast<int>(shape_.radius);
+    const int g     = r;
+    const int steps = static_cast<int>(num_sweeps);
+    const int halo  = r * steps;
+    const int tile  = static_cast<int>(tile_);
+    const int n[3]  = {static_cast<int>(dims_[0]), static_cast<int>(dims_[1]), Rank == 3 ? static_cast<int>(dims_[2]) : 1};
+
+    int num_tiles[3] = {1, 1, 1};
+    size_t tile_cells = 1;
+    for (size_t d = 0; d < Rank; d++) {
+        num_tiles[d] = (n[d] + tile - 1) / tile;
+        tile_cells *= static_cast<size_t>(tile + 2*halo);
+    }
+    const int league = num_tiles[0] * num_tiles[1] * num_tiles[2];
+
+    // two copies of a tile and its halo, in fast scratch memory when it fits
+    const size_t scratch_bytes = 2 * tile_cells * sizeof(T);
+    const int level = scratch_bytes <= 32768 ? 0 : 1;
+    Kokkos::TeamPolicy<ExecSpace> policy(league, Kokkos::AUTO);
+    policy.set_scratch_size(level, Kokkos::PerTeam(scratch_bytes));
+
+    T change = T(0);
+    Kokkos::parallel_reduce("StencilBlockedPass", policy, KOKKOS_LAMBDA(const team_t& team, T& team_change) {
+        // output tile, the region loaded with its halo, in grid indices
+        int t = team.league_rank();
+        int tile_id[3];
+        tile_id[2] = t % num_tiles[2];
+        t /= num_tiles[2];
+        tile_id[1] = t % num_tiles[1];
+        tile_id[0] = t / num_tiles[1];
+
+        int lo[3] = {0, 0, 0};
+        int hi[3] = {1, 1, 1};
+        int load_lo[3] = {0, 0, 0};
+        int width[3] = {1, 1, 1};
+        for (size_t d = 0; d < Rank; d++) {
+            lo[d] = g + tile_id[d]*tile;
+            hi[d] = lo[d] + tile < g + n[d] ? lo[d] + tile : g + n[d];
+            load_lo[d] = lo[d] - halo > 0 ? lo[d] - halo : 0;
+            const int load_hi = hi[d] + halo < n[d] + 2*g ? hi[d] + halo : n[d] + 2*g;
+            width[d] = load_hi - load_lo[d];
+        }
+        const int load_cells = width[0]*width[1]*width[2];
+
+        T* scratch = static_cast<T*>(team.team_scratch(level).get_shmem(scratch_bytes));
+        StencilTile<T, Rank> src = {scratch, {load_lo[0], load_lo[1], load_lo[2]}, {width[0], width[1], width[2]}};
+        StencilTile<T, Rank> dst = {scratch + tile_cells, {load_lo[0], load_lo[1], load_lo[2]}, {width[0], width[1], width[2]}};
+
+        // both copies get the ghosts, they are never updated
+        Kokkos::parallel_for(Kokkos::TeamThreadRange(team, load_cells), [&](const int c) {
+            const int i = load_lo[0] + c / (width[1]*width[2]);
+            const int j = load_lo[1] + (c / width[2]) % width[1];
+            const int k = load_lo[2] + c % width[2];
+            if constexpr (Rank == 2) {
+                src(i, j) = cur(i, j);
+                dst(i, j) = cur(i, j);
+            }
+            else {
+                src(i, j, k) = cur(i, j, k);
+                dst(i, j, k) = cur(i, j, k);
+            }
+        });
+        team.team_barrier();
+
+        // each sweep updates a region radius smaller, the last one is the tile
+        T tile_change = T(0);
+        for (int s = 1; s <= steps; s++) {
+            const int grow = r*(steps - s);
+            int u_lo[3] = {0, 0, 0};
+            int u_width[3] = {1, 1, 1};
+            for (size_t d = 0; d < Rank; d++) {
+                u_lo[d] = lo[d] - grow > g ? lo[d] - grow : g;
+                const int u_hi = hi[d] + grow < g + n[d] ? hi[d] + grow : g + n[d];
+                u_width[d] = u_hi - u_lo[d];
+            }
+            const int cells = u_width[0]*u_width[1]*u_width[2];
+
+            if (s < steps) {
+                Kokkos::parallel_for(Kokkos::TeamThreadRange(team, cells), [&](const int c) {
+                    const int i = u_lo[0] + c / (u_width[1]*u_width[2]);
+                    const int j = u_lo[1] + (c / u_width[2]) % u_width[1];
+                    const int k = u_lo[2] + c % u_width[2];
+                    if constexpr (Rank == 2) {
+                        dst(i, j) = fcn(src, i, j);
+                    }
+                    else {
+                        dst(i, j, k) = fcn(src, i, j, k);
+                    }
+                });
+            }
+            else {
+                // the last sweep goes straight to the next field
+                Kokkos::parallel_reduce(Kokkos::TeamThreadRange(team, cells), [&](const int c, T& local_change) {
+                    const int i = u_lo[0] + c / (u_width[1]*u_width[2]);
+                    const int j = u_lo[1] + (c / u_width[2]) % u_width[1];
+                    const int k = u_lo[2] + c % u_width[2];
+                    T value, old;
+                    if constexpr (Rank == 2) {
+                        value = fcn(src, i, j);
+                        old   = src(i, j);
+                        next(i, j) = value;
+                    }
+                    else {
+                        value = fcn(src, i, j, k);
+                        old   = src(i, j, k);
+                        next(i, j, k) = value;
+                    }
+                    const T diff = value > old ? value - old : old - value;
+                    local_change = diff > local_change ? diff : local_change;
+                }, Kokkos::Max<T>(tile_change));
+            }
+            team.team_barrier();
+
+            StencilTile<T, Rank> temp = src;
+            src = dst;
+            dst = temp;
+        }
+
+        team_change = tile_change > team_change ? tile_change : team_change;
+    }, Kokkos::Max<T>(change));
+
+    current_ = 1 - current_;
+    return change;
+}
+
+// End of StencilGrid
+
+#endif // HAVE_KOKKOS
+
+} // end namespace
+
+#endif // STENCIL_H
@@ -299,3 +299,111 @@ TEST(Test_CArrayKokkos, different_types)
         EXPECT_TRUE(A_bool(i));
     }
 }
+
+// Test the loop index selection used for large arrays
+TEST(Test_CArrayKokkos, loop_index)
+{
+    EXPECT_TRUE(matar_index_fits_int(0, 100));
+    EXPECT_TRUE(matar_index_fits_int(size_t(0), size_t(INT_MAX) - 1));
+    EXPECT_FALSE(matar_index_fits_int(size_t(0), size_t(1) << 32));
+    EXPECT_FALSE(matar_index_fits_int(0, INT_MAX));
+
+    // bounds of a different type than int still select the int path
+    const size_t size = 100;
+    CArrayKokkos<double> A(size, "A");
+    FOR_ALL(i, 0, size, {
+        A(i) = i;
+    });
+
+    double sum = 0.0;
+    double lsum;
+    FOR_REDUCE_SUM(i, 0, size, lsum, {
+        lsum += A(i);
+    }, sum);
+    EXPECT_EQ(sum, 4950.0);
+}
+
+// Test summing contributions from many iterations into shared entries
+TEST(Test_CArrayKokkos, scatter_add)
+{
+    const int num_corners = 40;
+    CArrayKokkos<double> node_force(10, 2, "node_force");
+    node_force.set_values(1.0);
+
+    ScatterArrayKokkos<double> scatter(node_force);
+    FOR_ALL(corner, 0, num_corners, {
+        scatter.contribute(corner % 10, 0, 1.0);
+        scatter.contribute(corner % 10, 1, 0.5);
+    });
+    scatter.merge();
+
+    for (int node = 0; node < 10; node++) {
+        EXPECT_DOUBLE_EQ(node_force(node, 0), 5.0);
+        EXPECT_DOUBLE_EQ(node_force(node, 1), 3.0);
+    }
+
+    // a merged scatter array starts from zero again
+    FOR_ALL(corner, 0, num_corners, {
+        scatter.contribute(corner % 10, 0, 1.0);
+    });
+    scatter.merge();
+    EXPECT_DOUBLE_EQ(node_force(3, 0), 9.0);
+
+    // histogram into a dual array
+    DCArrayKokkos<int> hist(4, "hist");
+    hist.set_values(0);
+    ScatterArrayKokkos<int> bins(hist);
+    FOR_ALL(i, 0, 100, {
+        bins.contribute(i % 4, 1);
+    });
+    bins.merge();
+    hist.update_host();
+    EXPECT_EQ(hist.host(2), 25);
+}
+
+// Test slices and strided sub-views inside a kernel
+TEST(Test_CArrayKokkos, slice_subview)
+{
+    const int size = 6;
+    CArrayKokkos<double> A(size, size, size, "A");
+    CArrayKokkos<double> B(size, 3, "B");
+
+    FOR_ALL(i, 0, size,
+            j, 0, size,
+            k, 0, size, {
+        A(i, j, k) = 100.0 * i + 10.0 * j + k;
+    });
+
+    // per element sub-block operations without temporaries
+    FOR_ALL(i, 0, size, {
+        ViewCArrayKokkos<double> plane = A.slice(i);          // A(i, :, :)
+        ViewStridedArrayKokkos<double> diag_cols = A.subview(i, Range{}, Range{0, size, 2});
+        B(i, 0) = plane(2, 3);
+        B(i, 1) = diag_cols(4, 1);                            // A(i, 4, 2)
+        B(i, 2) = diag_cols.subview(Range{1, 3}, 2)(1);       // A(i, 2, 4)
+    });
+
+    double total = 0.0;
+    double total_loc;
+    FOR_REDUCE_SUM(i, 0, size, total_loc, {
+        total_loc += (B(i, 0) - (100.0 * i + 23.0))
+                   + (B(i, 1) - (100.0 * i + 42.0))
+                   + (B(i, 2) - (100.0 * i + 24.0));
+    }, total);
+    EXPECT_DOUBLE_EQ(total, 0.0);
+
+    ViewStridedArrayKokkos<double> column = A.subview(Range{}, 1, 5);
+    EXPECT_EQ(column.order(), 1);
+    EXPECT_EQ(column.dims(0), size);
+    EXPECT_EQ(column.stride(0), size * size);
+    EXPECT_FALSE(column.is_contiguous());
+    EXPECT_TRUE(A.subview(2, Range{}, Range{}).is_contiguous());
+
+    column.set_values(-1.0);
+    double count = 0.0;
+    double count_loc;
+    FOR_REDUCE_SUM(i, 0, size, count_loc, {
+        count_loc += A(i, 1, 5) + A(i, 1, 4);
+    }, count);
+    EXPECT_DOUBLE_EQ(count, -size + (100.0 * size * (size - 1) / 2 + 14.0 * size));
+}
@@ -0,0 +1,111 @@
+#include "matar.h"
+#include "gtest/gtest.h"
+#include <stdio.h>
+
+using namespace mtr; // matar namespace
+
+
+// Test the blocked storage order and the padding
+TEST(Test_CArrayVec, layout)
+{
+    CArrayVec<double, 4> A(10, 3, "A");
+
+    EXPECT_EQ(A.num_packs(), 3);
+    EXPECT_EQ(A.size(), 30);
+    EXPECT_EQ(A.dims(0), 10);
+    EXPECT_EQ(A.dims(1), 3);
+    EXPECT_EQ(A.order(), 2);
+    EXPECT_EQ(A.get_name(), "A");
+    EXPECT_EQ(A.get_kokkos_view().extent(0), 36);
+
+    CArray<double> host(10, 3);
+    for (int i = 0; i < 10; i++) {
+        for (int d = 0; d < 3; d++) {
+            host(i, d) = 10.0 * i + d;
+        }
+    }
+    A.copy_from(host);
+
+    auto view = Kokkos::create_mirror_view(A.get_kokkos_view());
+    Kokkos::deep_copy(view, A.get_kokkos_view());
+
+    // vector 5 is lane 1 of pack 1
+    EXPECT_DOUBLE_EQ(view((1 * 3 + 2) * 4 + 1), 52.0);
+    // lanes of the last pack past dim0 stay zero
+    EXPECT_DOUBLE_EQ(view((2 * 3 + 0) * 4 + 3), 0.0);
+
+    CArray<double> back(10, 3);
+    A.copy_to(back);
+    for (int i = 0; i < 10; i++) {
+        for (int d = 0; d < 3; d++) {
+            EXPECT_DOUBLE_EQ(back(i, d), host(i, d));
+        }
+    }
+}
+
+// Test a pack wise update against the element wise one
+TEST(Test_CArrayVec, simd_loop)
+{
+    const int num_nodes = 37;
+    DCArrayKokkos<double> coords(num_nodes, 3, "coords");
+    DCArrayKokkos<double> result(num_nodes, 3, "result");
+
+    FOR_ALL(i, 0, num_nodes,
+            d, 0, 3, {
+        coords(i, d) = i + 0.5 * d;
+    });
+
+    CArrayVec<double, 8> x(num_nodes, 3, "x");
+    CArrayVec<double, 8> v(num_nodes, 3, "v");
+    x.copy_from(coords);
+    v.set_values(2.0);
+
+    FOR_ALL_SIMD(s, a0, a1, 0, num_nodes, 8, {
+        for (int d = 0; d < 3; d++) {
+            double* px = x.pack(s, d);
+            const double* pv = v.pack(s, d);
+            for (int a = a0; a < a1; a++) {
+                px[a] += 0.25 * pv[a];
+            }
+        }
+    });
+
+    x.copy_to(result);
+    result.update_host();
+
+    for (int i = 0; i < num_nodes; i++) {
+        for (int d = 0; d < 3; d++) {
+            EXPECT_DOUBLE_EQ(result.host(i, d), i + 0.5 * d + 0.5);
+        }
+    }
+}
+
+// Test a loop starting inside a pack and the pack pointers
+TEST(Test_CArrayVec, partial_range)
+{
+    CArrayVec<int, 4> A(12, 2);
+    A.set_values(0);
+
+    FOR_ALL_SIMD(s, a0, a1, 5, 11, 4, {
+        for (int a = a0; a < a1; a++) {
+            A.access(s, a, 1) = 1;
+        }
+    });
+
+    int total = 0;
+    int total_loc;
+    FOR_REDUCE_SUM(i, 0, 12, total_loc, {
+        total_loc += A(i, 1) + A(i, 0);
+    }, total);
+    EXPECT_EQ(total, 6);
+
+    DCArrayKokkos<int> flags(3, "flags");
+    FOR_ALL(s, 0, 3, {
+        int* lanes = A.pack(s, 1);
+        flags(s) = lanes[0] + lanes[1] + lanes[2] + lanes[3];
+    });
+    flags.update_host();
+    EXPECT_EQ(flags.host(0), 0);
+    EXPECT_EQ(flags.host(1), 3);
+    EXPECT_EQ(flags.host(2), 3);
+}
@@ -0,0 +1,379 @@
+#include "matar.h"
+#include "gtest/gtest.h"
+#include <stdio.h>
+#include <string.h>
+#include <cstddef>
+#include <vector>
+
+using namespace mtr; // matar namespace
+
+
+static long file_size(const std::string& name)
+{
+    FILE* file = fopen(name.c_str(), "rb");
+    fseek(file, 0, SEEK_END);
+    long size = ftell(file);
+    fclose(file);
+    return size;
+}
+
+// Test writing and reading back the dense host types
+TEST(Test_Checkpoint, dense_round_trip)
+{
+    CArray<double> A(6, 5, 4);
+    FArray<int> B(7, 3);
+    for (size_t i = 0; i < A.size(); i++) {
+        A.pointer()[i] = 0.5 * i;
+    }
+    for (size_t i = 0; i < B.size(); i++) {
+        B.pointer()[i] = 3 * i - 10;
+    }
+
+    for (bool compress : {false, true}) {
+        const std::string name = checkpoint_file_name("test_dense", compress);
+
+        CheckpointOptions options;
+        options.chunk_bytes = 100;  // several chunks per array
+        options.compress    = compress;
+        {
+            CheckpointWriter out(name, options);
+            out.write("A", A);
+            out.write("B", B);
+        }
+
+        CheckpointReader in(name);
+        EXPECT_TRUE(in.has("A"));
+        EXPECT_FALSE(in.has("C"));
+        EXPECT_EQ(in.names().size(), 2);
+
+        CArray<double> A_in;  // allocated by read
+        FArray<int> B_in(7, 3);
+        in.read("A", A_in);
+        in.read("B", B_in);
+
+        EXPECT_EQ(A_in.order(), 3);
+        EXPECT_EQ(A_in.dims(2), 4);
+        for (size_t i = 0; i < A.size(); i++) {
+            EXPECT_DOUBLE_EQ(A_in.pointer()[i], A.pointer()[i]);
+        }
+        for (size_t i = 0; i < B.size(); i++) {
+            EXPECT_EQ(B_in.pointer()[i], B.pointer()[i]);
+        }
+        remove(name.c_str());
+    }
+}
+
+// Test that compression makes repetitive data smaller
+TEST(Test_Checkpoint, compression)
+{
+    CArray<double> A(10000);
+    for (size_t i = 0; i < A.size(); i++) {
+        A(i) = i % 8;
+    }
+
+    CheckpointOptions options;
+    options.compress = true;
+    {
+        CheckpointWriter raw("test_raw.mckp");
+        raw.write("A", A);
+        CheckpointWriter packed("test_packed.mckp", options);
+        packed.write("A", A);
+    }
+    EXPECT_LT(file_size("test_packed.mckp"), file_size("test_raw.mckp") / 10);
+
+    CArray<double> A_in(10000);
+    CheckpointReader in("test_packed.mckp");
+    in.read("A", A_in);
+    for (size_t i = 0; i < A.size(); i++) {
+        EXPECT_DOUBLE_EQ(A_in(i), A(i));
+    }
+
+    // the block compressor on its own, including the short inputs
+    for (size_t length : {0, 1, 13, 70000}) {
+        std::vector<char> source(length);
+        for (size_t i = 0; i < length; i++) {
+            source[i] = static_cast<char>((i / 3) % 7);
+        }
+        std::vector<char> packed(length + length / 255 + 16);
+        size_t stored = lz4_compress_block(source.data(), length, packed.data(), packed.size());
+        ASSERT_GT(stored, 0);
+
+        std::vector<char> result(length);
+        EXPECT_TRUE(lz4_decompress_block(packed.data(), stored, result.data(), length));
+        EXPECT_EQ(result, source);
+    }
+
+    remove("test_raw.mckp");
+    remove("test_packed.mckp");
+}
+
+// Test the ragged and sparse types
+TEST(Test_Checkpoint, ragged_and_sparse)
+{
+    size_t strides[4] = {2, 0, 3, 1};
+    RaggedRightArray<double> R(strides, 4);
+    for (size_t i = 0; i < 4; i++) {
+        for (size_t j = 0; j < R.stride(i); j++) {
+            R(i, j) = 10.0 * i + j;
+        }
+    }
+
+    // 3x4 matrix with 5 nonzeros
+    CArray<double> values(5);
+    CArray<size_t> columns(5);
+    CArray<size_t> starts(4);
+    size_t col[5] = {0, 2, 1, 0, 3};
+    size_t row_start[4] = {0, 2, 3, 5};
+    for (size_t k = 0; k < 5; k++) {
+        values(k)  = k + 1.0;
+        columns(k) = col[k];
+    }
+    for (size_t i = 0; i < 4; i++) {
+        starts(i) = row_start[i];
+    }
+    CSRArray<double> S(values, columns, starts, 3, 4);
+
+    {
+        CheckpointOptions options;
+        options.compress = true;
+        CheckpointWriter out("test_sparse.mckp", options);
+        out.write("R", R);
+        out.write("S", S);
+    }
+
+    CheckpointReader in("test_sparse.mckp");
+    RaggedRightArray<double> R_in;
+    CSRArray<double> S_in;
+    in.read("R", R_in);
+    in.read("S", S_in);
+
+    EXPECT_EQ(R_in.dim1(), 4);
+    for (size_t i = 0; i < 4; i++) {
+        EXPECT_EQ(R_in.stride(i), R.stride(i));
+        for (size_t j = 0; j < R.stride(i); j++) {
+            EXPECT_DOUBLE_EQ(R_in(i, j), R(i, j));
+        }
+    }
+
+    EXPECT_EQ(S_in.dim1(), 3);
+    EXPECT_EQ(S_in.dim2(), 4);
+    EXPECT_EQ(S_in.nnz(), 5);
+    EXPECT_DOUBLE_EQ(S_in(0, 2), 2.0);
+    EXPECT_DOUBLE_EQ(S_in(2, 3), 5.0);
+
+    // a record read into the wrong type
+    CArray<float> wrong;
+    EXPECT_THROW(in.read("S", wrong), std::runtime_error);
+
+    remove("test_sparse.mckp");
+}
+
+// Test the device and dual types
+TEST(Test_Checkpoint, device_round_trip)
+{
+    const int size = 300;
+    CArrayKokkos<double> A(size, 2, "A");
+    DFArrayKokkos<int> B(size, "B");
+
+    FOR_ALL(i, 0, size, {
+        A(i, 0) = i;
+        A(i, 1) = -i;
+        B(i) = 2 * i;
+    });
+
+    {
+        CheckpointOptions options;
+        options.chunk_bytes = 512;
+        options.compress    = true;
+        CheckpointWriter out("test_device.mckp", options);
+        out.write("A", A);
+        out.write("B", B);
+    }
+
+    CheckpointReader in("test_device.mckp");
+    CArrayKokkos<double> A_in;
+    DFArrayKokkos<int> B_in(size, "B_in");
+    in.read("A", A_in);
+    in.read("B", B_in);
+
+    int errors = 0;
+    int errors_loc;
+    FOR_REDUCE_SUM(i, 0, size, errors_loc, {
+        errors_loc += (A_in(i, 0) != i) + (A_in(i, 1) != -i) + (B_in(i) != 2 * i);
+    }, errors);
+    EXPECT_EQ(errors, 0);
+    EXPECT_EQ(B_in.host(size - 1), 2 * (size - 1));
+
+    // the dims of an allocated array must match
+    DFArrayKokkos<int> B_small(size - 1, "B_small");
+    EXPECT_THROW(in.read("B", B_small), std::runtime_error);
+
+    remove("test_device.mckp");
+}
+
+// Test the Kokkos ragged, dual ragged and sparse types
+TEST(Test_Checkpoint, device_ragged_and_sparse)
+{
+    CArrayKokkos<size_t> strides(4, "strides");
+    RUN({
+        strides(0) = 2;
+        strides(1) = 0;
+        strides(2) = 3;
+        strides(3) = 1;
+    });
+    RaggedRightArrayKokkos<double> R(strides, "R");
+    RaggedDownArrayKokkos<double> D(strides, "D");
+    FOR_ALL(i, 0, 4, {
+        for (size_t j = 0; j < R.stride(i); j++) {
+            R(i, j) = 10.0 * i + j;
+            D(j, i) = -10.0 * i - j;
+        }
+    });
+
+    size_t dual_strides[3] = {1, 3, 2};
+    DRaggedRightArrayKokkos<int> V(dual_strides, 3, 2, "V");
+    for (size_t i = 0; i < 3; i++) {
+        for (size_t j = 0; j < dual_strides[i]; j++) {
+            V.host(i, j, 0) = 100 * i + j;
+            V.host(i, j, 1) = -100 * i - j;
+        }
+    }
+    V.update_device();
+
+    // 3x4 matrix with 5 nonzeros, and its transpose pattern as a CSC matrix
+    CArrayKokkos<double> values(5, "values");
+    CArrayKokkos<size_t> indices(5, "indices");
+    CArrayKokkos<size_t> starts(4, "starts");
+    FOR_ALL(k, 0, 5, {
+        values(k) = k + 1.0;
+    });
+    RUN({
+        indices(0) = 0;
+        indices(1) = 2;
+        indices(2) = 1;
+        indices(3) = 0;
+        indices(4) = 3;
+        starts(0) = 0;
+        starts(1) = 2;
+        starts(2) = 3;
+        starts(3) = 5;
+    });
+    CSRArrayKokkos<double> S(values, starts, indices, 3, 4, "S");
+    CSCArrayKokkos<double> C(values, starts, indices, 4, 3, "C");
+
+    {
+        CheckpointOptions options;
+        options.compress = true;
+        CheckpointWriter out("test_device_sparse.mckp", options);
+        out.write("R", R);
+        out.write("D", D);
+        out.write("V", V);
+        out.write("S", S);
+        out.write("C", C);
+    }
+
+    CheckpointReader in("test_device_sparse.mckp");
+    RaggedRightArrayKokkos<double> R_in;
+    RaggedDownArrayKokkos<double> D_in;
+    DRaggedRightArrayKokkos<int> V_in;
+    CSRArrayKokkos<double> S_in;
+    CSCArrayKokkos<double> C_in;
+    in.read("R", R_in);
+    in.read("D", D_in);
+    in.read("V", V_in);
+    in.read("S", S_in);
+    in.read("C", C_in);
+
+    int errors = 0;
+    int errors_loc;
+    FOR_REDUCE_SUM(i, 0, 4, errors_loc, {
+        errors_loc += R_in.stride(i) != R.stride(i);
+        for (size_t j = 0; j < R.stride(i); j++) {
+            errors_loc += (R_in(i, j) != R(i, j)) + (D_in(j, i) != D(j, i));
+        }
+    }, errors);
+    EXPECT_EQ(errors, 0);
+
+    EXPECT_EQ(V_in.dims(0), 3);
+    EXPECT_EQ(V_in.dims(1), 2);
+    for (size_t i = 0; i < 3; i++) {
+        EXPECT_EQ(V_in.stride_host(i), dual_strides[i]);
+        for (size_t j = 0; j < dual_strides[i]; j++) {
+            EXPECT_EQ(V_in.host(i, j, 0), V.host(i, j, 0));
+            EXPECT_EQ(V_in.host(i, j, 1), V.host(i, j, 1));
+        }
+    }
+
+    EXPECT_EQ(S_in.dim1(), 3);
+    EXPECT_EQ(S_in.dim2(), 4);
+    EXPECT_EQ(C_in.dim1(), 4);
+    EXPECT_EQ(C_in.dim2(), 3);
+    FOR_REDUCE_SUM(k, 0, 5, errors_loc, {
+        errors_loc += (S_in.get_col_flat(k) != S.get_col_flat(k)) + (C_in.get_row_flat(k) != C.get_row_flat(k));
+    }, errors);
+    EXPECT_EQ(errors, 0);
+    double sum = 0.0;
+    double sum_loc;
+    FOR_REDUCE_SUM(k, 0, 5, sum_loc, {
+        sum_loc += S_in.pointer()[k] + C_in.pointer()[k];
+    }, sum);
+    EXPECT_DOUBLE_EQ(sum, 30.0);
+
+    remove("test_device_sparse.mckp");
+}
+
+// Test that truncated and corrupt files are rejected
+TEST(Test_Checkpoint, corrupt_files)
+{
+    CArray<double> A(1000);
+    for (size_t i = 0; i < A.size(); i++) {
+        A(i) = i;
+    }
+    {
+        CheckpointWriter out("test_good.mckp");
+        out.write("A", A);
+    }
+
+    std::vector<char> bytes(file_size("test_good.mckp"));
+    FILE* file = fopen("test_good.mckp", "rb");
+    ASSERT_EQ(fread(bytes.data(), 1, bytes.size(), file), bytes.size());
+    fclose(file);
+
+    auto write_bytes = [](const std::vector<char>& data, size_t count) {
+        FILE* out = fopen("test_bad.mckp", "wb");
+        fwrite(data.data(), 1, count, out);
+        fclose(out);
+    };
+
+    // cut off in the file header, the record header and the values
+    for (size_t count : {size_t(10), size_t(40), bytes.size() / 2, bytes.size() - 1}) {
+        write_bytes(bytes, count);
+        EXPECT_THROW(CheckpointReader in("test_bad.mckp"), std::runtime_error);
+    }
+
+    // a record that claims to be empty
+    size_t record = 0;
+    while (record + 4 <= bytes.size() && std::string(&bytes[record], 4) != "MREC") {
+        record++;
+    }
+    ASSERT_LT(record, bytes.size());
+    std::vector<char> corrupt = bytes;
+    uint64_t zero = 0;
+    memcpy(&corrupt[record + offsetof(CheckpointRecordHeader, record_bytes)], &zero, sizeof(zero));
+    write_bytes(corrupt, corrupt.size());
+    EXPECT_THROW(CheckpointReader in("test_bad.mckp"), std::runtime_error);
+
+    // a section larger than the array it claims to hold
+    corrupt = bytes;
+    uint64_t count = 2000;
+    const size_t name_length = 1;
+    memcpy(&corrupt[record + sizeof(CheckpointRecordHeader) + name_length], &count, sizeof(count));
+    write_bytes(corrupt, corrupt.size());
+    EXPECT_THROW(CheckpointReader in("test_bad.mckp"), std::runtime_error);
+
+    // a file that is not a checkpoint
+    EXPECT_THROW(CheckpointReader in("test_Checkpoint.cpp.missing"), std::runtime_error);
+
+    remove("test_good.mckp");
+    remove("test_bad.mckp");
+}
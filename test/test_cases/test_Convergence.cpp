@@ -0,0 +1,85 @@
+#include "matar.h"
+#include "gtest/gtest.h"
+#include <stdio.h>
+
+using namespace mtr; // matar namespace
+
+
+// Test the check interval and a residual handed in by hand
+TEST(Test_Convergence, submit)
+{
+    ConvergenceMonitor monitor(0.1, 4);
+    EXPECT_TRUE(monitor.due(0));
+    EXPECT_FALSE(monitor.due(3));
+    EXPECT_TRUE(monitor.due(8));
+
+    monitor.submit(1.0);
+    EXPECT_FALSE(monitor.converged());
+    EXPECT_DOUBLE_EQ(monitor.residual(), 1.0);
+
+    monitor.submit(0.05);
+    EXPECT_TRUE(monitor.converged());
+    EXPECT_EQ(monitor.num_checks(), 2);
+}
+
+// Test the fused update and residual, halving a field until it settles
+TEST(Test_Convergence, step)
+{
+    const int size = 16;
+    DCArrayKokkos<double> u(size, size, "u");
+    u.set_values(1.0);
+
+    ConvergenceMonitor monitor(1e-3, 3);
+    size_t iter = 0;
+    for (; iter < 100 && !monitor.converged(); iter++) {
+        monitor.step(iter, policy2D({0, 0}, {size, size}),
+                     KOKKOS_LAMBDA(const int i, const int j, double& residual) {
+            const double old = u(i, j);
+            u(i, j) = 0.5 * old;
+            residual = fmax(residual, old - u(i, j));
+        });
+    }
+    monitor.finish();
+
+    // the change at iteration k is 2^-(k+1), below 1e-3 first at k = 9
+    EXPECT_EQ(iter, 10);
+    EXPECT_EQ(monitor.num_checks(), 4);
+    EXPECT_DOUBLE_EQ(monitor.residual(), pow(0.5, 10));
+
+    u.update_host();
+    EXPECT_DOUBLE_EQ(u.host(3, 5), pow(0.5, 10));
+}
+
+#ifdef HAVE_MPI
+
+// Test that every rank leaves the loop at the same check
+TEST(Test_Convergence, mpi_same_check)
+{
+    int rank, num_ranks;
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+    MPI_Comm_size(MPI_COMM_WORLD, &num_ranks);
+
+    // rank r sees (r+1)/2^k at check k, the global max is num_ranks/2^k
+    ConvergenceMonitor monitor(1e-2, 1, MPI_COMM_WORLD);
+    int loops = 0;
+    for (; loops < 100 && !monitor.converged(); loops++) {
+        monitor.submit((rank + 1) * pow(0.5, loops));
+    }
+    monitor.finish();
+
+    int loops_min, loops_max;
+    MPI_Allreduce(&loops, &loops_min, 1, MPI_INT, MPI_MIN, MPI_COMM_WORLD);
+    MPI_Allreduce(&loops, &loops_max, 1, MPI_INT, MPI_MAX, MPI_COMM_WORLD);
+    EXPECT_EQ(loops_min, loops_max);
+
+    // the first check below the tolerance is learned one check late
+    int first = 0;
+    while (num_ranks * pow(0.5, first) > 1e-2) {
+        first++;
+    }
+    EXPECT_EQ(loops, first + 2);
+    EXPECT_EQ(monitor.num_checks(), first + 2);
+    EXPECT_TRUE(monitor.converged());
+}
+
+#endif
@@ -308,3 +308,74 @@ TEST(Test_DCArrayKokkos, different_types)
         EXPECT_TRUE(A_bool.host(i));
     }
 }
+
+// Test that only the marked range is transferred and counted
+TEST(Test_DCArrayKokkos, modified_range)
+{
+    TransferLog::instance().enable(true);
+    TransferLog::instance().reset();
+
+    DCArrayKokkos<double> A(10, 10, "test_modified_range");
+    A.set_values(1.0);
+
+    // no range marked, the whole array moves
+    A.update_host();
+    EXPECT_EQ(TransferLog::instance().get("test_modified_range").to_host_bytes, 100 * sizeof(double));
+
+    // rows 2 and 3 of a 10x10 C ordered array
+    FOR_ALL(i, 2, 4,
+            j, 0, 10, {
+        A(i, j) = 2.0;
+    });
+    A.modified_device(2 * 10, 4 * 10);
+    A.update_host();
+    EXPECT_EQ(TransferLog::instance().get("test_modified_range").to_host_bytes, 120 * sizeof(double));
+    EXPECT_EQ(TransferLog::instance().get("test_modified_range").to_host_calls, 2);
+    EXPECT_EQ(A.host(3, 9), 2.0);
+    EXPECT_EQ(A.host(4, 0), 1.0);
+
+    // with tracking on, an update with nothing marked is skipped
+    A.track_modified(true);
+    A.update_device();
+    EXPECT_EQ(TransferLog::instance().get("test_modified_range").to_device_calls, 0);
+    EXPECT_EQ(TransferLog::instance().get("test_modified_range").skipped_calls, 1);
+
+    // copies share the marked range
+    DCArrayKokkos<double> B = A;
+    B.modified_host(0, 5);
+    B.modified_host(50, 60);
+    A.update_device();
+    EXPECT_EQ(TransferLog::instance().get("test_modified_range").to_device_bytes, 60 * sizeof(double));
+
+    TransferLog::instance().reset();
+    TransferLog::instance().enable(false);
+}
+
+// Test the asynchronous updates on an execution space instance
+TEST(Test_DCArrayKokkos, update_async)
+{
+    DefaultExecSpace exec;
+
+    DCArrayKokkos<double> A(10, "test_update_async");
+    A.set_values(3.0);
+    A.update_host(exec);
+    ExecEvent<> a_on_host(exec);
+    a_on_host.wait();
+    EXPECT_TRUE(a_on_host.recorded());
+    for (int i = 0; i < 10; i++) {
+        EXPECT_EQ(A.host(i), 3.0);
+    }
+
+    for (int i = 0; i < 10; i++) {
+        A.host(i) = i;
+    }
+    A.update_device(exec);
+    exec.fence();
+
+    double sum = 0.0;
+    double lsum;
+    FOR_REDUCE_SUM(i, 0, 10, lsum, {
+        lsum += A(i);
+    }, sum);
+    EXPECT_EQ(sum, 45.0);
+}
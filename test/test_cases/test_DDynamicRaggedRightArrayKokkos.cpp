@@ -166,6 +166,27 @@ TEST_F(DDynamicRaggedRightArrayKokkosTest, UpdateFunctions) {
     EXPECT_DOUBLE_EQ(array(3, 0), 6.0);
 }
 
+// Test the asynchronous updates on an execution space instance
+TEST_F(DDynamicRaggedRightArrayKokkosTest, UpdateAsync) {
+    DDynamicRaggedRightArrayKokkos<double> array(dim1, dim2, "test_array");
+
+    FOR_ALL(i, 0, dim1, {
+        array.stride(i) = dim2;
+        array(i, 0) = i;
+    }); // end parallel for
+
+    DefaultExecSpace exec;
+    array.update_host(exec);
+    ExecEvent<> on_host(exec);
+    on_host.wait();
+    EXPECT_DOUBLE_EQ(array.host(3, 0), 3.0);
+
+    array.host(2, 1) = 5.0;
+    array.update_device(exec);
+    exec.fence();
+    EXPECT_DOUBLE_EQ(array(2, 1), 5.0);
+}
+
 TEST_F(DDynamicRaggedRightArrayKokkosTest, NameManagement) {
     // Create DDynamicRaggedRightArrayKokkos with specific name
     DDynamicRaggedRightArrayKokkos<double> array(dim1, dim2, "test_array");
@@ -200,3 +221,83 @@ TEST_F(DDynamicRaggedRightArrayKokkosTest, KokkosViewAccess) {
     // Verify view is not null
     EXPECT_NE(view.h_view.data(), nullptr);
 }
+
+TEST_F(DDynamicRaggedRightArrayKokkosTest, PushAndCompact) {
+    // row i gets 2*i values, rows 3 overflows its dim2 of 4 by 2
+    DDynamicRaggedRightArrayKokkos<double> array(dim1, dim2, "test_array", 1);
+
+    const size_t num_pushes = 12;  // 0 + 2 + 4 + 6
+    DCArrayKokkos<int> pushed(num_pushes, "pushed");
+    FOR_ALL(p, 0, num_pushes, {
+        size_t row = p < 2 ? 1 : (p < 6 ? 2 : 3);
+        pushed(p) = array.push(row, 100.0 * row + p);
+    });
+    pushed.update_host();
+
+    int failures = 0;
+    for (size_t p = 0; p < num_pushes; p++) {
+        failures += pushed.host(p) == 0;
+    }
+    EXPECT_EQ(failures, 1);
+    EXPECT_EQ(array.num_spilled(), 1);
+    EXPECT_EQ(array.num_dropped(), 1);
+
+    array.update_strides_host();
+    EXPECT_EQ(array.stride_host(3), dim2);
+
+    RaggedRightArrayKokkos<double> tight = array.compact("tight");
+    EXPECT_EQ(tight.size(), 11);
+
+    DCArrayKokkos<double> row_sum(dim1, "row_sum");
+    DCArrayKokkos<size_t> row_stride(dim1, "row_stride");
+    FOR_ALL(i, 0, dim1, {
+        row_sum(i) = 0.0;
+        row_stride(i) = tight.stride(i);
+        for (size_t j = 0; j < tight.stride(i); j++) {
+            row_sum(i) += tight(i, j);
+        }
+    });
+    row_sum.update_host();
+    row_stride.update_host();
+
+    EXPECT_EQ(row_stride.host(0), 0);
+    EXPECT_EQ(row_stride.host(1), 2);
+    EXPECT_EQ(row_stride.host(2), 4);
+    EXPECT_EQ(row_stride.host(3), 5);
+    EXPECT_DOUBLE_EQ(row_sum.host(1), 200.0 + 0 + 1);
+    EXPECT_DOUBLE_EQ(row_sum.host(2), 800.0 + 2 + 3 + 4 + 5);
+
+    // reuse the storage for the next build
+    array.clear();
+    EXPECT_EQ(array.num_spilled(), 0);
+    EXPECT_EQ(array.compact("empty").size(), 0);
+}
+
+TEST_F(DDynamicRaggedRightArrayKokkosTest, DynamicPushAndCompact) {
+    DynamicRaggedRightArrayKokkos<int> array(dim1, 2, "test_array", 8);
+
+    // every row gets 3 values, one more than fits
+    DCArrayKokkos<int> pushed(1, "pushed");
+    pushed.set_values(0);
+    FOR_ALL(p, 0, 3 * dim1, {
+        if (array.push(p % 4, p)) {
+            Kokkos::atomic_add(&pushed(0), 1);
+        }
+    });
+    pushed.update_host();
+    EXPECT_EQ(pushed.host(0), 12);
+    EXPECT_EQ(array.num_spilled(), 4);
+    EXPECT_EQ(array.num_dropped(), 0);
+
+    RaggedRightArrayKokkos<int> tight = array.compact("tight");
+    EXPECT_EQ(tight.size(), 12);
+
+    int total = 0;
+    int total_loc;
+    FOR_REDUCE_SUM(i, 0, dim1, total_loc, {
+        for (size_t j = 0; j < tight.stride(i); j++) {
+            total_loc += tight(i, j);
+        }
+    }, total);
+    EXPECT_EQ(total, 66);
+}
@@ -238,3 +238,38 @@ TEST(Test_DFArrayKokkos, raii)
     B.set_values(0.0);
     EXPECT_EQ(B.size(), 10000);
 }
+
+// Test slices of the device and host data
+TEST(Test_DFArrayKokkos, slice_subview)
+{
+    DFArrayKokkos<int> A(4, 5, 3);
+    for (int i = 0; i < 4; i++) {
+        for (int j = 0; j < 5; j++) {
+            for (int k = 0; k < 3; k++) {
+                A.host(i, j, k) = 100 * i + 10 * j + k;
+            }
+        }
+    }
+    A.update_device();
+
+    // the last index is fixed for the F layout
+    ViewFArray<int> last = A.host.slice(2);
+    EXPECT_EQ(last.order(), 2);
+    EXPECT_EQ(last(3, 4), 342);
+    EXPECT_EQ(last.pointer(), &A.host(0, 0, 2));
+
+    ViewStridedArray<int> rows = A.host.subview(Range{0, 4, 2}, 1, Range{});
+    EXPECT_EQ(rows.dims(0), 2);
+    EXPECT_EQ(rows(1, 2), 212);
+    EXPECT_EQ(rows.stride(1), 20);
+
+    DFArrayKokkos<int> B(4, "B");
+    FOR_ALL(i, 0, 4, {
+        ViewFArrayKokkos<int> plane = A.slice(1);
+        B(i) = plane(i, 3) + A.subview(i, Range{1, 5, 3}, 0)(1);
+    });
+    B.update_host();
+    for (int i = 0; i < 4; i++) {
+        EXPECT_EQ(B.host(i), (100 * i + 31) + (100 * i + 40));
+    }
+}
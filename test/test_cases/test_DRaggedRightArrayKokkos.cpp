@@ -146,6 +146,28 @@ TEST(DRaggedRightArrayKokkosTest, HostAccess) {
     EXPECT_DOUBLE_EQ(array(1, 1), 4.0);
 }
 
+// Test the asynchronous updates on an execution space instance
+TEST(DRaggedRightArrayKokkosTest, UpdateAsync) {
+    CArrayKokkos<size_t> strides(3, "strides");
+    strides(0) = 2;
+    strides(1) = 3;
+    strides(2) = 1;
+
+    DRaggedRightArrayKokkos<double> array(strides);
+    array.set_values(2.0);
+
+    DefaultExecSpace exec;
+    array.update_host(exec);
+    ExecEvent<> on_host(exec);
+    on_host.wait();
+    EXPECT_DOUBLE_EQ(array.host(1, 2), 2.0);
+
+    array.host(1, 0) = 3.0;
+    array.update_device(exec);
+    exec.fence();
+    EXPECT_DOUBLE_EQ(array(1, 0), 3.0);
+}
+
 // Test vector constructor
 TEST(DRaggedRightArrayKokkosTest, VectorConstructor) {
     // Create strides array
@@ -0,0 +1,101 @@
+#include "matar.h"
+#include "gtest/gtest.h"
+#include <stdio.h>
+
+using namespace mtr; // matar namespace
+
+
+// Test fused arithmetic on host arrays
+TEST(Test_Expressions, host_arithmetic)
+{
+    const int size = 10;
+    CArray<double> A(size);
+    CArray<double> B(size);
+    CArray<double> C(size);
+
+    for (int i = 0; i < size; i++) {
+        A(i) = i;
+        B(i) = 2.0 * i;
+    }
+
+    assign(C, A + 2.0 * B - 1.0);
+    for (int i = 0; i < size; i++) {
+        EXPECT_DOUBLE_EQ(C(i), 5.0 * i - 1.0);
+    }
+
+    assign(C, -A / 2.0);
+    for (int i = 0; i < size; i++) {
+        EXPECT_DOUBLE_EQ(C(i), -0.5 * i);
+    }
+
+    assign(C, 0.0);
+    EXPECT_DOUBLE_EQ(sum(C), 0.0);
+}
+
+// Test the reductions
+TEST(Test_Expressions, host_reductions)
+{
+    const int size = 4;
+    FArray<double> A(size);
+    FArray<double> B(size);
+
+    for (int i = 0; i < size; i++) {
+        A(i) = i + 1.0;
+        B(i) = 1.0;
+    }
+
+    EXPECT_DOUBLE_EQ(sum(A), 10.0);
+    EXPECT_DOUBLE_EQ(sum(A - B), 6.0);
+    EXPECT_DOUBLE_EQ(max_value(A), 4.0);
+    EXPECT_DOUBLE_EQ(min_value(-A), -4.0);
+    EXPECT_DOUBLE_EQ(dot(A, B), 10.0);
+    EXPECT_DOUBLE_EQ(norm(A), sqrt(30.0));
+    EXPECT_DOUBLE_EQ(sum(abs(-A)), 10.0);
+}
+
+// Test repeating a row over a matrix
+TEST(Test_Expressions, broadcast)
+{
+    CArray<double> A(3, 4);
+    CArray<double> C(3, 4);
+    CArray<double> row(4);
+
+    for (int j = 0; j < 4; j++) {
+        row(j) = j;
+    }
+    for (int i = 0; i < 3; i++) {
+        for (int j = 0; j < 4; j++) {
+            A(i, j) = 10.0 * i;
+        }
+    }
+
+    assign(C, A + broadcast(row, A));
+    for (int i = 0; i < 3; i++) {
+        for (int j = 0; j < 4; j++) {
+            EXPECT_DOUBLE_EQ(C(i, j), 10.0 * i + j);
+        }
+    }
+}
+
+// Test device evaluation on Kokkos and dual types
+TEST(Test_Expressions, device_arithmetic)
+{
+    const int size = 100;
+    CArrayKokkos<double> A(size, "A");
+    DCArrayKokkos<double> C(size, "C");
+
+    FOR_ALL(i, 0, size, {
+        A(i) = i;
+    });
+
+    assign(C, 3.0 * A + 1.0);
+    C.update_host();
+
+    for (int i = 0; i < size; i++) {
+        EXPECT_DOUBLE_EQ(C.host(i), 3.0 * i + 1.0);
+    }
+
+    EXPECT_DOUBLE_EQ(sum(C - A), 2.0 * 4950.0 + 100.0);
+    EXPECT_DOUBLE_EQ(max_value(C), 298.0);
+    EXPECT_DOUBLE_EQ(min_value(C), 1.0);
+}
@@ -0,0 +1,86 @@
+#include "matar.h"
+#include "gtest/gtest.h"
+#include <stdio.h>
+
+using namespace mtr; // matar namespace
+
+
+// Test the storage order and the compile time extents
+TEST(Test_FixedTypes, layout)
+{
+    CArrayFixed<int, 2, 3, 4> C;
+    FArrayFixed<int, 2, 3, 4> F;
+
+    static_assert(CArrayFixed<int, 2, 3, 4>::size() == 24, "wrong size");
+    static_assert(CArrayFixed<int, 2, 3, 4>::order() == 3, "wrong order");
+    static_assert(CArrayFixed<int, 2, 3, 4>::stride(0) == 12, "wrong C stride");
+    static_assert(FArrayFixed<int, 2, 3, 4>::stride(2) == 6, "wrong F stride");
+    static_assert(sizeof(CArrayFixed<double, 3, 3>) == 9 * sizeof(double), "fixed types must not carry dims");
+
+    for (int i = 0; i < 2; i++) {
+        for (int j = 0; j < 3; j++) {
+            for (int k = 0; k < 4; k++) {
+                C(i, j, k) = 100 * i + 10 * j + k;
+                F(i, j, k) = 100 * i + 10 * j + k;
+            }
+        }
+    }
+
+    EXPECT_EQ(C.pointer()[1], 1);   // C(0,0,1)
+    EXPECT_EQ(F.pointer()[1], 100); // F(1,0,0)
+    EXPECT_EQ(C[23], 123);
+    EXPECT_EQ(F[23], 123);
+    EXPECT_EQ(C.dims(2), 4);
+}
+
+// Test the 1 based matrix types
+TEST(Test_FixedTypes, matrix)
+{
+    FMatrixFixed<double, 3, 3> A;
+    CMatrixFixed<double, 3, 3> B;
+    A.set_values(0.0);
+
+    for (int i = 1; i <= 3; i++) {
+        A(i, i) = i;
+        for (int j = 1; j <= 3; j++) {
+            B(i, j) = 10 * i + j;
+        }
+    }
+
+    EXPECT_EQ(A.dims(1), 3);
+    EXPECT_DOUBLE_EQ(A(2, 2), 2.0);
+    EXPECT_DOUBLE_EQ(A(1, 3), 0.0);
+    EXPECT_DOUBLE_EQ(B.pointer()[1], 12.0);
+}
+
+// Test a per point tensor inside a parallel loop
+TEST(Test_FixedTypes, inside_kernel)
+{
+    const int size = 50;
+    CArrayKokkos<double> trace(size, "trace");
+
+    // the commas in the template arguments would split the macro arguments
+    using Tensor = CArrayFixed<double, 3, 3>;
+
+    FOR_ALL(p, 0, size, {
+        Tensor stress;
+        stress.set_values(0.0);
+        for (int i = 0; i < 3; i++) {
+            stress(i, i) = p;
+        }
+
+        double tr = 0.0;
+        for (int i = 0; i < 3; i++) {
+            tr += stress(i, i);
+        }
+        trace(p) = tr;
+    });
+
+    double total = 0.0;
+    double total_loc;
+    FOR_REDUCE_SUM(p, 0, size, total_loc, {
+        total_loc += trace(p);
+    }, total);
+
+    EXPECT_DOUBLE_EQ(total, 3.0 * (size * (size - 1) / 2));
+}
@@ -0,0 +1,118 @@
+#include "matar.h"
+#include "gtest/gtest.h"
+#include <stdio.h>
+
+using namespace mtr; // matar namespace
+
+
+// num x num grid graph, vertices (i, j) with i, j < cut are left out so
+// the corner is a separate component when cut > 0
+CSRArrayKokkos<double> grid_graph(int num, int cut)
+{
+    SparseAssembler<double> assembler(num * num, num * num, 4 * num * num);
+    FOR_ALL(i, 0, num, j, 0, num, {
+        const bool corner = i < cut && j < cut;
+        if (i + 1 < num && corner == (i + 1 < cut && j < cut)) {
+            assembler.add(i * num + j, (i + 1) * num + j, 1.0);
+            assembler.add((i + 1) * num + j, i * num + j, 1.0);
+        }
+        if (j + 1 < num && corner == (i < cut && j + 1 < cut)) {
+            assembler.add(i * num + j, i * num + j + 1, 1.0);
+            assembler.add(i * num + j + 1, i * num + j, 1.0);
+        }
+    });
+    return assembler.to_csr();
+}
+
+// Test that BFS gives the Manhattan distance, top-down only and direction optimizing
+TEST(Test_Graph, bfs)
+{
+    const int num = 40;
+    CSRArrayKokkos<double> graph = grid_graph(num, 0);
+    DCArrayKokkos<int> distance(num * num, "distance");
+    CArrayKokkos<int> found(num * num, "found");
+
+    GraphBFSOptions top_down;
+    top_down.direction_optimizing = false;
+    GraphBFSResult result = graph_bfs(graph, 0, found, top_down);
+    EXPECT_EQ(result.reached, num * num);
+    EXPECT_EQ(result.levels, 2 * num - 1);
+    EXPECT_EQ(result.bottom_up_steps, 0);
+
+    GraphBFSOptions switching;
+    switching.alpha = 1.0e6;
+    result = graph_bfs(graph, 0, found, switching);
+    EXPECT_EQ(result.levels, 2 * num - 1);
+    EXPECT_GT(result.bottom_up_steps, 0);
+
+    FOR_ALL(v, 0, num * num, {
+        distance(v) = found(v);
+    });
+    distance.update_host();
+    for (int v = 0; v < num * num; v++) {
+        EXPECT_EQ(distance.host(v), v / num + v % num);
+    }
+}
+
+// Test the number and labels of connected components
+TEST(Test_Graph, components)
+{
+    const int num = 30;
+    CSRArrayKokkos<double> graph = grid_graph(num, 5);
+    DCArrayKokkos<size_t> labels(num * num, "labels");
+    CArrayKokkos<size_t> component(num * num, "component");
+
+    EXPECT_EQ(graph_components(graph, component), 2);
+
+    FOR_ALL(v, 0, num * num, {
+        labels(v) = component(v);
+    });
+    labels.update_host();
+    EXPECT_EQ(labels.host(4 * num + 4), 0);
+    EXPECT_EQ(labels.host(num * num - 1), 5);
+
+    // without the sampling step
+    GraphComponentsOptions options;
+    options.neighbor_rounds = 0;
+    EXPECT_EQ(graph_components(graph, component, options), 2);
+}
+
+// Test that distance-1 and distance-2 colorings have no conflicts
+TEST(Test_Graph, coloring)
+{
+    const int num = 20;
+    CSRArrayKokkos<double> graph = grid_graph(num, 0);
+
+    for (int distance = 1; distance <= 2; distance++) {
+        GraphColoring coloring = graph_color(graph, distance);
+        EXPECT_EQ(coloring.color_start.host(coloring.num_colors), num * num);
+        EXPECT_LE(coloring.num_colors, distance == 1 ? 5 : 13);
+
+        size_t conflicts = 0;
+        size_t loc_conflicts;
+        const bool two_hop = distance == 2;
+        CArrayKokkos<int> color = coloring.color;
+        FOR_REDUCE_SUM(v, 0, num * num, loc_conflicts, {
+            graph_visit_neighbors(graph, v, two_hop, [&](size_t u) {
+                loc_conflicts += (color(u) == color(v)) ? 1 : 0;
+            });
+        }, conflicts);
+        EXPECT_EQ(conflicts, 0);
+
+        // grouped vertices carry their color
+        size_t misplaced = 0;
+        size_t loc_misplaced;
+        CArrayKokkos<size_t> vertices = coloring.vertices;
+        const size_t start = coloring.color_start.host(1);
+        const size_t end   = coloring.color_start.host(2);
+        FOR_REDUCE_SUM(k, start, end, loc_misplaced, {
+            loc_misplaced += (color(vertices(k)) == 1) ? 0 : 1;
+        }, misplaced);
+        EXPECT_EQ(misplaced, 0);
+    }
+
+    // a graph without vertices has no colors
+    GraphColoring empty = graph_color(CSRArrayKokkos<double>());
+    EXPECT_EQ(empty.num_colors, 0);
+    EXPECT_EQ(empty.color_start.host(0), 0);
+}
@@ -0,0 +1,158 @@
+#include "matar.h"
+#include "gtest/gtest.h"
+#include <stdio.h>
+
+using namespace mtr; // matar namespace
+
+
+// Test the DLPack style descriptor of host arrays
+TEST(Test_Interop, descriptor)
+{
+    TensorDescriptor desc;
+    double* first = nullptr;
+    {
+        FArray<double> A(3, 4);
+        for (size_t i = 0; i < A.size(); i++) {
+            A.pointer()[i] = i;
+        }
+        first = A.pointer();
+        desc = to_descriptor(A);
+    }
+
+    // the descriptor keeps the memory of A alive
+    EXPECT_EQ(desc.data, first);
+    EXPECT_EQ(desc.ndim, 2);
+    EXPECT_EQ(desc.device_type, static_cast<int32_t>(DeviceKind::CPU));
+    EXPECT_EQ(desc.dtype_code, static_cast<uint8_t>(DataKind::Float));
+    EXPECT_EQ(desc.dtype_bits, 64);
+    EXPECT_EQ(desc.shape[1], 4);
+    EXPECT_EQ(desc.strides[0], 1);
+    EXPECT_EQ(desc.strides[1], 3);
+
+    ViewStridedArray<double> B = from_descriptor<double>(desc);
+    EXPECT_DOUBLE_EQ(B(2, 1), 5.0);
+
+    // a sub-view and a 1-based matrix
+    CArray<int> C(4, 6);
+    TensorDescriptor sub = to_descriptor(C.subview(Range{1, 4}, Range{0, 6, 2}));
+    EXPECT_EQ(sub.shape[0], 3);
+    EXPECT_EQ(sub.shape[1], 3);
+    EXPECT_EQ(sub.strides[0], 6);
+    EXPECT_EQ(sub.strides[1], 2);
+    EXPECT_EQ(sub.dtype_code, static_cast<uint8_t>(DataKind::Int));
+
+    CMatrix<float> M(2, 5);
+    TensorDescriptor mat = to_descriptor(M);
+    EXPECT_EQ(mat.shape[0], 2);
+    EXPECT_EQ(mat.strides[0], 5);
+    EXPECT_EQ(mat.dtype_bits, 32);
+
+    // a buffer from another library without strides is compact row-major
+    double buffer[24];
+    for (int i = 0; i < 24; i++) {
+        buffer[i] = i;
+    }
+    TensorDescriptor ext;
+    ext.data     = buffer;
+    ext.ndim     = 3;
+    ext.shape[0] = 2;
+    ext.shape[1] = 3;
+    ext.shape[2] = 4;
+    ViewStridedArray<double> E = from_descriptor<double>(ext);
+    EXPECT_DOUBLE_EQ(E(1, 2, 3), 23.0);
+    EXPECT_DOUBLE_EQ(E(0, 1, 0), 4.0);
+}
+
+// Test the Kokkos::View adapters in both directions
+TEST(Test_Interop, kokkos_view)
+{
+    const int size = 5;
+    CArrayKokkos<double> A(size, 3, "A");
+    FOR_ALL(i, 0, size,
+            j, 0, 3, {
+        A(i, j) = 10.0 * i + j;
+    });
+
+    auto v = to_kokkos_view<2>(A);
+    static_assert(std::is_same<decltype(v)::array_layout, Kokkos::LayoutRight>::value, "C types are LayoutRight");
+    EXPECT_EQ(v.data(), A.pointer());
+    EXPECT_EQ(v.extent(0), size);
+    EXPECT_EQ(v.extent(1), 3);
+
+    ViewCArrayKokkos<double> B = from_kokkos_view(v);
+    EXPECT_EQ(B.pointer(), A.pointer());
+    EXPECT_EQ(B.dims(1), 3);
+
+    FArrayKokkos<double> F(4, 2, "F");
+    auto fv = to_kokkos_view<2>(F);
+    static_assert(std::is_same<decltype(fv)::array_layout, Kokkos::LayoutLeft>::value, "F types are LayoutLeft");
+    ViewFArrayKokkos<double> G = from_kokkos_view(fv);
+    EXPECT_EQ(G.pointer(), F.pointer());
+
+    // a strided column through LayoutStride
+    ViewStridedArrayKokkos<double> column = A.subview(Range{}, 2);
+    auto sv = to_kokkos_view<1>(column);
+    EXPECT_EQ(sv.stride(0), 3);
+
+    ViewStridedArrayKokkos<double> back = from_kokkos_view(sv);
+    double total = 0.0;
+    double total_loc;
+    FOR_REDUCE_SUM(i, 0, size, total_loc, {
+        total_loc += back(i) + sv(i);
+    }, total);
+    EXPECT_DOUBLE_EQ(total, 2.0 * (10.0 * size * (size - 1) / 2 + 2.0 * size));
+}
+
+#ifdef MATAR_HAVE_MDSPAN
+// Test the mdspan adapters in both directions
+TEST(Test_Interop, mdspan)
+{
+    CArray<double> A(3, 4, 5);
+    for (size_t i = 0; i < A.size(); i++) {
+        A.pointer()[i] = i;
+    }
+    auto m = to_mdspan<3>(A);
+    static_assert(std::is_same<decltype(m)::layout_type, mdspan_ns::layout_right>::value, "C types are layout_right");
+    EXPECT_EQ(m.data_handle(), A.pointer());
+    EXPECT_EQ(m.extent(2), 5);
+    EXPECT_EQ(m.stride(0), 20);
+    EXPECT_DOUBLE_EQ(m.data_handle()[m.mapping()(1, 2, 3)], A(1, 2, 3));
+
+    ViewCArray<double> B = from_mdspan(m);
+    EXPECT_EQ(&B(1, 2, 3), &A(1, 2, 3));
+
+    FArray<double> F(3, 4);
+    auto fm = to_mdspan<2>(F);
+    static_assert(std::is_same<decltype(fm)::layout_type, mdspan_ns::layout_left>::value, "F types are layout_left");
+    EXPECT_EQ(fm.stride(1), 3);
+    ViewFArray<double> G = from_mdspan(fm);
+    EXPECT_EQ(&G(2, 1), &F(2, 1));
+
+    // a strided slab through layout_stride
+    auto s = to_mdspan<2>(A.subview(1, Range{}, Range{0, 5, 2}));
+    static_assert(std::is_same<decltype(s)::layout_type, mdspan_ns::layout_stride>::value, "strided views are layout_stride");
+    EXPECT_EQ(s.stride(1), 2);
+    ViewStridedArray<double> H = from_mdspan(s);
+    EXPECT_EQ(&H(3, 2), &A(1, 3, 4));
+
+#ifdef HAVE_KOKKOS
+    // device memory comes back as the Kokkos view types
+    const int size = 5;
+    CArrayKokkos<double> D(size, 3, "D");
+    FOR_ALL(i, 0, size,
+            j, 0, 3, {
+        D(i, j) = 10.0 * i + j;
+    });
+    ViewCArrayKokkos<double> E = from_mdspan_kokkos(to_mdspan<2>(D));
+    EXPECT_EQ(E.pointer(), D.pointer());
+
+    double total = 0.0;
+    double total_loc;
+    FOR_REDUCE_SUM(i, 0, size,
+                   j, 0, 3, total_loc, {
+        total_loc += E(i, j);
+    }, total);
+    EXPECT_DOUBLE_EQ(total, 3.0 * 10.0 * size * (size - 1) / 2 + size * 3.0);
+#endif
+}
+#endif
@@ -0,0 +1,78 @@
+#include "matar.h"
+#include "gtest/gtest.h"
+#include <stdio.h>
+
+using namespace mtr; // matar namespace
+
+
+// Test that scopes give memory back and the blocks are reused
+TEST(Test_MemoryArena, scopes)
+{
+    HostArena arena(1024, "test_arena");
+
+    double* first = nullptr;
+    {
+        ArenaScope<HostArena> scope(arena);
+        ViewCArray<double> A = arena.carray<double>(4, 8);
+        first = A.pointer();
+        EXPECT_EQ(A.size(), 32);
+        EXPECT_EQ(arena.used(), 256);
+        EXPECT_EQ(reinterpret_cast<uintptr_t>(A.pointer()) % 64, 0);
+
+        {
+            ArenaScope<HostArena> inner(arena);
+            ViewFMatrix<int> B = arena.fmatrix<int>(3, 3);
+            B(3, 3) = 1;
+            EXPECT_EQ(arena.used(), 256 + 64);
+        }
+        EXPECT_EQ(arena.used(), 256);
+    }
+    EXPECT_EQ(arena.used(), 0);
+
+    // the same memory is handed out again
+    ArenaScope<HostArena> scope(arena);
+    ViewCArray<double> C = arena.carray<double>(32);
+    EXPECT_EQ(C.pointer(), first);
+    EXPECT_EQ(arena.num_blocks(), 1);
+}
+
+// Test requests larger than a block
+TEST(Test_MemoryArena, growth)
+{
+    HostArena arena(1024, "test_arena");
+
+    ViewCArray<char> small = arena.carray<char>(1000);
+    ViewCArray<char> large = arena.carray<char>(5000);
+    EXPECT_EQ(arena.num_blocks(), 2);
+    EXPECT_GE(arena.capacity(), 1024 + 5000);
+    EXPECT_NE(small.pointer(), large.pointer());
+
+    arena.reset();
+    EXPECT_EQ(arena.used(), 0);
+    EXPECT_EQ(arena.num_blocks(), 2);
+}
+
+// Test device scratch arrays inside a loop
+TEST(Test_MemoryArena, device)
+{
+    DeviceArena arena(1 << 16, "scratch");
+
+    for (int cycle = 0; cycle < 3; cycle++) {
+        ArenaScope<DeviceArena> scope(arena);
+        ViewCArrayKokkos<double> v = arena.carray<double>(10, 3);
+
+        FOR_ALL(i, 0, 10,
+                j, 0, 3, {
+            v(i, j) = i + j + cycle;
+        });
+
+        double sum = 0.0;
+        double lsum;
+        FOR_REDUCE_SUM(i, 0, 10, lsum, {
+            lsum += v(i, 0);
+        }, sum);
+        EXPECT_DOUBLE_EQ(sum, 45.0 + 10.0 * cycle);
+    }
+    EXPECT_EQ(arena.used(), 0);
+    EXPECT_EQ(arena.num_blocks(), 1);
+}
@@ -0,0 +1,125 @@
+#include "matar.h"
+#include "gtest/gtest.h"
+
+using namespace mtr; // matar namespace
+
+#ifdef HAVE_MPI
+
+// Test the contiguous maps, the lookup is a subtraction
+TEST(Test_PartitionMap, contiguous)
+{
+    int rank, num_ranks;
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+    MPI_Comm_size(MPI_COMM_WORLD, &num_ranks);
+
+    // every rank holds 10 indices, rank r holds 10r to 10r+9
+    const size_t num_global = 10 * num_ranks;
+    PartitionMap<long long> map(num_global, MPI_COMM_WORLD, "map");
+    EXPECT_TRUE(map.contiguous());
+    EXPECT_EQ(map.size(), 10);
+
+    const long long first = 10 * rank;
+    int errors = 0;
+    int errors_loc;
+    FOR_REDUCE_SUM(i, 0, 10, errors_loc, {
+        errors_loc += map.getLocalIndex(first + i) != i;
+        errors_loc += map.getGlobalIndex(i) != first + i;
+        errors_loc += !map.isProcessGlobalIndex(first + i);
+    }, errors);
+    EXPECT_EQ(errors, 0);
+
+    for (int i = 0; i < 10; i++) {
+        EXPECT_EQ(map.getLocalIndexHost(first + i), i);
+        EXPECT_EQ(map.getGlobalIndexHost(i), first + i);
+    }
+    EXPECT_EQ(map.getLocalIndexHost(first - 1), -1);
+    EXPECT_EQ(map.getLocalIndexHost(first + 10), -1);
+    EXPECT_FALSE(map.isProcessLocalIndex(10));
+}
+
+// Test an arbitrary set of indices, the lookup probes the hash table
+TEST(Test_PartitionMap, hashed)
+{
+    const int size = 1000;
+    DCArrayKokkos<long long> gids(size, "gids");
+    for (int i = 0; i < size; i++) {
+        gids.host(i) = 7 * (size - i) + 3;  // descending, with gaps
+    }
+    gids.update_device();
+
+    PartitionMap<long long> map(gids, MPI_COMM_WORLD, "map");
+    EXPECT_FALSE(map.contiguous());
+    EXPECT_EQ(map.size(), size);
+
+    int errors = 0;
+    int errors_loc;
+    FOR_REDUCE_SUM(i, 0, size, errors_loc, {
+        const long long gid = 7 * (size - i) + 3;
+        errors_loc += map.getLocalIndex(gid) != i;
+        errors_loc += map.getGlobalIndex(i) != gid;
+        errors_loc += map.getLocalIndex(gid + 1) != -1;  // missing keys
+        errors_loc += map.isProcessGlobalIndex(gid - 1);
+    }, errors);
+    EXPECT_EQ(errors, 0);
+
+    for (int i = 0; i < size; i++) {
+        EXPECT_EQ(map.getLocalIndexHost(7 * (size - i) + 3), i);
+    }
+    EXPECT_EQ(map.getLocalIndexHost(0), -1);
+    EXPECT_EQ(map.getLocalIndexHost(8 * size), -1);
+
+    // a copy shares the table
+    PartitionMap<long long> copy = map;
+    EXPECT_EQ(copy.getLocalIndexHost(7 * size + 3), 0);
+
+    // editing on the host and updating rebuilds the table
+    map.host(0) = 1;
+    map.update_device();
+    EXPECT_EQ(map.getLocalIndexHost(1), 0);
+    EXPECT_EQ(map.getLocalIndexHost(7 * size + 3), -1);
+}
+
+// Test the unsigned index type used by the mesh decomposition
+TEST(Test_PartitionMap, unsigned_indices)
+{
+    DCArrayKokkos<size_t> gids(5, "gids");
+    for (int i = 0; i < 5; i++) {
+        gids.host(i) = 100 - 10 * i;
+    }
+    gids.update_device();
+
+    PartitionMap<size_t> map(gids, MPI_COMM_WORLD, "map");
+    EXPECT_FALSE(map.contiguous());
+    for (int i = 0; i < 5; i++) {
+        EXPECT_EQ(map.getLocalIndexHost(100 - 10 * i), i);
+    }
+    EXPECT_EQ(map.getLocalIndexHost(55), -1);
+}
+
+// Test maps holding nothing
+TEST(Test_PartitionMap, empty)
+{
+    PartitionMap<long long> unset;
+    EXPECT_EQ(unset.size(), 0);
+    EXPECT_EQ(unset.getLocalIndexHost(0), -1);
+
+    int rank, num_ranks;
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+    MPI_Comm_size(MPI_COMM_WORLD, &num_ranks);
+
+    // only rank 0 holds indices
+    PartitionMap<long long> map(4, rank == 0 ? 4 : 0, MPI_COMM_WORLD, "map");
+    EXPECT_TRUE(map.contiguous());
+    EXPECT_EQ(map.size(), rank == 0 ? 4 : 0);
+    EXPECT_EQ(map.getLocalIndexHost(0), rank == 0 ? 0 : -1);
+    EXPECT_EQ(map.getLocalIndexHost(4), -1);
+
+    int found = 0;
+    int found_loc;
+    FOR_REDUCE_SUM(i, 0, 4, found_loc, {
+        found_loc += map.getLocalIndex(i) >= 0;
+    }, found);
+    EXPECT_EQ(found, rank == 0 ? 4 : 0);
+}
+
+#endif
@@ -0,0 +1,89 @@
+#include "matar.h"
+#include "gtest/gtest.h"
+#include <stdio.h>
+#include <sstream>
+
+using namespace mtr; // matar namespace
+
+
+// Test that nested scopes build a tree and count calls
+TEST(Test_Profiler, nested_scopes)
+{
+    Profiler::instance().reset();
+
+    for (int iter = 0; iter < 3; iter++) {
+        ProfileScope outer("outer");
+        {
+            ProfileScope inner("inner", ProfileCategory::compute);
+        }
+        {
+            ProfileScope copy("copy", ProfileCategory::transfer);
+        }
+    }
+
+    std::vector<ProfileStats> stats = Profiler::instance().local_stats();
+    ASSERT_EQ(stats.size(), 3);
+
+    EXPECT_EQ(stats[0].path, "outer");
+    EXPECT_EQ(stats[0].depth, 0);
+    EXPECT_EQ(stats[0].count, 3);
+
+    EXPECT_EQ(stats[1].path, "outer|inner");
+    EXPECT_EQ(stats[1].depth, 1);
+    EXPECT_EQ(stats[1].count, 3);
+    EXPECT_EQ(stats[1].category, ProfileCategory::compute);
+
+    EXPECT_EQ(stats[2].path, "outer|copy");
+    EXPECT_EQ(stats[2].category, ProfileCategory::transfer);
+
+    // children can not take longer than their parent
+    EXPECT_GE(stats[0].total_avg, stats[1].total_avg + stats[2].total_avg);
+    EXPECT_GE(stats[0].self_avg, 0.0);
+}
+
+// Test that a disabled profiler records nothing
+TEST(Test_Profiler, disable)
+{
+    Profiler::instance().reset();
+    Profiler::instance().enable(false);
+    {
+        ProfileScope scope("ignored");
+    }
+    Profiler::instance().enable(true);
+
+    EXPECT_EQ(Profiler::instance().local_stats().size(), 0);
+}
+
+// Test the JSON and CSV writers
+TEST(Test_Profiler, output)
+{
+    Profiler::instance().reset();
+    {
+        ProfileScope scope("solve");
+        DCArrayKokkos<double> A(10, "A");
+        FOR_ALL(i, 0, 10, {
+            A(i) = 1.0;
+        });
+        A.update_host();
+    }
+
+    std::vector<ProfileStats> stats = Profiler::instance().local_stats();
+
+    std::ostringstream json;
+    Profiler::write_json(json, stats);
+    EXPECT_NE(json.str().find("\"path\": \"solve\""), std::string::npos);
+    EXPECT_NE(json.str().find("\"categories\""), std::string::npos);
+
+    std::ostringstream csv;
+    Profiler::write_csv(csv, stats);
+    EXPECT_EQ(csv.str().find("path,category"), 0);
+    EXPECT_NE(csv.str().find("\"solve\",user"), std::string::npos);
+
+#ifdef MATAR_ENABLE_PROFILING
+    // the loop and the copy are recorded below the user scope
+    EXPECT_NE(json.str().find("solve|FOR_ALL@"), std::string::npos);
+    EXPECT_NE(json.str().find("solve|DCArrayKokkos::update_host"), std::string::npos);
+#endif
+
+    Profiler::instance().reset();
+}
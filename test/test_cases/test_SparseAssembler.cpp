@@ -0,0 +1,106 @@
+#include "matar.h"
+#include "gtest/gtest.h"
+#include <stdio.h>
+
+using namespace mtr; // matar namespace
+
+
+// 1D bar of num elements, each adds [1 -1; -1 1] to its two nodes
+void add_bar(SparseAssembler<double>& assembler, int num, double scale)
+{
+    FOR_ALL(elem, 0, num, {
+        for (int a = 0; a < 2; a++) {
+            for (int b = 0; b < 2; b++) {
+                assembler.insert(4 * elem + 2 * a + b, elem + a, elem + b, (a == b ? scale : -scale));
+            }
+        }
+    });
+}
+
+// Copy a num x num sparse matrix to the host as a dense one
+template <typename Matrix>
+DCArrayKokkos<double> dense_copy(const Matrix& A, int num)
+{
+    DCArrayKokkos<double> dense(num, num, "dense");
+    FOR_ALL(i, 0, num, j, 0, num, {
+        dense(i, j) = A(i, j);
+    });
+    dense.update_host();
+    return dense;
+}
+
+// Test that duplicates are summed into a sorted CSR matrix
+TEST(Test_SparseAssembler, to_csr)
+{
+    const int num = 5;
+    SparseAssembler<double> assembler(num + 1, num + 1, 4 * num);
+    add_bar(assembler, num, 1.0);
+    EXPECT_EQ(assembler.num_triplets(), 4 * num);
+
+    CSRArrayKokkos<double> A = assembler.to_csr();
+    EXPECT_EQ(assembler.nnz(), 3 * num + 1);
+
+    DCArrayKokkos<double> dense = dense_copy(A, num + 1);
+    EXPECT_DOUBLE_EQ(dense.host(0, 0), 1.0);
+    EXPECT_DOUBLE_EQ(dense.host(2, 2), 2.0);
+    EXPECT_DOUBLE_EQ(dense.host(2, 1), -1.0);
+    EXPECT_DOUBLE_EQ(dense.host(2, 3), -1.0);
+    EXPECT_DOUBLE_EQ(dense.host(2, 4), 0.0);
+    EXPECT_DOUBLE_EQ(dense.host(num, num), 1.0);
+
+    // appended triplets land in the same matrix
+    SparseAssembler<double> appended(num + 1, num + 1, 4 * num);
+    FOR_ALL(elem, 0, num, {
+        appended.add(elem + 1, elem + 1, 1.0);
+        appended.add(elem, elem, 1.0);
+        appended.add(elem, elem + 1, -1.0);
+        appended.add(elem + 1, elem, -1.0);
+    });
+    DCArrayKokkos<double> other = dense_copy(appended.to_csr(), num + 1);
+    for (int i = 0; i < num + 1; i++) {
+        for (int j = 0; j < num + 1; j++) {
+            EXPECT_DOUBLE_EQ(other.host(i, j), dense.host(i, j));
+        }
+    }
+
+    // too many triplets for the capacity
+    SparseAssembler<double> small(num + 1, num + 1, num);
+    FOR_ALL(elem, 0, num, {
+        small.add(elem, elem, 1.0);
+        small.add(elem + 1, elem + 1, 1.0);
+    });
+    EXPECT_THROW(small.to_csr(), std::runtime_error);
+}
+
+// Test the CSC output and summing into the pattern again
+TEST(Test_SparseAssembler, reuse)
+{
+    const int num = 5;
+    SparseAssembler<double> assembler(num + 1, num + 1, 4 * num);
+    add_bar(assembler, num, 1.0);
+    CSCArrayKokkos<double> A = assembler.to_csc();
+
+    // by triplet, doubles the matrix
+    assembler.zero_values();
+    FOR_ALL(n, 0, 4 * num, {
+        assembler.sum_into(n, (n % 4 == 0 || n % 4 == 3) ? 2.0 : -2.0);
+    });
+    DCArrayKokkos<double> dense = dense_copy(A, num + 1);
+    EXPECT_DOUBLE_EQ(dense.host(0, 0), 2.0);
+    EXPECT_DOUBLE_EQ(dense.host(2, 2), 4.0);
+    EXPECT_DOUBLE_EQ(dense.host(3, 2), -2.0);
+
+    // by row and column, entries outside the pattern are refused
+    DCArrayKokkos<int> found(2, "found");
+    RUN({
+        found(0) = assembler.sum_into(3, 2, 1.0);
+        found(1) = assembler.sum_into(0, 4, 1.0);
+    });
+    found.update_host();
+    EXPECT_EQ(found.host(0), 1);
+    EXPECT_EQ(found.host(1), 0);
+
+    dense = dense_copy(A, num + 1);
+    EXPECT_DOUBLE_EQ(dense.host(3, 2), -1.0);
+    EXPECT_DOUBLE_EQ(dense.host(0, 4), 0.0);
+}
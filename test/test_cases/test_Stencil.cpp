@@ -0,0 +1,174 @@
+#include "matar.h"
+#include "gtest/gtest.h"
+#include <stdio.h>
+
+using namespace mtr; // matar namespace
+
+
+struct Jacobi2D {
+    template <typename Field>
+    KOKKOS_INLINE_FUNCTION
+    double operator()(const Field& u, const int i, const int j) const {
+        return 0.25 * (u(i + 1, j) + u(i - 1, j) + u(i, j + 1) + u(i, j - 1));
+    }
+};
+
+struct Jacobi3D {
+    template <typename Field>
+    KOKKOS_INLINE_FUNCTION
+    double operator()(const Field& u, const int i, const int j, const int k) const {
+        return (u(i + 1, j, k) + u(i - 1, j, k) + u(i, j + 1, k) +
+                u(i, j - 1, k) + u(i, j, k + 1) + u(i, j, k - 1)) / 6.0;
+    }
+};
+
+// hot left wall, cold elsewhere
+void set_plate(StencilGrid<double, 2>& grid)
+{
+    auto u = grid.current();
+    const int height = grid.dims(0);
+    const int width  = grid.dims(1);
+    FOR_ALL(i, 0, height + 2,
+            j, 0, width + 2, {
+        u(i, j) = (j == 0) ? 100.0 : 0.0;
+    });
+}
+
+// Test a sweep against the hand written update
+TEST(Test_Stencil, sweep)
+{
+    const int height = 12;
+    const int width  = 9;
+    StencilShape shape;
+    StencilGrid<double, 2> grid(shape, height, width, "plate");
+    set_plate(grid);
+
+    double change = grid.sweep(Jacobi2D());
+    EXPECT_DOUBLE_EQ(change, 25.0);
+
+    change = grid.sweep(Jacobi2D());
+    auto u_new = grid.current();
+    auto u_old = grid.previous();
+
+    double expected_change = 0.0;
+    double loc_change;
+    FOR_REDUCE_MAX(i, 1, height + 1,
+                   j, 1, width + 1, loc_change, {
+        double value = 0.25 * (u_old(i + 1, j) + u_old(i - 1, j) + u_old(i, j + 1) + u_old(i, j - 1));
+        double diff = fabs(value - u_old(i, j));
+        loc_change = diff > loc_change ? diff : loc_change;
+    }, expected_change);
+    EXPECT_DOUBLE_EQ(change, expected_change);
+
+    // the fixed ghosts are carried over to both buffers
+    int bad = 0;
+    int loc_bad;
+    FOR_REDUCE_SUM(i, 1, height + 1, loc_bad, {
+        loc_bad += (u_new(i, 0) != 100.0) + (u_old(i, 0) != 100.0);
+    }, bad);
+    EXPECT_EQ(bad, 0);
+}
+
+// Test that several sweeps per pass give the same field as one at a time
+TEST(Test_Stencil, temporal_blocking_2D)
+{
+    const int height = 21;
+    const int width  = 17;
+    StencilShape shape;
+    StencilGrid<double, 2> plain(shape, height, width);
+    StencilGrid<double, 2> blocked(shape, height, width);
+    set_plate(plain);
+    set_plate(blocked);
+    blocked.set_tile(5);
+
+    double plain_change = 0.0;
+    for (int step = 0; step < 10; step++) {
+        plain_change = plain.sweep(Jacobi2D());
+    }
+    double blocked_change = blocked.sweep(Jacobi2D(), 10, 4);
+    EXPECT_NEAR(blocked_change, plain_change, 1e-12);
+
+    auto a = plain.current();
+    auto b = blocked.current();
+    double error = 0.0;
+    double loc_error;
+    FOR_REDUCE_MAX(i, 1, height + 1,
+                   j, 1, width + 1, loc_error, {
+        double diff = fabs(a(i, j) - b(i, j));
+        loc_error = diff > loc_error ? diff : loc_error;
+    }, error);
+    EXPECT_LT(error, 1e-12);
+}
+
+// Test the 3D blocked sweeps
+TEST(Test_Stencil, temporal_blocking_3D)
+{
+    const int n = 10;
+    StencilShape shape;
+    StencilGrid<double, 3> plain(shape, n, n, n);
+    StencilGrid<double, 3> blocked(shape, n, n, n);
+    blocked.set_tile(4);
+
+    auto a = plain.current();
+    auto b = blocked.current();
+    FOR_ALL(i, 0, n + 2,
+            j, 0, n + 2,
+            k, 0, n + 2, {
+        a(i, j, k) = (k == 0) ? 1.0 : 0.0;
+        b(i, j, k) = a(i, j, k);
+    });
+
+    for (int step = 0; step < 6; step++) {
+        plain.sweep(Jacobi3D());
+    }
+    blocked.sweep(Jacobi3D(), 6, 3);
+
+    a = plain.current();
+    b = blocked.current();
+    double error = 0.0;
+    double loc_error;
+    FOR_REDUCE_MAX(i, 1, n + 1,
+                   j, 1, n + 1,
+                   k, 1, n + 1, loc_error, {
+        double diff = fabs(a(i, j, k) - b(i, j, k));
+        loc_error = diff > loc_error ? diff : loc_error;
+    }, error);
+    EXPECT_LT(error, 1e-12);
+}
+
+// Test the periodic and zero gradient ghosts
+TEST(Test_Stencil, ghost_kinds)
+{
+    const int n = 6;
+    StencilShape shape;
+    shape.ghosts = GhostKind::periodic;
+    StencilGrid<double, 2> periodic(shape, n, n);
+    shape.ghosts = GhostKind::zero_gradient;
+    StencilGrid<double, 2> mirrored(shape, n, n);
+
+    auto p = periodic.current();
+    auto m = mirrored.current();
+    FOR_ALL(i, 1, n + 1,
+            j, 1, n + 1, {
+        p(i, j) = 10 * i + j;
+        m(i, j) = 10 * i + j;
+    });
+
+    // the ghosts are filled before the sweep, they are in the old field
+    periodic.sweep(Jacobi2D());
+    mirrored.sweep(Jacobi2D());
+    p = periodic.previous();
+    m = mirrored.previous();
+
+    int bad = 0;
+    int loc_bad;
+    FOR_REDUCE_SUM(i, 0, n + 2, loc_bad, {
+        const int wrap = (i == 0) ? n : ((i == n + 1) ? 1 : i);
+        const int clamp = (i == 0) ? 1 : ((i == n + 1) ? n : i);
+        loc_bad += (p(i, 0) != p(wrap, n)) + (p(i, n + 1) != p(wrap, 1));
+        loc_bad += (p(0, i) != p(n, wrap)) + (p(n + 1, i) != p(1, wrap));
+        loc_bad += (m(i, 0) != m(clamp, 1)) + (m(i, n + 1) != m(clamp, n));
+        loc_bad += (m(0, i) != m(1, clamp)) + (m(n + 1, i) != m(n, clamp));
+    }, bad);
+    EXPECT_EQ(bad, 0);
+}
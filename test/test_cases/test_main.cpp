@@ -2,11 +2,17 @@
 #include "matar.h"
 
 int main(int argc, char** argv) {
+#ifdef HAVE_MPI
+    MPI_Init(&argc, &argv);
+#endif
     Kokkos::initialize(argc, argv);
     {
         ::testing::InitGoogleTest(&argc, argv);
         int result = RUN_ALL_TESTS();
         Kokkos::finalize();
+#ifdef HAVE_MPI
+        MPI_Finalize();
+#endif
         return result;
     }
 } 
\ No newline at end of file
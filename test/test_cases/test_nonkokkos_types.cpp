@@ -223,6 +223,27 @@ TEST(StandaredTypesTests, FunctionModifyDenseTypes)
 }
 
 
+TEST(StandaredTypesTests, AlignedAllocation)
+{
+  // cache line alignment by default
+  CArray<double> carray(100);
+  FMatrix<char> fmatrix(3, 7);
+  EXPECT_EQ(reinterpret_cast<uintptr_t>(carray.pointer()) % 64, 0);
+  EXPECT_EQ(reinterpret_cast<uintptr_t>(fmatrix.pointer()) % 64, 0);
+
+  // page alignment
+  host_alloc_policy().alignment = 4096;
+  FArray<float> farray(10);
+  EXPECT_EQ(reinterpret_cast<uintptr_t>(farray.pointer()) % 4096, 0);
+  host_alloc_policy() = HostAllocPolicy();
+
+  // non trivial types are constructed and destroyed
+  CArray<std::string> names(4);
+  names(2) = "node";
+  EXPECT_EQ(names(0), "");
+  EXPECT_EQ(names(2), "node");
+}
+
 // TEST(StandaredTypesTests, FunctionModifyRaggedTypes)
 // {
 //   const size_t dim = 4;
@@ -251,3 +272,98 @@ TEST(StandaredTypesTests, FunctionModifyDenseTypes)
 //   }
 // }
 
+
+// Test zero copy slices and strided sub-views of the host types
+TEST(StandaredTypesTests, SlicesAndSubviews)
+{
+    CArray<double> A(4, 5, 6);
+    for (size_t i = 0; i < A.size(); i++) {
+        A.pointer()[i] = i;
+    }
+
+    ViewCArray<double> plane = A.slice(3);
+    EXPECT_EQ(plane.order(), 2);
+    EXPECT_EQ(&plane(1, 2), &A(3, 1, 2));
+
+    ViewStridedArray<double> block = A.subview(Range{1, 3}, Range{}, Range{0, 6, 3});
+    EXPECT_EQ(block.order(), 3);
+    EXPECT_EQ(block.size(), 2 * 5 * 2);
+    EXPECT_EQ(&block(1, 4, 1), &A(2, 4, 3));
+    EXPECT_FALSE(block.is_contiguous());
+
+    // sub-view of a sub-view
+    ViewStridedArray<double> line = block.subview(0, Range{}, 1);
+    EXPECT_EQ(line.order(), 1);
+    EXPECT_EQ(&line(2), &A(1, 2, 3));
+
+    line.set_values(-1.0);
+    EXPECT_DOUBLE_EQ(A(1, 4, 3), -1.0);
+    EXPECT_DOUBLE_EQ(A(1, 4, 2), 1 * 30 + 4 * 6 + 2);
+
+    FArray<double> F(3, 4);
+    ViewFArray<double> col = F.slice(2);
+    EXPECT_EQ(col.size(), 3);
+    EXPECT_EQ(&col(1), &F(1, 2));
+    EXPECT_EQ(F.subview(2, Range{}).stride(0), 3);
+}
+
+// Test file backed arrays and the streaming loop over them
+TEST(StandaredTypesTests, MappedFileArrays)
+{
+    const char* name = "test_mapped_array.bin";
+    {
+        CArray<double> A(MappedFile(name, MapMode::create), 100, 64);
+        EXPECT_TRUE(A.is_mapped());
+        EXPECT_EQ(A.order(), 2);
+        EXPECT_EQ(A.size(), 6400);
+
+        FOR_ALL_STREAM(i, 0, A.dims(0), 7, (A), {
+            for (size_t j = 0; j < 64; j++) {
+                A(i, j) = 100.0 * i + j;
+            }
+        });
+        A.flush();
+    }
+
+    // map the file again, as a read only C array and as an F array
+    CArray<double> A(MappedFile(name, MapMode::read_only, 0, MapAdvice::sequential), 100, 64);
+    FArray<double> F(MappedFile(name, MapMode::private_copy), 64, 100);
+    CArray<double> B(100, 64);
+    EXPECT_FALSE(B.is_mapped());
+
+    FOR_ALL_STREAM(i, 0, 100, 16, (A, F, B), {
+        for (size_t j = 0; j < 64; j++) {
+            B(i, j) = A(i, j) + F(j, i);
+        }
+    });
+    EXPECT_DOUBLE_EQ(B(99, 63), 2.0 * 9963.0);
+    EXPECT_DOUBLE_EQ(B(0, 5), 10.0);
+
+    // copy on write, the file keeps its values
+    F(0, 0) = -1.0;
+    EXPECT_DOUBLE_EQ(A(0, 0), 0.0);
+
+    EXPECT_THROW(CArray<double>(MappedFile(name, MapMode::read_only), 1000, 64), std::runtime_error);
+    remove(name);
+}
+
+// Test the CSR array built from a dense matrix
+TEST(StandaredTypesTests, CSRArrayFromDense)
+{
+    CArray<double> dense(3, 4);
+    dense.set_values(0.0);
+    dense(0, 1) = 2.0;
+    dense(1, 0) = -1.0;
+    dense(1, 3) = 4.0;
+    dense(2, 2) = 3.0;
+
+    CSRArray<double> csr(dense);
+    EXPECT_EQ(csr.nnz(), 4);
+    EXPECT_EQ(csr.stride(0), 1);
+    EXPECT_EQ(csr.stride(1), 2);
+    EXPECT_EQ(csr.begin_index(2), 3);
+    EXPECT_EQ(csr.get_col_flat(2), 3);
+    EXPECT_DOUBLE_EQ(csr(1, 3), 4.0);
+    EXPECT_DOUBLE_EQ(csr(2, 2), 3.0);
+    EXPECT_DOUBLE_EQ(csr(2, 0), 0.0);
+}